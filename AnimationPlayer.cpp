@@ -0,0 +1,65 @@
+#include "AnimationPlayer.h"
+#include <QLabel>
+#include <QTimer>
+#include <QDebug>
+
+AnimationPlayer::AnimationPlayer(QLabel *label, QObject *parent)
+    : QObject(parent)
+    , m_label(label)
+    , m_timer(new QTimer(this))
+{
+    m_timer->setSingleShot(true);
+    m_timer->setTimerType(Qt::PreciseTimer);
+    connect(m_timer, &QTimer::timeout, this, &AnimationPlayer::advance);
+}
+
+void AnimationPlayer::setSource(const QString &path, const QSize &size)
+{
+    m_source = path;
+    m_frames.reset();
+    m_frameIndex = 0;
+    m_timer->stop();
+
+    AssetService::instance().loadAnimation(path, size, this, [this, path](AnimationFramesPtr frames) {
+        if (path != m_source) return; // 期间又换了素材
+        if (!frames) {
+            qDebug() << "错误：无法加载动画文件:" << path;
+            return;
+        }
+        m_frames = frames;
+        showFrame(0);
+        if (m_running) m_timer->start(m_frames->delays.value(0, 100));
+    });
+}
+
+void AnimationPlayer::start()
+{
+    m_running = true;
+    if (isValid() && !m_timer->isActive()) {
+        m_timer->start(m_frames->delays.value(m_frameIndex, 100));
+    }
+}
+
+void AnimationPlayer::stop()
+{
+    m_running = false;
+    m_timer->stop();
+}
+
+void AnimationPlayer::showFrame(int index)
+{
+    m_frameIndex = index;
+    if (m_label) m_label->setPixmap(m_frames->frames.at(index));
+}
+
+void AnimationPlayer::advance()
+{
+    if (!m_running || !isValid() || !m_label) return;
+    if (m_frames->frames.size() == 1) return; // 静态图片不需要定时器
+
+    // 窗口隐藏或最小化时不换帧，只按原节奏等待
+    if (m_label->isVisible()) {
+        showFrame((m_frameIndex + 1) % m_frames->frames.size());
+    }
+    m_timer->start(m_frames->delays.value(m_frameIndex, 100));
+}
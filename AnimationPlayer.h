@@ -0,0 +1,40 @@
+#ifndef ANIMATIONPLAYER_H
+#define ANIMATIONPLAYER_H
+
+#include "AssetService.h"
+#include <QObject>
+#include <QPointer>
+
+class QLabel;
+class QTimer;
+
+// 在 QLabel 上播放 AssetService 解码好的帧，代替每个窗口各自持有一个 QMovie。
+// 帧数据与其他窗口共用；标签不可见时不推进帧。
+class AnimationPlayer : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit AnimationPlayer(QLabel *label, QObject *parent = nullptr);
+
+    // 指定素材和目标尺寸（无效尺寸表示原始大小）；帧就绪前先不显示
+    void setSource(const QString &path, const QSize &size = QSize());
+    void start();
+    void stop();
+    void setPaused(bool paused) { paused ? stop() : start(); }
+    bool isRunning() const { return m_running; }
+    bool isValid() const { return m_frames && !m_frames->frames.isEmpty(); }
+
+private:
+    void showFrame(int index);
+    void advance();
+
+    QPointer<QLabel> m_label;
+    QTimer *m_timer;
+    QString m_source;
+    AnimationFramesPtr m_frames;
+    int m_frameIndex = 0;
+    bool m_running = false;
+};
+
+#endif // ANIMATIONPLAYER_H
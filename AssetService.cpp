@@ -0,0 +1,199 @@
+#include "AssetService.h"
+#include <QCoreApplication>
+#include <QFutureWatcher>
+#include <QImage>
+#include <QImageReader>
+#include <QSettings>
+#include <QtConcurrent>
+#include <QDebug>
+#include <limits>
+
+namespace {
+
+// 后台线程里只产出 QImage，QPixmap 必须在主线程创建
+struct DecodedImages {
+    QList<QImage> images;
+    QList<int> delays;
+    qint64 decodeMs = 0;
+};
+
+DecodedImages decodeAnimation(const QString &path, const QSize &size)
+{
+    QElapsedTimer elapsed;
+    elapsed.start();
+
+    DecodedImages result;
+    QImageReader reader(path);
+    const QSize original = reader.size();
+    if (size.isValid() && original.isValid()) {
+        // 只缩小不放大，并保持宽高比
+        const QSize scaled = original.scaled(size.boundedTo(original), Qt::KeepAspectRatio);
+        reader.setScaledSize(scaled);
+    }
+
+    // 动画格式每次 read() 取下一帧
+    while (reader.canRead()) {
+        QImage image = reader.read();
+        if (image.isNull()) break;
+        result.images.append(image.convertToFormat(QImage::Format_ARGB32_Premultiplied));
+        const int delay = reader.nextImageDelay();
+        result.delays.append(delay > 0 ? delay : 100);
+    }
+    if (result.images.isEmpty()) {
+        qDebug() << "素材解码失败：" << path << reader.errorString();
+    }
+
+    result.decodeMs = elapsed.elapsed();
+    return result;
+}
+
+} // namespace
+
+AssetService &AssetService::instance()
+{
+    static AssetService instance;
+    return instance;
+}
+
+AssetService::AssetService(QObject *parent)
+    : QObject(parent)
+{
+    m_clock.start();
+    QSettings settings("MyCourseApp", "Assets");
+    m_budgetBytes = qMax<qint64>(1, settings.value("frameCacheMB", 32).toLongLong()) * 1024 * 1024;
+
+    // 单例是静态对象，比 QGuiApplication 活得久；缓存里的 QPixmap 要在应用退出前释放
+    if (QCoreApplication *app = QCoreApplication::instance()) {
+        connect(app, &QCoreApplication::aboutToQuit, this, &AssetService::shutdown);
+    }
+}
+
+void AssetService::shutdown()
+{
+    m_shuttingDown = true;
+    // 还在后台解码的素材不再转成 QPixmap，也不再回调
+    const QList<QFutureWatcherBase *> watchers = findChildren<QFutureWatcherBase *>();
+    for (QFutureWatcherBase *watcher : watchers) {
+        watcher->disconnect(this);
+    }
+    m_pending.clear();
+    m_entries.clear();
+    m_cachedBytes = 0;
+}
+
+QString AssetService::keyFor(const QString &path, const QSize &size)
+{
+    return size.isValid() ? QString("%1@%2x%3").arg(path).arg(size.width()).arg(size.height()) : path;
+}
+
+void AssetService::setBudgetBytes(qint64 bytes)
+{
+    m_budgetBytes = qMax<qint64>(0, bytes);
+    evict();
+}
+
+void AssetService::loadAnimation(const QString &path, const QSize &size, QObject *context, Callback callback)
+{
+    if (m_shuttingDown) return;
+    const QString key = keyFor(path, size);
+
+    auto it = m_entries.find(key);
+    if (it != m_entries.end()) {
+        AnimationFramesPtr frames = it->strong ? it->strong : it->weak.toStrongRef();
+        if (frames) {
+            // 被淘汰但仍有窗口在用：重新放回缓存
+            if (!it->strong) {
+                it->strong = frames;
+                m_cachedBytes += frames->bytes;
+            }
+            it->lastUsedMs = m_clock.elapsed();
+            ++m_stats[key].hits;
+            evict();
+            callback(frames);
+            return;
+        }
+        m_entries.erase(it);
+    }
+
+    const bool alreadyDecoding = m_pending.contains(key);
+    m_pending[key].append(Pending{context, std::move(callback)});
+    if (alreadyDecoding) return;
+
+    auto *watcher = new QFutureWatcher<DecodedImages>(this);
+    connect(watcher, &QFutureWatcher<DecodedImages>::finished, this, [this, watcher, key]() {
+        const DecodedImages decoded = watcher->result();
+        watcher->deleteLater();
+
+        QSharedPointer<AnimationFrames> frames;
+        if (!decoded.images.isEmpty()) {
+            frames = QSharedPointer<AnimationFrames>::create();
+            frames->delays = decoded.delays;
+            frames->decodeMs = decoded.decodeMs;
+            frames->size = decoded.images.first().size();
+            frames->frames.reserve(decoded.images.size());
+            for (const QImage &image : decoded.images) {
+                frames->frames.append(QPixmap::fromImage(image));
+                frames->bytes += image.sizeInBytes();
+            }
+        }
+        onDecoded(key, frames);
+    });
+    watcher->setFuture(QtConcurrent::run(decodeAnimation, path, size));
+}
+
+void AssetService::onDecoded(const QString &key, AnimationFramesPtr frames)
+{
+    if (frames) {
+        Entry &entry = m_entries[key];
+        entry.strong = frames;
+        entry.weak = frames;
+        entry.lastUsedMs = m_clock.elapsed();
+        m_cachedBytes += frames->bytes;
+
+        AssetStats &stats = m_stats[key];
+        stats.bytes = frames->bytes;
+        stats.decodeMs = frames->decodeMs;
+        stats.frameCount = frames->frames.size();
+        ++stats.decodes;
+        emit animationDecoded(key, frames->bytes, frames->decodeMs);
+    }
+
+    const QList<Pending> waiting = m_pending.take(key);
+    for (const Pending &pending : waiting) {
+        if (pending.context) pending.callback(frames);
+    }
+    evict();
+}
+
+// 超出上限时释放最久未用的缓存引用；正在播放的帧仍由播放方持有
+void AssetService::evict()
+{
+    while (m_cachedBytes > m_budgetBytes) {
+        QString oldestKey;
+        qint64 oldestMs = std::numeric_limits<qint64>::max();
+        for (auto it = m_entries.cbegin(); it != m_entries.cend(); ++it) {
+            if (it->strong && it->lastUsedMs < oldestMs) {
+                oldestMs = it->lastUsedMs;
+                oldestKey = it.key();
+            }
+        }
+        if (oldestKey.isEmpty()) break;
+
+        Entry &entry = m_entries[oldestKey];
+        m_cachedBytes -= entry.strong->bytes;
+        entry.strong.reset();
+        if (!entry.weak.toStrongRef()) m_entries.remove(oldestKey);
+    }
+}
+
+QString AssetService::report() const
+{
+    QString text = QString("帧缓存 %1 / %2 KB\n").arg(m_cachedBytes / 1024).arg(m_budgetBytes / 1024);
+    for (auto it = m_stats.cbegin(); it != m_stats.cend(); ++it) {
+        const AssetStats &s = it.value();
+        text += QString("%1: %2 帧, %3 KB, 解码 %4 ms (共 %5 次), 命中 %6 次\n")
+                    .arg(it.key()).arg(s.frameCount).arg(s.bytes / 1024)
+                    .arg(s.decodeMs).arg(s.decodes).arg(s.hits);
+    }
+    return text;
+}
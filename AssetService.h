@@ -0,0 +1,89 @@
+#ifndef ASSETSERVICE_H
+#define ASSETSERVICE_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QList>
+#include <QPixmap>
+#include <QPointer>
+#include <QSharedPointer>
+#include <QSize>
+#include <functional>
+
+// 一段动画按目标尺寸解码后的全部帧
+struct AnimationFrames {
+    QList<QPixmap> frames;
+    QList<int> delays;    // 每帧停留的毫秒数
+    QSize size;           // 实际帧尺寸（按比例缩放后）
+    qint64 bytes = 0;     // 解码后占用的字节数
+    qint64 decodeMs = 0;  // 解码耗时
+};
+using AnimationFramesPtr = QSharedPointer<const AnimationFrames>;
+
+// 全应用共用的图片/动画素材服务：动画第一次用到时才在后台线程解码，
+// 按 (路径, 尺寸) 缓存预缩放好的帧，多个窗口共用同一份。
+// 缓存有内存上限（QSettings "Assets"/"frameCacheMB"，默认 32MB），超出时按最久未用淘汰；
+// 被淘汰但仍在播放的帧由播放方持有，再次请求时直接复用，不重新解码。
+// 应用退出（aboutToQuit）时清空缓存，之后的请求不再回调。
+class AssetService : public QObject
+{
+    Q_OBJECT
+
+public:
+    using Callback = std::function<void(AnimationFramesPtr frames)>;
+
+    struct AssetStats {
+        qint64 bytes = 0;
+        qint64 decodeMs = 0;
+        int frameCount = 0;
+        int decodes = 0; // 解码次数，大于 1 说明被淘汰后又重新解码
+        int hits = 0;    // 命中缓存的次数
+    };
+
+    static AssetService &instance();
+
+    // 取动画帧。已缓存时立即回调，否则后台解码完成后在主线程回调；
+    // 同一素材的并发请求只解码一次。context 已销毁时不再回调。解码失败时 frames 为空。
+    void loadAnimation(const QString &path, const QSize &size, QObject *context, Callback callback);
+
+    qint64 budgetBytes() const { return m_budgetBytes; }
+    void setBudgetBytes(qint64 bytes);
+    qint64 cachedBytes() const { return m_cachedBytes; }
+
+    QHash<QString, AssetStats> stats() const { return m_stats; }
+    QString report() const;
+
+    // 释放缓存的帧并丢弃等待中的回调，aboutToQuit 时自动调用
+    void shutdown();
+
+signals:
+    void animationDecoded(const QString &key, qint64 bytes, qint64 decodeMs);
+
+private:
+    explicit AssetService(QObject *parent = nullptr);
+
+    struct Entry {
+        AnimationFramesPtr strong;            // 缓存持有的引用，淘汰时释放
+        QWeakPointer<const AnimationFrames> weak;
+        qint64 lastUsedMs = 0;
+    };
+    struct Pending {
+        QPointer<QObject> context;
+        Callback callback;
+    };
+
+    static QString keyFor(const QString &path, const QSize &size);
+    void onDecoded(const QString &key, AnimationFramesPtr frames);
+    void evict();
+
+    QHash<QString, Entry> m_entries;
+    QHash<QString, QList<Pending>> m_pending; // 正在解码的素材 -> 等待的回调
+    QHash<QString, AssetStats> m_stats;
+    qint64 m_budgetBytes = 32 * 1024 * 1024;
+    qint64 m_cachedBytes = 0;
+    bool m_shuttingDown = false;
+    QElapsedTimer m_clock;
+};
+
+#endif // ASSETSERVICE_H
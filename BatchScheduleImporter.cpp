@@ -0,0 +1,139 @@
+#include "BatchScheduleImporter.h"
+#include "GroupScheduleStore.h"
+#include "ScheduleHtmlParser.h"
+#include <QDir>
+#include <QDirIterator>
+#include <QFileInfo>
+#include <QSet>
+#include <QtConcurrent/QtConcurrentMap>
+#include <QDebug>
+#include <algorithm>
+
+static bool isScheduleFile(const QFileInfo &info)
+{
+    const QString suffix = info.suffix().toLower();
+    return suffix == "html" || suffix == "htm" || suffix == "txt";
+}
+
+BatchScheduleImporter::BatchScheduleImporter(QObject *parent)
+    : QObject(parent)
+{
+    connect(&m_watcher, &QFutureWatcher<Result>::resultReadyAt, this, [this](int index) {
+        emit progress(++m_done, m_sources.size(), QFileInfo(m_sources.at(index).path).fileName());
+    });
+    connect(&m_watcher, &QFutureWatcher<Result>::finished,
+            this, &BatchScheduleImporter::onFinished);
+}
+
+BatchScheduleImporter::~BatchScheduleImporter()
+{
+    // 解析任务只读文件，取消后等它们退出即可
+    m_watcher.cancel();
+    m_watcher.waitForFinished();
+}
+
+QList<BatchScheduleImporter::Source> BatchScheduleImporter::collectSources(const QStringList &paths,
+                                                                           QStringList *renamed)
+{
+    QList<Source> sources;
+    QSet<QString> seenPaths;
+    QSet<QString> usedNames;
+    auto add = [&](const QFileInfo &file, const QString &relativePath) {
+        const QString path = file.absoluteFilePath();
+        if (seenPaths.contains(path)) return;
+        seenPaths.insert(path);
+
+        const QString dir = QFileInfo(relativePath).path();
+        const QString base = dir == "." ? file.completeBaseName() : dir + "/" + file.completeBaseName();
+        QString name = base;
+        for (int n = 2; usedNames.contains(name); ++n) {
+            name = QString("%1 (%2)").arg(base).arg(n);
+        }
+        usedNames.insert(name);
+        if (name != base && renamed) {
+            renamed->append(QString("%1 → %2").arg(QDir::toNativeSeparators(path), name));
+        }
+        sources.append({path, name});
+    };
+
+    for (const QString &path : paths) {
+        const QFileInfo info(path);
+        if (info.isDir()) {
+            const QDir root(info.absoluteFilePath());
+            QDirIterator it(root.absolutePath(), QDir::Files | QDir::Readable, QDirIterator::Subdirectories);
+            QList<QFileInfo> files;
+            while (it.hasNext()) {
+                const QFileInfo file(it.next());
+                if (isScheduleFile(file)) files << file;
+            }
+            // 目录遍历顺序随文件系统而定，排序后重名文件的编号才稳定
+            std::sort(files.begin(), files.end(), [](const QFileInfo &a, const QFileInfo &b) {
+                return a.absoluteFilePath() < b.absoluteFilePath();
+            });
+            for (const QFileInfo &file : files) {
+                add(file, root.relativeFilePath(file.absoluteFilePath()));
+            }
+        } else if (info.isFile() && isScheduleFile(info)) {
+            add(info, info.fileName());
+        }
+    }
+    return sources;
+}
+
+BatchScheduleImporter::Result BatchScheduleImporter::importFile(const QString &path, const QString &name)
+{
+    Result result;
+    result.person.name = name.isEmpty() ? QFileInfo(path).completeBaseName() : name;
+    result.person.sourcePath = path;
+    result.person.importedAt = QDateTime::currentDateTime();
+    if (!ScheduleHtmlParser::parseFile(path, result.person.courses, &result.error)) {
+        return result;
+    }
+    if (result.person.courses.isEmpty()) {
+        result.error = "未找到课程信息";
+        return result;
+    }
+    result.person.rebuildMask();
+    return result;
+}
+
+bool BatchScheduleImporter::start(const QStringList &paths)
+{
+    if (isRunning()) return false;
+    m_renamed.clear();
+    m_sources = collectSources(paths, &m_renamed);
+    if (m_sources.isEmpty()) return false;
+
+    m_done = 0;
+    emit progress(0, m_sources.size(), QString());
+    m_watcher.setFuture(QtConcurrent::mapped(m_sources, [](const Source &source) {
+        return importFile(source.path, source.name);
+    }));
+    return true;
+}
+
+void BatchScheduleImporter::cancel()
+{
+    m_watcher.cancel();
+}
+
+void BatchScheduleImporter::onFinished()
+{
+    QList<PersonSchedule> imported;
+    QStringList failures;
+    const QFuture<Result> future = m_watcher.future();
+    for (int i = 0; i < m_sources.size(); ++i) {
+        if (!future.isResultReadyAt(i)) continue; // 取消时未处理的文件
+        const Result result = future.resultAt(i);
+        if (result.error.isEmpty()) {
+            imported.append(result.person);
+        } else {
+            failures << QString("%1：%2").arg(QDir::toNativeSeparators(m_sources.at(i).path), result.error);
+        }
+    }
+
+    // 所有结果一次写入，只保存和通知一次
+    GroupScheduleStore::instance().upsert(imported);
+    qDebug() << "批量导入课表完成：成功" << imported.size() << "份，失败" << failures.size() << "份";
+    emit finished(imported.size(), failures, m_renamed);
+}
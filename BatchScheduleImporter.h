@@ -0,0 +1,55 @@
+#ifndef BATCHSCHEDULEIMPORTER_H
+#define BATCHSCHEDULEIMPORTER_H
+
+#include "PersonSchedule.h"
+#include <QObject>
+#include <QFutureWatcher>
+#include <QStringList>
+
+// 批量导入课表：接受多个文件或目录，在全局线程池上并行解析（C++ 解析器，
+// 不经过 Python，避免 GIL 限制），逐个报告进度，完成后一次性写入 GroupScheduleStore。
+// 每人的名字取文件相对于拖入目录的路径（不含扩展名），例如“一组/张三”；
+// 同一批里仍然重名的（如 张三.html 和 张三.txt）依次加上“ (2)”“ (3)”，并在结果里列出。
+class BatchScheduleImporter : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Result {
+        PersonSchedule person;
+        QString error;
+    };
+
+    struct Source {
+        QString path; // 绝对路径
+        QString name; // 导入后的人名
+    };
+
+    explicit BatchScheduleImporter(QObject *parent = nullptr);
+    ~BatchScheduleImporter() override;
+
+    // 展开目录（含子目录），只保留 .html/.htm/.txt，并给每个文件定好人名；
+    // renamed 不为空时写入因重名而改名的文件（“路径 → 新名字”）
+    static QList<Source> collectSources(const QStringList &paths, QStringList *renamed = nullptr);
+    // name 为空时取文件名（不含扩展名）
+    static Result importFile(const QString &path, const QString &name = QString());
+
+    // 正在导入或没有可导入的文件时返回 false
+    bool start(const QStringList &paths);
+    void cancel();
+    bool isRunning() const { return m_watcher.isRunning(); }
+
+signals:
+    void progress(int done, int total, const QString &fileName);
+    void finished(int imported, const QStringList &failures, const QStringList &renamed);
+
+private:
+    void onFinished();
+
+    QFutureWatcher<Result> m_watcher;
+    QList<Source> m_sources;
+    QStringList m_renamed;
+    int m_done = 0;
+};
+
+#endif // BATCHSCHEDULEIMPORTER_H
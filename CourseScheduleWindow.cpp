@@ -1,4 +1,12 @@
 #include "CourseScheduleWindow.h"
+#include "FreeRoomClient.h"
+#include "PythonWorker.h"
+#include "BatchScheduleImporter.h"
+#include "GroupScheduleStore.h"
+#include "GroupAvailability.h"
+#include "DatabaseManager.h"
+#include "FreeRoomModel.h"
+#include "ScheduleModel.h"
 #include <QVBoxLayout>
 #include <QTableWidget>
 #include <QLabel>
@@ -13,6 +21,9 @@
 #include <QJsonObject>
 #include <QTableWidgetItem>
 #include <QSettings>
+#include <QProgressBar>
+#include <QCheckBox>
+#include <QSpinBox>
 #include <QDebug>
 
 const int NUM_DAYS = 7;
@@ -23,19 +34,24 @@ CourseScheduleWindow::CourseScheduleWindow(QWidget *parent)
 {
     setupUi();
 
-    m_scraperProcess = new QProcess(this);
-    connect(m_scraperProcess, &QProcess::finished,
-            this, &CourseScheduleWindow::onScraperFinished);
-
-    // --- 新增：初始化空闲教室查询进程并连接信号 ---
-    m_freeRoomQueryProcess = new QProcess(this);
-    connect(m_freeRoomQueryProcess, &QProcess::finished,
+    // 空闲教室查询直接请求门户接口
+    m_freeRoomClient = new FreeRoomClient(this);
+    connect(m_freeRoomClient, &FreeRoomClient::finished,
             this, &CourseScheduleWindow::onFreeRoomQueryFinished);
+    connect(m_freeRoomClient, &FreeRoomClient::failed,
+            this, &CourseScheduleWindow::onFreeRoomQueryFailed);
 
     // --- 新增：连接表格点击事件到新的槽函数 ---
     connect(m_scheduleTable, &QTableWidget::cellClicked,
             this, &CourseScheduleWindow::onTableCellClicked);
 
+    // 批量导入（多个文件或目录）
+    m_batchImporter = new BatchScheduleImporter(this);
+    connect(m_batchImporter, &BatchScheduleImporter::progress,
+            this, &CourseScheduleWindow::onBatchProgress);
+    connect(m_batchImporter, &BatchScheduleImporter::finished,
+            this, &CourseScheduleWindow::onBatchFinished);
+
     setAcceptDrops(true);
 
     loadSchedule();
@@ -43,13 +59,7 @@ CourseScheduleWindow::CourseScheduleWindow(QWidget *parent)
 
 CourseScheduleWindow::~CourseScheduleWindow()
 {
-    // 确保所有子进程在窗口关闭时都被正确终止
-    if (m_scraperProcess && m_scraperProcess->state() == QProcess::Running) {
-        m_scraperProcess->kill();
-    }
-    if (m_freeRoomQueryProcess && m_freeRoomQueryProcess->state() == QProcess::Running) {
-        m_freeRoomQueryProcess->kill();
-    }
+    // Python worker 是全局常驻的，窗口关闭后未完成的解析结果会被丢弃
 }
 
 void CourseScheduleWindow::setupUi()
@@ -59,7 +69,8 @@ void CourseScheduleWindow::setupUi()
     resize(800, 600);
 
     m_infoLabel = new QLabel(
-        "请拖拽课表HTML文件到此，或直接点击课表空白处查询当日空闲教室",
+        "请拖拽课表HTML文件到此，或直接点击课表空白处查询当日空闲教室\n"
+        "一次拖入多个文件或整个文件夹可批量导入小组成员的课表",
         this
         );
     m_infoLabel->setAlignment(Qt::AlignCenter);
@@ -79,8 +90,39 @@ void CourseScheduleWindow::setupUi()
     m_scheduleTable->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
     m_scheduleTable->verticalHeader()->setSectionResizeMode(QHeaderView::Stretch);
 
+    m_batchProgress = new QProgressBar(this);
+    m_batchProgress->setVisible(false);
+
+    // 小组空闲情况：热力图叠加显示 + 会议时间推荐
+    m_overlayCheck = new QCheckBox("小组空闲热力图", this);
+    m_includeMeCheck = new QCheckBox("包含我的课表和本周日程", this);
+    m_includeMeCheck->setChecked(true);
+    m_meetingLengthSpin = new QSpinBox(this);
+    m_meetingLengthSpin->setRange(1, 4);
+    m_meetingLengthSpin->setSuffix(" 节");
+    m_bestSlotButton = new QPushButton("推荐会议时间", this);
+    m_clearGroupButton = new QPushButton("清空小组", this);
+
+    topLayout = new QHBoxLayout();
+    topLayout->addWidget(m_overlayCheck);
+    topLayout->addWidget(m_includeMeCheck);
+    topLayout->addStretch();
+    topLayout->addWidget(new QLabel("会议时长：", this));
+    topLayout->addWidget(m_meetingLengthSpin);
+    topLayout->addWidget(m_bestSlotButton);
+    topLayout->addWidget(m_clearGroupButton);
+
+    connect(m_overlayCheck, &QCheckBox::toggled, this, &CourseScheduleWindow::onOverlayToggled);
+    connect(m_includeMeCheck, &QCheckBox::toggled, this, [this]() {
+        if (m_overlayCheck->isChecked()) showAvailabilityOverlay();
+    });
+    connect(m_bestSlotButton, &QPushButton::clicked, this, &CourseScheduleWindow::onBestSlotClicked);
+    connect(m_clearGroupButton, &QPushButton::clicked, this, &CourseScheduleWindow::onClearGroupClicked);
+
     QVBoxLayout *mainLayout = new QVBoxLayout(this);
     mainLayout->addWidget(m_infoLabel);
+    mainLayout->addWidget(m_batchProgress);
+    mainLayout->addLayout(topLayout);
     mainLayout->addWidget(m_scheduleTable);
     setLayout(mainLayout);
 }
@@ -97,6 +139,18 @@ void CourseScheduleWindow::dropEvent(QDropEvent *event)
     const QMimeData* mimeData = event->mimeData();
     if (mimeData->hasUrls()) {
         QList<QUrl> urlList = mimeData->urls();
+        if (urlList.isEmpty()) return;
+
+        // 多个文件或文件夹：批量导入为小组成员的课表
+        QStringList paths;
+        for (const QUrl &url : urlList) {
+            if (url.isLocalFile()) paths << url.toLocalFile();
+        }
+        if (paths.size() > 1 || (paths.size() == 1 && QFileInfo(paths.first()).isDir())) {
+            startBatchImport(paths);
+            return;
+        }
+
         if (!urlList.isEmpty()) {
             QString filePath = urlList.first().toLocalFile();
             QFileInfo fileInfo(filePath);
@@ -117,44 +171,198 @@ void CourseScheduleWindow::dropEvent(QDropEvent *event)
     }
 }
 
+void CourseScheduleWindow::startBatchImport(const QStringList &paths)
+{
+    if (m_batchImporter->isRunning()) {
+        m_infoLabel->setText("上一批课表还在导入，请稍候...");
+        return;
+    }
+    if (!m_batchImporter->start(paths)) {
+        QMessageBox::warning(
+            this,
+            "文件类型错误",
+            "拖入的文件或文件夹中没有 .html / .htm / .txt 课表文件。"
+            );
+    }
+}
+
+void CourseScheduleWindow::onBatchProgress(int done, int total, const QString &fileName)
+{
+    m_batchProgress->setVisible(true);
+    m_batchProgress->setRange(0, total);
+    m_batchProgress->setValue(done);
+    m_infoLabel->setText(fileName.isEmpty()
+                             ? QString("正在批量导入 %1 份课表...").arg(total)
+                             : QString("正在批量导入 %1/%2：%3").arg(done).arg(total).arg(fileName));
+}
+
+void CourseScheduleWindow::onBatchFinished(int imported, const QStringList &failures, const QStringList &renamed)
+{
+    m_batchProgress->setVisible(false);
+
+    const GroupScheduleStore &store = GroupScheduleStore::instance();
+    const WeekMask commonFree = store.commonFreePeriods();
+    QString text = QString("批量导入完成：成功 %1 份，失败 %2 份。小组共 %3 人，共同空闲 %4 个时段")
+                       .arg(imported).arg(failures.size()).arg(store.size()).arg(commonFree.count());
+    if (!renamed.isEmpty()) text += QString("（%1 份因重名已改名）").arg(renamed.size());
+    m_infoLabel->setText(text);
+    m_infoLabel->setToolTip(GroupScheduleStore::describeSlots(commonFree, 84)
+                            + (renamed.isEmpty() ? QString() : "\n\n重名改名：\n" + renamed.join('\n'))
+                            + (failures.isEmpty() ? QString() : "\n\n导入失败：\n" + failures.join('\n')));
+    if (m_overlayCheck->isChecked()) showAvailabilityOverlay();
+}
+
+// 参与统计的人：小组成员的课表，加上（可选）我自己的课表和本周日程
+QList<WeekMask> CourseScheduleWindow::groupMasks() const
+{
+    QList<WeekMask> masks;
+    for (const PersonSchedule &person : GroupScheduleStore::instance().people()) {
+        masks.append(person.busy);
+    }
+
+    if (m_includeMeCheck->isChecked()) {
+        PersonSchedule me;
+        me.courses = ScheduleModel::loadSaved();
+        me.rebuildMask();
+
+        const QDate today = QDate::currentDate();
+        const QDate weekStart = today.addDays(1 - today.dayOfWeek());
+        const QDate weekEnd = weekStart.addDays(SCHEDULE_DAYS - 1);
+        DatabaseManager &db = DatabaseManager::instance();
+        QList<DatedTask> tasks = db.getTasksBetween(weekStart, weekEnd);
+        tasks += db.getOccurrencesBetween(weekStart, weekEnd);
+        masks.append(me.busy | GroupAvailability::maskForTasks(tasks, weekStart));
+    }
+    return masks;
+}
+
+void CourseScheduleWindow::onOverlayToggled(bool enabled)
+{
+    if (enabled) {
+        showAvailabilityOverlay();
+        return;
+    }
+    // 退出热力图，恢复自己的课表
+    m_scheduleTable->clearContents();
+    m_scheduleTable->clearSpans();
+    loadSchedule();
+}
+
+// 每个格子按有课人数着色：全员空闲为绿色，越多人忙越红
+void CourseScheduleWindow::showAvailabilityOverlay()
+{
+    const GroupAvailability availability(groupMasks());
+    const int total = availability.peopleCount();
+
+    m_scheduleTable->clearContents();
+    m_scheduleTable->clearSpans();
+    if (total == 0) {
+        m_infoLabel->setText("还没有小组成员的课表，请一次拖入多个课表文件或一个文件夹");
+        return;
+    }
+
+    const std::array<int, SCHEDULE_SLOTS> counts = availability.busyCounts();
+    for (int day = 0; day < NUM_DAYS; ++day) {
+        for (int period = 0; period < NUM_PERIODS; ++period) {
+            const int busy = counts[slotIndex(day, period)];
+            const double ratio = double(busy) / total;
+            auto *item = new QTableWidgetItem(busy == 0 ? QString("全员空闲")
+                                                        : QString("%1/%2 人有课").arg(busy).arg(total));
+            item->setTextAlignment(Qt::AlignCenter);
+            // 色相从绿（120）到红（0）
+            item->setBackground(QColor::fromHsv(int(120 * (1.0 - ratio)), 90 + int(120 * ratio), 240));
+            item->setFlags(Qt::ItemIsEnabled);
+            m_scheduleTable->setItem(period, day, item);
+        }
+    }
+    m_infoLabel->setText(QString("小组空闲热力图：共 %1 人%2").arg(total)
+                             .arg(m_includeMeCheck->isChecked() ? "（含我的课表和本周日程）" : ""));
+}
+
+void CourseScheduleWindow::onBestSlotClicked()
+{
+    const GroupAvailability availability(groupMasks());
+    const int total = availability.peopleCount();
+    if (total == 0) {
+        QMessageBox::information(this, "推荐会议时间", "还没有可用于比较的课表。");
+        return;
+    }
+
+    const int length = m_meetingLengthSpin->value();
+    static const char *const dayNames[SCHEDULE_DAYS] = {"一", "二", "三", "四", "五", "六", "日"};
+    QStringList lines;
+    for (const GroupAvailability::Slot &slot : availability.bestSlots(length, 5)) {
+        const QString periods = slot.length == 1
+                                    ? QString("第%1节").arg(slot.period + 1)
+                                    : QString("第%1-%2节").arg(slot.period + 1).arg(slot.period + slot.length);
+        const QString when = QString("周%1 %2（%3-%4）")
+                                 .arg(dayNames[slot.day], periods,
+                                      GroupAvailability::periodStart(slot.period).toString("HH:mm"),
+                                      GroupAvailability::periodEnd(slot.period + slot.length - 1).toString("HH:mm"));
+        lines << (slot.busyCount == 0 ? QString("%1：全部 %2 人都有空").arg(when).arg(total)
+                                      : QString("%1：%2 人有冲突").arg(when).arg(slot.busyCount));
+    }
+    QMessageBox::information(this, "推荐会议时间", lines.join('\n'));
+}
+
+void CourseScheduleWindow::onClearGroupClicked()
+{
+    if (GroupScheduleStore::instance().size() == 0) return;
+    if (QMessageBox::question(this, "清空小组", "确定删除所有已导入的小组成员课表吗？")
+        != QMessageBox::Yes) {
+        return;
+    }
+    GroupScheduleStore::instance().clear();
+    if (m_overlayCheck->isChecked()) showAvailabilityOverlay();
+}
+
 void CourseScheduleWindow::startScraperWithFile(const QString &filePath)
 {
-    if (m_scraperProcess->state() == QProcess::Running)
+    if (m_parsing)
         return;
 
+    m_parsing = true;
     m_scheduleTable->clearContents();
-    QString pythonExecutable = "python";
-    QStringList args;
-    args << "-B" << "scraper.py" << filePath;
-    m_scraperProcess->start(pythonExecutable, args);
+    // 由常驻的 Python worker 解析，不再每次启动解释器
+    PythonWorker::instance().call("parse_schedule", QJsonObject{{"path", filePath}}, this,
+                                  [this](const QJsonValue &result, const QString &error) {
+                                      onScheduleParsed(result, error);
+                                  });
 }
 
-void CourseScheduleWindow::onScraperFinished(int exitCode, QProcess::ExitStatus exitStatus)
+void CourseScheduleWindow::onScheduleParsed(const QJsonValue &result, const QString &error)
 {
+    m_parsing = false;
     m_infoLabel->setText("解析完成！请拖拽新的文件来更新课表。");
-    if (exitStatus != QProcess::NormalExit || exitCode != 0) {
+    if (!error.isEmpty()) {
         QMessageBox::critical(
             this,
             "错误",
             "Python脚本执行失败！\n请检查文件内容或Python环境。"
             );
-        qDebug() << "Python script error output:"
-                 << m_scraperProcess->readAllStandardError();
+        qDebug() << "Python script error output:" << error;
         return;
     }
 
-    QByteArray jsonData = m_scraperProcess->readAllStandardOutput();
+    QByteArray jsonData;
+    if (result.isArray()) {
+        jsonData = QJsonDocument(result.toArray()).toJson(QJsonDocument::Compact);
+    }
 
     if (!jsonData.isEmpty()) {
         saveSchedule(jsonData);
     }
 
     populateTable(jsonData);
+    // 热力图模式下，新课表只影响统计结果
+    if (m_overlayCheck->isChecked()) showAvailabilityOverlay();
 }
 
 void CourseScheduleWindow::populateTable(const QByteArray& jsonData)
 {
-    if (jsonData.isEmpty()) {
+    QList<CourseEntry> courses;
+    const ScheduleModel::ParseStatus status = ScheduleModel::parse(jsonData, courses);
+    if (status == ScheduleModel::ParseStatus::EmptyInput) {
         QMessageBox::warning(
             this,
             "提示",
@@ -162,9 +370,7 @@ void CourseScheduleWindow::populateTable(const QByteArray& jsonData)
             );
         return;
     }
-
-    QJsonDocument doc = QJsonDocument::fromJson(jsonData);
-    if (doc.isNull() || !doc.isArray()) {
+    if (status == ScheduleModel::ParseStatus::Invalid) {
         qDebug() << "Failed to parse JSON or JSON is not an array. Data:"
                  << jsonData;
         QMessageBox::critical(
@@ -175,10 +381,10 @@ void CourseScheduleWindow::populateTable(const QByteArray& jsonData)
         return;
     }
 
-    QJsonArray scheduleArray = doc.array();
     m_scheduleTable->clearContents();
+    m_scheduleTable->clearSpans();
 
-    if (scheduleArray.isEmpty()) {
+    if (status == ScheduleModel::ParseStatus::NoCourses) {
         QMessageBox::information(
             this,
             "提示",
@@ -187,44 +393,35 @@ void CourseScheduleWindow::populateTable(const QByteArray& jsonData)
         return;
     }
 
-    for (const QJsonValue& value : scheduleArray) {
-        QJsonObject course = value.toObject();
-        int day = course["day"].toInt() - 1;
-        int startPeriod = course["start_period"].toInt() - 1;
-        int periods = course["periods"].toInt();
-
-        if (day < 0 || day >= NUM_DAYS ||
-            startPeriod < 0 || startPeriod >= NUM_PERIODS)
+    for (const CourseEntry& course : courses) {
+        if (!ScheduleModel::isPlaceable(course))
             continue;
+        const int day = course.day - 1;
+        const int startPeriod = course.startPeriod - 1;
 
         auto* item = new QTableWidgetItem();
-        QString displayText = QString("%1\n\n@%2\n%3")
-                                  .arg(course["name"].toString())
-                                  .arg(course["classroom"].toString())
-                                  .arg(course["teacher"].toString());
+        const QString displayText = ScheduleModel::displayText(course);
         item->setText(displayText);
         item->setTextAlignment(Qt::AlignCenter);
-        item->setBackground(QColor(course["color"].toString()));
+        item->setBackground(QColor(course.color));
         item->setToolTip(displayText);
         m_scheduleTable->setItem(startPeriod, day, item);
 
-        if (periods > 1) {
-            m_scheduleTable->setSpan(startPeriod, day, periods, 1);
+        if (course.periods > 1) {
+            m_scheduleTable->setSpan(startPeriod, day, course.periods, 1);
         }
     }
 }
 
 void CourseScheduleWindow::saveSchedule(const QByteArray& jsonData)
 {
-    QSettings settings("MyCourseApp", "ScheduleData");
-    settings.setValue("lastScheduleJson", jsonData);
+    ScheduleModel::save(jsonData);
     qDebug() << "课表数据已保存。";
 }
 
 void CourseScheduleWindow::loadSchedule()
 {
-    QSettings settings("MyCourseApp", "ScheduleData");
-    QByteArray savedJson = settings.value("lastScheduleJson").toByteArray();
+    const QByteArray savedJson = ScheduleModel::savedJson();
     if (!savedJson.isEmpty()) {
         qDebug() << "找到已保存的课表数据，正在加载...";
         m_infoLabel->setText("已加载上次保存的课表，可拖拽文件更新");
@@ -237,8 +434,8 @@ void CourseScheduleWindow::loadSchedule()
 // --- 新增：实现单元格点击的槽函数 ---
 void CourseScheduleWindow::onTableCellClicked(int row, int column)
 {
-    // 检查查询进程是否已在运行
-    if (m_freeRoomQueryProcess->state() == QProcess::Running) {
+    // 检查是否还有查询在进行
+    if (m_freeRoomClient->isBusy()) {
         QMessageBox::information(
             this,
             "提示",
@@ -276,70 +473,31 @@ void CourseScheduleWindow::onTableCellClicked(int row, int column)
             m_lastQueriedPeriod = row + 1;
             m_lastQueriedBuilding = building;
 
-            // 调用Python脚本，这里我们默认查询“今天”的空闲情况
-            // 注意：请确保 query_free_room.py 位于可执行文件同目录下
-            QString pythonExecutable = "python";
-            QStringList args;
-            args << "query_free_room.py" << building << "今天";
-            m_freeRoomQueryProcess->start(pythonExecutable, args);
+            // 默认查询“今天”的空闲情况
+            m_freeRoomClient->query(building, "今天");
         }
     }
 }
 
 // --- 新增：实现处理查询结果的槽函数 ---
-void CourseScheduleWindow::onFreeRoomQueryFinished()
+void CourseScheduleWindow::onFreeRoomQueryFailed(const QString &building, const QString &error)
 {
-    m_infoLabel->setText("查询完成！可继续点击空白处查询，或拖拽文件更新课表。");
-
-    if (m_freeRoomQueryProcess->exitStatus() != QProcess::NormalExit ||
-        m_freeRoomQueryProcess->exitCode() != 0) {
-        QMessageBox::critical(
-            this,
-            "查询失败",
-            "Python脚本执行出错。\n请检查Python环境或脚本文件是否存在。"
-            );
-        qDebug() << "Free room script error:"
-                 << m_freeRoomQueryProcess->readAllStandardError();
-        return;
-    }
-
-    QByteArray jsonData = m_freeRoomQueryProcess->readAllStandardOutput();
-    if (jsonData.isEmpty()) {
-        QMessageBox::warning(
-            this,
-            "无结果",
-            "查询脚本没有返回任何数据。"
-            );
-        return;
-    }
-
-    QJsonDocument doc = QJsonDocument::fromJson(jsonData);
-    if (!doc.isObject()) {
-        QMessageBox::critical(
-            this,
-            "解析失败",
-            "无法解析返回的JSON数据。"
-            );
-        qDebug() << "Could not parse JSON:" << jsonData;
-        return;
-    }
+    m_infoLabel->setText("查询失败！可继续点击空白处查询，或拖拽文件更新课表。");
+    QMessageBox::critical(
+        this,
+        "查询失败",
+        QString("查询 %1 的空闲教室失败：\n%2").arg(building, error)
+        );
+}
 
-    // 解析JSON，找到对应教学楼、对应节次的教室列表
-    QJsonObject rootObj = doc.object();
-    QJsonObject buildingObj = rootObj.value(m_lastQueriedBuilding).toObject();
+void CourseScheduleWindow::onFreeRoomQueryFinished(const QString &building, const QJsonObject &result)
+{
+    m_infoLabel->setText("查询完成！可继续点击空白处查询，或拖拽文件更新课表。");
 
-    // 在返回的数据中，日期可能是"default"或其他，节次是 "c1", "c2" 等
-    QString sectionKey = "c" + QString::number(m_lastQueriedPeriod);
+    // 找到对应教学楼、对应节次的教室列表
     QStringList freeRooms;
-
-    for (const QString& dateKey : buildingObj.keys()) {
-        QJsonObject sectionsObj = buildingObj.value(dateKey).toObject();
-        if (sectionsObj.contains(sectionKey)) {
-            QJsonArray roomsArray = sectionsObj.value(sectionKey).toArray();
-            for (const QJsonValue& val : roomsArray) {
-                freeRooms.append(val.toString());
-            }
-        }
+    for (const FreeRoomModel::Entry &entry : FreeRoomModel::entries(result, building, {m_lastQueriedPeriod})) {
+        freeRooms.append(entry.room);
     }
 
     // 显示最终结果
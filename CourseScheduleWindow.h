@@ -2,12 +2,20 @@
 #define COURSESCHEDULEWINDOW_H
 
 #include <QWidget>
-#include <QProcess>
 #include <QHBoxLayout>
 #include <QPushButton>
 #include <QInputDialog> // 新增
 #include <QMessageBox>  // 新增
+#include <QJsonObject>
+#include <QJsonValue>
 #include "smartroomwidget.h"
+#include "PersonSchedule.h"
+
+class FreeRoomClient;
+class BatchScheduleImporter;
+class QProgressBar;
+class QCheckBox;
+class QSpinBox;
 
 QT_BEGIN_NAMESPACE
 class QTableWidget;
@@ -19,6 +27,7 @@ QT_END_NAMESPACE
 class CourseScheduleWindow : public QWidget
 {
     Q_OBJECT
+    friend class PlannerBenchmark; // 基准测试直接调用 populateTable
 
 public:
     explicit CourseScheduleWindow(QWidget *parent = nullptr);
@@ -30,29 +39,45 @@ protected:
     void dropEvent(QDropEvent *event) override;
 
 private slots:
-    void onScraperFinished(int exitCode, QProcess::ExitStatus exitStatus);
+    void onScheduleParsed(const QJsonValue &result, const QString &error);
     // void onFreeRoomButtonClicked(); // 不再需要
     void onTableCellClicked(int row, int column); // 新增：处理单元格点击
-    void onFreeRoomQueryFinished();               // 新增：处理教室查询脚本结束
+    void onFreeRoomQueryFinished(const QString &building, const QJsonObject &result); // 处理空闲教室查询结果
+    void onFreeRoomQueryFailed(const QString &building, const QString &error);
+    void onBatchProgress(int done, int total, const QString &fileName);
+    void onBatchFinished(int imported, const QStringList &failures, const QStringList &renamed);
+    void onOverlayToggled(bool enabled);          // 切换小组空闲热力图
+    void onBestSlotClicked();                     // 推荐会议时间
+    void onClearGroupClicked();
 
 private:
     void setupUi();
     void startScraperWithFile(const QString& filePath);
+    void startBatchImport(const QStringList& paths); // 多个文件或目录：导入为小组成员课表
     void populateTable(const QByteArray& jsonData);
 
     // --- 新增的函数 ---
     void saveSchedule(const QByteArray& jsonData);
     void loadSchedule();
+    QList<WeekMask> groupMasks() const;          // 参与统计的每个人的忙碌位图
+    void showAvailabilityOverlay();
     // -----------------
     QHBoxLayout* topLayout;
+    QCheckBox* m_overlayCheck;
+    QCheckBox* m_includeMeCheck;
+    QSpinBox* m_meetingLengthSpin;
+    QPushButton* m_bestSlotButton;
+    QPushButton* m_clearGroupButton;
     QLabel* m_infoLabel; // 用于提示用户拖拽文件
     // QPushButton* m_freeRoomButton; // 不再需要
     SmartRoomWidget* m_freeRoomWindow = nullptr;
     QTableWidget* m_scheduleTable;
-    QProcess* m_scraperProcess;
+    bool m_parsing = false; // 课表文件正在由 Python worker 解析
+    BatchScheduleImporter* m_batchImporter;
+    QProgressBar* m_batchProgress;
 
     // --- 新增成员 ---
-    QProcess* m_freeRoomQueryProcess; // 用于查询空闲教室的进程
+    FreeRoomClient* m_freeRoomClient; // 查询空闲教室（走共享的网络服务）
     int m_lastQueriedPeriod = -1;     // 记录上次查询的节次
     QString m_lastQueriedBuilding;    // 记录上次查询的教学楼
 };
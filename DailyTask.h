@@ -4,6 +4,7 @@
 #include <QString>
 #include <QTime>
 #include <QDate> // 包含QDate头文件
+#include <QDateTime>
 
 class DailyTask {
 public:
@@ -18,12 +19,16 @@ public:
     QTime getEndTime() const;
     QString getNote() const;
     int getId() const;
+    // 由重复规则展开出的实例没有自己的行，id 为 -1，ruleId 指向 task_rules
+    int getRuleId() const { return ruleId; }
+    bool isOccurrence() const { return ruleId >= 0; }
 
     void setTitle(const QString &t) { title = t; }
     void setStartTime(const QTime &t) { startTime = t; }
     void setEndTime(const QTime &t) { endTime = t; }
     void setNote(const QString &n) { note = n; }
     void setId(const int value) { id = value; }
+    void setRuleId(const int value) { ruleId = value; }
 
 private:
     int id = -1;
@@ -31,8 +36,16 @@ private:
     QTime startTime;
     QTime endTime;
     QString note;
+    int ruleId = -1;
 };
 
+// 带日期的任务，用于跨日期的查询（提醒、搜索等）
+struct DatedTask {
+    QDate date;
+    DailyTask task;
+
+    QDateTime startDateTime() const { return QDateTime(date, task.getStartTime()); }
+};
 
 
 #endif // DAILYTASK_H
@@ -10,12 +10,51 @@
 #include <QTextEdit>            // 多行文本输入
 #include <QDialogButtonBox>     // 对话框标准按钮盒（这里未使用，但作为常见组件保留）
 #include <QGridLayout>          // 网格布局，用于更好的对齐
+#include <QComboBox>            // 重复方式选择
+#include <QSpinBox>             // 重复间隔
+#include <QCheckBox>            // 截止日期开关
+#include <QDateEdit>            // 截止日期
+#include <QToolButton>          // 撤销/重做
+#include <QUndoStack>           // 暂存修改的撤销栈
+#include <QAction>
+#include <functional>
+
+namespace {
+
+// 一步暂存的修改：记录修改前后的对话框状态和对应的数据库操作。
+// 撤销/重做只在两个状态之间切换，真正写库的是栈底到当前位置的全部操作。
+class TaskEditCommand : public QUndoCommand
+{
+public:
+    using Apply = std::function<void(const DailyTaskDialog::EditState &)>;
+
+    TaskEditCommand(const QString &text,
+                    const DailyTaskDialog::EditState &before,
+                    const DailyTaskDialog::EditState &after,
+                    const QList<TaskChange> &changes,
+                    Apply apply)
+        : QUndoCommand(text), m_before(before), m_after(after), m_changes(changes), m_apply(std::move(apply))
+    {
+    }
+
+    void undo() override { m_apply(m_before); }
+    void redo() override { m_apply(m_after); }
+    const QList<TaskChange> &changes() const { return m_changes; }
+
+private:
+    DailyTaskDialog::EditState m_before;
+    DailyTaskDialog::EditState m_after;
+    QList<TaskChange> m_changes;
+    Apply m_apply;
+};
+
+} // namespace
 
 // 构造函数
 DailyTaskDialog::DailyTaskDialog(const QDate &date, QWidget *parent, const QList<DailyTask> &existingTasks)
     : QDialog(parent), currentDate(date),  taskList(existingTasks) // 初始化父类、当前日期和现有任务列表
 {
-    setWindowTitle("添加/修改日程"); // 设置窗口标题
+    setWindowTitle("添加/修改日程[*]"); // 设置窗口标题，有未保存的修改时显示 *
     setMinimumSize(700, 500); // 设置最小尺寸，使界面更美观
 
     /* STEP 1: 设置页面布局 */
@@ -30,14 +69,51 @@ DailyTaskDialog::DailyTaskDialog(const QDate &date, QWidget *parent, const QList
     endTimeEdit = new QTimeEdit(QTime::currentTime().addSecs(3600), this); // 默认显示当前时间加一小时
     noteEdit = new QTextEdit(this);
 
-    saveButton = new QPushButton("保存", this);
-    cancelButton = new QPushButton("取消", this);
+    // 重复设置：规则只保存一次，日历和提醒列表按需展开
+    repeatComboBox = new QComboBox(this);
+    repeatComboBox->addItems({"不重复", "每天", "每周", "每月"});
+    intervalSpinBox = new QSpinBox(this);
+    intervalSpinBox->setRange(1, 99);
+    intervalSpinBox->setPrefix("每 ");
+    untilCheckBox = new QCheckBox("截止到", this);
+    untilDateEdit = new QDateEdit(date.addMonths(3), this);
+    untilDateEdit->setCalendarPopup(true);
+    connect(repeatComboBox, QOverload<int>::of(&QComboBox::currentIndexChanged), this, [this](int index) {
+        intervalSpinBox->setEnabled(index > 0);
+        untilCheckBox->setEnabled(index > 0);
+        untilDateEdit->setEnabled(index > 0 && untilCheckBox->isChecked());
+    });
+    connect(untilCheckBox, &QCheckBox::toggled, untilDateEdit, &QDateEdit::setEnabled);
+
+    // 修改先暂存，关闭对话框时一次性写入；暂存的每一步都可以撤销/重做
+    undoStack = new QUndoStack(this);
+    QAction *undoAction = undoStack->createUndoAction(this, "撤销");
+    QAction *redoAction = undoStack->createRedoAction(this, "重做");
+    undoAction->setShortcut(QKeySequence::Undo);
+    redoAction->setShortcut(QKeySequence::Redo);
+    addAction(undoAction);
+    addAction(redoAction);
+    undoButton = new QToolButton(this);
+    undoButton->setDefaultAction(undoAction);
+    redoButton = new QToolButton(this);
+    redoButton->setDefaultAction(redoAction);
+    connect(undoStack, &QUndoStack::indexChanged, this, &DailyTaskDialog::updateStatus);
+
+    statusLabel = new QLabel(this);
+    statusLabel->setWordWrap(true);
+
+    saveButton = new QPushButton("暂存", this);
+    saveButton->setToolTip("修改先暂存，关闭对话框时一起写入");
+    cancelButton = new QPushButton("放弃修改", this);
+    QPushButton *doneButton = new QPushButton("完成", this);
+    doneButton->setDefault(true);
     newTaskButton = new QPushButton("新建日程", this); // 新建日程按钮
     deleteTaskButton = new QPushButton("删除日程", this); // 删除日程按钮
 
     // 连接信号和槽
     connect(saveButton, &QPushButton::clicked, this, &DailyTaskDialog::onSaveClicked);
-    connect(cancelButton, &QPushButton::clicked, this, &DailyTaskDialog::reject); // 点击取消按钮关闭对话框
+    connect(cancelButton, &QPushButton::clicked, this, &DailyTaskDialog::onDiscardClicked);
+    connect(doneButton, &QPushButton::clicked, this, &DailyTaskDialog::accept); // 关闭并写入暂存的修改
     connect(newTaskButton, &QPushButton::clicked, this, &DailyTaskDialog::onNewTaskClicked); // 连接新建按钮
     connect(deleteTaskButton, &QPushButton::clicked, this, &DailyTaskDialog::onDeleteTaskClicked); // 连接删除按钮
     connect(taskListWidget, &QListWidget::currentRowChanged, this, &DailyTaskDialog::onTaskSelected); // 列表选中项改变时触发
@@ -50,19 +126,29 @@ DailyTaskDialog::DailyTaskDialog(const QDate &date, QWidget *parent, const QList
     inputLayout->addWidget(startTimeEdit, 1, 1);
     inputLayout->addWidget(new QLabel("结束时间:"), 2, 0);
     inputLayout->addWidget(endTimeEdit, 2, 1);
-    inputLayout->addWidget(new QLabel("备注:"), 3, 0, 1, 2); // 备注标签跨两列
-    inputLayout->addWidget(noteEdit, 4, 0, 1, 2); // 备注输入框跨两列
+    QHBoxLayout *repeatLayout = new QHBoxLayout;
+    repeatLayout->addWidget(repeatComboBox);
+    repeatLayout->addWidget(intervalSpinBox);
+    repeatLayout->addWidget(untilCheckBox);
+    repeatLayout->addWidget(untilDateEdit);
+    inputLayout->addWidget(new QLabel("重复:"), 3, 0);
+    inputLayout->addLayout(repeatLayout, 3, 1);
+    inputLayout->addWidget(new QLabel("备注:"), 4, 0, 1, 2); // 备注标签跨两列
+    inputLayout->addWidget(noteEdit, 5, 0, 1, 2); // 备注输入框跨两列
 
     // 动作按钮布局 (新建、删除)
     QHBoxLayout *actionButtonLayout = new QHBoxLayout;
     actionButtonLayout->addWidget(newTaskButton);
     actionButtonLayout->addWidget(deleteTaskButton);
     actionButtonLayout->addStretch(); // 将按钮推向左侧
+    actionButtonLayout->addWidget(undoButton);
+    actionButtonLayout->addWidget(redoButton);
 
-    // 对话框底部标准按钮布局 (保存、取消)
+    // 对话框底部：状态提示 + 暂存、完成、放弃修改
     QHBoxLayout *dialogButtonLayout = new QHBoxLayout;
-    dialogButtonLayout->addStretch(); // 将按钮推向右侧
+    dialogButtonLayout->addWidget(statusLabel, 1); // 状态提示占据左侧剩余空间
     dialogButtonLayout->addWidget(saveButton);
+    dialogButtonLayout->addWidget(doneButton);
     dialogButtonLayout->addWidget(cancelButton);
 
     // 组合右侧布局：动作按钮 -> 输入区域 -> 底部对话框按钮
@@ -79,6 +165,7 @@ DailyTaskDialog::DailyTaskDialog(const QDate &date, QWidget *parent, const QList
     setLayout(mainLayout); // 应用主布局
 
     clearInputFields(); // 构造完成后，默认进入“新建任务”模式
+    updateStatus();
 }
 
 // 获取当前对话框中的任务数据
@@ -95,6 +182,13 @@ void DailyTaskDialog::clearInputFields() {
     startTimeEdit->setTime(QTime::currentTime()); // 设置开始时间为当前时间
     endTimeEdit->setTime(QTime::currentTime().addSecs(3600)); // 设置结束时间为当前时间加一小时
     noteEdit->clear(); // 清空备注
+    repeatComboBox->setCurrentIndex(0); // 默认不重复
+    intervalSpinBox->setValue(1);
+    untilCheckBox->setChecked(false);
+    untilDateEdit->setDate(currentDate.addMonths(3));
+    intervalSpinBox->setEnabled(false);
+    untilCheckBox->setEnabled(false);
+    untilDateEdit->setEnabled(false);
     editingIndex = -1; // 设置为新建模式
     taskListWidget->clearSelection(); // 取消左侧列表的选中状态
 }
@@ -103,10 +197,92 @@ void DailyTaskDialog::clearInputFields() {
 void DailyTaskDialog::refreshTaskList() {
     taskListWidget->clear(); // 清空现有列表项
     for (const DailyTask &task : taskList) {
-        taskListWidget->addItem(task.getTitle()); // 为每个任务添加标题到列表
+        // 重复日程的实例加一个标记
+        taskListWidget->addItem(task.isOccurrence() ? QString::fromUtf8("↻ ") + task.getTitle()
+                                                    : task.getTitle()); // 为每个任务添加标题到列表
     }
 }
 
+bool DailyTaskDialog::isRepeatSelected() const
+{
+    return repeatComboBox->currentIndex() > 0;
+}
+
+RecurrenceRule DailyTaskDialog::ruleFromInputs(const QDate &start) const
+{
+    static const RecurrenceRule::Frequency frequencies[] = {
+        RecurrenceRule::Daily, RecurrenceRule::Daily, RecurrenceRule::Weekly, RecurrenceRule::Monthly
+    };
+    RecurrenceRule rule(frequencies[repeatComboBox->currentIndex()], intervalSpinBox->value(), start);
+    if (untilCheckBox->isChecked()) {
+        rule.setUntil(untilDateEdit->date());
+    }
+    return rule;
+}
+
+void DailyTaskDialog::loadRuleToInputs(const DailyTask &task)
+{
+    RecurringTask recurring;
+    if (!task.isOccurrence() || !findRule(task.getRuleId(), recurring)) {
+        repeatComboBox->setCurrentIndex(0);
+        return;
+    }
+    const RecurrenceRule &rule = recurring.rule;
+    repeatComboBox->setCurrentIndex(rule.frequency() == RecurrenceRule::Daily ? 1
+                                    : rule.frequency() == RecurrenceRule::Weekly ? 2 : 3);
+    intervalSpinBox->setValue(rule.interval());
+    untilCheckBox->setChecked(rule.until().isValid());
+    if (rule.until().isValid()) {
+        untilDateEdit->setDate(rule.until());
+    }
+}
+
+bool DailyTaskDialog::findRule(int ruleId, RecurringTask &out) const
+{
+    auto it = stagedRules.constFind(ruleId);
+    if (it != stagedRules.constEnd()) {
+        out = it.value();
+        return true;
+    }
+    return DatabaseManager::instance().getTaskRule(ruleId, out);
+}
+
+// 暂存对重复日程某个实例的修改：选择“不重复”表示把这一次单独拆出来，否则修改整个系列
+bool DailyTaskDialog::saveOccurrence(const DailyTask &original, const DailyTask &taskToSave,
+                                     EditState &state, QList<TaskChange> &changes, QString &text)
+{
+    const int ruleId = original.getRuleId();
+    if (!isRepeatSelected()) {
+        DailyTask detached = taskToSave;
+        detached.setRuleId(-1);
+        detached.setId(nextTempId--);
+        changes << TaskChange::ruleException(ruleId, currentDate)
+                << TaskChange::addTask(currentDate, detached);
+        state.tasks[editingIndex] = detached;
+        text = QString("单独修改这一次：%1").arg(detached.getTitle());
+        return true;
+    }
+
+    RecurringTask recurring;
+    if (!findRule(ruleId, recurring)) {
+        return false;
+    }
+    // 保留系列的起始日期和已有的例外日期
+    RecurrenceRule rule = ruleFromInputs(recurring.rule.startDate());
+    rule.setExceptions(recurring.rule.exceptions());
+    DailyTask series = taskToSave;
+    series.setRuleId(ruleId);
+    changes << TaskChange::updateRule(ruleId, series, rule);
+    state.rules.insert(ruleId, RecurringTask{ruleId, series, rule});
+    if (rule.occursOn(currentDate)) {
+        state.tasks[editingIndex] = series;
+    } else {
+        state.tasks.removeAt(editingIndex);
+    }
+    text = QString("修改重复日程：%1").arg(series.getTitle());
+    return true;
+}
+
 // 点击左侧任务列表项时触发
 void DailyTaskDialog::onTaskSelected(int currentRow) {
     // 如果选中行无效（例如，清除了选中或超出范围），则切换到新建任务模式
@@ -122,11 +298,12 @@ void DailyTaskDialog::onTaskSelected(int currentRow) {
     startTimeEdit->setTime(task.getStartTime());
     endTimeEdit->setTime(task.getEndTime());
     noteEdit->setPlainText(task.getNote());
+    loadRuleToInputs(task);
 
     editingIndex = currentRow; // 标记当前正在编辑的任务索引
 }
 
-// 点击保存按钮时触发
+// 点击保存按钮时触发：只暂存，关闭对话框时再写入数据库
 void DailyTaskDialog::onSaveClicked()
 {
     QString title = titleEdit->text();
@@ -136,43 +313,57 @@ void DailyTaskDialog::onSaveClicked()
 
     // 标题不能为空检查
     if (title.isEmpty()) {
-        QMessageBox::warning(this, "警告", "标题不能为空！");
+        showStatus("标题不能为空！", true);
+        titleEdit->setFocus();
         return;
     }
 
     DailyTask taskToSave(title, startTime, endTime, note); // 创建或更新的任务对象
+    EditState after = currentState();
+    QList<TaskChange> changes;
+    QString text;
+    const bool editing = editingIndex >= 0 && editingIndex < taskList.size();
 
-    if (editingIndex >= 0 && editingIndex < taskList.size()) {
-        // 处于编辑模式
-        int oldId = taskList[editingIndex].getId(); // 获取原始任务的ID
-        taskToSave.setId(oldId); // 将原始ID赋给新任务对象，以保留ID
-
-        // 更新数据库中的任务
-        if (DatabaseManager::instance().updateTaskById(oldId, taskToSave)) {
-            taskList[editingIndex] = taskToSave; // 更新本地任务列表中的数据
-            taskListWidget->item(editingIndex)->setText(taskToSave.getTitle()); // 更新左侧列表项的显示文本
-            QMessageBox::information(this, "成功", "任务更新成功！");
-        } else {
-            QMessageBox::critical(this, "错误", "更新任务失败！");
+    if (editing && taskList[editingIndex].isOccurrence()) {
+        // 编辑重复日程的实例
+        if (!saveOccurrence(taskList[editingIndex], taskToSave, after, changes, text)) {
+            showStatus("找不到这个重复日程的规则，无法修改。", true);
             return;
         }
+    } else if (editing && isRepeatSelected()) {
+        // 把已有的单次日程改成重复日程：写入规则后删除原来的行。
+        // 两步都作为暂存修改由 applyTaskChanges 放进同一个事务，任一步失败都整体回滚
+        DailyTask series = taskToSave;
+        series.setRuleId(nextTempId--);
+        const RecurrenceRule rule = ruleFromInputs(currentDate);
+        changes << TaskChange::addRule(series, rule)
+                << TaskChange::deleteTask(taskList[editingIndex].getId());
+        after.rules.insert(series.getRuleId(), RecurringTask{series.getRuleId(), series, rule});
+        after.tasks[editingIndex] = series;
+        text = QString("改为重复日程：%1").arg(series.getTitle());
+    } else if (editing) {
+        // 处于编辑模式，保留原始ID
+        taskToSave.setId(taskList[editingIndex].getId());
+        changes << TaskChange::updateTask(taskToSave.getId(), taskToSave);
+        after.tasks[editingIndex] = taskToSave;
+        text = QString("修改日程：%1").arg(taskToSave.getTitle());
+    } else if (isRepeatSelected()) {
+        // 新建重复日程：只写入一条规则，从当天开始重复
+        DailyTask series = taskToSave;
+        series.setRuleId(nextTempId--);
+        const RecurrenceRule rule = ruleFromInputs(currentDate);
+        changes << TaskChange::addRule(series, rule);
+        after.rules.insert(series.getRuleId(), RecurringTask{series.getRuleId(), series, rule});
+        after.tasks.append(series);
+        text = QString("新建重复日程：%1").arg(series.getTitle());
     } else {
-        // 处于新建模式
-        // 添加任务到数据库，并获取新生成的ID
-        int newId = DatabaseManager::instance().addDailyTask(currentDate, taskToSave);
-        if (newId != -1) {
-            taskToSave.setId(newId); // 设置任务对象的ID为数据库生成的ID
-            taskList.append(taskToSave); // 将新任务添加到本地任务列表
-            taskListWidget->addItem(taskToSave.getTitle()); // 将新任务标题添加到左侧列表部件
-            QMessageBox::information(this, "成功", "任务添加成功！");
-        } else {
-            QMessageBox::critical(this, "错误", "添加任务失败！");
-            return;
-        }
+        // 处于新建模式，写入前先用临时ID，之后的修改/删除都能引用它
+        taskToSave.setId(nextTempId--);
+        changes << TaskChange::addTask(currentDate, taskToSave);
+        after.tasks.append(taskToSave);
+        text = QString("新建日程：%1").arg(taskToSave.getTitle());
     }
-    clearInputFields(); // 保存后，清空输入框并切换回“新建任务”模式
-    // 如果希望保存后关闭对话框，取消注释下一行：
-    // accept();
+    stage(text, after, changes); // 暂存后清空输入框并切换回“新建任务”模式
 }
 
 // “新建日程”按钮的槽函数
@@ -181,31 +372,122 @@ void DailyTaskDialog::onNewTaskClicked()
     clearInputFields(); // 调用辅助函数清空输入框，进入新建模式
 }
 
-// “删除日程”按钮的槽函数
+// “删除日程”按钮的槽函数：删除同样只是暂存，可以撤销
 void DailyTaskDialog::onDeleteTaskClicked()
 {
-    if (editingIndex >= 0 && editingIndex < taskList.size()) { // 确保有选中的任务
-        QMessageBox::StandardButton reply;
-        reply = QMessageBox::question(this, "确认删除", "确定要删除此日程吗？",
-                                      QMessageBox::Yes|QMessageBox::No);
-        if (reply == QMessageBox::Yes) {
-            int taskIdToDelete = taskList[editingIndex].getId(); // 获取要删除任务的ID
-            if (DatabaseManager::instance().deleteTaskById(taskIdToDelete)) { // 从数据库中删除
-                deleteTask(editingIndex); // 调用现有的deleteTask方法从本地列表和UI中删除
-                QMessageBox::information(this, "成功", "任务删除成功！");
-                clearInputFields(); // 删除后清空输入框
-                // 重新刷新整个列表，确保索引正确，因为删除后原有索引可能失效
-                // 或者在deleteTask内部直接处理好刷新
-                // 暂时这里不调用refreshTaskList()，因为deleteTask内部已经处理了QListWidget的移除
-            } else {
-                QMessageBox::critical(this, "错误", "删除任务失败！");
-            }
+    if (editingIndex < 0 || editingIndex >= taskList.size()) { // 确保有选中的任务
+        showStatus("请选择一个要删除的日程！", true);
+        return;
+    }
+
+    const DailyTask task = taskList[editingIndex];
+    EditState after = currentState();
+    after.tasks.removeAt(editingIndex);
+
+    if (task.isOccurrence()) {
+        // 重复日程：可以只删除这一次（记为例外日期），也可以删除整个系列
+        QMessageBox box(QMessageBox::Question, "确认删除", "这是一个重复日程，要删除哪些？",
+                        QMessageBox::Cancel, this);
+        QPushButton *onlyThis = box.addButton("仅这一次", QMessageBox::AcceptRole);
+        QPushButton *wholeSeries = box.addButton("整个系列", QMessageBox::DestructiveRole);
+        box.exec();
+
+        const int ruleId = task.getRuleId();
+        if (box.clickedButton() == onlyThis) {
+            stage(QString("删除这一次：%1").arg(task.getTitle()), after,
+                  {TaskChange::ruleException(ruleId, currentDate)});
+        } else if (box.clickedButton() == wholeSeries) {
+            after.rules.remove(ruleId);
+            stage(QString("删除重复日程：%1").arg(task.getTitle()), after,
+                  {TaskChange::deleteRule(ruleId)});
         }
+        return;
+    }
+
+    stage(QString("删除日程：%1").arg(task.getTitle()), after, {TaskChange::deleteTask(task.getId())});
+}
+
+void DailyTaskDialog::onDiscardClicked()
+{
+    discardChanges = true;
+    reject();
+}
+
+DailyTaskDialog::EditState DailyTaskDialog::currentState() const
+{
+    return EditState{taskList, stagedRules};
+}
+
+void DailyTaskDialog::restoreState(const EditState &state)
+{
+    taskList = state.tasks;
+    stagedRules = state.rules;
+    refreshTaskList();
+    clearInputFields();
+}
+
+void DailyTaskDialog::stage(const QString &text, const EditState &after, const QList<TaskChange> &changes)
+{
+    // push 会立即执行 redo()，把对话框切换到修改后的状态
+    undoStack->push(new TaskEditCommand(text, currentState(), after, changes,
+                                        [this](const EditState &state) { restoreState(state); }));
+}
+
+int DailyTaskDialog::pendingChangeCount() const
+{
+    return undoStack->index();
+}
+
+QList<TaskChange> DailyTaskDialog::pendingChanges() const
+{
+    QList<TaskChange> changes;
+    for (int i = 0; i < undoStack->index(); ++i) {
+        changes += static_cast<const TaskEditCommand *>(undoStack->command(i))->changes();
+    }
+    return changes;
+}
+
+bool DailyTaskDialog::commitChanges()
+{
+    const QList<TaskChange> changes = pendingChanges();
+    if (changes.isEmpty()) {
+        return true;
+    }
+    if (!DatabaseManager::instance().applyTaskChanges(changes)) {
+        showStatus("写入数据库失败，修改仍然保留，可以重试或放弃修改。", true);
+        return false;
+    }
+    undoStack->clear();
+    return true;
+}
+
+void DailyTaskDialog::done(int result)
+{
+    if (!discardChanges && !commitChanges()) {
+        return;
+    }
+    discardChanges = false;
+    QDialog::done(result);
+}
+
+void DailyTaskDialog::updateStatus()
+{
+    const int pending = pendingChangeCount();
+    setWindowModified(pending > 0);
+    if (pending > 0) {
+        showStatus(QString("%1 项修改已暂存（最近：%2），关闭对话框时一起保存")
+                       .arg(pending).arg(undoStack->undoText()));
     } else {
-        QMessageBox::warning(this, "警告", "请选择一个要删除的日程！");
+        showStatus("没有未保存的修改");
     }
 }
 
+void DailyTaskDialog::showStatus(const QString &message, bool error)
+{
+    statusLabel->setText(message);
+    statusLabel->setStyleSheet(error ? "color: #C62828;" : "color: #555;");
+}
+
 // 删除任务的逻辑（从本地列表和UI中移除）
 void DailyTaskDialog::deleteTask(int index) {
     if (index >= 0 && index < taskList.size()) {
@@ -9,6 +9,17 @@
 #include <QPushButton> // 引入QPushButton，因为头文件里用到了
 
 #include "DailyTask.h" // 引入DailyTask类定义
+#include "RecurrenceRule.h"
+#include "DatabaseManager.h"
+#include <QHash>
+
+class QComboBox;
+class QSpinBox;
+class QCheckBox;
+class QDateEdit;
+class QLabel;
+class QToolButton;
+class QUndoStack;
 
 class QLineEdit; // 前向声明QLineEdit，避免循环引用
 class QTimeEdit; // 前向声明QTimeEdit
@@ -30,6 +41,19 @@ public:
     // 删除任务（已存在，但在cpp中会有更具体的调用逻辑）
     void deleteTask(int index);
 
+    // 对话框里的修改先暂存（可撤销/重做），关闭时在一个事务里一次性写入数据库
+    int pendingChangeCount() const;
+
+    // 暂存状态：当天的任务列表，以及本次新建/修改过的重复规则
+    struct EditState {
+        QList<DailyTask> tasks;
+        QHash<int, RecurringTask> rules;
+    };
+
+public slots:
+    // 关闭时提交暂存的修改；写入失败时对话框保持打开，修改不会丢
+    void done(int result) override;
+
 private slots:
     // 当左侧任务列表选中项改变时触发
     void onTaskSelected(int currentRow);
@@ -39,23 +63,53 @@ private slots:
     void onNewTaskClicked();
     // 点击“删除日程”按钮时触发
     void onDeleteTaskClicked();
+    // 点击“放弃修改”按钮时触发
+    void onDiscardClicked();
 
 private:
     // 辅助函数：清空右侧输入框内容并重置为新建模式
     void clearInputFields();
     // 辅助函数：刷新左侧任务列表
     void refreshTaskList();
+    // 重复设置相关
+    bool isRepeatSelected() const;
+    RecurrenceRule ruleFromInputs(const QDate &start) const;
+    void loadRuleToInputs(const DailyTask &task);
+    bool findRule(int ruleId, RecurringTask &out) const; // 先查本次暂存的规则，再查数据库
+    bool saveOccurrence(const DailyTask &original, const DailyTask &taskToSave,
+                        EditState &state, QList<TaskChange> &changes, QString &text);
+
+    // 暂存与提交
+    EditState currentState() const;
+    void restoreState(const EditState &state);
+    void stage(const QString &text, const EditState &after, const QList<TaskChange> &changes);
+    QList<TaskChange> pendingChanges() const;
+    bool commitChanges();
+    void updateStatus();
+    void showStatus(const QString &message, bool error = false);
 
     QListWidget *taskListWidget; // 左侧任务列表部件
     QLineEdit *titleEdit;        // 任务标题输入框
     QTimeEdit *startTimeEdit;    // 开始时间选择器
     QTimeEdit *endTimeEdit;      // 结束时间选择器
     QTextEdit *noteEdit;         // 备注输入框
+    QComboBox *repeatComboBox;   // 重复：不重复/每天/每周/每月
+    QSpinBox *intervalSpinBox;   // 每隔几天/周/月
+    QCheckBox *untilCheckBox;    // 是否设置截止日期
+    QDateEdit *untilDateEdit;    // 截止日期
 
     QPushButton *saveButton;     // 保存按钮
     QPushButton *cancelButton;   // 取消按钮
     QPushButton *newTaskButton;  // 新建日程按钮
     QPushButton *deleteTaskButton; // 删除日程按钮
+    QToolButton *undoButton;     // 撤销上一步暂存的修改
+    QToolButton *redoButton;     // 重做
+    QLabel *statusLabel;         // 非模态的状态提示，代替每次保存弹出的消息框
+
+    QUndoStack *undoStack;       // 暂存的修改，栈底到当前位置就是待写入的修改集
+    QHash<int, RecurringTask> stagedRules; // 本次新建/修改过、尚未写入的重复规则
+    int nextTempId = -2;         // 暂存新建的任务/规则使用的临时 id
+    bool discardChanges = false; // 点了“放弃修改”，关闭时不写入
 
     QDate currentDate;           // 当前日期，用于添加新任务时关联
 
@@ -1,21 +1,169 @@
 #include "DatabaseManager.h"
+#include "MetricsRegistry.h"
+#include "StallWatchdog.h"
+#include <QJsonDocument>
+#include <QSet>
+#include <QSettings>
+#include <QSignalBlocker>
+#include <QUuid>
+#include <algorithm>
+#include <atomic>
+
+namespace {
+
+// 参与同步的表及其列（不含 id 和 uuid），变更记录的 payload 就是这些列
+struct SyncedTable {
+    QString name;
+    QStringList columns;
+    QStringList notNullText; // 声明为 NOT NULL DEFAULT '' 的列，对端发来 null 时存空串
+};
+
+const QList<SyncedTable> &syncedTables()
+{
+    static const QList<SyncedTable> tables = {
+        {"tasks", {"date", "title", "start_time", "end_time", "note"}, {"start_time"}},
+        {"task_rules", {"dtstart", "title", "start_time", "end_time", "note", "rrule", "exdates"}},
+        {"study_sessions", {"start_time", "end_time", "duration_seconds", "tag"}},
+    };
+    return tables;
+}
+
+const SyncedTable *findSyncedTable(const QString &name)
+{
+    for (const SyncedTable &table : syncedTables()) {
+        if (table.name == name) return &table;
+    }
+    return nullptr;
+}
+
+// 新行的 uuid：32 位小写十六进制，与触发器里 lower(hex(randomblob(16))) 的格式一致
+QString newRowUuid()
+{
+    return QUuid::createUuid().toString(QUuid::Id128);
+}
+
+// 当前时间（毫秒）的 SQL 表达式
+const QString kNowMillisSql = QStringLiteral("CAST((julianday('now') - 2440587.5) * 86400000 AS INTEGER)");
+
+QVariant jsonToSql(const QJsonValue &value)
+{
+    return value.isNull() || value.isUndefined() ? QVariant() : value.toVariant();
+}
+
+QVariant payloadValue(const SyncedTable &table, const QJsonObject &payload, const QString &column)
+{
+    const QVariant value = jsonToSql(payload.value(column));
+    return value.isNull() && table.notNullText.contains(column) ? QVariant(QString("")) : value;
+}
+
+// tasks.start_time 不允许 NULL（见 migrateTasksStartTime），没有开始时间的任务存空串
+QString startTimeToSql(const QTime &time)
+{
+    return time.isValid() ? time.toString("HH:mm") : QString("");
+}
+
+// 查询结果的前六列（date, title, start_time, end_time, note, id）组成一个任务
+DatedTask datedTaskFromRow(const QSqlQuery &query)
+{
+    DatedTask item;
+    item.date = QDate::fromString(query.value(0).toString(), Qt::ISODate);
+    item.task = DailyTask(query.value(1).toString(),
+                          QTime::fromString(query.value(2).toString(), "HH:mm"),
+                          QTime::fromString(query.value(3).toString(), "HH:mm"),
+                          query.value(4).toString(),
+                          query.value(5).toInt());
+    return item;
+}
+
+// LIKE ... ESCAPE '\' 的子串匹配模式
+QString likePattern(QString term)
+{
+    term.replace("\\", "\\\\").replace("%", "\\%").replace("_", "\\_");
+    return "%" + term + "%";
+}
+
+// trigram 分词按码点切分，不足三个码点的词在 FTS 里匹配不到。
+// 不能用 QString::size()：emoji 等 BMP 以外的字符一个就占两个 UTF-16 单元
+bool isShortTerm(const QString &term)
+{
+    return term.toUcs4().size() < 3;
+}
+
+// 一个调用点的指标序列。放在函数内的静态变量里，只在第一次经过时查一次登记处：
+//   static const DbOperationMetrics metrics("add_task");
+//   DbOperation op(metrics);
+// 错误计数等第一次失败时才登记，没出过错的操作不会在导出里多出一行 0
+class DbOperationMetrics
+{
+public:
+    explicit DbOperationMetrics(const char *op)
+        : m_op(op)
+        , m_duration(MetricsRegistry::instance().histogram("planner_db_operation_seconds", {{"op", op}}))
+    {
+    }
+
+    const char *op() const { return m_op; }
+    MetricsRegistry::Histogram *duration() const { return m_duration; }
+    MetricsRegistry::Counter *errors() const
+    {
+        MetricsRegistry::Counter *counter = m_errors.load(std::memory_order_acquire);
+        if (!counter) {
+            // 两个线程同时第一次失败时都会去查，拿到的是同一个序列
+            counter = MetricsRegistry::instance().counter("planner_db_errors_total", {{"op", m_op}});
+            m_errors.store(counter, std::memory_order_release);
+        }
+        return counter;
+    }
+
+private:
+    const char *m_op;
+    MetricsRegistry::Histogram *m_duration;
+    mutable std::atomic<MetricsRegistry::Counter *> m_errors{nullptr};
+};
+
+// 一次数据库操作：作用域内的耗时记进 planner_db_operation_seconds，失败时另计 planner_db_errors_total；
+// 同时给卡顿看门狗打上 op 标签
+class DbOperation
+{
+public:
+    explicit DbOperation(const DbOperationMetrics &metrics)
+        : m_metrics(metrics)
+        , m_tag(metrics.op())
+        , m_timer(metrics.duration())
+    {
+    }
+
+    void failed() { m_metrics.errors()->increment(); }
+
+private:
+    const DbOperationMetrics &m_metrics;
+    StallWatchdog::Operation m_tag;
+    MetricsRegistry::ScopedTimer m_timer;
+};
+
+} // namespace
 
 DatabaseManager::DatabaseManager() {}
 
 // 【新增】删除所有自习记录的实现
 bool DatabaseManager::deleteAllStudySessions()
 {
+    static const DbOperationMetrics metrics("delete_all_study_sessions");
+    DbOperation op(metrics);
     if (!db.isOpen()) {
+        op.failed();
         qWarning() << "数据库未打开，无法删除记录！";
         return false;
     }
     QSqlQuery query(db);
     // 使用 DELETE FROM 语句清空表，这比 DROP TABLE 更安全
     if (!query.exec("DELETE FROM study_sessions")) {
+        op.failed();
         qWarning() << "清空 study_sessions 表失败: " << query.lastError().text();
         return false;
     }
-    // VACUUM 命令可以收缩数据库文件，释放已删除数据占用的空间（可选）
+    // VACUUM 命令可以收缩数据库文件，释放已删除数据占用的空间（可选）；要重写整个文件，数据多时很慢
+    StallWatchdog::Operation vacuum("vacuum");
     query.exec("VACUUM");
     return true;
 }
@@ -33,17 +181,54 @@ QList<QDate> DatabaseManager::getAllDatesWithTasks() const
     return dates;
 }
 
+QList<QDate> DatabaseManager::getDatesWithTasksBetween(const QDate &from, const QDate &to) const
+{
+    static const DbOperationMetrics metrics("dates_with_tasks");
+    DbOperation op(metrics);
+    QList<QDate> dates;
+    if (!db.isOpen()) return dates;
+
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+    query.prepare("SELECT DISTINCT date FROM tasks WHERE date >= ? AND date <= ?");
+    query.addBindValue(from.toString(Qt::ISODate));
+    query.addBindValue(to.toString(Qt::ISODate));
+    if (!query.exec()) {
+        op.failed();
+        qDebug() << "查询区间内有任务的日期失败：" << query.lastError().text();
+        return dates;
+    }
+    while (query.next()) {
+        dates.append(query.value(0).toDate());
+    }
+    return dates;
+}
+
 DatabaseManager& DatabaseManager::instance()
 {
     static DatabaseManager instance;
     return instance;
 }
 
-bool DatabaseManager::init()
+bool DatabaseManager::init(const QString &path)
 {
+    static const DbOperationMetrics metrics("init");
+    DbOperation op(metrics);
+    // 重新指定数据库文件时（例如基准测试切换数据集）先关掉并移除旧连接，再清缓存；
+    // 不移除的话 addDatabase 会替换仍在注册表里的同名连接并报警告
+    if (db.isValid()) {
+        const QString connection = db.connectionName();
+        db.close();
+        db = QSqlDatabase(); // removeDatabase 要求这份连接不再有人持有
+        QSqlDatabase::removeDatabase(connection);
+    }
+    m_rulesLoaded = false;
+    m_occurrenceCache.clear();
+
     db = QSqlDatabase::addDatabase("QSQLITE");
-    db.setDatabaseName("tasks.db");
+    db.setDatabaseName(path);
     if (!db.open()) {
+        op.failed();
         qDebug() << "无法打开数据库：" << db.lastError().text();
         return false;
     }
@@ -54,7 +239,7 @@ bool DatabaseManager::init()
             id INTEGER PRIMARY KEY AUTOINCREMENT,
             date TEXT,
             title TEXT,
-            start_time TEXT,
+            start_time TEXT NOT NULL DEFAULT '',
             end_time TEXT,
             note TEXT
         )
@@ -64,46 +249,144 @@ bool DatabaseManager::init()
             id INTEGER PRIMARY KEY AUTOINCREMENT,
             start_time TEXT,
             end_time TEXT,
-            duration_seconds INTEGER
+            duration_seconds INTEGER,
+            tag TEXT
         )
     )";
 
     // 执行创建 study_sessions 表
     if (!query.exec(createStudyTable)) {
+        op.failed();
         qDebug() << "创建 study_sessions 表失败：" << query.lastError().text();
         return false;
     }
+    if (!migrateStudySessionsTable()) {
+        return false;
+    }
 
     // 执行创建 tasks 表
     if (!query.exec(createTable)) {
+        op.failed();
         qDebug() << "创建 tasks 表失败：" << query.lastError().text();
         return false;
     }
+    if (!migrateTasksStartTime()) {
+        op.failed();
+        return false;
+    }
+    QString createRuleTable = R"(
+        CREATE TABLE IF NOT EXISTS task_rules (
+            id INTEGER PRIMARY KEY AUTOINCREMENT,
+            dtstart TEXT,
+            title TEXT,
+            start_time TEXT,
+            end_time TEXT,
+            note TEXT,
+            rrule TEXT,
+            exdates TEXT
+        )
+    )";
+    if (!query.exec(createRuleTable)) {
+        op.failed();
+        qDebug() << "创建 task_rules 表失败：" << query.lastError().text();
+        return false;
+    }
+
+    // 按日期/时间排序和分页查询都走这个索引
+    if (!query.exec("CREATE INDEX IF NOT EXISTS idx_tasks_date_start ON tasks(date, start_time, id)")) {
+        op.failed();
+        qDebug() << "创建 tasks 索引失败：" << query.lastError().text();
+    }
+    m_ftsAvailable = createFullTextIndex();
+    // 早先的开发版本为一两个字的搜索建过单字/双字索引，体积太大，已改为按日期索引扫描（见 searchTasks）
+    for (const char *sql : {"DROP TRIGGER IF EXISTS tasks_grams_ai", "DROP TRIGGER IF EXISTS tasks_grams_ad",
+                            "DROP TRIGGER IF EXISTS tasks_grams_au", "DROP TABLE IF EXISTS task_grams",
+                            "DROP TABLE IF EXISTS gram_positions"}) {
+        query.exec(sql);
+    }
+    m_changeLogAvailable = createChangeLog();
 
     return true;
 }
 
 bool DatabaseManager::addDailyTask(const QDate &date, DailyTask &task)
 {
+    static const DbOperationMetrics metrics("add_task");
+    DbOperation op(metrics);
     QSqlQuery query;
-    query.prepare("INSERT INTO tasks (date, title, start_time, end_time, note) VALUES (?, ?, ?, ?, ?)");
+    query.prepare("INSERT INTO tasks (date, title, start_time, end_time, note, uuid) VALUES (?, ?, ?, ?, ?, ?)");
     query.addBindValue(date.toString(Qt::ISODate));
     query.addBindValue(task.getTitle());
-    query.addBindValue(task.getStartTime().toString("HH:mm"));
+    query.addBindValue(startTimeToSql(task.getStartTime()));
     query.addBindValue(task.getEndTime().toString("HH:mm"));
     query.addBindValue(task.getNote());
+    query.addBindValue(newRowUuid());
 
     bool success = query.exec();
     if (success) {
         task.setId(query.lastInsertId().toInt());  // ✅ 设置返回的 ID
+        emit taskAdded(task.getId());
     } else {
+        op.failed();
         qDebug() << "添加任务失败：" << query.lastError().text();
     }
     return success;
 }
 
+bool DatabaseManager::addDailyTasks(QList<DatedTask> &tasks)
+{
+    static const DbOperationMetrics metrics("add_tasks_batch");
+    DbOperation op(metrics);
+    if (tasks.isEmpty()) {
+        return true;
+    }
+    if (!db.transaction()) {
+        op.failed();
+        qDebug() << "开启事务失败：" << db.lastError().text();
+        return false;
+    }
+    if (!insertDailyTasks(tasks)) {
+        op.failed();
+        db.rollback();
+        return false;
+    }
+
+    if (!db.commit()) {
+        op.failed();
+        qDebug() << "提交任务失败：" << db.lastError().text();
+        db.rollback();
+        return false;
+    }
+    for (const DatedTask &item : tasks) {
+        emit taskAdded(item.task.getId());
+    }
+    return true;
+}
+
+bool DatabaseManager::insertDailyTasks(QList<DatedTask> &tasks)
+{
+    QSqlQuery query(db);
+    query.prepare("INSERT INTO tasks (date, title, start_time, end_time, note, uuid) VALUES (?, ?, ?, ?, ?, ?)");
+    for (DatedTask &item : tasks) {
+        query.addBindValue(item.date.toString(Qt::ISODate));
+        query.addBindValue(item.task.getTitle());
+        query.addBindValue(startTimeToSql(item.task.getStartTime()));
+        query.addBindValue(item.task.getEndTime().toString("HH:mm"));
+        query.addBindValue(item.task.getNote());
+        query.addBindValue(newRowUuid());
+        if (!query.exec()) {
+            qDebug() << "批量添加任务失败：" << query.lastError().text();
+            return false;
+        }
+        item.task.setId(query.lastInsertId().toInt());
+    }
+    return true;
+}
+
 QList<DailyTask> DatabaseManager::getTasksForDate(const QDate &date)
 {
+    static const DbOperationMetrics metrics("tasks_for_date");
+    DbOperation op(metrics);
     QList<DailyTask> tasks;
     QSqlQuery query;
     query.prepare("SELECT title, start_time, end_time, note, id FROM tasks WHERE date = ?");
@@ -121,24 +404,285 @@ QList<DailyTask> DatabaseManager::getTasksForDate(const QDate &date)
             tasks.append(task);
         }
     }
+
+    // 合并当天由重复规则展开的实例
+    const QList<DatedTask> occurrences = getOccurrencesBetween(date, date);
+    if (!occurrences.isEmpty()) {
+        for (const DatedTask &occurrence : occurrences) {
+            tasks.append(occurrence.task);
+        }
+        std::stable_sort(tasks.begin(), tasks.end(), [](const DailyTask &a, const DailyTask &b) {
+            return a.getStartTime() < b.getStartTime();
+        });
+    }
+    return tasks;
+}
+
+QList<DatedTask> DatabaseManager::getTasksBetween(const QDate &from, const QDate &to)
+{
+    static const DbOperationMetrics metrics("tasks_between");
+    DbOperation op(metrics);
+    QList<DatedTask> tasks;
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+    query.prepare("SELECT date, title, start_time, end_time, note, id FROM tasks "
+                  "WHERE date >= ? AND date <= ? ORDER BY date, start_time");
+    query.addBindValue(from.toString(Qt::ISODate));
+    query.addBindValue(to.toString(Qt::ISODate));
+
+    if (!query.exec()) {
+        op.failed();
+        qDebug() << "查询区间任务失败：" << query.lastError().text();
+        return tasks;
+    }
+    while (query.next()) {
+        DatedTask item;
+        item.date = QDate::fromString(query.value(0).toString(), Qt::ISODate);
+        item.task = DailyTask(query.value(1).toString(),
+                              QTime::fromString(query.value(2).toString(), "HH:mm"),
+                              QTime::fromString(query.value(3).toString(), "HH:mm"),
+                              query.value(4).toString(),
+                              query.value(5).toInt());
+        tasks.append(item);
+    }
+    return tasks;
+}
+
+// 建立 tasks 的 FTS5 外部内容索引，并用触发器保持同步。
+// trigram 分词按三字切分，中文不需要分词词典，同时天然支持前缀和子串匹配。
+bool DatabaseManager::createFullTextIndex()
+{
+    QSqlQuery query(db);
+    const bool exists = query.exec("SELECT 1 FROM sqlite_master WHERE type = 'table' AND name = 'tasks_fts'") && query.next();
+
+    // 触发器每次都补建一遍：tasks 表重建（见 migrateTasksStartTime）时它们随旧表一起被删掉
+    QStringList statements;
+    if (!exists) {
+        statements << R"(CREATE VIRTUAL TABLE tasks_fts USING fts5(
+                             title, note, content = 'tasks', content_rowid = 'id', tokenize = 'trigram'))";
+    }
+    statements
+        << R"(CREATE TRIGGER IF NOT EXISTS tasks_fts_ai AFTER INSERT ON tasks BEGIN
+                  INSERT INTO tasks_fts(rowid, title, note) VALUES (new.id, new.title, new.note);
+              END)"
+        << R"(CREATE TRIGGER IF NOT EXISTS tasks_fts_ad AFTER DELETE ON tasks BEGIN
+                  INSERT INTO tasks_fts(tasks_fts, rowid, title, note) VALUES ('delete', old.id, old.title, old.note);
+              END)"
+        << R"(CREATE TRIGGER IF NOT EXISTS tasks_fts_au AFTER UPDATE ON tasks BEGIN
+                  INSERT INTO tasks_fts(tasks_fts, rowid, title, note) VALUES ('delete', old.id, old.title, old.note);
+                  INSERT INTO tasks_fts(rowid, title, note) VALUES (new.id, new.title, new.note);
+              END)";
+    if (!exists) {
+        // 给已有数据建立索引
+        statements << "INSERT INTO tasks_fts(tasks_fts) VALUES ('rebuild')";
+    }
+
+    if (!db.transaction()) {
+        qDebug() << "创建全文索引失败：" << db.lastError().text();
+        return false;
+    }
+    for (const QString &sql : statements) {
+        if (!query.exec(sql)) {
+            qDebug() << "创建全文索引失败，搜索将退回 LIKE：" << query.lastError().text();
+            db.rollback();
+            return false;
+        }
+    }
+    if (!db.commit()) {
+        qDebug() << "提交全文索引失败，搜索将退回 LIKE：" << db.lastError().text();
+        db.rollback();
+        return false;
+    }
+    return true;
+}
+
+QList<DatedTask> DatabaseManager::searchTasks(const QString &text, int limit)
+{
+    static const DbOperationMetrics metrics("search_tasks");
+    DbOperation op(metrics);
+    QList<DatedTask> results;
+    const QStringList terms = text.simplified().split(' ', Qt::SkipEmptyParts);
+    if (terms.isEmpty() || !db.isOpen()) {
+        return results;
+    }
+
+    // trigram 只能匹配不少于三个字符的词；任一词更短或 FTS5 不可用时退回 LIKE 子串匹配
+    bool hasShortTerm = false;
+    for (const QString &term : terms) {
+        if (isShortTerm(term)) hasShortTerm = true;
+    }
+
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+    if (m_ftsAvailable && !hasShortTerm) {
+        // 每个词加双引号作为短语，避免用户输入中的 FTS 语法字符
+        QStringList phrases;
+        for (QString term : terms) {
+            phrases << "\"" + term.replace("\"", "\"\"") + "\"";
+        }
+        // bm25 中标题权重高于备注
+        query.prepare("SELECT t.date, t.title, t.start_time, t.end_time, t.note, t.id "
+                      "FROM tasks_fts JOIN tasks t ON t.id = tasks_fts.rowid "
+                      "WHERE tasks_fts MATCH ? ORDER BY bm25(tasks_fts, 10.0, 1.0) LIMIT ?");
+        query.addBindValue(phrases.join(" AND "));
+        query.addBindValue(limit);
+    } else {
+        QStringList conditions;
+        for (int i = 0; i < terms.size(); ++i) {
+            conditions << "(title LIKE ? ESCAPE '\\' OR note LIKE ? ESCAPE '\\')";
+        }
+        QString sql = "SELECT date, title, start_time, end_time, note, id FROM tasks WHERE " + conditions.join(" AND ");
+        if (hasShortTerm) {
+            // 一两个字的词命中的任务很多：沿 (date, start_time, id) 索引按日期顺序扫描，取满 limit 就停。
+            // 不把标题命中排在前面，那样要扫完整张表再排序
+            sql += " ORDER BY date, start_time, id LIMIT ?";
+        } else {
+            // 没有相关度可用时，标题命中的排在前面，其次按日期
+            sql += " ORDER BY (title LIKE ? ESCAPE '\\') DESC, date LIMIT ?";
+        }
+        query.prepare(sql);
+        for (const QString &term : terms) {
+            query.addBindValue(likePattern(term));
+            query.addBindValue(likePattern(term));
+        }
+        if (!hasShortTerm) query.addBindValue(likePattern(terms.first()));
+        query.addBindValue(limit);
+    }
+
+    if (!query.exec()) {
+        op.failed();
+        qDebug() << "搜索任务失败：" << query.lastError().text();
+        return results;
+    }
+    while (query.next()) {
+        results.append(datedTaskFromRow(query));
+    }
+
+    // 重复日程数量很少，直接在内存里匹配，显示下一次发生的日期
+    ensureTaskRulesLoaded();
+    const QDate today = QDate::currentDate();
+    for (const RecurringTask &recurring : m_rules) {
+        if (results.size() >= limit) break;
+        bool matched = true;
+        for (const QString &term : terms) {
+            if (!recurring.task.getTitle().contains(term, Qt::CaseInsensitive)
+                && !recurring.task.getNote().contains(term, Qt::CaseInsensitive)) {
+                matched = false;
+                break;
+            }
+        }
+        if (!matched) continue;
+        const QList<QDate> next = recurring.rule.occurrencesBetween(today, today.addYears(1));
+        results.append(DatedTask{next.isEmpty() ? recurring.rule.startDate() : next.first(), recurring.task});
+    }
+    return results;
+}
+
+QList<DatedTask> DatabaseManager::getTasksPageAfter(const DatedTask &after, int limit)
+{
+    static const DbOperationMetrics metrics("tasks_page");
+    DbOperation op(metrics);
+    QList<DatedTask> tasks;
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+    // 行值比较和排序都直接用原始列，(date, start_time, id) 索引既定位起点又提供顺序，
+    // 不需要临时排序，翻页代价与页码无关（start_time 不为 NULL，见 migrateTasksStartTime）
+    query.prepare("SELECT date, title, start_time, end_time, note, id FROM tasks "
+                  "WHERE (date, start_time, id) > (?, ?, ?) "
+                  "ORDER BY date, start_time, id LIMIT ?");
+    query.addBindValue(after.date.toString(Qt::ISODate));
+    query.addBindValue(startTimeToSql(after.task.getStartTime()));
+    query.addBindValue(after.task.getId());
+    query.addBindValue(limit);
+
+    if (!query.exec()) {
+        op.failed();
+        qDebug() << "分页查询任务失败：" << query.lastError().text();
+        return tasks;
+    }
+    while (query.next()) {
+        DatedTask item;
+        item.date = QDate::fromString(query.value(0).toString(), Qt::ISODate);
+        item.task = DailyTask(query.value(1).toString(),
+                              QTime::fromString(query.value(2).toString(), "HH:mm"),
+                              QTime::fromString(query.value(3).toString(), "HH:mm"),
+                              query.value(4).toString(),
+                              query.value(5).toInt());
+        tasks.append(item);
+    }
     return tasks;
 }
 
+bool DatabaseManager::getTaskById(int id, DatedTask &out)
+{
+    QSqlQuery query(db);
+    query.prepare("SELECT date, title, start_time, end_time, note FROM tasks WHERE id = ?");
+    query.addBindValue(id);
+
+    if (!query.exec() || !query.next()) {
+        return false;
+    }
+    out.date = QDate::fromString(query.value(0).toString(), Qt::ISODate);
+    out.task = DailyTask(query.value(1).toString(),
+                         QTime::fromString(query.value(2).toString(), "HH:mm"),
+                         QTime::fromString(query.value(3).toString(), "HH:mm"),
+                         query.value(4).toString(),
+                         id);
+    return true;
+}
+
+bool DatabaseManager::forEachTask(const QDate &from, const QDate &to,
+                                  const std::function<bool(const DatedTask &)> &visit)
+{
+    static const DbOperationMetrics metrics("for_each_task");
+    DbOperation op(metrics);
+    QSqlQuery query(db);
+    // 只前向读取时 SQLite 逐行产出结果，百万行导出也只占一行的内存
+    query.setForwardOnly(true);
+    query.prepare("SELECT date, title, start_time, end_time, note, id FROM tasks "
+                  "WHERE date >= ? AND date <= ? ORDER BY date, start_time, id");
+    query.addBindValue(from.isValid() ? from.toString(Qt::ISODate) : QString(""));
+    query.addBindValue(to.isValid() ? to.toString(Qt::ISODate) : QString("9999-12-31"));
+
+    if (!query.exec()) {
+        op.failed();
+        qDebug() << "遍历任务失败：" << query.lastError().text();
+        return false;
+    }
+    while (query.next()) {
+        DatedTask item;
+        item.date = QDate::fromString(query.value(0).toString(), Qt::ISODate);
+        item.task = DailyTask(query.value(1).toString(),
+                              QTime::fromString(query.value(2).toString(), "HH:mm"),
+                              QTime::fromString(query.value(3).toString(), "HH:mm"),
+                              query.value(4).toString(),
+                              query.value(5).toInt());
+        if (!visit(item)) break;
+    }
+    return true;
+}
+
 bool DatabaseManager::deleteTaskById(int id)
 {
+    static const DbOperationMetrics metrics("delete_task");
+    DbOperation op(metrics);
     QSqlQuery query;
     query.prepare("DELETE FROM tasks WHERE id = ?");
     query.addBindValue(id); // 绑定id
 
     if (!query.exec()) {
+        op.failed();
         qDebug() << "删除任务失败：" << query.lastError().text();
         return false;
     }
+    emit taskRemoved(id);
     return true;
 }
 
 bool DatabaseManager::updateTaskById(int id, const DailyTask &task)
 {
+    static const DbOperationMetrics metrics("update_task");
+    DbOperation op(metrics);
     QSqlQuery query;
     query.prepare(R"(
         UPDATE tasks
@@ -146,38 +690,455 @@ bool DatabaseManager::updateTaskById(int id, const DailyTask &task)
         WHERE id = ?
     )");
     query.addBindValue(task.getTitle());
-    query.addBindValue(task.getStartTime().toString("HH:mm"));
+    query.addBindValue(startTimeToSql(task.getStartTime()));
     query.addBindValue(task.getEndTime().toString("HH:mm"));
     query.addBindValue(task.getNote());
     query.addBindValue(id);
 
     if (!query.exec()) {
+        op.failed();
         qDebug() << "更新任务失败：" << query.lastError().text();
         return false;
     }
+    emit taskUpdated(id);
+    return true;
+}
+
+bool DatabaseManager::addTaskRule(DailyTask &task, const RecurrenceRule &rule)
+{
+    static const DbOperationMetrics metrics("add_rule");
+    DbOperation op(metrics);
+    QSqlQuery query(db);
+    query.prepare("INSERT INTO task_rules (dtstart, title, start_time, end_time, note, rrule, exdates, uuid) "
+                  "VALUES (?, ?, ?, ?, ?, ?, ?, ?)");
+    query.addBindValue(rule.startDate().toString(Qt::ISODate));
+    query.addBindValue(task.getTitle());
+    query.addBindValue(task.getStartTime().toString("HH:mm"));
+    query.addBindValue(task.getEndTime().toString("HH:mm"));
+    query.addBindValue(task.getNote());
+    query.addBindValue(rule.toRRule());
+    query.addBindValue(rule.exceptionsToString());
+    query.addBindValue(newRowUuid());
+
+    if (!query.exec()) {
+        op.failed();
+        qDebug() << "添加重复日程失败：" << query.lastError().text();
+        return false;
+    }
+    task.setRuleId(query.lastInsertId().toInt());
+    invalidateOccurrenceCache();
+    return true;
+}
+
+bool DatabaseManager::updateTaskRule(int ruleId, const DailyTask &task, const RecurrenceRule &rule)
+{
+    static const DbOperationMetrics metrics("update_rule");
+    DbOperation op(metrics);
+    QSqlQuery query(db);
+    query.prepare(R"(
+        UPDATE task_rules
+        SET dtstart = ?, title = ?, start_time = ?, end_time = ?, note = ?, rrule = ?, exdates = ?
+        WHERE id = ?
+    )");
+    query.addBindValue(rule.startDate().toString(Qt::ISODate));
+    query.addBindValue(task.getTitle());
+    query.addBindValue(task.getStartTime().toString("HH:mm"));
+    query.addBindValue(task.getEndTime().toString("HH:mm"));
+    query.addBindValue(task.getNote());
+    query.addBindValue(rule.toRRule());
+    query.addBindValue(rule.exceptionsToString());
+    query.addBindValue(ruleId);
+
+    if (!query.exec()) {
+        op.failed();
+        qDebug() << "更新重复日程失败：" << query.lastError().text();
+        return false;
+    }
+    invalidateOccurrenceCache();
+    return true;
+}
+
+bool DatabaseManager::deleteTaskRule(int ruleId)
+{
+    static const DbOperationMetrics metrics("delete_rule");
+    DbOperation op(metrics);
+    QSqlQuery query(db);
+    query.prepare("DELETE FROM task_rules WHERE id = ?");
+    query.addBindValue(ruleId);
+
+    if (!query.exec()) {
+        op.failed();
+        qDebug() << "删除重复日程失败：" << query.lastError().text();
+        return false;
+    }
+    invalidateOccurrenceCache();
     return true;
 }
 
-bool DatabaseManager::addStudySession(const QDateTime &start, const QDateTime &end, int durationSeconds)
+bool DatabaseManager::addTaskRuleException(int ruleId, const QDate &date)
 {
+    RecurringTask recurring;
+    if (!getTaskRule(ruleId, recurring)) {
+        return false;
+    }
+    recurring.rule.addException(date);
+
+    QSqlQuery query(db);
+    query.prepare("UPDATE task_rules SET exdates = ? WHERE id = ?");
+    query.addBindValue(recurring.rule.exceptionsToString());
+    query.addBindValue(ruleId);
+
+    if (!query.exec()) {
+        qDebug() << "添加例外日期失败：" << query.lastError().text();
+        return false;
+    }
+    invalidateOccurrenceCache();
+    return true;
+}
+
+bool DatabaseManager::getTaskRule(int ruleId, RecurringTask &out)
+{
+    ensureTaskRulesLoaded();
+    for (const RecurringTask &recurring : m_rules) {
+        if (recurring.id == ruleId) {
+            out = recurring;
+            return true;
+        }
+    }
+    return false;
+}
+
+QList<RecurringTask> DatabaseManager::getTaskRules()
+{
+    ensureTaskRulesLoaded();
+    return m_rules;
+}
+
+QList<DatedTask> DatabaseManager::getOccurrencesBetween(const QDate &from, const QDate &to)
+{
+    QList<DatedTask> result;
+    if (!from.isValid() || !to.isValid() || to < from) {
+        return result;
+    }
+    ensureTaskRulesLoaded();
+    if (m_rules.isEmpty()) {
+        return result;
+    }
+
+    // 以月为单位展开并缓存，日历翻页、提醒列表滚动时大多直接命中缓存
+    for (QDate month(from.year(), from.month(), 1); month <= to; month = month.addMonths(1)) {
+        const int key = month.year() * 12 + month.month() - 1;
+        auto it = m_occurrenceCache.find(key);
+        if (it == m_occurrenceCache.end()) {
+            QList<DatedTask> monthOccurrences;
+            const QDate monthEnd = month.addMonths(1).addDays(-1);
+            for (const RecurringTask &recurring : m_rules) {
+                for (const QDate &date : recurring.rule.occurrencesBetween(month, monthEnd)) {
+                    monthOccurrences.append(DatedTask{date, recurring.task});
+                }
+            }
+            std::sort(monthOccurrences.begin(), monthOccurrences.end(),
+                      [](const DatedTask &a, const DatedTask &b) {
+                          return a.startDateTime() < b.startDateTime();
+                      });
+            it = m_occurrenceCache.insert(key, monthOccurrences);
+        }
+        for (const DatedTask &occurrence : it.value()) {
+            if (occurrence.date >= from && occurrence.date <= to) {
+                result.append(occurrence);
+            }
+        }
+    }
+    return result;
+}
+
+bool DatabaseManager::applyTaskChanges(const QList<TaskChange> &changes)
+{
+    QList<DatedTask> newTasks;
+    return applyTaskChanges(changes, newTasks);
+}
+
+bool DatabaseManager::applyTaskChanges(const QList<TaskChange> &changes, QList<DatedTask> &newTasks)
+{
+    static const DbOperationMetrics metrics("apply_task_changes");
+    DbOperation op(metrics);
+    if (changes.isEmpty() && newTasks.isEmpty()) {
+        return true;
+    }
+    if (!db.transaction()) {
+        op.failed();
+        qDebug() << "开启事务失败：" << db.lastError().text();
+        return false;
+    }
+
+    QHash<int, int> taskIds; // 临时 id -> 插入后的真实 id
+    QHash<int, int> ruleIds;
+    QList<int> added, updated, removed;
+    bool rulesChanged = false;
+    bool ok = insertDailyTasks(newTasks);
+    if (ok) {
+        for (const DatedTask &item : newTasks) added.append(item.task.getId());
+        // 提交之前不通知外部，回滚时也就没有人看到过中间状态
+        const QSignalBlocker blocker(this);
+        for (const TaskChange &change : changes) {
+            switch (change.type) {
+            case TaskChange::AddTask: {
+                DailyTask task = change.task;
+                ok = addDailyTask(change.date, task);
+                if (ok) {
+                    taskIds.insert(change.id, task.getId());
+                    added.append(task.getId());
+                }
+                break;
+            }
+            case TaskChange::UpdateTask: {
+                const int id = taskIds.value(change.id, change.id);
+                ok = updateTaskById(id, change.task);
+                if (ok) updated.append(id);
+                break;
+            }
+            case TaskChange::DeleteTask: {
+                const int id = taskIds.value(change.id, change.id);
+                ok = deleteTaskById(id);
+                if (ok) removed.append(id);
+                break;
+            }
+            case TaskChange::AddRule: {
+                DailyTask task = change.task;
+                ok = addTaskRule(task, change.rule);
+                if (ok) ruleIds.insert(change.id, task.getRuleId());
+                rulesChanged = true;
+                break;
+            }
+            case TaskChange::UpdateRule:
+                ok = updateTaskRule(ruleIds.value(change.id, change.id), change.task, change.rule);
+                rulesChanged = true;
+                break;
+            case TaskChange::DeleteRule:
+                ok = deleteTaskRule(ruleIds.value(change.id, change.id));
+                rulesChanged = true;
+                break;
+            case TaskChange::AddRuleException:
+                ok = addTaskRuleException(ruleIds.value(change.id, change.id), change.date);
+                rulesChanged = true;
+                break;
+            }
+            if (!ok) break;
+        }
+    }
+
+    if (!ok || !db.commit()) {
+        op.failed();
+        qDebug() << "批量保存日程失败，已回滚：" << db.lastError().text();
+        db.rollback();
+        m_rulesLoaded = false;
+        m_occurrenceCache.clear();
+        return false;
+    }
+
+    for (int id : added) emit taskAdded(id);
+    for (int id : updated) emit taskUpdated(id);
+    for (int id : removed) emit taskRemoved(id);
+    if (rulesChanged) emit taskRulesChanged();
+    return true;
+}
+
+void DatabaseManager::ensureTaskRulesLoaded()
+{
+    if (m_rulesLoaded || !db.isOpen()) {
+        return;
+    }
+    static const DbOperationMetrics metrics("load_rules");
+    DbOperation op(metrics);
+    m_rules.clear();
+
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+    if (!query.exec("SELECT id, dtstart, title, start_time, end_time, note, rrule, exdates FROM task_rules")) {
+        op.failed();
+        qDebug() << "读取重复日程失败：" << query.lastError().text();
+        return;
+    }
+    while (query.next()) {
+        RecurringTask recurring;
+        recurring.id = query.value(0).toInt();
+        recurring.task = DailyTask(query.value(2).toString(),
+                                   QTime::fromString(query.value(3).toString(), "HH:mm"),
+                                   QTime::fromString(query.value(4).toString(), "HH:mm"),
+                                   query.value(5).toString());
+        recurring.task.setRuleId(recurring.id);
+        recurring.rule = RecurrenceRule::fromRRule(query.value(6).toString(),
+                                                   QDate::fromString(query.value(1).toString(), Qt::ISODate));
+        recurring.rule.setExceptions(RecurrenceRule::exceptionsFromString(query.value(7).toString()));
+        m_rules.append(recurring);
+    }
+    m_rulesLoaded = true;
+}
+
+void DatabaseManager::invalidateOccurrenceCache()
+{
+    m_rulesLoaded = false;
+    m_occurrenceCache.clear();
+    emit taskRulesChanged();
+}
+
+// 旧库的 tasks.start_time 允许 NULL，分页只能比较 COALESCE(start_time, '')，用不上索引的顺序。
+// SQLite 改不了列约束，只能建一张 start_time NOT NULL DEFAULT '' 的新表，按列名拷数据后换名；
+// 旧表上的索引和触发器随之删除，由 init 之后的 createFullTextIndex / createChangeLog 补建
+bool DatabaseManager::migrateTasksStartTime()
+{
+    QSqlQuery query(db);
+    if (!query.exec("PRAGMA table_info(tasks)")) {
+        qDebug() << "读取 tasks 表结构失败：" << query.lastError().text();
+        return false;
+    }
+    bool notNull = false;
+    bool hasUuid = false;
+    while (query.next()) {
+        const QString column = query.value(1).toString();
+        if (column == "start_time") notNull = query.value(3).toInt() != 0;
+        if (column == "uuid") hasUuid = true;
+    }
+    if (notNull) return true;
+
+    // 与 init 里的建表语句一致；uuid 列是 createChangeLog 后来 ALTER 加上的，旧表有就一起搬过来
+    QString createSql = R"(
+        CREATE TABLE tasks_migrating (
+            id INTEGER PRIMARY KEY AUTOINCREMENT,
+            date TEXT,
+            title TEXT,
+            start_time TEXT NOT NULL DEFAULT '',
+            end_time TEXT,
+            note TEXT%1
+        )
+    )";
+    createSql = createSql.arg(hasUuid ? ",\n            uuid TEXT" : "");
+    QStringList columns = {"id", "date", "title", "start_time", "end_time", "note"};
+    QStringList selected = {"id", "date", "title", "COALESCE(start_time, '')", "end_time", "note"};
+    if (hasUuid) {
+        columns << "uuid";
+        selected << "uuid";
+    }
+    const QStringList statements = {
+        createSql,
+        QString("INSERT INTO tasks_migrating (%1) SELECT %2 FROM tasks").arg(columns.join(", "), selected.join(", ")),
+        // AUTOINCREMENT 的计数随旧表删除，先记下来，删过的大 id 不会被重新分配
+        "CREATE TEMP TABLE tasks_sequence AS SELECT seq FROM sqlite_sequence WHERE name = 'tasks'",
+        "DROP TABLE tasks",
+        "ALTER TABLE tasks_migrating RENAME TO tasks",
+        "UPDATE sqlite_sequence SET seq = MAX(seq, (SELECT seq FROM temp.tasks_sequence)) "
+        "WHERE name = 'tasks' AND EXISTS (SELECT 1 FROM temp.tasks_sequence)",
+        // 表里一行都没有时新表还没有计数，直接补上旧的
+        "INSERT INTO sqlite_sequence (name, seq) SELECT 'tasks', seq FROM temp.tasks_sequence "
+        "WHERE NOT EXISTS (SELECT 1 FROM sqlite_sequence WHERE name = 'tasks')",
+        "DROP TABLE temp.tasks_sequence",
+    };
+    if (!db.transaction()) {
+        qDebug() << "开启事务失败：" << db.lastError().text();
+        return false;
+    }
+    for (const QString &sql : statements) {
+        if (!query.exec(sql)) {
+            qDebug() << "迁移 tasks.start_time 失败：" << query.lastError().text();
+            db.rollback();
+            return false;
+        }
+    }
+    if (!db.commit()) {
+        qDebug() << "提交 tasks 表迁移失败：" << db.lastError().text();
+        db.rollback();
+        return false;
+    }
+    return true;
+}
+
+// 旧版本数据库的 study_sessions 没有 tag 列，这里补上
+bool DatabaseManager::migrateStudySessionsTable()
+{
+    QSqlQuery query(db);
+    if (!query.exec("PRAGMA table_info(study_sessions)")) {
+        qDebug() << "读取 study_sessions 表结构失败：" << query.lastError().text();
+        return false;
+    }
+    while (query.next()) {
+        if (query.value(1).toString() == "tag") {
+            return true;
+        }
+    }
+    if (!query.exec("ALTER TABLE study_sessions ADD COLUMN tag TEXT")) {
+        qDebug() << "为 study_sessions 添加 tag 列失败：" << query.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+bool DatabaseManager::addStudySession(const QDateTime &start, const QDateTime &end, int durationSeconds,
+                                      const QString &tag)
+{
+    static const DbOperationMetrics metrics("add_study_session");
+    DbOperation op(metrics);
     QSqlQuery query;
-    query.prepare("INSERT INTO study_sessions (start_time, end_time, duration_seconds) VALUES (?, ?, ?)");
+    query.prepare("INSERT INTO study_sessions (start_time, end_time, duration_seconds, tag, uuid) VALUES (?, ?, ?, ?, ?)");
     query.addBindValue(start.toString(Qt::ISODate));
     query.addBindValue(end.toString(Qt::ISODate));
     query.addBindValue(durationSeconds);
+    query.addBindValue(tag);
+    query.addBindValue(newRowUuid());
 
     if (!query.exec()) {
+        op.failed();
         qDebug() << "保存自习记录失败：" << query.lastError().text();
         return false;
     }
     return true;
 }
 
+bool DatabaseManager::addStudySegments(const QList<StudySegment> &segments)
+{
+    static const DbOperationMetrics metrics("add_study_segments");
+    DbOperation op(metrics);
+    if (segments.isEmpty()) {
+        return true;
+    }
+    if (!db.transaction()) {
+        op.failed();
+        qDebug() << "开启事务失败：" << db.lastError().text();
+        return false;
+    }
+
+    QSqlQuery query(db);
+    query.prepare("INSERT INTO study_sessions (start_time, end_time, duration_seconds, tag, uuid) VALUES (?, ?, ?, ?, ?)");
+    for (const StudySegment &segment : segments) {
+        query.addBindValue(segment.start.toString(Qt::ISODate));
+        query.addBindValue(segment.end.toString(Qt::ISODate));
+        query.addBindValue(segment.durationSeconds());
+        query.addBindValue(segment.tag);
+        query.addBindValue(newRowUuid());
+        if (!query.exec()) {
+            op.failed();
+            qDebug() << "批量保存自习记录失败：" << query.lastError().text();
+            db.rollback();
+            return false;
+        }
+    }
+
+    if (!db.commit()) {
+        op.failed();
+        qDebug() << "提交自习记录失败：" << db.lastError().text();
+        db.rollback();
+        return false;
+    }
+    return true;
+}
+
 // 新增：获取每日自习时长
 QMap<QDate, int> DatabaseManager::getDailyStudyDurations()
 {
+    static const DbOperationMetrics metrics("daily_study_durations");
+    DbOperation op(metrics);
     QMap<QDate, int> dailyDurations;
     if (!db.isOpen()) {
+        op.failed();
         qWarning() << "Database is not open for getDailyStudyDurations!";
         return dailyDurations;
     }
@@ -193,7 +1154,380 @@ QMap<QDate, int> DatabaseManager::getDailyStudyDurations()
             dailyDurations[date] += duration; // 累加每天的总时长
         }
     } else {
+        op.failed();
         qWarning() << "Error getting daily study durations:" << query.lastError().text();
     }
     return dailyDurations;
 }
+
+QMap<QString, int> DatabaseManager::getStudyDurationsByTag()
+{
+    static const DbOperationMetrics metrics("study_durations_by_tag");
+    DbOperation op(metrics);
+    QMap<QString, int> tagDurations;
+    if (!db.isOpen()) {
+        op.failed();
+        qWarning() << "Database is not open for getStudyDurationsByTag!";
+        return tagDurations;
+    }
+
+    QSqlQuery query(db);
+    if (query.exec("SELECT COALESCE(tag, ''), SUM(duration_seconds) FROM study_sessions GROUP BY COALESCE(tag, '')")) {
+        while (query.next()) {
+            tagDurations.insert(query.value(0).toString(), query.value(1).toInt());
+        }
+    } else {
+        op.failed();
+        qWarning() << "Error getting study durations by tag:" << query.lastError().text();
+    }
+    return tagDurations;
+}
+
+// 增量同步的变更日志。三张表各加一列 uuid 作为跨机器的行标识（不支持 JSON 函数时也加），
+// 增删改由触发器记进 change_log，C++ 里的写入路径不需要各自记录。
+// 合并对端变更时，sync_state 里的 apply_time/apply_origin 让触发器沿用对端的修改时间和来源设备。
+bool DatabaseManager::createChangeLog()
+{
+    QSqlQuery query(db);
+    const QStringList tables = {
+        "CREATE TABLE IF NOT EXISTS sync_state (key TEXT PRIMARY KEY, value TEXT)",
+        R"(CREATE TABLE IF NOT EXISTS change_log (
+               seq INTEGER PRIMARY KEY AUTOINCREMENT,
+               table_name TEXT NOT NULL,
+               row_uuid TEXT NOT NULL,
+               op TEXT NOT NULL,
+               payload TEXT,
+               changed_at INTEGER NOT NULL,
+               origin TEXT NOT NULL
+           ))",
+        "CREATE INDEX IF NOT EXISTS idx_change_log_row ON change_log(table_name, row_uuid, seq)",
+    };
+    for (const QString &sql : tables) {
+        if (!query.exec(sql)) {
+            qDebug() << "创建变更日志表失败：" << query.lastError().text();
+            return false;
+        }
+    }
+
+    // 设备 id 存在本机设置里而不是数据库里，手工拷过去的 tasks.db 在另一台机器上也会换成那台的 id。
+    // PLANNER_SYNC_DEVICE_ID 优先且不写回设置，测试可以在一个进程里扮演多台设备
+    QSettings settings("MyCourseApp", "Sync");
+    m_deviceId = qEnvironmentVariable("PLANNER_SYNC_DEVICE_ID", settings.value("deviceId").toString());
+    if (m_deviceId.isEmpty()) {
+        m_deviceId = newRowUuid();
+        settings.setValue("deviceId", m_deviceId);
+    }
+    query.prepare("INSERT OR REPLACE INTO sync_state (key, value) VALUES ('device_id', ?)");
+    query.addBindValue(m_deviceId);
+    if (!query.exec()) {
+        qDebug() << "写入设备 id 失败：" << query.lastError().text();
+        return false;
+    }
+    // 上次合并中途退出时可能残留
+    query.exec("DELETE FROM sync_state WHERE key IN ('apply_time', 'apply_origin')");
+
+    // 一组语句放在一个事务里执行，任何一步失败都整体回滚
+    const auto execAll = [this, &query](const QStringList &statements, const char *what) {
+        if (!db.transaction()) {
+            qDebug() << what << "开启事务失败：" << db.lastError().text();
+            return false;
+        }
+        for (const QString &sql : statements) {
+            if (!query.exec(sql)) {
+                qDebug() << what << "失败：" << query.lastError().text();
+                db.rollback();
+                return false;
+            }
+        }
+        if (!db.commit()) {
+            qDebug() << what << "提交失败：" << db.lastError().text();
+            db.rollback();
+            return false;
+        }
+        return true;
+    };
+
+    // uuid 列不依赖 JSON 函数，而且写入路径总是带着 uuid 插入，所以不管能不能记变更日志都要先补上
+    QStringList uuidStatements;
+    for (const SyncedTable &table : syncedTables()) {
+        bool hasUuid = false;
+        if (query.exec(QString("PRAGMA table_info(%1)").arg(table.name))) {
+            while (query.next()) {
+                if (query.value(1).toString() == "uuid") hasUuid = true;
+            }
+        }
+        if (!hasUuid) {
+            uuidStatements << QString("ALTER TABLE %1 ADD COLUMN uuid TEXT").arg(table.name)
+                           << QString("UPDATE %1 SET uuid = lower(hex(randomblob(16)))").arg(table.name);
+        }
+        uuidStatements
+            << QString("CREATE UNIQUE INDEX IF NOT EXISTS idx_%1_uuid ON %1(uuid)").arg(table.name)
+            // 没带 uuid 的插入（旧代码路径、手工 SQL）在这里补上，补的这次 UPDATE 会由 _log_au 记录
+            << QString(R"(CREATE TRIGGER IF NOT EXISTS %1_uuid_ai AFTER INSERT ON %1 WHEN new.uuid IS NULL BEGIN
+                              UPDATE %1 SET uuid = lower(hex(randomblob(16))) WHERE id = new.id;
+                          END)").arg(table.name);
+    }
+    if (!execAll(uuidStatements, "补建 uuid 列")) return false;
+
+    if (!query.exec("SELECT json_object('a', 1)")) {
+        qDebug() << "SQLite 不支持 JSON 函数，不记录变更日志：" << query.lastError().text();
+        return false;
+    }
+
+    const QString changedAt = QString("COALESCE((SELECT CAST(value AS INTEGER) FROM sync_state WHERE key = 'apply_time'), %1)")
+                                  .arg(kNowMillisSql);
+    const QString origin = "COALESCE((SELECT value FROM sync_state WHERE key = 'apply_origin'), "
+                           "(SELECT value FROM sync_state WHERE key = 'device_id'))";
+
+    QStringList logStatements;
+    for (const SyncedTable &table : syncedTables()) {
+        QStringList pairs;
+        for (const QString &column : table.columns) {
+            pairs << "'" + column + "', %1." + column;
+        }
+        // %1 换成 new 或 old 后就是该行的 JSON
+        const QString payload = "json_object(" + pairs.join(", ") + ")";
+
+        // 这张表第一次开始记日志（新库、旧库升级，或者之前的 SQLite 不支持 JSON）：
+        // 把现有的行作为本机的初始变更记一遍，第一次同步时整表发给对端
+        query.prepare("SELECT 1 FROM sqlite_master WHERE type = 'trigger' AND name = ?");
+        query.addBindValue(table.name + "_log_ai");
+        if (query.exec() && !query.next()) {
+            logStatements << QString("INSERT INTO change_log (table_name, row_uuid, op, payload, changed_at, origin) "
+                                     "SELECT '%1', uuid, 'upsert', %2, %3, %4 FROM %1")
+                                 .arg(table.name, payload.arg(table.name), kNowMillisSql, origin);
+        }
+        logStatements
+            << QString(R"(CREATE TRIGGER IF NOT EXISTS %1_log_ai AFTER INSERT ON %1 WHEN new.uuid IS NOT NULL BEGIN
+                              INSERT INTO change_log (table_name, row_uuid, op, payload, changed_at, origin)
+                              VALUES ('%1', new.uuid, 'upsert', %2, %3, %4);
+                          END)").arg(table.name, payload.arg("new"), changedAt, origin)
+            << QString(R"(CREATE TRIGGER IF NOT EXISTS %1_log_au AFTER UPDATE ON %1 WHEN new.uuid IS NOT NULL BEGIN
+                              INSERT INTO change_log (table_name, row_uuid, op, payload, changed_at, origin)
+                              VALUES ('%1', new.uuid, 'upsert', %2, %3, %4);
+                          END)").arg(table.name, payload.arg("new"), changedAt, origin)
+            << QString(R"(CREATE TRIGGER IF NOT EXISTS %1_log_ad AFTER DELETE ON %1 WHEN old.uuid IS NOT NULL BEGIN
+                              INSERT INTO change_log (table_name, row_uuid, op, payload, changed_at, origin)
+                              VALUES ('%1', old.uuid, 'delete', NULL, %2, %3);
+                          END)").arg(table.name, changedAt, origin);
+    }
+    return execAll(logStatements, "创建变更日志触发器");
+}
+
+qint64 DatabaseManager::lastChangeSeq()
+{
+    QSqlQuery query(db);
+    if (!query.exec("SELECT COALESCE(MAX(seq), 0) FROM change_log") || !query.next()) {
+        return 0;
+    }
+    return query.value(0).toLongLong();
+}
+
+QList<ChangeLogEntry> DatabaseManager::getChangesSince(qint64 seq, int limit)
+{
+    static const DbOperationMetrics metrics("changes_since");
+    DbOperation op(metrics);
+    QList<ChangeLogEntry> changes;
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+    query.prepare("SELECT seq, table_name, row_uuid, op, payload, changed_at, origin FROM change_log "
+                  "WHERE seq > ? ORDER BY seq LIMIT ?");
+    query.addBindValue(seq);
+    query.addBindValue(limit);
+    if (!query.exec()) {
+        op.failed();
+        qDebug() << "读取变更日志失败：" << query.lastError().text();
+        return changes;
+    }
+    while (query.next()) {
+        ChangeLogEntry entry;
+        entry.seq = query.value(0).toLongLong();
+        entry.table = query.value(1).toString();
+        entry.rowUuid = query.value(2).toString();
+        entry.op = query.value(3).toString();
+        entry.payload = QJsonDocument::fromJson(query.value(4).toByteArray()).object();
+        entry.changedAt = query.value(5).toLongLong();
+        entry.origin = query.value(6).toString();
+        changes.append(entry);
+    }
+    return changes;
+}
+
+qint64 DatabaseManager::syncValue(const QString &key, qint64 fallback)
+{
+    QSqlQuery query(db);
+    query.prepare("SELECT value FROM sync_state WHERE key = ?");
+    query.addBindValue(key);
+    if (!query.exec() || !query.next()) {
+        return fallback;
+    }
+    return query.value(0).toLongLong();
+}
+
+bool DatabaseManager::setSyncValue(const QString &key, qint64 value)
+{
+    QSqlQuery query(db);
+    query.prepare("INSERT OR REPLACE INTO sync_state (key, value) VALUES (?, ?)");
+    query.addBindValue(key);
+    query.addBindValue(QString::number(value));
+    if (!query.exec()) {
+        qDebug() << "写入同步状态失败：" << query.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+bool DatabaseManager::applyRemoteChanges(const QString &peer, const QList<ChangeLogEntry> &changes,
+                                         SyncApplyResult *result)
+{
+    static const DbOperationMetrics metrics("apply_remote_changes");
+    DbOperation op(metrics);
+    SyncApplyResult counts;
+    if (!m_changeLogAvailable) {
+        op.failed();
+        qDebug() << "变更日志不可用，无法合并对端变更";
+        return false;
+    }
+    const QString seenKey = QString("peer:%1:seen").arg(peer);
+    const qint64 seen = syncValue(seenKey);
+    if (!db.transaction()) {
+        op.failed();
+        qDebug() << "开启事务失败：" << db.lastError().text();
+        return false;
+    }
+
+    QSqlQuery latest(db);
+    latest.prepare("SELECT changed_at, origin FROM change_log WHERE table_name = ? AND row_uuid = ? "
+                   "ORDER BY seq DESC LIMIT 1");
+    QSqlQuery context(db);
+    context.prepare("INSERT OR REPLACE INTO sync_state (key, value) VALUES ('apply_time', ?), ('apply_origin', ?)");
+    QSqlQuery query(db);
+
+    QList<int> added, updated, removed;
+    bool rulesChanged = false;
+    qint64 maxSeq = seen;
+    bool ok = true;
+    for (const ChangeLogEntry &change : changes) {
+        maxSeq = qMax(maxSeq, change.seq);
+        const SyncedTable *table = findSyncedTable(change.table);
+        if (change.seq <= seen || change.origin == m_deviceId) {
+            ++counts.duplicates;
+            continue;
+        }
+        if (!table || change.rowUuid.isEmpty() || (change.op != "upsert" && change.op != "delete")) {
+            qDebug() << "跳过无法识别的变更：" << change.table << change.op << change.seq;
+            continue;
+        }
+
+        // 后写者胜：本机对这一行最后一次修改比对端这条新（或同时刻且设备 id 更大）时丢弃对端的
+        latest.addBindValue(change.table);
+        latest.addBindValue(change.rowUuid);
+        if (!latest.exec()) {
+            ok = false;
+            break;
+        }
+        const bool hasLocal = latest.next();
+        const qint64 localAt = hasLocal ? latest.value(0).toLongLong() : 0;
+        const QString localOrigin = hasLocal ? latest.value(1).toString() : QString();
+        latest.finish();
+        if (hasLocal && localAt == change.changedAt && localOrigin == change.origin) {
+            ++counts.duplicates;
+            continue;
+        }
+        if (hasLocal && (localAt > change.changedAt || (localAt == change.changedAt && localOrigin > change.origin))) {
+            ++counts.conflicts;
+            continue;
+        }
+
+        context.addBindValue(change.changedAt);
+        context.addBindValue(change.origin);
+        if (!context.exec()) {
+            ok = false;
+            break;
+        }
+
+        query.prepare(QString("SELECT id FROM %1 WHERE uuid = ?").arg(table->name));
+        query.addBindValue(change.rowUuid);
+        if (!query.exec()) {
+            ok = false;
+            break;
+        }
+        const int id = query.next() ? query.value(0).toInt() : -1;
+
+        if (change.op == "delete") {
+            if (id >= 0) {
+                query.prepare(QString("DELETE FROM %1 WHERE id = ?").arg(table->name));
+                query.addBindValue(id);
+            } else {
+                // 本机没有这一行也要留下删除标记，之后到达的更早的修改才会被判为过期
+                query.prepare("INSERT INTO change_log (table_name, row_uuid, op, payload, changed_at, origin) "
+                              "VALUES (?, ?, 'delete', NULL, ?, ?)");
+                query.addBindValue(table->name);
+                query.addBindValue(change.rowUuid);
+                query.addBindValue(change.changedAt);
+                query.addBindValue(change.origin);
+            }
+        } else if (id >= 0) {
+            QStringList assignments;
+            for (const QString &column : table->columns) assignments << column + " = ?";
+            query.prepare(QString("UPDATE %1 SET %2 WHERE id = ?").arg(table->name, assignments.join(", ")));
+            for (const QString &column : table->columns) query.addBindValue(payloadValue(*table, change.payload, column));
+            query.addBindValue(id);
+        } else {
+            query.prepare(QString("INSERT INTO %1 (%2, uuid) VALUES (%3?)")
+                              .arg(table->name, table->columns.join(", "), QString("?, ").repeated(table->columns.size())));
+            for (const QString &column : table->columns) query.addBindValue(payloadValue(*table, change.payload, column));
+            query.addBindValue(change.rowUuid);
+        }
+        if (!query.exec()) {
+            ok = false;
+            break;
+        }
+
+        ++counts.applied;
+        if (table->name == "task_rules") {
+            rulesChanged = true;
+        } else if (table->name == "tasks") {
+            if (change.op == "delete") {
+                if (id >= 0) removed.append(id);
+            } else if (id >= 0) {
+                updated.append(id);
+            } else {
+                added.append(query.lastInsertId().toInt());
+            }
+        }
+    }
+
+    if (ok) {
+        ok = query.exec("DELETE FROM sync_state WHERE key IN ('apply_time', 'apply_origin')")
+             && setSyncValue(seenKey, maxSeq);
+    }
+    if (!ok || !db.commit()) {
+        op.failed();
+        qDebug() << "合并对端变更失败，已回滚：" << query.lastError().text() << db.lastError().text();
+        db.rollback();
+        return false;
+    }
+
+    if (result) *result = counts;
+    for (int id : added) emit taskAdded(id);
+    for (int id : updated) emit taskUpdated(id);
+    for (int id : removed) emit taskRemoved(id);
+    if (rulesChanged) invalidateOccurrenceCache();
+    return true;
+}
+
+bool DatabaseManager::compactChangeLog()
+{
+    static const DbOperationMetrics metrics("compact_change_log");
+    DbOperation op(metrics);
+    QSqlQuery query(db);
+    // 每行只需要最新的一条：对端拿到它就能得到这一行的最终状态
+    if (!query.exec("DELETE FROM change_log WHERE seq NOT IN "
+                    "(SELECT MAX(seq) FROM change_log GROUP BY table_name, row_uuid)")) {
+        op.failed();
+        qDebug() << "压缩变更日志失败：" << query.lastError().text();
+        return false;
+    }
+    return true;
+}
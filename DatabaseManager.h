@@ -1,6 +1,7 @@
 #ifndef DATABASEMANAGER_H
 #define DATABASEMANAGER_H
 
+#include <QObject>
 #include <QSqlDatabase>
 #include <QSqlQuery>
 #include <QSqlError>
@@ -8,30 +9,154 @@
 #include <QDateTime> // 新增，因为要处理 QDateTime
 #include <QMap>      // 新增，用于返回 QMap<QDate, int>
 #include <QDate>     // 新增，因为要处理 QDate
+#include <QHash>
+#include <QJsonObject>
+#include <functional>
 #include "DailyTask.h" // 确保你的 DailyTask.h 存在
+#include "StudySegment.h"
+#include "RecurrenceRule.h"
 
-class DatabaseManager
+// 一条重复日程：模板任务 + 重复规则，只占 task_rules 表的一行
+struct RecurringTask {
+    int id = -1;
+    DailyTask task;
+    RecurrenceRule rule;
+};
+
+// 编辑对话框暂存的一项修改，由 applyTaskChanges 在一个事务里统一写入。
+// 暂存期间新建的任务/规则还没有真实 id，用小于 -1 的临时 id 表示，后续修改可以引用它。
+struct TaskChange {
+    enum Type { AddTask, UpdateTask, DeleteTask, AddRule, UpdateRule, DeleteRule, AddRuleException };
+
+    Type type = AddTask;
+    int id = -1;        // UpdateTask/DeleteTask 为任务 id，规则相关的为规则 id
+    QDate date;         // AddTask 的日期，AddRuleException 的例外日期
+    DailyTask task;     // AddTask 的临时 id 在 task.getId()，AddRule 的临时 id 在 task.getRuleId()
+    RecurrenceRule rule;
+
+    static TaskChange addTask(const QDate &date, const DailyTask &task) { return {AddTask, task.getId(), date, task, {}}; }
+    static TaskChange updateTask(int id, const DailyTask &task) { return {UpdateTask, id, {}, task, {}}; }
+    static TaskChange deleteTask(int id) { return {DeleteTask, id, {}, {}, {}}; }
+    static TaskChange addRule(const DailyTask &task, const RecurrenceRule &rule) { return {AddRule, task.getRuleId(), {}, task, rule}; }
+    static TaskChange updateRule(int ruleId, const DailyTask &task, const RecurrenceRule &rule) { return {UpdateRule, ruleId, {}, task, rule}; }
+    static TaskChange deleteRule(int ruleId) { return {DeleteRule, ruleId, {}, {}, {}}; }
+    static TaskChange ruleException(int ruleId, const QDate &date) { return {AddRuleException, ruleId, date, {}, {}}; }
+};
+
+// change_log 的一行：某台设备对一行数据的一次修改。行用 uuid 标识，跨机器不变
+struct ChangeLogEntry {
+    qint64 seq = 0;        // 在导出它的那台机器上的序号
+    QString table;         // tasks / task_rules / study_sessions
+    QString rowUuid;
+    QString op;            // upsert / delete
+    QJsonObject payload;   // upsert 时整行的列值（不含 id 和 uuid）
+    qint64 changedAt = 0;  // 修改时间（毫秒），冲突时后写者胜
+    QString origin;        // 最初做出修改的设备
+};
+
+struct SyncApplyResult {
+    int applied = 0;
+    int conflicts = 0;   // 本机对同一行有更新的修改，对端这条被丢弃
+    int duplicates = 0;  // 已经合并过的（含本机自己发出又转回来的）
+};
+
+class DatabaseManager : public QObject
 {
+    Q_OBJECT
+
 public:
     bool deleteAllStudySessions(); // 【新增】删除所有自习记录
     QList<QDate> getAllDatesWithTasks() const;
+    // 只取 [from, to] 区间内有任务的日期，走 (date, start_time) 索引
+    QList<QDate> getDatesWithTasksBetween(const QDate &from, const QDate &to) const;
     static DatabaseManager& instance();
-    bool init();
+    bool init(const QString &path = QStringLiteral("tasks.db"));
     //增
     bool addDailyTask(const QDate &date, DailyTask &task);
+    // 批量导入用：整批在一个事务里写入，成功后把新 id 写回 tasks，提交后再逐条发 taskAdded
+    bool addDailyTasks(QList<DatedTask> &tasks);
     QList<DailyTask> getTasksForDate(const QDate &date);
+    // 查询 [from, to] 区间内的任务，按日期和开始时间排序
+    QList<DatedTask> getTasksBetween(const QDate &from, const QDate &to);
+    bool getTaskById(int id, DatedTask &out);
+    // 按 (日期, 开始时间, id) 做键集分页，返回排在 after 之后的最多 limit 条任务
+    QList<DatedTask> getTasksPageAfter(const DatedTask &after, int limit);
+    // 按日期和开始时间顺序逐条回调，不把结果集读进内存，供大批量导出使用。
+    // from/to 为无效日期时该端不设限；visit 返回 false 时提前结束
+    bool forEachTask(const QDate &from, const QDate &to, const std::function<bool(const DatedTask &)> &visit);
     //删
     bool deleteTaskById(int id);
     //改
     bool updateTaskById(int id, const DailyTask &task);
 
-    bool addStudySession(const QDateTime &start, const QDateTime &end, int durationSeconds);
+    // 全文搜索标题和备注，结果按相关度排序
+    QList<DatedTask> searchTasks(const QString &text, int limit = 50);
+
+    // 重复日程：规则只存一行，实例按需展开并按月缓存
+    bool addTaskRule(DailyTask &task, const RecurrenceRule &rule);
+    bool updateTaskRule(int ruleId, const DailyTask &task, const RecurrenceRule &rule);
+    bool deleteTaskRule(int ruleId);
+    bool addTaskRuleException(int ruleId, const QDate &date); // 只删除某一次
+    bool getTaskRule(int ruleId, RecurringTask &out);
+    QList<RecurringTask> getTaskRules();
+    QList<DatedTask> getOccurrencesBetween(const QDate &from, const QDate &to);
+
+    // 在一个事务里按顺序执行一组暂存的修改，全部成功才提交；
+    // 提交之后才发出 taskAdded 等信号，失败时整体回滚，不发任何信号
+    bool applyTaskChanges(const QList<TaskChange> &changes);
+    // 导入用：先批量插入 newTasks（新 id 写回），再执行 changes，两者同在一个事务里
+    bool applyTaskChanges(const QList<TaskChange> &changes, QList<DatedTask> &newTasks);
+
+    bool addStudySession(const QDateTime &start, const QDateTime &end, int durationSeconds,
+                         const QString &tag = QString());
+    // 在一个事务内批量写入多段自习记录
+    bool addStudySegments(const QList<StudySegment> &segments);
     // 新增：获取每日自习时长
     QMap<QDate, int> getDailyStudyDurations();
+    // 按课程/标签汇总自习时长（一次 GROUP BY 查询）
+    QMap<QString, int> getStudyDurationsByTag();
+
+    // 增量同步：tasks、task_rules、study_sessions 的每次写入都由触发器记进 change_log。
+    // SQLite 不支持 JSON 函数时不记录，isChangeLogAvailable() 返回 false
+    bool isChangeLogAvailable() const { return m_changeLogAvailable; }
+    QString deviceId() const { return m_deviceId; } // QSettings "Sync"/"deviceId"（或 PLANNER_SYNC_DEVICE_ID），每台机器一个
+    qint64 lastChangeSeq();
+    // 序号大于 seq 的变更，按序号升序，最多 limit 条
+    QList<ChangeLogEntry> getChangesSince(qint64 seq, int limit);
+    // 在一个事务里合并对端 peer 的一批变更：同一行以修改时间后写者胜（相同时设备 id 大者胜），
+    // 并把 peer 的已见序号推进到这批的最大序号
+    bool applyRemoteChanges(const QString &peer, const QList<ChangeLogEntry> &changes,
+                            SyncApplyResult *result = nullptr);
+    // sync_state 里的整数值，例如 "peer:<设备>:seen"
+    qint64 syncValue(const QString &key, qint64 fallback = 0);
+    bool setSyncValue(const QString &key, qint64 value);
+    // 删掉被同一行后续修改覆盖的旧记录，只留每行最新的一条（含删除标记）
+    bool compactChangeLog();
+
+signals:
+    // 任务增删改后发出，提醒调度器等据此做增量更新
+    void taskAdded(int id);
+    void taskUpdated(int id);
+    void taskRemoved(int id);
+    void taskRulesChanged();
 
 private:
     DatabaseManager(); // 单例
+    bool insertDailyTasks(QList<DatedTask> &tasks); // 不开事务、不发信号，由调用方负责
+    bool migrateStudySessionsTable();
+    bool migrateTasksStartTime();
+    bool createFullTextIndex();
+    bool createChangeLog();
+    void ensureTaskRulesLoaded();
+    void invalidateOccurrenceCache();
     QSqlDatabase db;
+
+    bool m_ftsAvailable = false; // SQLite 未编译 FTS5/trigram 时退回 LIKE 搜索
+    bool m_changeLogAvailable = false;
+    QString m_deviceId;
+    bool m_rulesLoaded = false;
+    QList<RecurringTask> m_rules;
+    QHash<int, QList<DatedTask>> m_occurrenceCache; // 键为 year*12+month-1，值为该月全部实例
 };
 
 #endif // DATABASEMANAGER_H
@@ -0,0 +1,282 @@
+#include "DeltaSync.h"
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QIODevice>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QLocalSocket>
+#include <QSaveFile>
+#include <QDebug>
+
+namespace {
+
+constexpr int PAGE_SIZE = 1000;          // 每次从 change_log 读的条数，也是推送时一次 sync.apply 的条数
+constexpr int RPC_TIMEOUT_MS = 30000;
+const char *const FORMAT_NAME = "planner-delta";
+
+void setError(QString *error, const QString &message)
+{
+    if (error) *error = message;
+}
+
+void addResult(DeltaSync::Stats *stats, const SyncApplyResult &result)
+{
+    if (!stats) return;
+    stats->applied += result.applied;
+    stats->conflicts += result.conflicts;
+    stats->duplicates += result.duplicates;
+}
+
+// 共享目录里本机写出的文件名：补零的结束序号，按文件名排序就是时间顺序
+QString changeFileName(qint64 lastSeq)
+{
+    return QString("%1.jsonl").arg(lastSeq, 12, 10, QChar('0'));
+}
+
+// 同步用的连接：一问一答，阻塞等待响应（只在命令行工具里用）
+class RpcClient
+{
+public:
+    bool connectTo(const QString &name, QString *error)
+    {
+        m_socket.connectToServer(name);
+        if (!m_socket.waitForConnected(RPC_TIMEOUT_MS)) {
+            setError(error, "无法连接同步服务 " + name + "：" + m_socket.errorString());
+            return false;
+        }
+        return true;
+    }
+
+    bool call(const QString &method, const QJsonObject &params, QJsonObject &result, QString *error)
+    {
+        const QJsonObject request{{"jsonrpc", "2.0"}, {"id", ++m_nextId}, {"method", method}, {"params", params}};
+        m_socket.write(QJsonDocument(request).toJson(QJsonDocument::Compact) + '\n');
+        while (!m_socket.canReadLine()) {
+            if (!m_socket.waitForReadyRead(RPC_TIMEOUT_MS)) {
+                setError(error, method + " 无响应：" + m_socket.errorString());
+                return false;
+            }
+        }
+        const QJsonObject response = QJsonDocument::fromJson(m_socket.readLine()).object();
+        if (response.contains("error")) {
+            setError(error, method + " 失败：" + response.value("error").toObject().value("message").toString());
+            return false;
+        }
+        result = response.value("result").toObject();
+        return true;
+    }
+
+private:
+    QLocalSocket m_socket;
+    qint64 m_nextId = 0;
+};
+
+} // namespace
+
+QJsonObject DeltaSync::toJson(const ChangeLogEntry &entry)
+{
+    QJsonObject obj{{"seq", entry.seq}, {"table", entry.table}, {"uuid", entry.rowUuid}, {"op", entry.op},
+                    {"at", entry.changedAt}, {"origin", entry.origin}};
+    if (entry.op != "delete") obj.insert("payload", entry.payload);
+    return obj;
+}
+
+ChangeLogEntry DeltaSync::fromJson(const QJsonObject &obj)
+{
+    ChangeLogEntry entry;
+    entry.seq = obj.value("seq").toInteger();
+    entry.table = obj.value("table").toString();
+    entry.rowUuid = obj.value("uuid").toString();
+    entry.op = obj.value("op").toString();
+    entry.payload = obj.value("payload").toObject();
+    entry.changedAt = obj.value("at").toInteger();
+    entry.origin = obj.value("origin").toString();
+    return entry;
+}
+
+bool DeltaSync::exportChanges(QIODevice *out, qint64 since, qint64 *lastSeq, Stats *stats, QString *error)
+{
+    DatabaseManager &db = DatabaseManager::instance();
+    if (!db.isChangeLogAvailable()) {
+        setError(error, "变更日志不可用（SQLite 缺少 JSON 函数）");
+        return false;
+    }
+    // 先定下终点，导出期间新产生的变更留给下一次
+    const qint64 to = qMax(since, db.lastChangeSeq());
+    const QJsonObject header{{"format", FORMAT_NAME}, {"version", 1}, {"device", db.deviceId()},
+                             {"from", since}, {"to", to}};
+    out->write(QJsonDocument(header).toJson(QJsonDocument::Compact) + '\n');
+
+    qint64 seq = since;
+    while (seq < to) {
+        const QList<ChangeLogEntry> page = db.getChangesSince(seq, PAGE_SIZE);
+        if (page.isEmpty()) break;
+        for (const ChangeLogEntry &entry : page) {
+            if (entry.seq > to) break;
+            out->write(QJsonDocument(toJson(entry)).toJson(QJsonDocument::Compact) + '\n');
+            if (stats) ++stats->sent;
+        }
+        seq = page.constLast().seq;
+    }
+    if (lastSeq) *lastSeq = to;
+    return true;
+}
+
+bool DeltaSync::importChanges(QIODevice *in, int batchSize, Stats *stats, QString *error)
+{
+    DatabaseManager &db = DatabaseManager::instance();
+    const QJsonObject header = QJsonDocument::fromJson(in->readLine()).object();
+    if (header.value("format").toString() != FORMAT_NAME || header.value("version").toInt() != 1) {
+        setError(error, "不是 planner-delta 变更文件");
+        return false;
+    }
+    const QString peer = header.value("device").toString();
+    if (peer.isEmpty() || peer == db.deviceId()) {
+        setError(error, "这是本机导出的变更");
+        return false;
+    }
+    // 文件起点之前的变更还没见过，说明中间缺了一段；仍然合并（后写者胜不依赖顺序），只提示
+    const qint64 seen = db.syncValue(QString("peer:%1:seen").arg(peer));
+    if (header.value("from").toInteger() > seen) {
+        qDebug() << "设备" << peer << "的变更不连续：已见" << seen << "，文件从" << header.value("from").toInteger() << "开始";
+    }
+
+    QList<ChangeLogEntry> batch;
+    auto flush = [&] {
+        SyncApplyResult result;
+        if (!db.applyRemoteChanges(peer, batch, &result)) {
+            setError(error, "合并变更失败");
+            return false;
+        }
+        addResult(stats, result);
+        batch.clear();
+        return true;
+    };
+    for (;;) {
+        const QByteArray raw = in->readLine();
+        if (raw.isEmpty()) break; // 标准输入的 atEnd 不可靠，以读不到数据为准
+        const QByteArray line = raw.trimmed();
+        if (line.isEmpty()) continue;
+        batch.append(fromJson(QJsonDocument::fromJson(line).object()));
+        if (stats) ++stats->received;
+        if (batch.size() >= batchSize && !flush()) return false;
+    }
+    return batch.isEmpty() || flush();
+}
+
+bool DeltaSync::syncDirectory(const QString &dirPath, Stats *stats, QString *error)
+{
+    DatabaseManager &db = DatabaseManager::instance();
+    QDir dir(dirPath);
+    if (!dir.exists() && !QDir().mkpath(dirPath)) {
+        setError(error, "无法创建同步目录 " + dirPath);
+        return false;
+    }
+    const QString ownDir = db.deviceId();
+    if (!dir.mkpath(ownDir)) {
+        setError(error, "无法创建 " + dir.filePath(ownDir));
+        return false;
+    }
+
+    // 1. 本机在这个目录里上次写到哪，之后的变更写成一个新文件
+    const QString publishedKey = "published:" + dir.absolutePath();
+    const qint64 published = db.syncValue(publishedKey);
+    if (db.lastChangeSeq() > published) {
+        QSaveFile file;
+        qint64 last = published;
+        // 先写临时文件，写完再改名，对端不会读到半个文件
+        file.setFileName(dir.filePath(ownDir + "/" + changeFileName(db.lastChangeSeq())));
+        if (!file.open(QIODevice::WriteOnly) || !exportChanges(&file, published, &last, stats, error)) {
+            if (error && error->isEmpty()) *error = "无法写入 " + file.fileName() + "：" + file.errorString();
+            file.cancelWriting();
+            return false;
+        }
+        if (!file.commit()) {
+            setError(error, "无法写入 " + file.fileName() + "：" + file.errorString());
+            return false;
+        }
+        db.setSyncValue(publishedKey, last);
+    }
+
+    // 2. 其他设备目录里结束序号大于已见序号的文件，按顺序合并
+    const QStringList peers = dir.entryList(QDir::Dirs | QDir::NoDotAndDotDot);
+    for (const QString &peer : peers) {
+        if (peer == ownDir) continue;
+        const qint64 seen = db.syncValue(QString("peer:%1:seen").arg(peer));
+        QDir peerDir(dir.filePath(peer));
+        const QStringList files = peerDir.entryList({"*.jsonl"}, QDir::Files, QDir::Name);
+        for (const QString &name : files) {
+            bool ok = false;
+            const qint64 last = QFileInfo(name).completeBaseName().toLongLong(&ok);
+            if (!ok || last <= seen) continue;
+            QFile file(peerDir.filePath(name));
+            if (!file.open(QIODevice::ReadOnly)) {
+                setError(error, "无法读取 " + file.fileName() + "：" + file.errorString());
+                return false;
+            }
+            QString fileError;
+            if (!importChanges(&file, 5000, stats, &fileError)) {
+                setError(error, file.fileName() + "：" + fileError);
+                return false;
+            }
+        }
+    }
+
+    // 已写出的文件里保留着完整历史，本机的日志只需要每行最新的一条
+    db.compactChangeLog();
+    return true;
+}
+
+bool DeltaSync::syncWithServer(const QString &serverName, Stats *stats, QString *error)
+{
+    DatabaseManager &db = DatabaseManager::instance();
+    if (!db.isChangeLogAvailable()) {
+        setError(error, "变更日志不可用（SQLite 缺少 JSON 函数）");
+        return false;
+    }
+    RpcClient client;
+    if (!client.connectTo(serverName, error)) return false;
+
+    // 1. 推送：服务端告诉我们它见过本机的哪个序号
+    QJsonObject result;
+    if (!client.call("sync.seen", QJsonObject{{"device", db.deviceId()}}, result, error)) return false;
+    const QString serverDevice = result.value("device").toString();
+    if (serverDevice.isEmpty() || serverDevice == db.deviceId()) {
+        setError(error, "同步服务使用的是本机的数据库");
+        return false;
+    }
+    qint64 pushed = result.value("seen").toInteger();
+    const qint64 pushEnd = db.lastChangeSeq();
+    while (pushed < pushEnd) {
+        const QList<ChangeLogEntry> page = db.getChangesSince(pushed, PAGE_SIZE);
+        if (page.isEmpty()) break;
+        QJsonArray changes;
+        for (const ChangeLogEntry &entry : page) changes.append(toJson(entry));
+        if (!client.call("sync.apply", QJsonObject{{"device", db.deviceId()}, {"changes", changes}}, result, error)) {
+            return false;
+        }
+        pushed = page.constLast().seq;
+        if (stats) stats->sent += page.size();
+    }
+
+    // 2. 拉取：从本机记录的已见序号之后一页页取，每页一个事务
+    for (;;) {
+        const qint64 seen = db.syncValue(QString("peer:%1:seen").arg(serverDevice));
+        if (!client.call("sync.changes", QJsonObject{{"since", seen}, {"limit", PAGE_SIZE}}, result, error)) {
+            return false;
+        }
+        const QJsonArray changes = result.value("changes").toArray();
+        if (changes.isEmpty()) break;
+        QList<ChangeLogEntry> page;
+        for (const QJsonValue &value : changes) page.append(fromJson(value.toObject()));
+        SyncApplyResult applied;
+        if (!db.applyRemoteChanges(serverDevice, page, &applied)) {
+            setError(error, "合并变更失败");
+            return false;
+        }
+        addResult(stats, applied);
+        if (stats) stats->received += page.size();
+    }
+    return true;
+}
@@ -0,0 +1,42 @@
+#ifndef DELTASYNC_H
+#define DELTASYNC_H
+
+#include "DatabaseManager.h"
+#include <QJsonObject>
+#include <QString>
+
+class QIODevice;
+
+// 两台机器之间按变更日志做增量同步，只传对端还没见过的修改（见 DatabaseManager::createChangeLog）。
+// 变更流为 JSON Lines：首行是头 {"format":"planner-delta","version":1,"device","from","to"}，
+// 之后每行一条变更 {"seq","table","uuid","op","payload","at","origin"}。
+//
+// 两种传输方式：
+//   共享目录  每台机器把自己的变更写到 <dir>/<设备 id>/<序号>.jsonl，再读其他设备目录里没见过的文件，
+//             网盘同步目录、U 盘都可以
+//   本地服务  连接另一个进程里的 PlannerRpcServer（例如 planner-cli serve），推送本机变更并拉取对方的
+class DeltaSync
+{
+public:
+    struct Stats {
+        qint64 sent = 0;       // 写出/推送的变更条数
+        qint64 received = 0;   // 读到/拉取的变更条数
+        qint64 applied = 0;
+        qint64 conflicts = 0;  // 本机版本更新而丢弃的
+        qint64 duplicates = 0;
+    };
+
+    static QJsonObject toJson(const ChangeLogEntry &entry);
+    static ChangeLogEntry fromJson(const QJsonObject &obj);
+
+    // 写出本机序号大于 since 的全部变更，lastSeq 返回头里的 to（没有变更时等于 since）
+    static bool exportChanges(QIODevice *out, qint64 since, qint64 *lastSeq = nullptr,
+                              Stats *stats = nullptr, QString *error = nullptr);
+    // 读 exportChanges 的输出并合并，每 batchSize 条一个事务；已见过的部分自动跳过
+    static bool importChanges(QIODevice *in, int batchSize = 1000, Stats *stats = nullptr, QString *error = nullptr);
+
+    static bool syncDirectory(const QString &dir, Stats *stats = nullptr, QString *error = nullptr);
+    static bool syncWithServer(const QString &serverName, Stats *stats = nullptr, QString *error = nullptr);
+};
+
+#endif // DELTASYNC_H
@@ -0,0 +1,227 @@
+#include "DiagnosticsWindow.h"
+#include "MetricsExporter.h"
+#include "MetricsRegistry.h"
+#include "StallWatchdog.h"
+#include <QCheckBox>
+#include <QFileDialog>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QLabel>
+#include <QLineEdit>
+#include <QMessageBox>
+#include <QPlainTextEdit>
+#include <QPushButton>
+#include <QSplitter>
+#include <QTabWidget>
+#include <QTableWidget>
+#include <QTimer>
+#include <QVBoxLayout>
+
+namespace {
+
+// 微秒按量级显示成 us / ms / s
+QString formatMicros(double micros)
+{
+    if (micros < 1000) return QString("%1 us").arg(micros, 0, 'f', 0);
+    if (micros < 1000 * 1000) return QString("%1 ms").arg(micros / 1000, 0, 'f', 2);
+    return QString("%1 s").arg(micros / 1e6, 0, 'f', 2);
+}
+
+} // namespace
+
+DiagnosticsWindow::DiagnosticsWindow(MetricsExporter *exporter, QWidget *parent)
+    : QWidget(parent)
+    , m_exporter(exporter)
+{
+    setupUi();
+    setWindowTitle("诊断");
+    resize(900, 520);
+
+    refreshTimer = new QTimer(this);
+    refreshTimer->setInterval(1000);
+    connect(refreshTimer, &QTimer::timeout, this, &DiagnosticsWindow::refresh);
+    connect(autoRefreshCheckBox, &QCheckBox::toggled, this, [this](bool on) {
+        if (on) refreshTimer->start(); else refreshTimer->stop();
+    });
+    connect(filterLineEdit, &QLineEdit::textChanged, this, &DiagnosticsWindow::refresh);
+    refresh();
+    autoRefreshCheckBox->setChecked(true);
+}
+
+void DiagnosticsWindow::setupUi()
+{
+    filterLineEdit = new QLineEdit();
+    filterLineEdit->setPlaceholderText("按指标名或标签过滤，如 db、python、http...");
+    filterLineEdit->setClearButtonEnabled(true);
+    autoRefreshCheckBox = new QCheckBox("自动刷新");
+    QPushButton *refreshButton = new QPushButton("刷新");
+    QPushButton *exportButton = new QPushButton("导出 Prometheus 文本...");
+    connect(refreshButton, &QPushButton::clicked, this, &DiagnosticsWindow::refresh);
+    connect(exportButton, &QPushButton::clicked, this, &DiagnosticsWindow::onExportClicked);
+
+    QHBoxLayout *topLayout = new QHBoxLayout();
+    topLayout->addWidget(filterLineEdit, 1);
+    topLayout->addWidget(autoRefreshCheckBox);
+    topLayout->addWidget(refreshButton);
+    topLayout->addWidget(exportButton);
+
+    table = new QTableWidget(0, 9);
+    table->setHorizontalHeaderLabels({"指标", "标签", "类型", "值 / 次数", "平均", "p50", "p90", "p99", "最大"});
+    table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    table->setSelectionBehavior(QAbstractItemView::SelectRows);
+    table->verticalHeader()->setVisible(false);
+    table->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+    table->horizontalHeader()->setStretchLastSection(true);
+
+    exporterLabel = new QLabel();
+    exporterLabel->setTextInteractionFlags(Qt::TextSelectableByMouse);
+
+    QWidget *metricsPage = new QWidget();
+    QVBoxLayout *metricsLayout = new QVBoxLayout(metricsPage);
+    metricsLayout->addLayout(topLayout);
+    metricsLayout->addWidget(table, 1);
+    metricsLayout->addWidget(exporterLabel);
+
+    // 卡顿页：上面是记录列表，下面是选中记录的调用栈
+    stallTable = new QTableWidget(0, 4);
+    stallTable->setHorizontalHeaderLabels({"开始时间", "时长", "操作", "最内层"});
+    stallTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    stallTable->setSelectionBehavior(QAbstractItemView::SelectRows);
+    stallTable->setSelectionMode(QAbstractItemView::SingleSelection);
+    stallTable->verticalHeader()->setVisible(false);
+    stallTable->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+    stallTable->horizontalHeader()->setStretchLastSection(true);
+    backtraceView = new QPlainTextEdit();
+    backtraceView->setReadOnly(true);
+    backtraceView->setLineWrapMode(QPlainTextEdit::NoWrap);
+    backtraceView->setPlaceholderText("选中一条记录查看主线程调用栈");
+    connect(stallTable, &QTableWidget::currentCellChanged, this, [this](int row) {
+        const QTableWidgetItem *item = row >= 0 ? stallTable->item(row, 0) : nullptr;
+        backtraceView->setPlainText(item ? item->data(Qt::UserRole).toString() : QString());
+    });
+    watchdogLabel = new QLabel();
+    watchdogLabel->setTextInteractionFlags(Qt::TextSelectableByMouse);
+
+    QSplitter *stallSplitter = new QSplitter(Qt::Vertical);
+    stallSplitter->addWidget(stallTable);
+    stallSplitter->addWidget(backtraceView);
+    QWidget *stallPage = new QWidget();
+    QVBoxLayout *stallLayout = new QVBoxLayout(stallPage);
+    stallLayout->addWidget(stallSplitter, 1);
+    stallLayout->addWidget(watchdogLabel);
+
+    tabWidget = new QTabWidget();
+    tabWidget->addTab(metricsPage, "指标");
+    tabWidget->addTab(stallPage, "界面卡顿");
+    connect(tabWidget, &QTabWidget::currentChanged, this, &DiagnosticsWindow::refresh);
+
+    QVBoxLayout *mainLayout = new QVBoxLayout(this);
+    mainLayout->addWidget(tabWidget);
+    setLayout(mainLayout);
+}
+
+void DiagnosticsWindow::refresh()
+{
+    // 窗口藏起来时不必每秒重建表格
+    if (!isVisible() && refreshTimer->isActive()) return;
+    if (tabWidget->currentIndex() == 1) {
+        refreshStalls();
+        return;
+    }
+
+    const QString filter = filterLineEdit->text().trimmed();
+    QList<MetricsRegistry::Sample> samples = MetricsRegistry::instance().samples();
+    if (!filter.isEmpty()) {
+        samples.removeIf([&](const MetricsRegistry::Sample &sample) {
+            return !sample.name.contains(filter, Qt::CaseInsensitive) && !sample.labels.contains(filter, Qt::CaseInsensitive);
+        });
+    }
+
+    static const char *const typeNames[] = {"计数器", "仪表", "直方图"};
+    table->setUpdatesEnabled(false);
+    table->setRowCount(samples.size());
+    for (int row = 0; row < samples.size(); ++row) {
+        const MetricsRegistry::Sample &sample = samples.at(row);
+        const bool histogram = sample.type == MetricsRegistry::HistogramType;
+        const QStringList cells = {
+            sample.name,
+            sample.labels,
+            typeNames[sample.type],
+            QString::number(sample.value, 'g', 12),
+            histogram ? formatMicros(sample.meanMicros) : QString(),
+            histogram ? formatMicros(sample.p50Micros) : QString(),
+            histogram ? formatMicros(sample.p90Micros) : QString(),
+            histogram ? formatMicros(sample.p99Micros) : QString(),
+            histogram ? formatMicros(sample.maxMicros) : QString(),
+        };
+        for (int column = 0; column < cells.size(); ++column) {
+            QTableWidgetItem *item = table->item(row, column);
+            if (!item) {
+                item = new QTableWidgetItem();
+                if (column >= 3) item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+                table->setItem(row, column, item);
+            }
+            item->setText(cells.at(column));
+        }
+    }
+    table->setUpdatesEnabled(true);
+
+    QStringList exporterInfo;
+    if (m_exporter && m_exporter->port() > 0) {
+        exporterInfo << QString("http://127.0.0.1:%1/metrics").arg(m_exporter->port());
+    }
+    exporterLabel->setText(exporterInfo.isEmpty()
+                               ? "未开启指标端口（设置 Metrics/port 或环境变量 PLANNER_METRICS_PORT）"
+                               : "Prometheus 采集地址：" + exporterInfo.join("，"));
+}
+
+void DiagnosticsWindow::refreshStalls()
+{
+    StallWatchdog &watchdog = StallWatchdog::instance();
+    watchdogLabel->setText(watchdog.isRunning()
+                               ? QString("阈值 %1 ms，记录文件：%2").arg(watchdog.thresholdMs()).arg(watchdog.logPath())
+                               : "看门狗未开启（设置 Watchdog/thresholdMs 或环境变量 PLANNER_STALL_MS）");
+
+    // 新的在上；行数不变时不重建，免得自动刷新把选中行冲掉
+    const QList<StallWatchdog::Stall> stalls = watchdog.recentStalls();
+    if (stallTable->rowCount() == stalls.size()
+        && (stalls.isEmpty() || stallTable->item(0, 0)->text() == stalls.constLast().startedAt.toString("MM-dd HH:mm:ss.zzz"))) {
+        return;
+    }
+    stallTable->setRowCount(stalls.size());
+    for (int row = 0; row < stalls.size(); ++row) {
+        const StallWatchdog::Stall &stall = stalls.at(stalls.size() - 1 - row);
+        const QStringList cells = {
+            stall.startedAt.toString("MM-dd HH:mm:ss.zzz"),
+            QString("%1 ms").arg(stall.durationMs),
+            stall.action.isEmpty() ? QString("（无标签）") : stall.action,
+            stall.operation != stall.action ? stall.operation : QString(),
+        };
+        for (int column = 0; column < cells.size(); ++column) {
+            QTableWidgetItem *item = stallTable->item(row, column);
+            if (!item) {
+                item = new QTableWidgetItem();
+                if (column == 1) item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+                stallTable->setItem(row, column, item);
+            }
+            item->setText(cells.at(column));
+        }
+        stallTable->item(row, 0)->setData(Qt::UserRole, stall.backtrace.isEmpty()
+                                                            ? QString("（本平台不采集调用栈，或主线程未响应信号）")
+                                                            : stall.backtrace.join('\n'));
+    }
+    if (stallTable->currentRow() >= 0) {
+        backtraceView->setPlainText(stallTable->item(stallTable->currentRow(), 0)->data(Qt::UserRole).toString());
+    }
+}
+
+void DiagnosticsWindow::onExportClicked()
+{
+    const QString path = QFileDialog::getSaveFileName(this, "导出指标", "planner_metrics.prom",
+                                                      "Prometheus 文本 (*.prom *.txt)");
+    if (path.isEmpty()) return;
+    QString error;
+    if (!MetricsRegistry::instance().writePrometheusFile(path, &error)) {
+        QMessageBox::warning(this, "导出失败", error);
+    }
+}
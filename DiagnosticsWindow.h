@@ -0,0 +1,49 @@
+#ifndef DIAGNOSTICSWINDOW_H
+#define DIAGNOSTICSWINDOW_H
+
+#include <QPointer>
+#include <QWidget>
+
+QT_BEGIN_NAMESPACE
+class QCheckBox;
+class QLabel;
+class QLineEdit;
+class QPlainTextEdit;
+class QTableWidget;
+class QTabWidget;
+class QTimer;
+QT_END_NAMESPACE
+
+class MetricsExporter;
+
+// 诊断面板：列出 MetricsRegistry 里的全部指标（计数器、仪表、延迟分位数），
+// 可以按名字过滤、自动刷新，或把当前值存成 Prometheus 文本文件；
+// 另一页是 StallWatchdog 记下的最近几次界面卡顿，选中一行可看主线程当时的调用栈
+class DiagnosticsWindow : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit DiagnosticsWindow(MetricsExporter *exporter, QWidget *parent = nullptr);
+
+private slots:
+    void refresh();
+    void onExportClicked();
+
+private:
+    void setupUi();
+    void refreshStalls();
+
+    QPointer<MetricsExporter> m_exporter;
+    QTabWidget *tabWidget;
+    QTableWidget *table;
+    QTableWidget *stallTable;
+    QPlainTextEdit *backtraceView;
+    QLabel *watchdogLabel;
+    QLineEdit *filterLineEdit;
+    QCheckBox *autoRefreshCheckBox;
+    QLabel *exporterLabel;
+    QTimer *refreshTimer;
+};
+
+#endif // DIAGNOSTICSWINDOW_H
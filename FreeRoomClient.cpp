@@ -0,0 +1,62 @@
+#include "FreeRoomClient.h"
+#include "FreeRoomModel.h"
+#include "NetworkService.h"
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QSettings>
+#include <QUrlQuery>
+#include <QDebug>
+
+static const char *DEFAULT_ENDPOINT =
+    "https://portal.pku.edu.cn/publicQuery/classroomQuery/retrClassRoomFree.do";
+static const int REQUEST_TIMEOUT_MS = 10000;
+
+FreeRoomClient::FreeRoomClient(QObject *parent)
+    : QObject(parent)
+{
+    // 环境变量优先于配置文件，方便测试时指向本地 mock
+    QSettings settings("MyCourseApp", "FreeRoom");
+    m_endpoint = QUrl(qEnvironmentVariable("PLANNER_FREEROOM_URL",
+                                           settings.value("endpoint", DEFAULT_ENDPOINT).toString()));
+}
+
+void FreeRoomClient::query(const QString &building, const QString &time)
+{
+    QUrl url(m_endpoint);
+    QUrlQuery query;
+    query.addQueryItem("buildingName", building);
+    query.addQueryItem("time", time);
+    url.setQuery(query);
+
+    QNetworkRequest request(url);
+    request.setHeader(QNetworkRequest::UserAgentHeader, "Mozilla/5.0");
+    request.setRawHeader("Referer", "https://portal.pku.edu.cn/publicQuery/#/freeClassroom");
+    request.setTransferTimeout(REQUEST_TIMEOUT_MS);
+
+    ++m_pending;
+    NetworkService::instance().get(request, this, [this, building](QNetworkReply *reply) {
+        onReply(reply, building);
+    });
+}
+
+void FreeRoomClient::onReply(QNetworkReply *reply, const QString &building)
+{
+    --m_pending;
+    if (reply->error() != QNetworkReply::NoError) {
+        qDebug() << "空闲教室查询失败：" << reply->errorString();
+        emit failed(building, reply->errorString());
+        return;
+    }
+
+    QJsonParseError err;
+    const QJsonDocument doc = QJsonDocument::fromJson(reply->readAll(), &err);
+    if (err.error != QJsonParseError::NoError || !doc.isObject()) {
+        qDebug() << "空闲教室返回数据解析错误：" << err.errorString();
+        emit failed(building, "返回数据格式不正确");
+        return;
+    }
+
+    emit finished(building, FreeRoomModel::groupRows(building, doc.object().value("rows").toArray()));
+}
@@ -0,0 +1,36 @@
+#ifndef FREEROOMCLIENT_H
+#define FREEROOMCLIENT_H
+
+#include <QObject>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QUrl>
+
+class QNetworkReply;
+
+// 空闲教室查询：直接请求北大门户的公开接口，经共享的 NetworkService 发出，
+// 不再为每次查询启动 Python。结果由 FreeRoomModel 整理成和原来脚本输出相同的结构：
+// { 楼宇: { 日期: { "c1": [教室...], ... } } }
+class FreeRoomClient : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit FreeRoomClient(QObject *parent = nullptr);
+
+    // time 为门户接受的 "今天" / "明天" / "后天"
+    void query(const QString &building, const QString &time);
+    bool isBusy() const { return m_pending > 0; }
+
+signals:
+    void finished(const QString &building, const QJsonObject &result);
+    void failed(const QString &building, const QString &error);
+
+private:
+    void onReply(QNetworkReply *reply, const QString &building);
+
+    QUrl m_endpoint;
+    int m_pending = 0;
+};
+
+#endif // FREEROOMCLIENT_H
@@ -0,0 +1,64 @@
+#include "FreeRoomModel.h"
+#include <QHash>
+#include <QRegularExpression>
+
+QJsonObject FreeRoomModel::groupRows(const QString &building, const QJsonArray &rows)
+{
+    // 先按 日期 -> 节次 -> 教室列表 收集，最后一次性转成 JSON
+    QHash<QString, QHash<QString, QJsonArray>> byDate;
+    for (const QJsonValue &value : rows) {
+        const QJsonObject row = value.toObject();
+        const QString room = row.value("room").toString().trimmed();
+        if (room.isEmpty()) continue;
+        const QString date = row.value("date").toString("default");
+
+        QHash<QString, QJsonArray> &sections = byDate[date];
+        for (auto it = row.constBegin(); it != row.constEnd(); ++it) {
+            // 过滤掉非节次信息（如教室名、容量、日期）
+            if (it.key() == "room" || it.key() == "cap" || it.key() == "date") continue;
+            // 值为空字符串表示该节次空闲
+            if (it.value().isString() && it.value().toString().isEmpty()) {
+                sections[it.key()].append(room);
+            }
+        }
+    }
+
+    QJsonObject dates;
+    for (auto d = byDate.constBegin(); d != byDate.constEnd(); ++d) {
+        QJsonObject sections;
+        for (auto s = d.value().constBegin(); s != d.value().constEnd(); ++s) {
+            sections.insert(s.key(), s.value());
+        }
+        dates.insert(d.key(), sections);
+    }
+    return QJsonObject{{building, dates}};
+}
+
+QList<FreeRoomModel::Entry> FreeRoomModel::entries(const QJsonObject &grouped, const QString &building,
+                                                    const QSet<int> &periods)
+{
+    QList<Entry> result;
+    QString key = building;
+    if (!grouped.contains(key)) {
+        if (grouped.isEmpty()) return result;
+        key = grouped.constBegin().key();
+    }
+
+    const QJsonObject dates = grouped.value(key).toObject();
+    for (auto d = dates.constBegin(); d != dates.constEnd(); ++d) {
+        const QString date = d.key() == "default" ? QString() : d.key();
+        const QJsonObject sections = d.value().toObject();
+        for (auto s = sections.constBegin(); s != sections.constEnd(); ++s) {
+            // 节次键形如 "c3"
+            static const QRegularExpression nonDigits("[^0-9]");
+            const int period = QString(s.key()).remove(nonDigits).toInt();
+            if (!periods.isEmpty() && !periods.contains(period)) continue;
+
+            for (const QJsonValue &room : s.value().toArray()) {
+                if (room.toString().isEmpty()) continue;
+                result.append(Entry{date, period, room.toString()});
+            }
+        }
+    }
+    return result;
+}
@@ -0,0 +1,30 @@
+#ifndef FREEROOMMODEL_H
+#define FREEROOMMODEL_H
+
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QList>
+#include <QSet>
+#include <QString>
+
+// 空闲教室数据的整理与查询，不依赖网络和界面。
+// 整理后的结构：{ 楼宇: { 日期: { "c1": [教室...], ... } } }，日期缺失时为 "default"
+class FreeRoomModel
+{
+public:
+    struct Entry {
+        QString date;   // 为空表示门户没有给出日期
+        int period = 0; // 第几节课
+        QString room;
+    };
+
+    // 把门户返回的 rows 转成按日期、节次分组的空闲教室表
+    static QJsonObject groupRows(const QString &building, const QJsonArray &rows);
+
+    // 取出某个楼宇的空闲教室；periods 为空表示所有节次。
+    // 结果里没有该楼宇时退回第一个楼宇（门户有时返回别名）。
+    static QList<Entry> entries(const QJsonObject &grouped, const QString &building,
+                                const QSet<int> &periods = {});
+};
+
+#endif // FREEROOMMODEL_H
@@ -0,0 +1,108 @@
+#include "GroupAvailability.h"
+#include <QtAlgorithms>
+#include <algorithm>
+
+namespace {
+// 北大作息：每节 50 分钟，{开始时, 开始分}
+constexpr int PERIOD_STARTS[SCHEDULE_PERIODS][2] = {
+    {8, 0},   {9, 0},   {10, 10}, {11, 10}, {13, 0},  {14, 0},
+    {15, 10}, {16, 10}, {17, 10}, {18, 40}, {19, 40}, {20, 40}
+};
+constexpr int PERIOD_MINUTES = 50;
+}
+
+GroupAvailability::GroupAvailability(const QList<WeekMask> &people)
+    : m_people(people.size())
+    , m_words((people.size() + 63) / 64)
+    , m_slotPeople(SCHEDULE_SLOTS * ((people.size() + 63) / 64), 0)
+{
+    for (int person = 0; person < m_people; ++person) {
+        const WeekMask &mask = people.at(person);
+        if (mask.none()) continue;
+        const quint64 bit = quint64(1) << (person % 64);
+        const int word = person / 64;
+        for (int slot = 0; slot < SCHEDULE_SLOTS; ++slot) {
+            if (mask.test(slot)) m_slotPeople[slot * m_words + word] |= bit;
+        }
+    }
+}
+
+int GroupAvailability::busyCount(int day, int period) const
+{
+    const quint64 *row = m_slotPeople.constData() + slotIndex(day, period) * m_words;
+    int count = 0;
+    for (int w = 0; w < m_words; ++w) {
+        count += qPopulationCount(row[w]);
+    }
+    return count;
+}
+
+std::array<int, SCHEDULE_SLOTS> GroupAvailability::busyCounts() const
+{
+    std::array<int, SCHEDULE_SLOTS> counts{};
+    for (int day = 0; day < SCHEDULE_DAYS; ++day) {
+        for (int period = 0; period < SCHEDULE_PERIODS; ++period) {
+            counts[slotIndex(day, period)] = busyCount(day, period);
+        }
+    }
+    return counts;
+}
+
+QList<GroupAvailability::Slot> GroupAvailability::bestSlots(int length, int maxResults) const
+{
+    QList<Slot> candidates;
+    if (length < 1 || length > SCHEDULE_PERIODS) return candidates;
+
+    QVector<quint64> anyBusy(m_words);
+    for (int day = 0; day < SCHEDULE_DAYS; ++day) {
+        for (int start = 0; start + length <= SCHEDULE_PERIODS; ++start) {
+            // 连续几节里任何一节忙都算忙：按字或起来再数
+            std::fill(anyBusy.begin(), anyBusy.end(), 0);
+            for (int p = start; p < start + length; ++p) {
+                const quint64 *row = m_slotPeople.constData() + slotIndex(day, p) * m_words;
+                for (int w = 0; w < m_words; ++w) anyBusy[w] |= row[w];
+            }
+            Slot slot;
+            slot.day = day;
+            slot.period = start;
+            slot.length = length;
+            for (int w = 0; w < m_words; ++w) slot.busyCount += qPopulationCount(anyBusy[w]);
+            candidates.append(slot);
+        }
+    }
+
+    std::stable_sort(candidates.begin(), candidates.end(), [](const Slot &a, const Slot &b) {
+        return a.busyCount < b.busyCount;
+    });
+    if (maxResults >= 0 && candidates.size() > maxResults) {
+        candidates.resize(maxResults);
+    }
+    return candidates;
+}
+
+QTime GroupAvailability::periodStart(int period)
+{
+    return QTime(PERIOD_STARTS[period][0], PERIOD_STARTS[period][1]);
+}
+
+QTime GroupAvailability::periodEnd(int period)
+{
+    return periodStart(period).addSecs(PERIOD_MINUTES * 60);
+}
+
+WeekMask GroupAvailability::maskForTasks(const QList<DatedTask> &tasks, const QDate &weekStart)
+{
+    WeekMask mask;
+    for (const DatedTask &item : tasks) {
+        const qint64 day = weekStart.daysTo(item.date);
+        if (day < 0 || day >= SCHEDULE_DAYS) continue;
+        const QTime start = item.task.getStartTime();
+        const QTime end = item.task.getEndTime();
+        for (int period = 0; period < SCHEDULE_PERIODS; ++period) {
+            if (start < periodEnd(period) && end > periodStart(period)) {
+                mask.set(slotIndex(int(day), period));
+            }
+        }
+    }
+    return mask;
+}
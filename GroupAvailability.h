@@ -0,0 +1,44 @@
+#ifndef GROUPAVAILABILITY_H
+#define GROUPAVAILABILITY_H
+
+#include "PersonSchedule.h"
+#include "DailyTask.h"
+#include <QDate>
+#include <QList>
+#include <QVector>
+#include <array>
+
+// 小组空闲情况的聚合：把每个人的 7×12 “有课”位图转置成“每个时段 × 每个人”的位串，
+// 某个时段有几个人忙就是一次 popcount（每 64 人一个字），几百人也是瞬间完成。
+class GroupAvailability
+{
+public:
+    struct Slot {
+        int day = 0;         // 0=周一
+        int period = 0;      // 开始节次，0 起
+        int length = 1;      // 连续几节
+        int busyCount = 0;   // 这段时间里至少有一节忙的人数
+    };
+
+    explicit GroupAvailability(const QList<WeekMask> &people);
+
+    int peopleCount() const { return m_people; }
+    int busyCount(int day, int period) const;
+    std::array<int, SCHEDULE_SLOTS> busyCounts() const;
+
+    // 连续 length 节的会议时段，按忙的人数从少到多排序（同样少时按时间先后），最多返回 maxResults 个
+    QList<Slot> bestSlots(int length, int maxResults) const;
+
+    // 把某一周的日程映射到节次上（与任一节课时间有重叠即算忙）
+    static WeekMask maskForTasks(const QList<DatedTask> &tasks, const QDate &weekStart);
+    // 第 period 节（0 起）的上课时间
+    static QTime periodStart(int period);
+    static QTime periodEnd(int period);
+
+private:
+    int m_people = 0;
+    int m_words = 0;
+    QVector<quint64> m_slotPeople; // SCHEDULE_SLOTS 行，每行 m_words 个字
+};
+
+#endif // GROUPAVAILABILITY_H
@@ -0,0 +1,166 @@
+#include "GroupScheduleStore.h"
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QDebug>
+
+GroupScheduleStore &GroupScheduleStore::instance()
+{
+    static GroupScheduleStore instance;
+    return instance;
+}
+
+GroupScheduleStore::GroupScheduleStore(QObject *parent)
+    : QObject(parent)
+{
+    load();
+}
+
+QString GroupScheduleStore::storagePath() const
+{
+    return QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation) + "/group_schedules.json";
+}
+
+void GroupScheduleStore::load()
+{
+    QFile file(storagePath());
+    if (!file.open(QIODevice::ReadOnly)) return;
+
+    const QJsonArray array = QJsonDocument::fromJson(file.readAll()).array();
+    for (const QJsonValue &value : array) {
+        const QJsonObject obj = value.toObject();
+        PersonSchedule person;
+        person.name = obj.value("name").toString();
+        person.sourcePath = obj.value("source").toString();
+        person.importedAt = QDateTime::fromString(obj.value("imported_at").toString(), Qt::ISODate);
+        for (const QJsonValue &course : obj.value("courses").toArray()) {
+            person.courses.append(CourseEntry::fromJson(course.toObject()));
+        }
+        person.rebuildMask();
+        if (person.name.isEmpty() || m_indexByName.contains(person.name)) continue;
+        m_indexByName.insert(person.name, m_people.size());
+        m_people.append(person);
+    }
+}
+
+bool GroupScheduleStore::save() const
+{
+    QJsonArray array;
+    for (const PersonSchedule &person : m_people) {
+        QJsonArray courses;
+        for (const CourseEntry &course : person.courses) {
+            courses.append(course.toJson());
+        }
+        array.append(QJsonObject{{"name", person.name},
+                                 {"source", person.sourcePath},
+                                 {"imported_at", person.importedAt.toString(Qt::ISODate)},
+                                 {"courses", courses}});
+    }
+
+    QDir().mkpath(QFileInfo(storagePath()).absolutePath());
+    QSaveFile file(storagePath());
+    if (!file.open(QIODevice::WriteOnly)) {
+        qDebug() << "无法保存小组课表：" << file.errorString();
+        return false;
+    }
+    file.write(QJsonDocument(array).toJson(QJsonDocument::Compact));
+    return file.commit();
+}
+
+void GroupScheduleStore::upsert(const QList<PersonSchedule> &people)
+{
+    if (people.isEmpty()) return;
+    for (const PersonSchedule &person : people) {
+        auto it = m_indexByName.constFind(person.name);
+        if (it != m_indexByName.constEnd()) {
+            m_people[it.value()] = person;
+        } else {
+            m_indexByName.insert(person.name, m_people.size());
+            m_people.append(person);
+        }
+    }
+    save();
+    emit changed();
+}
+
+bool GroupScheduleStore::remove(const QString &name)
+{
+    auto it = m_indexByName.constFind(name);
+    if (it == m_indexByName.constEnd()) return false;
+    m_people.removeAt(it.value());
+    m_indexByName.clear();
+    for (int i = 0; i < m_people.size(); ++i) {
+        m_indexByName.insert(m_people.at(i).name, i);
+    }
+    save();
+    emit changed();
+    return true;
+}
+
+void GroupScheduleStore::clear()
+{
+    m_people.clear();
+    m_indexByName.clear();
+    save();
+    emit changed();
+}
+
+QStringList GroupScheduleStore::names() const
+{
+    QStringList result;
+    result.reserve(m_people.size());
+    for (const PersonSchedule &person : m_people) {
+        result << person.name;
+    }
+    return result;
+}
+
+QList<PersonSchedule> GroupScheduleStore::people() const
+{
+    return m_people;
+}
+
+bool GroupScheduleStore::person(const QString &name, PersonSchedule &out) const
+{
+    auto it = m_indexByName.constFind(name);
+    if (it == m_indexByName.constEnd()) return false;
+    out = m_people.at(it.value());
+    return true;
+}
+
+WeekMask GroupScheduleStore::commonFreePeriods(const QStringList &names) const
+{
+    // 所有人的“有课”位图按位或，取反即为大家都空的时段
+    WeekMask busy;
+    if (names.isEmpty()) {
+        for (const PersonSchedule &person : m_people) {
+            busy |= person.busy;
+        }
+    } else {
+        for (const QString &name : names) {
+            auto it = m_indexByName.constFind(name);
+            if (it != m_indexByName.constEnd()) busy |= m_people.at(it.value()).busy;
+        }
+    }
+    return ~busy;
+}
+
+QString GroupScheduleStore::describeSlots(const WeekMask &mask, int maxItems)
+{
+    static const char *const dayNames[SCHEDULE_DAYS] = {"一", "二", "三", "四", "五", "六", "日"};
+    QStringList items;
+    for (int day = 0; day < SCHEDULE_DAYS; ++day) {
+        for (int period = 0; period < SCHEDULE_PERIODS; ++period) {
+            if (!mask.test(slotIndex(day, period))) continue;
+            if (items.size() == maxItems) {
+                return items.join("、") + QString(" 等 %1 个时段").arg(mask.count());
+            }
+            items << QString("周%1第%2节").arg(dayNames[day]).arg(period + 1);
+        }
+    }
+    return items.join("、");
+}
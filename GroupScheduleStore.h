@@ -0,0 +1,46 @@
+#ifndef GROUPSCHEDULESTORE_H
+#define GROUPSCHEDULESTORE_H
+
+#include "PersonSchedule.h"
+#include <QObject>
+#include <QHash>
+#include <QStringList>
+
+// 小组成员课表（批量导入的结果），按人名保存（见 BatchScheduleImporter 的命名规则），
+// 重新导入同一份文件会覆盖原来的记录。
+// 数据保存在应用数据目录的 group_schedules.json 中。
+class GroupScheduleStore : public QObject
+{
+    Q_OBJECT
+
+public:
+    static GroupScheduleStore &instance();
+
+    void upsert(const QList<PersonSchedule> &people);
+    bool remove(const QString &name);
+    void clear();
+
+    int size() const { return m_people.size(); }
+    QStringList names() const;
+    QList<PersonSchedule> people() const;
+    bool person(const QString &name, PersonSchedule &out) const;
+
+    // names 中所有人都没课的时段；names 为空表示全体成员
+    WeekMask commonFreePeriods(const QStringList &names = QStringList()) const;
+    // 把位图转成“周一第3节、周二第5节…”，最多列出 maxItems 项
+    static QString describeSlots(const WeekMask &mask, int maxItems = 10);
+
+signals:
+    void changed();
+
+private:
+    explicit GroupScheduleStore(QObject *parent = nullptr);
+    QString storagePath() const;
+    void load();
+    bool save() const;
+
+    QList<PersonSchedule> m_people;   // 按导入顺序
+    QHash<QString, int> m_indexByName;
+};
+
+#endif // GROUPSCHEDULESTORE_H
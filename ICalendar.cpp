@@ -0,0 +1,418 @@
+#include "ICalendar.h"
+#include "GroupAvailability.h"
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QIODevice>
+#include <QList>
+#include <QStringList>
+#include <QTimeZone>
+#include <algorithm>
+
+namespace {
+
+constexpr qsizetype FLUSH_BYTES = 64 * 1024;
+constexpr qsizetype MAX_LINE_OCTETS = 75;
+
+QString escapeText(QString text)
+{
+    text.replace('\\', "\\\\");
+    text.replace(';', "\\;");
+    text.replace(',', "\\,");
+    text.replace("\r\n", "\\n");
+    text.replace('\n', "\\n");
+    return text;
+}
+
+QString unescapeText(const QString &text)
+{
+    QString out;
+    out.reserve(text.size());
+    for (qsizetype i = 0; i < text.size(); ++i) {
+        const QChar c = text.at(i);
+        if (c != '\\' || i + 1 >= text.size()) {
+            out += c;
+            continue;
+        }
+        const QChar n = text.at(++i);
+        out += (n == 'n' || n == 'N') ? QChar('\n') : n;
+    }
+    return out;
+}
+
+// 内容行超过 75 字节时折行（续行以空格开头），不在 UTF-8 多字节字符中间断开
+QByteArray fold(const QByteArray &line)
+{
+    if (line.size() <= MAX_LINE_OCTETS) return line + "\r\n";
+    QByteArray out;
+    out.reserve(line.size() + line.size() / 24 + 2);
+    qsizetype pos = 0;
+    qsizetype limit = MAX_LINE_OCTETS;
+    while (pos < line.size()) {
+        qsizetype end = qMin(pos + limit, line.size());
+        while (end < line.size() && end > pos && (static_cast<uchar>(line.at(end)) & 0xC0) == 0x80) --end;
+        if (pos > 0) out += ' ';
+        out += line.mid(pos, end - pos) + "\r\n";
+        pos = end;
+        limit = MAX_LINE_OCTETS - 1; // 续行开头的空格占一个字节
+    }
+    return out;
+}
+
+QByteArray dateText(const QDate &date)
+{
+    return date.toString("yyyyMMdd").toLatin1();
+}
+
+QByteArray dateTimeText(const QDate &date, const QTime &time)
+{
+    return dateText(date) + 'T' + time.toString("HHmmss").toLatin1();
+}
+
+// 读一行原始字节并去掉行尾换行；返回 false 表示已到输入末尾
+bool readRawLine(QIODevice *in, QByteArray &line)
+{
+    line = in->readLine();
+    if (line.isEmpty()) return false;
+    while (line.endsWith('\n') || line.endsWith('\r')) line.chop(1);
+    return true;
+}
+
+// 属性名和参数之后的第一个冒号；参数值里带引号的冒号不算
+qsizetype valueSeparator(const QString &text)
+{
+    bool quoted = false;
+    for (qsizetype i = 0; i < text.size(); ++i) {
+        if (text.at(i) == '"') quoted = !quoted;
+        else if (text.at(i) == ':' && !quoted) return i;
+    }
+    return -1;
+}
+
+QString parameter(const QStringList &params, const QString &name)
+{
+    for (const QString &param : params) {
+        if (param.section('=', 0, 0).trimmed().compare(name, Qt::CaseInsensitive) == 0) {
+            QString value = param.section('=', 1).trimmed();
+            if (value.startsWith('"') && value.endsWith('"') && value.size() >= 2) value = value.mid(1, value.size() - 2);
+            return value;
+        }
+    }
+    return QString();
+}
+
+// 解析 DATE 或 DATE-TIME：20240601、20240601T080000（本地）、20240601T000000Z（UTC），
+// 带 TZID 参数时按该时区换算；不认识的时区按本地时间处理
+bool parseDateTime(const QString &value, const QStringList &params, QDate &date, QTime &time)
+{
+    const QString v = value.trimmed();
+    date = QDate::fromString(v.left(8), "yyyyMMdd");
+    time = QTime();
+    if (!date.isValid()) return false;
+    if (v.size() < 15 || v.at(8) != 'T') return true;
+
+    time = QTime::fromString(v.mid(9, 6), "HHmmss");
+    if (!time.isValid()) return false;
+
+    QDateTime dt;
+    if (v.endsWith('Z')) {
+        dt = QDateTime(date, time, Qt::UTC);
+    } else {
+        const QTimeZone zone(parameter(params, "TZID").toUtf8());
+        if (zone.isValid()) dt = QDateTime(date, time, zone);
+    }
+    if (dt.isValid()) {
+        const QDateTime local = dt.toLocalTime();
+        date = local.date();
+        time = local.time();
+    }
+    return true;
+}
+
+// DURATION：P1W、P1D、PT1H30M、P1DT2H 等，返回秒数；无法解析返回 -1
+qint64 parseDuration(const QString &value)
+{
+    QString v = value.trimmed().toUpper();
+    const bool negative = v.startsWith('-');
+    if (v.startsWith('-') || v.startsWith('+')) v.remove(0, 1);
+    if (!v.startsWith('P')) return -1;
+
+    qint64 seconds = 0;
+    qint64 number = -1;
+    for (qsizetype i = 1; i < v.size(); ++i) {
+        const QChar c = v.at(i);
+        if (c.isDigit()) {
+            number = (number < 0 ? 0 : number * 10) + c.digitValue();
+            continue;
+        }
+        if (c == 'T') continue;
+        if (number < 0) return -1;
+        switch (c.unicode()) {
+        case 'W': seconds += number * 7 * 86400; break;
+        case 'D': seconds += number * 86400; break;
+        case 'H': seconds += number * 3600; break;
+        case 'M': seconds += number * 60; break;
+        case 'S': seconds += number; break;
+        default: return -1;
+        }
+        number = -1;
+    }
+    return negative ? -seconds : seconds;
+}
+
+int weekdayFromCode(const QString &code)
+{
+    static const QStringList codes{"MO", "TU", "WE", "TH", "FR", "SA", "SU"};
+    return codes.indexOf(code) + 1;
+}
+
+} // namespace
+
+// ---------------------------------------------------------------- 写出
+
+ICalendarWriter::ICalendarWriter(QIODevice *out)
+    : m_out(out)
+{
+}
+
+void ICalendarWriter::begin()
+{
+    m_stamp = QDateTime::currentDateTimeUtc().toString("yyyyMMdd'T'HHmmss'Z'").toLatin1();
+    append("BEGIN:VCALENDAR\r\nVERSION:2.0\r\nPRODID:-//MyCourseApp//Planner//ZH\r\nCALSCALE:GREGORIAN\r\n");
+}
+
+void ICalendarWriter::end()
+{
+    append("END:VCALENDAR\r\n");
+    flush();
+}
+
+void ICalendarWriter::writeTask(const DatedTask &item)
+{
+    const DailyTask &task = item.task;
+    append("BEGIN:VEVENT\r\nUID:task-" + QByteArray::number(task.getId()) + "@mycourseapp\r\n"
+           "DTSTAMP:" + m_stamp + "\r\n");
+    if (task.getStartTime().isValid()) {
+        append("DTSTART:" + dateTimeText(item.date, task.getStartTime()) + "\r\n");
+        if (task.getEndTime().isValid() && task.getEndTime() > task.getStartTime()) {
+            append("DTEND:" + dateTimeText(item.date, task.getEndTime()) + "\r\n");
+        }
+    } else {
+        append("DTSTART;VALUE=DATE:" + dateText(item.date) + "\r\n");
+    }
+    appendProperty("SUMMARY", task.getTitle());
+    if (!task.getNote().isEmpty()) appendProperty("DESCRIPTION", task.getNote());
+    append("END:VEVENT\r\n");
+}
+
+void ICalendarWriter::writeRule(const RecurringTask &recurring)
+{
+    const DailyTask &task = recurring.task;
+    const RecurrenceRule &rule = recurring.rule;
+    const bool timed = task.getStartTime().isValid();
+
+    append("BEGIN:VEVENT\r\nUID:rule-" + QByteArray::number(recurring.id) + "@mycourseapp\r\n"
+           "DTSTAMP:" + m_stamp + "\r\n");
+    if (timed) {
+        append("DTSTART:" + dateTimeText(rule.startDate(), task.getStartTime()) + "\r\n");
+        if (task.getEndTime().isValid() && task.getEndTime() > task.getStartTime()) {
+            append("DTEND:" + dateTimeText(rule.startDate(), task.getEndTime()) + "\r\n");
+        }
+    } else {
+        append("DTSTART;VALUE=DATE:" + dateText(rule.startDate()) + "\r\n");
+    }
+
+    // UNTIL 的值类型要与 DTSTART 一致，带时间的事件写成当天最后一秒
+    QByteArray rrule = rule.toRRule().toLatin1();
+    if (timed && rule.count() == 0 && rule.until().isValid()) {
+        rrule.replace("UNTIL=" + dateText(rule.until()), "UNTIL=" + dateText(rule.until()) + "T235959");
+    }
+    append("RRULE:" + rrule + "\r\n");
+
+    if (!rule.exceptions().isEmpty()) {
+        QList<QDate> dates(rule.exceptions().cbegin(), rule.exceptions().cend());
+        std::sort(dates.begin(), dates.end());
+        QByteArray line = timed ? "EXDATE:" : "EXDATE;VALUE=DATE:";
+        for (qsizetype i = 0; i < dates.size(); ++i) {
+            if (i > 0) line += ',';
+            line += timed ? dateTimeText(dates.at(i), task.getStartTime()) : dateText(dates.at(i));
+        }
+        append(fold(line));
+    }
+    appendProperty("SUMMARY", task.getTitle());
+    if (!task.getNote().isEmpty()) appendProperty("DESCRIPTION", task.getNote());
+    append("END:VEVENT\r\n");
+}
+
+void ICalendarWriter::writeCourse(const CourseEntry &course, const QDate &termStart, int weeks)
+{
+    if (course.day < 1 || course.day > SCHEDULE_DAYS || course.startPeriod < 1 || course.startPeriod > SCHEDULE_PERIODS) {
+        return;
+    }
+    const int first = course.startPeriod - 1;
+    const int last = qMin(first + qMax(1, course.periods) - 1, SCHEDULE_PERIODS - 1);
+    const QDate monday = termStart.addDays(1 - termStart.dayOfWeek());
+    const QDate date = monday.addDays(course.day - 1);
+
+    // 同一门课在同一时段的 UID 固定，重复导出后日历软件会更新而不是新增
+    const QByteArray key = QString("%1|%2|%3").arg(course.name).arg(course.day).arg(course.startPeriod).toUtf8();
+    const QByteArray uid = QCryptographicHash::hash(key, QCryptographicHash::Md5).toHex().left(16);
+
+    append("BEGIN:VEVENT\r\nUID:course-" + uid + "@mycourseapp\r\n"
+           "DTSTAMP:" + m_stamp + "\r\n"
+           "DTSTART:" + dateTimeText(date, GroupAvailability::periodStart(first)) + "\r\n"
+           "DTEND:" + dateTimeText(date, GroupAvailability::periodEnd(last)) + "\r\n"
+           "RRULE:FREQ=WEEKLY;COUNT=" + QByteArray::number(qMax(1, weeks)) + "\r\n");
+    appendProperty("SUMMARY", course.name);
+    if (!course.classroom.isEmpty()) appendProperty("LOCATION", course.classroom);
+    if (!course.teacher.isEmpty()) appendProperty("DESCRIPTION", "教师：" + course.teacher);
+    append("END:VEVENT\r\n");
+}
+
+bool ICalendarWriter::flush()
+{
+    if (!m_buffer.isEmpty()) {
+        if (m_out->write(m_buffer) != m_buffer.size()) m_failed = true;
+        m_buffer.clear();
+    }
+    return !m_failed;
+}
+
+void ICalendarWriter::append(const QByteArray &bytes)
+{
+    // 攒够一块再写，避免每个事件一次系统调用
+    m_buffer += bytes;
+    if (m_buffer.size() >= FLUSH_BYTES) flush();
+}
+
+void ICalendarWriter::appendProperty(const QByteArray &name, const QString &value)
+{
+    append(fold(name + ':' + escapeText(value).toUtf8()));
+}
+
+// ---------------------------------------------------------------- 读入
+
+ICalendarReader::ICalendarReader(QIODevice *in)
+    : m_in(in)
+{
+}
+
+bool ICalendarReader::next(ICalendarEvent &event)
+{
+    event = ICalendarEvent();
+    bool inEvent = false;
+    int nested = 0; // VEVENT 里的 VALARM 等子组件，其属性忽略
+    QString endValue, duration;
+    QStringList endParams;
+
+    QByteArray line;
+    while (nextLine(line)) {
+        const QString text = QString::fromUtf8(line);
+        const qsizetype colon = valueSeparator(text);
+        if (colon < 0) continue;
+        QStringList params = text.left(colon).split(';');
+        const QString name = params.takeFirst().trimmed().toUpper();
+        const QString value = text.mid(colon + 1);
+
+        if (name == "BEGIN") {
+            if (inEvent) {
+                ++nested;
+            } else if (value.trimmed().compare("VEVENT", Qt::CaseInsensitive) == 0) {
+                inEvent = true;
+                event.line = m_line;
+            }
+            continue;
+        }
+        if (!inEvent) continue;
+        if (name == "END") {
+            if (nested > 0) {
+                --nested;
+                continue;
+            }
+            // DTEND 优先，其次 DURATION；结束时间落在别的日子就只保留开始时间
+            if (event.date.isValid() && event.start.isValid()) {
+                QDate endDate;
+                QTime end;
+                if (!endValue.isEmpty() && parseDateTime(endValue, endParams, endDate, end) && endDate == event.date) {
+                    event.end = end;
+                } else if (!duration.isEmpty()) {
+                    const qint64 seconds = parseDuration(duration);
+                    const QDateTime finish = QDateTime(event.date, event.start).addSecs(seconds);
+                    if (seconds > 0 && finish.date() == event.date) event.end = finish.time();
+                }
+            }
+            return true;
+        }
+        if (nested > 0) continue;
+
+        if (name == "UID") {
+            event.uid = value.trimmed();
+        } else if (name == "SUMMARY") {
+            event.summary = unescapeText(value);
+        } else if (name == "DESCRIPTION") {
+            event.description = unescapeText(value);
+        } else if (name == "LOCATION") {
+            event.location = unescapeText(value);
+        } else if (name == "DTSTART") {
+            if (!parseDateTime(value, params, event.date, event.start)) event.date = QDate();
+        } else if (name == "DTEND") {
+            endValue = value;
+            endParams = params;
+        } else if (name == "DURATION") {
+            duration = value;
+        } else if (name == "RRULE") {
+            event.rrule = value.trimmed();
+        } else if (name == "EXDATE") {
+            for (const QString &part : value.split(',', Qt::SkipEmptyParts)) {
+                QDate date;
+                QTime time;
+                if (parseDateTime(part, params, date, time)) event.exdates.insert(date);
+            }
+        }
+    }
+    return false;
+}
+
+bool ICalendarReader::isSupportedRRule(const QString &rrule, const QDate &start)
+{
+    bool hasFreq = false;
+    bool weekly = false;
+    QString byDay;
+    for (const QString &part : rrule.split(';', Qt::SkipEmptyParts)) {
+        const QString key = part.section('=', 0, 0).trimmed().toUpper();
+        const QString value = part.section('=', 1).trimmed().toUpper();
+        if (key == "FREQ") {
+            if (value != "DAILY" && value != "WEEKLY" && value != "MONTHLY") return false;
+            hasFreq = true;
+            weekly = value == "WEEKLY";
+        } else if (key == "BYDAY") {
+            byDay = value;
+        } else if (key != "INTERVAL" && key != "COUNT" && key != "UNTIL" && key != "WKST") {
+            return false;
+        }
+    }
+    if (!byDay.isEmpty() && (!weekly || weekdayFromCode(byDay) != start.dayOfWeek())) return false;
+    return hasFreq;
+}
+
+// 取一条展开折行后的内容行。按字节拼接，折行落在多字节字符中间也能还原
+bool ICalendarReader::nextLine(QByteArray &line)
+{
+    if (!m_hasPending) {
+        if (!readRawLine(m_in, m_pending)) return false;
+        ++m_line;
+    }
+    line = m_pending;
+    m_hasPending = false;
+    QByteArray raw;
+    while (readRawLine(m_in, raw)) {
+        ++m_line;
+        if (raw.startsWith(' ') || raw.startsWith('\t')) {
+            line += raw.mid(1);
+        } else {
+            m_pending = raw;
+            m_hasPending = true;
+            break;
+        }
+    }
+    return true;
+}
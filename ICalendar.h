@@ -0,0 +1,80 @@
+#ifndef ICALENDAR_H
+#define ICALENDAR_H
+
+#include "DatabaseManager.h"
+#include "PersonSchedule.h"
+#include <QByteArray>
+#include <QDate>
+#include <QSet>
+#include <QString>
+#include <QTime>
+
+class QIODevice;
+
+// iCalendar（RFC 5545）的流式读写，只涉及规划器用到的 VEVENT 属性。
+// 写出时逐个 VEVENT 追加到设备，读入时逐个 VEVENT 返回，都不构建整份文档。
+// 时间一律按不带时区的本地时间写出；读入时 UTC 和 TZID 时间会换算成本地时间。
+class ICalendarWriter
+{
+public:
+    explicit ICalendarWriter(QIODevice *out);
+
+    void begin(); // BEGIN:VCALENDAR 和日历属性
+    void end();   // END:VCALENDAR，并把缓冲写出
+
+    // 单个任务，没有开始时间的写成全天事件
+    void writeTask(const DatedTask &item);
+    // task_rules 的一行：一个带 RRULE/EXDATE 的 VEVENT，不展开实例
+    void writeRule(const RecurringTask &recurring);
+    // 一门课：从 termStart 所在周起每周重复 weeks 次，上下课时间取自作息表
+    void writeCourse(const CourseEntry &course, const QDate &termStart, int weeks);
+
+    bool flush();
+    bool failed() const { return m_failed; }
+
+private:
+    void append(const QByteArray &bytes);
+    void appendProperty(const QByteArray &name, const QString &value); // 转义并折行
+
+    QIODevice *m_out;
+    QByteArray m_buffer;
+    QByteArray m_stamp;
+    bool m_failed = false;
+};
+
+// 读到的一个 VEVENT。date 无效表示 DTSTART 缺失或无法解析
+struct ICalendarEvent {
+    QString uid;
+    QString summary;
+    QString description;
+    QString location;
+    QDate date;
+    QTime start;         // 全天事件为无效时间
+    QTime end;           // 没有 DTEND/DURATION 或跨天时为无效时间
+    QString rrule;       // 原样保留，是否支持由调用方判断
+    QSet<QDate> exdates;
+    qint64 line = 0;     // BEGIN:VEVENT 所在行号，用于报错
+};
+
+class ICalendarReader
+{
+public:
+    explicit ICalendarReader(QIODevice *in);
+
+    // 读下一个 VEVENT，到输入末尾返回 false
+    bool next(ICalendarEvent &event);
+
+    // rrule 能否无损转成 RecurrenceRule（FREQ 为 DAILY/WEEKLY/MONTHLY，
+    // 没有 BYxxx 之类改变实例集合的部分；与开始日期同一天的 BYDAY 除外）
+    static bool isSupportedRRule(const QString &rrule, const QDate &start);
+
+private:
+    bool nextLine(QByteArray &line);
+
+    QIODevice *m_in;
+    QByteArray m_pending;
+    bool m_hasPending = false;
+    qint64 m_line = 0;
+};
+
+#endif // ICALENDAR_H
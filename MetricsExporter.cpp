@@ -0,0 +1,121 @@
+#include "MetricsExporter.h"
+#include "MetricsRegistry.h"
+#include <QSettings>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTimer>
+#include <QDebug>
+
+namespace {
+
+constexpr qint64 MAX_REQUEST_HEADER_BYTES = 8 * 1024;
+
+QByteArray httpResponse(const QByteArray &status, const QByteArray &contentType, const QByteArray &body)
+{
+    return "HTTP/1.1 " + status + "\r\n"
+           "Content-Type: " + contentType + "\r\n"
+           "Content-Length: " + QByteArray::number(body.size()) + "\r\n"
+           "Connection: close\r\n\r\n" + body;
+}
+
+} // namespace
+
+MetricsExporter::MetricsExporter(QObject *parent)
+    : QObject(parent)
+    , m_fileTimer(new QTimer(this))
+{
+    connect(m_fileTimer, &QTimer::timeout, this, &MetricsExporter::writeFile);
+}
+
+MetricsExporter::~MetricsExporter()
+{
+    if (!m_filePath.isEmpty()) writeFile();
+}
+
+bool MetricsExporter::startFromSettings()
+{
+    QSettings settings("MyCourseApp", "Metrics");
+    const QString file = qEnvironmentVariable("PLANNER_METRICS_FILE", settings.value("file").toString());
+    const int port = qEnvironmentVariableIsSet("PLANNER_METRICS_PORT")
+                         ? qEnvironmentVariableIntValue("PLANNER_METRICS_PORT")
+                         : settings.value("port", 0).toInt();
+    if (!file.isEmpty()) setFile(file, settings.value("intervalSeconds", 15).toInt());
+    if (port > 0 && port <= 65535) listen(quint16(port));
+    return !m_filePath.isEmpty() || m_server;
+}
+
+bool MetricsExporter::listen(quint16 port)
+{
+    delete m_server;
+    m_server = new QTcpServer(this);
+    connect(m_server, &QTcpServer::newConnection, this, &MetricsExporter::onNewConnection);
+    // 只监听回环地址，指标不对局域网开放
+    if (!m_server->listen(QHostAddress::LocalHost, port)) {
+        qDebug() << "指标端口监听失败：" << m_server->errorString();
+        delete m_server;
+        m_server = nullptr;
+        return false;
+    }
+    qDebug() << "指标地址：http://127.0.0.1:" << m_server->serverPort() << "/metrics";
+    return true;
+}
+
+quint16 MetricsExporter::port() const
+{
+    return m_server ? m_server->serverPort() : 0;
+}
+
+void MetricsExporter::setFile(const QString &path, int intervalSeconds)
+{
+    m_filePath = path;
+    if (path.isEmpty()) {
+        m_fileTimer->stop();
+        return;
+    }
+    m_fileTimer->start(qMax(1, intervalSeconds) * 1000);
+    writeFile();
+}
+
+bool MetricsExporter::writeFile()
+{
+    QString error;
+    if (!MetricsRegistry::instance().writePrometheusFile(m_filePath, &error)) {
+        qDebug() << "写出指标文件失败：" << m_filePath << error;
+        return false;
+    }
+    return true;
+}
+
+void MetricsExporter::onNewConnection()
+{
+    while (QTcpSocket *socket = m_server->nextPendingConnection()) {
+        connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+        connect(socket, &QTcpSocket::readyRead, this, [this, socket] { handleRequest(socket); });
+    }
+}
+
+void MetricsExporter::handleRequest(QTcpSocket *socket)
+{
+    // 只需要请求行，等请求头收完整再回复
+    const QByteArray head = socket->peek(MAX_REQUEST_HEADER_BYTES);
+    if (!head.contains("\r\n\r\n")) {
+        if (head.size() >= MAX_REQUEST_HEADER_BYTES) socket->abort();
+        return;
+    }
+    socket->disconnect(this);
+    const QList<QByteArray> requestLine = head.left(head.indexOf("\r\n")).split(' ');
+    const QByteArray method = requestLine.value(0);
+    const QByteArray path = requestLine.value(1).split('?').value(0);
+
+    if (method != "GET" && method != "HEAD") {
+        socket->write(httpResponse("405 Method Not Allowed", "text/plain", "method not allowed\n"));
+    } else if (path != "/metrics" && path != "/") {
+        socket->write(httpResponse("404 Not Found", "text/plain", "not found\n"));
+    } else {
+        QByteArray response = httpResponse("200 OK", "text/plain; version=0.0.4; charset=utf-8",
+                                           MetricsRegistry::instance().prometheusText());
+        if (method == "HEAD") response.truncate(response.indexOf("\r\n\r\n") + 4);
+        socket->write(response);
+    }
+    socket->disconnectFromHost();
+}
@@ -0,0 +1,41 @@
+#ifndef METRICSEXPORTER_H
+#define METRICSEXPORTER_H
+
+#include <QObject>
+#include <QString>
+
+class QTcpServer;
+class QTcpSocket;
+class QTimer;
+
+// 把 MetricsRegistry 交给外部采集：定期把 Prometheus 文本写到文件（node_exporter textfile 收集器可读），
+// 和/或只在 127.0.0.1 上监听一个端口，GET /metrics 返回同样的内容。
+// 两者默认都关闭；环境变量 PLANNER_METRICS_FILE、PLANNER_METRICS_PORT 优先于
+// QSettings "Metrics" 里的 file、port（以及写文件间隔 intervalSeconds，默认 15 秒）。
+class MetricsExporter : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit MetricsExporter(QObject *parent = nullptr);
+    ~MetricsExporter() override;
+
+    // 按环境变量和设置启动，两者都没配置时返回 false
+    bool startFromSettings();
+
+    bool listen(quint16 port);
+    quint16 port() const;
+    // path 为空时停止写文件；退出时也会再写一次
+    void setFile(const QString &path, int intervalSeconds = 15);
+    bool writeFile();
+
+private:
+    void onNewConnection();
+    void handleRequest(QTcpSocket *socket);
+
+    QTcpServer *m_server = nullptr;
+    QTimer *m_fileTimer;
+    QString m_filePath;
+};
+
+#endif // METRICSEXPORTER_H
@@ -0,0 +1,249 @@
+#include "MetricsRegistry.h"
+#include <QDebug>
+#include <QSaveFile>
+#include <QtAlgorithms>
+#include <cmath>
+
+namespace {
+
+// Prometheus 直方图的 le 档位（秒），覆盖一次查询到一次联网请求的范围
+const double kBucketSeconds[] = {0.0001, 0.00025, 0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025,
+                                 0.05, 0.1, 0.25, 0.5, 1, 2.5, 5, 10, 30, 60};
+
+QString escapeLabelValue(QString value)
+{
+    return value.replace('\\', "\\\\").replace('"', "\\\"").replace('\n', "\\n");
+}
+
+QByteArray withLabels(const QString &name, const QString &labels, const QString &extra = QString())
+{
+    QStringList parts;
+    if (!labels.isEmpty()) parts << labels;
+    if (!extra.isEmpty()) parts << extra;
+    return (parts.isEmpty() ? name : name + '{' + parts.join(',') + '}').toUtf8();
+}
+
+QByteArray number(double value)
+{
+    return QByteArray::number(value, 'g', 12);
+}
+
+} // namespace
+
+void MetricsRegistry::Gauge::add(double delta)
+{
+    double current = m_value.load(std::memory_order_relaxed);
+    while (!m_value.compare_exchange_weak(current, current + delta, std::memory_order_relaxed)) {}
+}
+
+int MetricsRegistry::Histogram::bucketIndex(qint64 micros)
+{
+    if (micros < SUB_BUCKETS) return int(qMax<qint64>(0, micros));
+    const quint64 value = qMin<quint64>(quint64(micros), (quint64(1) << (MAX_EXPONENT + 1)) - 1);
+    const int exponent = 63 - qCountLeadingZeroBits(value);
+    const int shift = exponent - SUB_BUCKET_BITS;
+    return SUB_BUCKETS * (shift + 1) + int(value >> shift) - SUB_BUCKETS;
+}
+
+qint64 MetricsRegistry::Histogram::bucketUpperBound(int index)
+{
+    if (index < SUB_BUCKETS) return index;
+    const int shift = index / SUB_BUCKETS - 1;
+    const qint64 lower = qint64(SUB_BUCKETS + index % SUB_BUCKETS) << shift;
+    return lower + (qint64(1) << shift) - 1;
+}
+
+void MetricsRegistry::Histogram::record(qint64 micros)
+{
+    micros = qMax<qint64>(0, micros);
+    m_buckets[bucketIndex(micros)].fetch_add(1, std::memory_order_relaxed);
+    m_count.fetch_add(1, std::memory_order_relaxed);
+    m_sum.fetch_add(micros, std::memory_order_relaxed);
+    qint64 max = m_max.load(std::memory_order_relaxed);
+    while (micros > max && !m_max.compare_exchange_weak(max, micros, std::memory_order_relaxed)) {}
+}
+
+qint64 MetricsRegistry::Histogram::percentileMicros(double fraction) const
+{
+    const qint64 total = count();
+    if (total == 0) return 0;
+    const qint64 target = qMax<qint64>(1, qint64(std::ceil(total * fraction)));
+    qint64 seen = 0;
+    for (int i = 0; i < BUCKET_COUNT; ++i) {
+        seen += m_buckets[i].load(std::memory_order_relaxed);
+        if (seen >= target) return qMin(maxMicros(), bucketUpperBound(i));
+    }
+    return maxMicros();
+}
+
+qint64 MetricsRegistry::Histogram::countAtOrBelow(qint64 micros) const
+{
+    qint64 total = 0;
+    for (int i = 0; i < BUCKET_COUNT && bucketUpperBound(i) <= micros; ++i) {
+        total += m_buckets[i].load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+MetricsRegistry::MetricsRegistry()
+{
+    // 各模块用到的指标说明，导出时作为 # HELP
+    m_help = {
+        {"planner_db_operation_seconds", "DatabaseManager operation latency by op"},
+        {"planner_db_errors_total", "Failed DatabaseManager operations by op"},
+        {"planner_python_call_seconds", "Round trip of requests to the Python worker by method"},
+        {"planner_python_calls_total", "Python worker requests by method and result"},
+        {"planner_python_start_seconds", "Time to spawn the Python worker process"},
+        {"planner_python_starts_total", "Python worker process starts by result"},
+        {"planner_python_exits_total", "Python worker process exits by result (ok or crash)"},
+        {"planner_python_pending", "Python worker requests in flight"},
+        {"planner_http_request_seconds", "HTTP request latency by host, excluding queueing"},
+        {"planner_http_queue_seconds", "Time HTTP requests waited for a per-host connection slot"},
+        {"planner_http_requests_total", "HTTP requests by host and result"},
+        {"planner_http_received_bytes_total", "HTTP response bytes by host"},
+        {"planner_weather_fetch_seconds", "Weather fetch latency including queueing"},
+        {"planner_weather_replies_total", "Weather lookups by result"},
+        {"planner_chart_rebuild_seconds", "Statistics chart rebuild time by chart"},
+        {"planner_ui_refresh_seconds", "Main window refresh time by view"},
+        {"planner_rpc_request_seconds", "Local JSON-RPC request latency by method"},
+        {"planner_gui_stalls_total", "GUI event loop stalls over the watchdog threshold by action"},
+        {"planner_gui_stall_seconds", "Duration of GUI event loop stalls by action"},
+    };
+}
+
+MetricsRegistry &MetricsRegistry::instance()
+{
+    static MetricsRegistry instance;
+    return instance;
+}
+
+void MetricsRegistry::describe(const QString &name, const QString &help)
+{
+    QMutexLocker locker(&m_mutex);
+    m_help.insert(name, help);
+}
+
+MetricsRegistry::Counter *MetricsRegistry::counter(const QString &name, const Labels &labels)
+{
+    return static_cast<Counter *>(findOrCreate(name, labels, CounterType));
+}
+
+MetricsRegistry::Gauge *MetricsRegistry::gauge(const QString &name, const Labels &labels)
+{
+    return static_cast<Gauge *>(findOrCreate(name, labels, GaugeType));
+}
+
+MetricsRegistry::Histogram *MetricsRegistry::histogram(const QString &name, const Labels &labels)
+{
+    return static_cast<Histogram *>(findOrCreate(name, labels, HistogramType));
+}
+
+void *MetricsRegistry::findOrCreate(const QString &name, const Labels &labels, Type type)
+{
+    const QString key = formatLabels(labels);
+    QMutexLocker locker(&m_mutex);
+    auto family = m_families.find(name);
+    if (family == m_families.end()) {
+        family = m_families.insert(name, Family{type, {}});
+    } else if (family->type != type) {
+        qWarning() << "指标" << name << "已按另一种类型登记，这次的记录不会导出";
+        switch (type) {
+        case CounterType: return &m_strayCounter;
+        case GaugeType: return &m_strayGauge;
+        case HistogramType: return &m_strayHistogram;
+        }
+    }
+    std::shared_ptr<void> &series = family->series[key];
+    if (!series) {
+        switch (type) {
+        case CounterType: series = std::make_shared<Counter>(); break;
+        case GaugeType: series = std::make_shared<Gauge>(); break;
+        case HistogramType: series = std::make_shared<Histogram>(); break;
+        }
+    }
+    return series.get();
+}
+
+QString MetricsRegistry::formatLabels(const Labels &labels)
+{
+    QStringList parts;
+    for (auto it = labels.cbegin(); it != labels.cend(); ++it) {
+        parts << it.key() + "=\"" + escapeLabelValue(it.value()) + '"';
+    }
+    return parts.join(',');
+}
+
+QList<MetricsRegistry::Sample> MetricsRegistry::samples() const
+{
+    QList<Sample> result;
+    QMutexLocker locker(&m_mutex);
+    for (auto family = m_families.cbegin(); family != m_families.cend(); ++family) {
+        for (auto it = family->series.cbegin(); it != family->series.cend(); ++it) {
+            Sample sample;
+            sample.name = family.key();
+            sample.labels = it.key();
+            sample.type = family->type;
+            if (family->type == CounterType) {
+                sample.value = static_cast<const Counter *>(it.value().get())->value();
+            } else if (family->type == GaugeType) {
+                sample.value = static_cast<const Gauge *>(it.value().get())->value();
+            } else {
+                const auto *histogram = static_cast<const Histogram *>(it.value().get());
+                sample.value = histogram->count();
+                sample.p50Micros = histogram->percentileMicros(0.50);
+                sample.p90Micros = histogram->percentileMicros(0.90);
+                sample.p99Micros = histogram->percentileMicros(0.99);
+                sample.maxMicros = histogram->maxMicros();
+                sample.meanMicros = histogram->count() ? double(histogram->sumMicros()) / histogram->count() : 0.0;
+            }
+            result.append(sample);
+        }
+    }
+    return result;
+}
+
+QByteArray MetricsRegistry::prometheusText() const
+{
+    QByteArray out;
+    QMutexLocker locker(&m_mutex);
+    for (auto family = m_families.cbegin(); family != m_families.cend(); ++family) {
+        const QString &name = family.key();
+        const QString help = m_help.value(name);
+        if (!help.isEmpty()) {
+            out += "# HELP " + name.toUtf8() + ' ' + QString(help).replace('\\', "\\\\").replace('\n', "\\n").toUtf8() + '\n';
+        }
+        static const char *const typeNames[] = {"counter", "gauge", "histogram"};
+        out += "# TYPE " + name.toUtf8() + ' ' + typeNames[family->type] + '\n';
+
+        for (auto it = family->series.cbegin(); it != family->series.cend(); ++it) {
+            const QString &labels = it.key();
+            if (family->type == CounterType) {
+                out += withLabels(name, labels) + ' ' + QByteArray::number(static_cast<const Counter *>(it.value().get())->value()) + '\n';
+            } else if (family->type == GaugeType) {
+                out += withLabels(name, labels) + ' ' + number(static_cast<const Gauge *>(it.value().get())->value()) + '\n';
+            } else {
+                const auto *histogram = static_cast<const Histogram *>(it.value().get());
+                for (double seconds : kBucketSeconds) {
+                    const qint64 micros = qint64(std::llround(seconds * 1e6));
+                    out += withLabels(name + "_bucket", labels, "le=\"" + QString::number(seconds) + '"') + ' '
+                           + QByteArray::number(histogram->countAtOrBelow(micros)) + '\n';
+                }
+                out += withLabels(name + "_bucket", labels, "le=\"+Inf\"") + ' ' + QByteArray::number(histogram->count()) + '\n';
+                out += withLabels(name + "_sum", labels) + ' ' + number(histogram->sumMicros() / 1e6) + '\n';
+                out += withLabels(name + "_count", labels) + ' ' + QByteArray::number(histogram->count()) + '\n';
+            }
+        }
+    }
+    return out;
+}
+
+bool MetricsRegistry::writePrometheusFile(const QString &path, QString *error) const
+{
+    // node_exporter 的 textfile 收集器会随时读取，先写临时文件再替换
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly) || file.write(prometheusText()) < 0 || !file.commit()) {
+        if (error) *error = file.errorString();
+        return false;
+    }
+    return true;
+}
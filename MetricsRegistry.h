@@ -0,0 +1,142 @@
+#ifndef METRICSREGISTRY_H
+#define METRICSREGISTRY_H
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QList>
+#include <QMap>
+#include <QMutex>
+#include <QString>
+#include <array>
+#include <atomic>
+#include <memory>
+
+// 进程内的指标登记处：计数器、仪表和延迟直方图，供诊断面板显示，
+// 也可以导出 Prometheus 文本格式（见 MetricsExporter）。
+//
+// counter()/gauge()/histogram() 按名字和标签查找或创建一个序列，返回的指针不为空，在进程结束前一直有效，
+// 热点路径可以把它存在静态变量里。同一个名字已经按另一种类型登记时返回一个不登记、不导出的替身序列。记录数值只用原子操作，任何线程都可以调用。
+// 延迟统一以微秒记录，导出时换算成秒。
+class MetricsRegistry
+{
+public:
+    using Labels = QMap<QString, QString>;
+    enum Type { CounterType, GaugeType, HistogramType };
+
+    class Counter
+    {
+    public:
+        void increment(qint64 delta = 1) { m_value.fetch_add(delta, std::memory_order_relaxed); }
+        qint64 value() const { return m_value.load(std::memory_order_relaxed); }
+
+    private:
+        std::atomic<qint64> m_value{0};
+    };
+
+    class Gauge
+    {
+    public:
+        void set(double value) { m_value.store(value, std::memory_order_relaxed); }
+        void add(double delta);
+        double value() const { return m_value.load(std::memory_order_relaxed); }
+
+    private:
+        std::atomic<double> m_value{0.0};
+    };
+
+    // HDR 风格的对数线性分桶：每个 2 的幂区间再等分 8 份，相对误差不超过 12.5%，
+    // 范围 0 到约 50 天，固定 320 个桶，记录一次是几次原子操作
+    class Histogram
+    {
+    public:
+        static constexpr int SUB_BUCKET_BITS = 3;
+        static constexpr int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+        static constexpr int MAX_EXPONENT = 41;
+        static constexpr int BUCKET_COUNT = SUB_BUCKETS * (MAX_EXPONENT - SUB_BUCKET_BITS + 2);
+
+        void record(qint64 micros);
+        qint64 count() const { return m_count.load(std::memory_order_relaxed); }
+        qint64 sumMicros() const { return m_sum.load(std::memory_order_relaxed); }
+        qint64 maxMicros() const { return m_max.load(std::memory_order_relaxed); }
+        // 第 fraction 分位所在桶的上界（不超过最大值）
+        qint64 percentileMicros(double fraction) const;
+        // 不超过 micros 的记录数（按桶上界计，用于 Prometheus 的 le 桶）
+        qint64 countAtOrBelow(qint64 micros) const;
+
+        static int bucketIndex(qint64 micros);
+        static qint64 bucketUpperBound(int index);
+
+    private:
+        std::array<std::atomic<qint64>, BUCKET_COUNT> m_buckets{};
+        std::atomic<qint64> m_count{0};
+        std::atomic<qint64> m_sum{0};
+        std::atomic<qint64> m_max{0};
+    };
+
+    // 作用域计时，析构时把耗时记进直方图；histogram 为空时什么也不做
+    class ScopedTimer
+    {
+    public:
+        explicit ScopedTimer(Histogram *histogram) : m_histogram(histogram) { m_timer.start(); }
+        ~ScopedTimer()
+        {
+            if (m_histogram) m_histogram->record(m_timer.nsecsElapsed() / 1000);
+        }
+        ScopedTimer(const ScopedTimer &) = delete;
+        ScopedTimer &operator=(const ScopedTimer &) = delete;
+
+    private:
+        Histogram *m_histogram;
+        QElapsedTimer m_timer;
+    };
+
+    // 诊断面板用的一行：一个序列的当前值
+    struct Sample {
+        QString name;
+        QString labels; // 已格式化，如 op="add_task"
+        Type type = CounterType;
+        double value = 0;      // 计数器/仪表的值，直方图为记录数
+        qint64 p50Micros = 0;
+        qint64 p90Micros = 0;
+        qint64 p99Micros = 0;
+        qint64 maxMicros = 0;
+        double meanMicros = 0;
+    };
+
+    static MetricsRegistry &instance();
+
+    // 第一次使用某个名字前可以登记说明，导出时作为 # HELP
+    void describe(const QString &name, const QString &help);
+
+    Counter *counter(const QString &name, const Labels &labels = {});
+    Gauge *gauge(const QString &name, const Labels &labels = {});
+    Histogram *histogram(const QString &name, const Labels &labels = {});
+
+    QList<Sample> samples() const;
+    // Prometheus 文本格式（0.0.4），直方图的 le 桶为固定的秒数档位
+    QByteArray prometheusText() const;
+    bool writePrometheusFile(const QString &path, QString *error = nullptr) const;
+
+private:
+    MetricsRegistry();
+
+    struct Family {
+        Type type = CounterType;
+        // 标签文本 -> 序列；shared_ptr<void> 擦除类型，序列的地址不会变
+        QMap<QString, std::shared_ptr<void>> series;
+    };
+
+    void *findOrCreate(const QString &name, const Labels &labels, Type type);
+    static QString formatLabels(const Labels &labels);
+
+    mutable QMutex m_mutex;
+    QMap<QString, Family> m_families;
+    QHash<QString, QString> m_help;
+
+    // 类型冲突时交给调用方的替身，调用方照常记录，但不出现在 samples() 和导出里
+    Counter m_strayCounter;
+    Gauge m_strayGauge;
+    Histogram m_strayHistogram;
+};
+
+#endif // METRICSREGISTRY_H
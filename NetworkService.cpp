@@ -0,0 +1,167 @@
+#include "NetworkService.h"
+#include "MetricsRegistry.h"
+#include <QCoreApplication>
+#include <QNetworkAccessManager>
+#include <QNetworkDiskCache>
+#include <QNetworkReply>
+#include <QStandardPaths>
+#include <QSettings>
+#include <QDebug>
+
+NetworkService &NetworkService::instance()
+{
+    static NetworkService instance;
+    return instance;
+}
+
+NetworkService::NetworkService(QObject *parent)
+    : QObject(parent)
+    , m_manager(new QNetworkAccessManager(this))
+    , m_diskCache(new QNetworkDiskCache(this))
+{
+    m_clock.start();
+
+    QSettings settings("MyCourseApp", "Network");
+    m_maxPerHost = qMax(1, settings.value("maxConnectionsPerHost", m_maxPerHost).toInt());
+    const qint64 cacheMb = settings.value("diskCacheMB", 50).toLongLong();
+
+    m_diskCache->setCacheDirectory(
+        QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/http");
+    m_diskCache->setMaximumCacheSize(cacheMb * 1024 * 1024);
+    m_manager->setCache(m_diskCache); // 缓存归 manager 所有
+    m_manager->setAutoDeleteReplies(false);
+
+    // 单例是静态对象，比 QApplication 活得久；QNAM 和磁盘缓存要在应用退出前释放
+    if (QCoreApplication *app = QCoreApplication::instance()) {
+        connect(app, &QCoreApplication::aboutToQuit, this, &NetworkService::shutdown);
+    }
+}
+
+void NetworkService::shutdown()
+{
+    if (!m_manager) return;
+    m_queued.clear();
+    m_active.clear();
+    // 进行中的请求直接放弃，不再回调发起方
+    const QList<QNetworkReply *> replies = m_manager->findChildren<QNetworkReply *>();
+    for (QNetworkReply *reply : replies) {
+        disconnect(reply, nullptr, this, nullptr);
+        reply->abort();
+    }
+    delete m_manager; // 连同磁盘缓存和未释放的 reply
+    m_manager = nullptr;
+    m_diskCache = nullptr;
+}
+
+void NetworkService::setMaxConnectionsPerHost(int count)
+{
+    m_maxPerHost = qMax(1, count);
+    // 上限调大后把排队的请求放出来
+    const QStringList hosts = m_queued.keys();
+    for (const QString &host : hosts) {
+        startNext(host);
+    }
+}
+
+void NetworkService::get(const QNetworkRequest &request, QObject *context, Callback onFinished)
+{
+    // 退出阶段不再发起请求
+    if (!m_manager) return;
+
+    Pending pending;
+    pending.request = request;
+    pending.context = context;
+    pending.callback = std::move(onFinished);
+    pending.queuedAtMs = m_clock.elapsed();
+
+    const QString host = request.url().host();
+    if (m_active.value(host) < m_maxPerHost) {
+        start(std::move(pending));
+    } else {
+        m_queued[host].enqueue(std::move(pending));
+    }
+}
+
+void NetworkService::start(Pending pending)
+{
+    const QString host = pending.request.url().host();
+    ++m_active[host];
+
+    QNetworkRequest request = pending.request;
+    // HTTPS 下通过 ALPN 协商，服务器不支持时自动退回 HTTP/1.1
+    request.setAttribute(QNetworkRequest::Http2AllowedAttribute, true);
+
+    const qint64 startedAtMs = m_clock.elapsed();
+    m_metrics[host].totalQueueMs += startedAtMs - pending.queuedAtMs;
+    MetricsRegistry::instance().histogram("planner_http_queue_seconds", {{"host", host}})
+        ->record((startedAtMs - pending.queuedAtMs) * 1000);
+
+    QNetworkReply *reply = m_manager->get(request);
+    connect(reply, &QNetworkReply::finished, this, [this, reply, pending, startedAtMs]() {
+        onReplyFinished(reply, pending, startedAtMs);
+    });
+}
+
+void NetworkService::onReplyFinished(QNetworkReply *reply, const Pending &pending, qint64 startedAtMs)
+{
+    const QString host = pending.request.url().host();
+    const qint64 latencyMs = m_clock.elapsed() - startedAtMs;
+    const bool fromCache = reply->attribute(QNetworkRequest::SourceIsFromCacheAttribute).toBool();
+    const bool ok = reply->error() == QNetworkReply::NoError;
+    const qint64 bytes = reply->bytesAvailable();
+
+    HostMetrics &m = m_metrics[host];
+    ++m.requests;
+    if (!ok) ++m.failures;
+    if (fromCache) ++m.cacheHits;
+    m.bytesReceived += bytes;
+    m.totalLatencyMs += latencyMs;
+    m.maxLatencyMs = qMax(m.maxLatencyMs, latencyMs);
+    emit requestFinished(host, latencyMs, bytes, fromCache, ok);
+
+    // 同样的数据也进全局指标，供诊断面板和 Prometheus 导出（毫秒精度）
+    MetricsRegistry &metrics = MetricsRegistry::instance();
+    metrics.histogram("planner_http_request_seconds", {{"host", host}})->record(latencyMs * 1000);
+    metrics.counter("planner_http_requests_total", {{"host", host}, {"result", !ok ? "error" : fromCache ? "cache" : "ok"}})
+        ->increment();
+    metrics.counter("planner_http_received_bytes_total", {{"host", host}})->increment(bytes);
+
+    if (pending.context && pending.callback) {
+        pending.callback(reply);
+    }
+    reply->deleteLater();
+
+    if (--m_active[host] <= 0) m_active.remove(host);
+    startNext(host);
+}
+
+void NetworkService::startNext(const QString &host)
+{
+    auto queue = m_queued.find(host);
+    while (queue != m_queued.end() && !queue->isEmpty() && m_active.value(host) < m_maxPerHost) {
+        Pending next = queue->dequeue();
+        // 发起方已经没了，不必再发
+        if (!next.context) continue;
+        start(std::move(next));
+        queue = m_queued.find(host);
+    }
+    if (queue != m_queued.end() && queue->isEmpty()) m_queued.erase(queue);
+}
+
+QString NetworkService::metricsReport() const
+{
+    QStringList lines;
+    for (auto it = m_metrics.constBegin(); it != m_metrics.constEnd(); ++it) {
+        const HostMetrics &m = it.value();
+        lines << QString("%1: 请求 %2，失败 %3，缓存命中 %4，接收 %5 KB，平均 %6 ms，最长 %7 ms，排队 %8 ms")
+                     .arg(it.key())
+                     .arg(m.requests)
+                     .arg(m.failures)
+                     .arg(m.cacheHits)
+                     .arg(m.bytesReceived / 1024.0, 0, 'f', 1)
+                     .arg(m.averageLatencyMs())
+                     .arg(m.maxLatencyMs)
+                     .arg(m.totalQueueMs);
+    }
+    return lines.join('\n');
+}
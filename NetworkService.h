@@ -0,0 +1,81 @@
+#ifndef NETWORKSERVICE_H
+#define NETWORKSERVICE_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QNetworkRequest>
+#include <QPointer>
+#include <QQueue>
+#include <functional>
+
+class QNetworkAccessManager;
+class QNetworkDiskCache;
+class QNetworkReply;
+
+// 全应用共用的网络层：一个 QNetworkAccessManager（连接、DNS、TLS 会话都能复用），
+// 带磁盘缓存，允许 HTTP/2；同一主机的并发请求数有上限，超出的排队。
+// 每个主机记录请求数、失败数、缓存命中、流量和耗时。
+class NetworkService : public QObject
+{
+    Q_OBJECT
+
+public:
+    using Callback = std::function<void(QNetworkReply *reply)>;
+
+    struct HostMetrics {
+        int requests = 0;
+        int failures = 0;
+        int cacheHits = 0;
+        qint64 bytesReceived = 0;
+        qint64 totalLatencyMs = 0; // 从发出到完成，不含排队
+        qint64 maxLatencyMs = 0;
+        qint64 totalQueueMs = 0;   // 因并发上限排队的时间
+
+        qint64 averageLatencyMs() const { return requests ? totalLatencyMs / requests : 0; }
+    };
+
+    static NetworkService &instance();
+
+    // 发起 GET。完成后调用 onFinished，回调返回后 reply 自动释放；
+    // context 用来跟踪发起方的生命周期，已销毁时不再回调（排队中的请求直接丢弃）。
+    void get(const QNetworkRequest &request, QObject *context, Callback onFinished);
+
+    void setMaxConnectionsPerHost(int count);
+    int maxConnectionsPerHost() const { return m_maxPerHost; }
+
+    // 中止进行中的请求并释放 QNAM 和磁盘缓存，在 aboutToQuit 时自动调用；之后的 get() 直接忽略
+    void shutdown();
+
+    QNetworkAccessManager *manager() const { return m_manager; } // shutdown() 之后为 nullptr
+    QHash<QString, HostMetrics> metrics() const { return m_metrics; }
+    QString metricsReport() const;
+
+signals:
+    void requestFinished(const QString &host, qint64 latencyMs, qint64 bytes, bool fromCache, bool ok);
+
+private:
+    explicit NetworkService(QObject *parent = nullptr);
+
+    struct Pending {
+        QNetworkRequest request;
+        QPointer<QObject> context;
+        Callback callback;
+        qint64 queuedAtMs = 0;
+    };
+
+    void start(Pending pending);
+    void startNext(const QString &host);
+    void onReplyFinished(QNetworkReply *reply, const Pending &pending, qint64 startedAtMs);
+
+    QNetworkAccessManager *m_manager;
+    QNetworkDiskCache *m_diskCache;
+    int m_maxPerHost = 4;
+    QElapsedTimer m_clock;
+
+    QHash<QString, int> m_active;            // 主机 -> 正在进行的请求数
+    QHash<QString, QQueue<Pending>> m_queued; // 主机 -> 等待中的请求
+    QHash<QString, HostMetrics> m_metrics;
+};
+
+#endif // NETWORKSERVICE_H
@@ -0,0 +1,72 @@
+#ifndef PERSONSCHEDULE_H
+#define PERSONSCHEDULE_H
+
+#include <QDateTime>
+#include <QJsonObject>
+#include <QList>
+#include <QString>
+#include <bitset>
+
+// 一周 7 天 × 每天 12 节，第 day 天（0=周一）第 period 节（0 起）对应第 day*12+period 位
+constexpr int SCHEDULE_DAYS = 7;
+constexpr int SCHEDULE_PERIODS = 12;
+constexpr int SCHEDULE_SLOTS = SCHEDULE_DAYS * SCHEDULE_PERIODS;
+using WeekMask = std::bitset<SCHEDULE_SLOTS>;
+
+constexpr int slotIndex(int day, int period) { return day * SCHEDULE_PERIODS + period; }
+
+// 课表中的一门课，字段与 scraper.py 输出的 JSON 一致（day、start_period 从 1 开始）
+struct CourseEntry {
+    QString name;
+    QString classroom;
+    QString teacher;
+    int day = 0;
+    int startPeriod = 0;
+    int periods = 1;
+    QString color;
+    QString rawText;
+
+    QJsonObject toJson() const
+    {
+        return QJsonObject{{"name", name}, {"classroom", classroom}, {"teacher", teacher},
+                           {"day", day}, {"start_period", startPeriod}, {"periods", periods},
+                           {"color", color}, {"raw_text", rawText}};
+    }
+
+    static CourseEntry fromJson(const QJsonObject &obj)
+    {
+        CourseEntry c;
+        c.name = obj.value("name").toString();
+        c.classroom = obj.value("classroom").toString();
+        c.teacher = obj.value("teacher").toString();
+        c.day = obj.value("day").toInt();
+        c.startPeriod = obj.value("start_period").toInt();
+        c.periods = obj.value("periods").toInt(1);
+        c.color = obj.value("color").toString();
+        c.rawText = obj.value("raw_text").toString();
+        return c;
+    }
+};
+
+// 一个人的课表：课程列表和由它算出的“有课”位图
+struct PersonSchedule {
+    QString name;        // 默认取文件相对拖入目录的路径（不含扩展名）
+    QString sourcePath;
+    QDateTime importedAt;
+    QList<CourseEntry> courses;
+    WeekMask busy;
+
+    void rebuildMask()
+    {
+        busy.reset();
+        for (const CourseEntry &c : courses) {
+            const int day = c.day - 1;
+            if (day < 0 || day >= SCHEDULE_DAYS) continue;
+            for (int p = c.startPeriod - 1; p < c.startPeriod - 1 + c.periods; ++p) {
+                if (p >= 0 && p < SCHEDULE_PERIODS) busy.set(slotIndex(day, p));
+            }
+        }
+    }
+};
+
+#endif // PERSONSCHEDULE_H
@@ -0,0 +1,456 @@
+#include "PlannerRpcServer.h"
+#include "DatabaseManager.h"
+#include "DeltaSync.h"
+#include "MetricsRegistry.h"
+#include "StallWatchdog.h"
+#include "TaskTransfer.h"
+#include <QJsonDocument>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QSettings>
+#include <QTimer>
+#include <QDebug>
+#include <cmath>
+
+namespace {
+
+constexpr qint64 MAX_REQUEST_BYTES = 1024 * 1024;  // 单行请求上限，也是套接字读缓冲的大小
+constexpr qint64 HIGH_WATER_BYTES = 4 * 1024 * 1024; // 待发送超过这个数就暂停读这个连接
+constexpr qint64 LOW_WATER_BYTES = 1024 * 1024;      // 降到这个数以下再继续
+constexpr int REQUESTS_PER_TURN = 64;                 // 每个连接每轮事件循环最多处理的请求行数
+constexpr int MAX_LIST_DAYS = 366;
+constexpr int MAX_SYNC_PAGE = 5000;
+constexpr int STALE_PROBE_MS = 500;                   // 判断同名套接字是否还有人在监听的连接超时
+
+// JSON-RPC 2.0 错误码
+constexpr int PARSE_ERROR = -32700;
+constexpr int INVALID_REQUEST = -32600;
+constexpr int METHOD_NOT_FOUND = -32601;
+constexpr int INVALID_PARAMS = -32602;
+constexpr int SERVER_ERROR = -32000;
+
+QJsonObject errorResponse(const QJsonValue &id, int code, const QString &message)
+{
+    return QJsonObject{{"jsonrpc", "2.0"}, {"id", id},
+                       {"error", QJsonObject{{"code", code}, {"message", message}}}};
+}
+
+QJsonObject resultResponse(const QJsonValue &id, const QJsonValue &result)
+{
+    return QJsonObject{{"jsonrpc", "2.0"}, {"id", id}, {"result", result}};
+}
+
+bool isWriteMethod(const QString &method)
+{
+    return method == "tasks.add" || method == "tasks.update" || method == "tasks.delete";
+}
+
+// 请求对象的合法性：jsonrpc 为 "2.0"，method 为字符串，params 省略或为对象
+bool validRequest(const QJsonObject &request)
+{
+    return request.value("jsonrpc").toString() == "2.0" && request.value("method").isString()
+           && (!request.contains("params") || request.value("params").isObject());
+}
+
+QJsonArray taskList(const QList<DatedTask> &tasks)
+{
+    QJsonArray array;
+    for (const DatedTask &item : tasks) array.append(TaskTransfer::toJson(item));
+    return array;
+}
+
+} // namespace
+
+void PlannerRpcServer::MethodStats::record(qint64 micros, bool failed)
+{
+    ++calls;
+    if (failed) ++errors;
+    totalMicros += micros;
+    maxMicros = qMax(maxMicros, micros);
+    int bucket = 0;
+    while (bucket + 1 < int(buckets.size()) && (qint64(1) << (bucket + 1)) <= micros) ++bucket;
+    ++buckets[bucket];
+}
+
+qint64 PlannerRpcServer::MethodStats::percentileMicros(double fraction) const
+{
+    if (calls == 0) return 0;
+    const qint64 target = qMax<qint64>(1, qint64(std::ceil(calls * fraction)));
+    qint64 seen = 0;
+    for (int i = 0; i < int(buckets.size()); ++i) {
+        seen += buckets[i];
+        if (seen >= target) return qMin(maxMicros, (qint64(1) << (i + 1)) - 1);
+    }
+    return maxMicros;
+}
+
+PlannerRpcServer::PlannerRpcServer(QObject *parent)
+    : QObject(parent)
+{
+}
+
+PlannerRpcServer::~PlannerRpcServer()
+{
+    stop();
+}
+
+bool PlannerRpcServer::enabledInSettings()
+{
+    if (qEnvironmentVariableIsSet("PLANNER_RPC_SERVER")) {
+        return !qEnvironmentVariableIsEmpty("PLANNER_RPC_SERVER");
+    }
+    QSettings settings("MyCourseApp", "RpcServer");
+    return settings.value("enabled", false).toBool();
+}
+
+QString PlannerRpcServer::defaultName()
+{
+    const QString env = qEnvironmentVariable("PLANNER_RPC_SERVER");
+    if (!env.isEmpty() && env != "1") return env;
+    QSettings settings("MyCourseApp", "RpcServer");
+    return settings.value("name", "planner-rpc").toString();
+}
+
+bool PlannerRpcServer::start(const QString &name)
+{
+    stop();
+    m_server = new QLocalServer(this);
+    m_server->setSocketOptions(QLocalServer::UserAccessOption); // 只允许当前用户连接
+    connect(m_server, &QLocalServer::newConnection, this, &PlannerRpcServer::onNewConnection);
+    bool listening = m_server->listen(name);
+    if (!listening && m_server->serverError() == QAbstractSocket::AddressInUseError) {
+        // 名字被占用时先试着连一下：连得上说明另一个实例正在服务，不能抢走它的套接字；
+        // 连不上才是上次异常退出留下的套接字文件，清掉再试一次
+        QLocalSocket probe;
+        probe.connectToServer(name);
+        if (probe.waitForConnected(STALE_PROBE_MS)) {
+            probe.abort();
+            qDebug() << "RPC 服务启动失败：" << name << "已有其他实例在监听";
+            delete m_server;
+            m_server = nullptr;
+            return false;
+        }
+        QLocalServer::removeServer(name);
+        listening = m_server->listen(name);
+    }
+    if (!listening) {
+        qDebug() << "RPC 服务启动失败：" << m_server->errorString();
+        delete m_server;
+        m_server = nullptr;
+        return false;
+    }
+    qDebug() << "RPC 服务已启动：" << m_server->fullServerName();
+    return true;
+}
+
+void PlannerRpcServer::stop()
+{
+    for (Connection *connection : std::as_const(m_connections)) {
+        connection->socket->disconnect(this);
+        connection->socket->abort();
+        connection->socket->deleteLater();
+        delete connection;
+    }
+    m_connections.clear();
+    if (m_server) {
+        m_server->close();
+        delete m_server;
+        m_server = nullptr;
+    }
+}
+
+bool PlannerRpcServer::isListening() const
+{
+    return m_server && m_server->isListening();
+}
+
+QString PlannerRpcServer::serverName() const
+{
+    return m_server ? m_server->fullServerName() : QString();
+}
+
+QJsonObject PlannerRpcServer::statsJson() const
+{
+    QJsonObject methods;
+    for (auto it = m_stats.cbegin(); it != m_stats.cend(); ++it) {
+        const MethodStats &s = it.value();
+        methods.insert(it.key(), QJsonObject{
+            {"calls", s.calls},
+            {"errors", s.errors},
+            {"mean_us", s.calls ? double(s.totalMicros) / s.calls : 0.0},
+            {"p50_us", s.percentileMicros(0.50)},
+            {"p99_us", s.percentileMicros(0.99)},
+            {"max_us", s.maxMicros},
+        });
+    }
+    return QJsonObject{{"connections", m_connections.size()}, {"methods", methods}};
+}
+
+void PlannerRpcServer::onNewConnection()
+{
+    while (QLocalSocket *socket = m_server->nextPendingConnection()) {
+        // 读缓冲有上限：处理不过来时 Qt 不再从系统读数据，对端的写入自然被阻塞
+        socket->setReadBufferSize(MAX_REQUEST_BYTES);
+        auto *connection = new Connection;
+        connection->socket = socket;
+        m_connections.insert(socket, connection);
+
+        connect(socket, &QLocalSocket::readyRead, this, [this, connection] { scheduleProcessing(connection); });
+        connect(socket, &QLocalSocket::bytesWritten, this, [this, connection] {
+            if (connection->socket->bytesToWrite() < LOW_WATER_BYTES) scheduleProcessing(connection);
+        });
+        connect(socket, &QLocalSocket::disconnected, this, [this, socket] {
+            delete m_connections.take(socket);
+            socket->deleteLater();
+        });
+    }
+}
+
+void PlannerRpcServer::scheduleProcessing(Connection *connection)
+{
+    if (connection->scheduled) return;
+    connection->scheduled = true;
+    QTimer::singleShot(0, this, [this, socket = connection->socket] {
+        // 等待期间连接可能已经断开
+        if (Connection *c = m_connections.value(socket)) {
+            c->scheduled = false;
+            processConnection(c);
+        }
+    });
+}
+
+void PlannerRpcServer::processConnection(Connection *connection)
+{
+    QLocalSocket *socket = connection->socket;
+    int handled = 0;
+    while (handled < REQUESTS_PER_TURN && socket->canReadLine()) {
+        if (socket->bytesToWrite() > HIGH_WATER_BYTES) {
+            break; // 背压：等 bytesWritten 把积压降下来再继续
+        }
+        const QByteArray line = socket->readLine(MAX_REQUEST_BYTES + 1).trimmed();
+        ++handled;
+        if (line.isEmpty()) continue;
+        const QByteArray response = handleLine(line);
+        if (!response.isEmpty()) socket->write(response + '\n');
+    }
+    emitChanges();
+
+    if (!socket->canReadLine() && socket->bytesAvailable() >= MAX_REQUEST_BYTES) {
+        socket->write(QJsonDocument(errorResponse(QJsonValue(), INVALID_REQUEST, "请求过长")).toJson(QJsonDocument::Compact) + '\n');
+        socket->disconnectFromServer();
+        return;
+    }
+    // 还有没处理完的请求：让出事件循环，界面不会被一个连接拖住
+    if (socket->canReadLine() && socket->bytesToWrite() <= HIGH_WATER_BYTES) {
+        scheduleProcessing(connection);
+    }
+}
+
+QByteArray PlannerRpcServer::handleLine(const QByteArray &line)
+{
+    QJsonParseError parseError;
+    const QJsonDocument doc = QJsonDocument::fromJson(line, &parseError);
+    if (parseError.error != QJsonParseError::NoError) {
+        return QJsonDocument(errorResponse(QJsonValue(), PARSE_ERROR, parseError.errorString())).toJson(QJsonDocument::Compact);
+    }
+    if (doc.isArray()) {
+        if (doc.array().isEmpty()) {
+            return QJsonDocument(errorResponse(QJsonValue(), INVALID_REQUEST, "空的批量请求")).toJson(QJsonDocument::Compact);
+        }
+        const QJsonArray responses = handleBatch(doc.array());
+        return responses.isEmpty() ? QByteArray() : QJsonDocument(responses).toJson(QJsonDocument::Compact);
+    }
+    const QJsonValue response = handleRequest(doc.object());
+    return response.isObject() ? QJsonDocument(response.toObject()).toJson(QJsonDocument::Compact) : QByteArray();
+}
+
+QJsonArray PlannerRpcServer::handleBatch(const QJsonArray &requests)
+{
+    QJsonArray responses;
+    qsizetype i = 0;
+    while (i < requests.size()) {
+        // 连续的 tasks.add 攒成一组，一个事务写入
+        QList<QJsonObject> adds;
+        QList<DatedTask> tasks;
+        while (i < requests.size()) {
+            const QJsonObject request = requests.at(i).toObject();
+            if (!validRequest(request) || request.value("method").toString() != "tasks.add") break;
+            const DatedTask item = TaskTransfer::fromJson(request.value("params").toObject());
+            if (!item.date.isValid() || item.task.getTitle().trimmed().isEmpty()) break; // 交给单条路径报错
+            adds.append(request);
+            tasks.append(item);
+            ++i;
+        }
+        if (adds.size() > 1) {
+            QElapsedTimer timer;
+            timer.start();
+            const bool ok = DatabaseManager::instance().addDailyTasks(tasks);
+            const qint64 perCall = timer.nsecsElapsed() / 1000 / adds.size();
+            for (qsizetype k = 0; k < adds.size(); ++k) {
+                recordCall("tasks.add", perCall, !ok);
+                if (!adds.at(k).contains("id")) continue; // 通知不需要响应
+                const QJsonValue id = adds.at(k).value("id");
+                responses.append(ok ? resultResponse(id, QJsonObject{{"id", tasks.at(k).task.getId()}})
+                                    : errorResponse(id, SERVER_ERROR, "写入数据库失败"));
+            }
+            m_tasksDirty = m_tasksDirty || ok;
+            continue;
+        }
+        if (adds.size() == 1) --i; // 只有一条时走普通路径
+
+        const QJsonValue response = handleRequest(requests.at(i));
+        if (response.isObject()) responses.append(response);
+        ++i;
+    }
+    return responses;
+}
+
+QJsonValue PlannerRpcServer::handleRequest(const QJsonValue &value)
+{
+    StallWatchdog::Operation tag("rpc-request");
+    const QJsonObject request = value.toObject();
+    const QJsonValue id = request.value("id");
+    if (!value.isObject() || !validRequest(request)) {
+        return errorResponse(id.isUndefined() ? QJsonValue() : id, INVALID_REQUEST, "不是有效的 JSON-RPC 2.0 请求");
+    }
+
+    const QString method = request.value("method").toString();
+    int errorCode = 0;
+    QString errorMessage;
+    QElapsedTimer timer;
+    timer.start();
+    const QJsonValue result = invoke(method, request.value("params").toObject(), errorCode, errorMessage);
+    recordCall(errorCode == METHOD_NOT_FOUND ? QString("(unknown)") : method, timer.nsecsElapsed() / 1000, errorCode != 0);
+
+    if (errorCode == 0 && isWriteMethod(method)) m_tasksDirty = true;
+    if (errorCode == 0 && method == "study.add") m_studyDirty = true;
+    if (errorCode == 0 && method == "sync.apply") m_tasksDirty = m_studyDirty = true;
+    if (!request.contains("id")) return QJsonValue(); // 通知
+    return errorCode ? errorResponse(id, errorCode, errorMessage) : resultResponse(id, result);
+}
+
+QJsonValue PlannerRpcServer::invoke(const QString &method, const QJsonObject &params, int &errorCode, QString &errorMessage)
+{
+    DatabaseManager &db = DatabaseManager::instance();
+    auto fail = [&](int code, const QString &message) {
+        errorCode = code;
+        errorMessage = message;
+        return QJsonValue();
+    };
+
+    if (method == "ping") {
+        return "pong";
+    }
+    if (method == "server.stats") {
+        return statsJson();
+    }
+    if (method == "tasks.add") {
+        DatedTask item = TaskTransfer::fromJson(params);
+        if (!item.date.isValid()) return fail(INVALID_PARAMS, "date 无效");
+        if (item.task.getTitle().trimmed().isEmpty()) return fail(INVALID_PARAMS, "title 为空");
+        if (!db.addDailyTask(item.date, item.task)) return fail(SERVER_ERROR, "写入数据库失败");
+        return QJsonObject{{"id", item.task.getId()}};
+    }
+    if (method == "tasks.get" || method == "tasks.update" || method == "tasks.delete") {
+        const int id = params.value("id").toInt(-1);
+        DatedTask item;
+        if (id < 0 || !db.getTaskById(id, item)) return fail(INVALID_PARAMS, "任务不存在");
+        if (method == "tasks.get") return TaskTransfer::toJson(item);
+        if (method == "tasks.delete") {
+            return db.deleteTaskById(id) ? QJsonValue(true) : fail(SERVER_ERROR, "删除失败");
+        }
+        // 只改请求里给出的字段；日期不能修改
+        QJsonObject merged = TaskTransfer::toJson(item);
+        for (const QString &key : {"title", "start_time", "end_time", "note"}) {
+            if (params.contains(key)) merged.insert(key, params.value(key));
+        }
+        const DatedTask updated = TaskTransfer::fromJson(merged);
+        if (updated.task.getTitle().trimmed().isEmpty()) return fail(INVALID_PARAMS, "title 为空");
+        return db.updateTaskById(id, updated.task) ? QJsonValue(true) : fail(SERVER_ERROR, "更新失败");
+    }
+    if (method == "tasks.list") {
+        const QDate from = QDate::fromString(params.value("from").toString(), Qt::ISODate);
+        const QDate to = QDate::fromString(params.value("to").toString(), Qt::ISODate);
+        if (!from.isValid() || !to.isValid() || to < from) return fail(INVALID_PARAMS, "from/to 无效");
+        if (from.daysTo(to) >= MAX_LIST_DAYS) return fail(INVALID_PARAMS, "区间不能超过一年");
+        return taskList(db.getTasksBetween(from, to));
+    }
+    if (method == "tasks.search") {
+        const QString text = params.value("text").toString();
+        if (text.trimmed().isEmpty()) return fail(INVALID_PARAMS, "text 为空");
+        return taskList(db.searchTasks(text, qBound(1, params.value("limit").toInt(50), 500)));
+    }
+    if (method == "study.add") {
+        const QDateTime start = QDateTime::fromString(params.value("start").toString(), Qt::ISODate);
+        const QDateTime end = QDateTime::fromString(params.value("end").toString(), Qt::ISODate);
+        if (!start.isValid() || !end.isValid() || end <= start) return fail(INVALID_PARAMS, "start/end 无效");
+        if (!db.addStudySession(start, end, int(start.secsTo(end)), params.value("tag").toString())) {
+            return fail(SERVER_ERROR, "写入数据库失败");
+        }
+        return true;
+    }
+    if (method == "study.totals") {
+        // 按天（可限定 from/to）或按标签汇总，单位秒
+        QJsonObject totals;
+        if (params.value("by").toString("day") == "tag") {
+            const QMap<QString, int> byTag = db.getStudyDurationsByTag();
+            for (auto it = byTag.cbegin(); it != byTag.cend(); ++it) totals.insert(it.key(), it.value());
+            return totals;
+        }
+        const QDate from = QDate::fromString(params.value("from").toString(), Qt::ISODate);
+        const QDate to = QDate::fromString(params.value("to").toString(), Qt::ISODate);
+        const QMap<QDate, int> daily = db.getDailyStudyDurations();
+        for (auto it = daily.cbegin(); it != daily.cend(); ++it) {
+            if ((from.isValid() && it.key() < from) || (to.isValid() && it.key() > to)) continue;
+            totals.insert(it.key().toString(Qt::ISODate), it.value());
+        }
+        return totals;
+    }
+    if (method == "sync.seen") {
+        // 本机的设备 id，以及见过对方设备的哪个序号（对方从这里之后推送）
+        const QString device = params.value("device").toString();
+        if (device.isEmpty()) return fail(INVALID_PARAMS, "device 为空");
+        return QJsonObject{{"device", db.deviceId()}, {"seen", db.syncValue(QString("peer:%1:seen").arg(device))}};
+    }
+    if (method == "sync.changes") {
+        if (!db.isChangeLogAvailable()) return fail(SERVER_ERROR, "变更日志不可用");
+        QJsonArray changes;
+        for (const ChangeLogEntry &entry : db.getChangesSince(params.value("since").toInteger(),
+                                                              qBound(1, params.value("limit").toInt(1000), MAX_SYNC_PAGE))) {
+            changes.append(DeltaSync::toJson(entry));
+        }
+        return QJsonObject{{"device", db.deviceId()}, {"changes", changes}};
+    }
+    if (method == "sync.apply") {
+        const QString device = params.value("device").toString();
+        const QJsonArray changes = params.value("changes").toArray();
+        if (device.isEmpty() || device == db.deviceId()) return fail(INVALID_PARAMS, "device 无效");
+        if (changes.size() > MAX_SYNC_PAGE) return fail(INVALID_PARAMS, "一次最多 5000 条变更");
+        QList<ChangeLogEntry> entries;
+        for (const QJsonValue &value : changes) entries.append(DeltaSync::fromJson(value.toObject()));
+        SyncApplyResult result;
+        if (!db.applyRemoteChanges(device, entries, &result)) return fail(SERVER_ERROR, "合并变更失败");
+        return QJsonObject{{"applied", result.applied}, {"conflicts", result.conflicts},
+                           {"duplicates", result.duplicates},
+                           {"seen", db.syncValue(QString("peer:%1:seen").arg(device))}};
+    }
+    return fail(METHOD_NOT_FOUND, "未知方法：" + method);
+}
+
+void PlannerRpcServer::recordCall(const QString &method, qint64 micros, bool failed)
+{
+    m_stats[method].record(micros, failed);
+    MetricsRegistry::instance().histogram("planner_rpc_request_seconds", {{"method", method}})->record(micros);
+}
+
+void PlannerRpcServer::emitChanges()
+{
+    if (m_tasksDirty) {
+        m_tasksDirty = false;
+        emit tasksChanged();
+    }
+    if (m_studyDirty) {
+        m_studyDirty = false;
+        emit studySessionsChanged();
+    }
+}
@@ -0,0 +1,88 @@
+#ifndef PLANNERRPCSERVER_H
+#define PLANNERRPCSERVER_H
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QObject>
+#include <array>
+
+class QLocalServer;
+class QLocalSocket;
+
+// 进程内的本地 JSON-RPC 2.0 服务（QLocalServer），让脚本在界面打开时也能读写数据，
+// 所有请求都在主线程上经同一个 DatabaseManager 连接执行，不会和界面抢 tasks.db 的锁。
+//
+// 协议：每行一个 JSON-RPC 请求对象或批量数组，响应同样每行一个，按请求顺序返回。
+// 客户端可以不等响应连续发送（流水线）；服务端每轮事件循环最多处理一小批请求，
+// 某个连接待发送的数据过多时暂停读取它的请求，等对方读走响应后再继续（背压）。
+// 同一批量数组里连续的 tasks.add 合并成一个事务写入。
+//
+// 方法：ping、tasks.add、tasks.get、tasks.list、tasks.update、tasks.delete、tasks.search、
+//       study.add、study.totals、server.stats，
+//       以及增量同步用的 sync.seen、sync.changes、sync.apply（见 DeltaSync.h）
+class PlannerRpcServer : public QObject
+{
+    Q_OBJECT
+
+public:
+    // 单个方法的调用统计，延迟按 2 的幂分桶（第 i 桶为 [2^i, 2^(i+1)) 微秒）
+    struct MethodStats {
+        qint64 calls = 0;
+        qint64 errors = 0;
+        qint64 totalMicros = 0;
+        qint64 maxMicros = 0;
+        std::array<qint64, 32> buckets{};
+
+        void record(qint64 micros, bool failed);
+        qint64 percentileMicros(double fraction) const; // 所在桶的上界
+    };
+
+    explicit PlannerRpcServer(QObject *parent = nullptr);
+    ~PlannerRpcServer() override;
+
+    // 是否随应用启动：环境变量 PLANNER_RPC_SERVER 非空时启用，其值不是 "1" 时作为服务名；
+    // 否则看 QSettings "RpcServer"/"enabled"（默认关闭）
+    static bool enabledInSettings();
+    static QString defaultName(); // "RpcServer"/"name"，默认 planner-rpc
+
+    // 同名服务已有其他实例在监听时返回 false，只清理没人监听的残留套接字
+    bool start(const QString &name = defaultName());
+    void stop();
+    bool isListening() const;
+    QString serverName() const;
+
+    const QHash<QString, MethodStats> &stats() const { return m_stats; }
+    QJsonObject statsJson() const;
+
+signals:
+    // 一次处理的请求里有写操作时各发一次，供界面刷新
+    void tasksChanged();
+    void studySessionsChanged();
+
+private:
+    struct Connection {
+        QLocalSocket *socket = nullptr;
+        bool scheduled = false; // 已排队等下一轮继续处理
+    };
+
+    void onNewConnection();
+    void scheduleProcessing(Connection *connection);
+    void processConnection(Connection *connection);
+    QByteArray handleLine(const QByteArray &line);
+    QJsonArray handleBatch(const QJsonArray &requests);
+    QJsonValue handleRequest(const QJsonValue &request);
+    // 执行一个方法，出错时写 errorCode/errorMessage 并返回空值
+    QJsonValue invoke(const QString &method, const QJsonObject &params, int &errorCode, QString &errorMessage);
+    void recordCall(const QString &method, qint64 micros, bool failed);
+    void emitChanges();
+
+    QLocalServer *m_server = nullptr;
+    QHash<QLocalSocket *, Connection *> m_connections;
+    QHash<QString, MethodStats> m_stats;
+    bool m_tasksDirty = false;
+    bool m_studyDirty = false;
+};
+
+#endif // PLANNERRPCSERVER_H
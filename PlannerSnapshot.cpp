@@ -0,0 +1,393 @@
+#include "PlannerSnapshot.h"
+#include "DatabaseManager.h"
+#include "ScheduleModel.h"
+#include <QDir>
+#include <QFileInfo>
+#include <QHash>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QtEndian>
+#include <QDebug>
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+namespace {
+
+constexpr char MAGIC[8] = {'P', 'L', 'N', 'R', 'S', 'N', 'A', 'P'};
+constexpr quint32 HEADER_SIZE = 64;
+constexpr quint32 SECTION_ENTRY_SIZE = 16;
+
+enum SectionType : quint32 {
+    TaskDatesSection = 1,
+    WeekTasksSection = 2,
+    CoursesSection = 3,
+    StudyTotalsSection = 4,
+    StringsSection = 5
+};
+
+// 各段的定长记录大小
+constexpr quint32 DATE_RECORD = 4;    // i32 儒略日
+constexpr quint32 TASK_RECORD = 32;   // i32 日, i32 id, i32 ruleId, u16 开始分钟, u16 结束分钟, 标题/备注的 (偏移, 长度)
+constexpr quint32 COURSE_RECORD = 36; // u8 星期, u8 开始节, u8 节数, u8 保留, 颜色/课名/教室/教师的 (偏移, 长度)
+constexpr quint32 TOTAL_RECORD = 8;   // i32 儒略日, i32 秒数
+constexpr quint16 NO_TIME = 0xFFFF;
+
+quint32 crc32(const uchar *data, qint64 size)
+{
+    static const std::array<quint32, 256> table = [] {
+        std::array<quint32, 256> t{};
+        for (quint32 i = 0; i < 256; ++i) {
+            quint32 c = i;
+            for (int k = 0; k < 8; ++k) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            t[i] = c;
+        }
+        return t;
+    }();
+    quint32 crc = 0xFFFFFFFFu;
+    for (qint64 i = 0; i < size; ++i) {
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFFu;
+}
+
+template <typename T>
+void put(QByteArray &buffer, T value)
+{
+    const T le = qToLittleEndian(value);
+    buffer.append(reinterpret_cast<const char *>(&le), sizeof(T));
+}
+
+template <typename T>
+T get(const uchar *p)
+{
+    return qFromLittleEndian<T>(p);
+}
+
+// 字符串池：相同字符串只存一份
+class StringPool
+{
+public:
+    void add(QByteArray &record, const QString &text)
+    {
+        auto it = m_seen.constFind(text);
+        if (it == m_seen.constEnd()) {
+            const QByteArray utf8 = text.toUtf8();
+            it = m_seen.insert(text, {quint32(m_data.size()), quint32(utf8.size())});
+            m_data += utf8;
+        }
+        put<quint32>(record, it->first);
+        put<quint32>(record, it->second);
+    }
+    const QByteArray &data() const { return m_data; }
+
+private:
+    QByteArray m_data;
+    QHash<QString, QPair<quint32, quint32>> m_seen;
+};
+
+quint16 minutesOf(const QTime &time)
+{
+    return time.isValid() ? quint16(time.hour() * 60 + time.minute()) : NO_TIME;
+}
+
+QTime timeOf(quint16 minutes)
+{
+    return minutes == NO_TIME ? QTime() : QTime(minutes / 60, minutes % 60);
+}
+
+} // namespace
+
+PlannerSnapshot::~PlannerSnapshot()
+{
+    close();
+}
+
+QString PlannerSnapshot::defaultPath()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation) + "/planner.snapshot";
+}
+
+bool PlannerSnapshot::open(const QString &path)
+{
+    close();
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::ReadOnly)) return false;
+
+    m_size = m_file.size();
+    if (m_size < HEADER_SIZE) {
+        close();
+        return false;
+    }
+    const uchar *data = m_file.map(0, m_size);
+    if (!data) {
+        close();
+        return false;
+    }
+
+    const quint32 version = get<quint32>(data + 8);
+    const quint32 sectionCount = get<quint32>(data + 12);
+    const quint64 payloadSize = get<quint64>(data + 16);
+    const quint32 checksum = get<quint32>(data + 24);
+    const bool headerOk = memcmp(data, MAGIC, sizeof(MAGIC)) == 0
+                          && version == VERSION
+                          && payloadSize == quint64(m_size - HEADER_SIZE)
+                          && quint64(sectionCount) * SECTION_ENTRY_SIZE <= payloadSize;
+    if (!headerOk || crc32(data + HEADER_SIZE, m_size - HEADER_SIZE) != checksum) {
+        qDebug() << "快照无效，已忽略：" << path;
+        m_file.unmap(const_cast<uchar *>(data));
+        close();
+        return false;
+    }
+
+    // 每一段都不能越界
+    const uchar *table = data + HEADER_SIZE;
+    for (quint32 i = 0; i < sectionCount; ++i) {
+        const quint32 offset = get<quint32>(table + i * SECTION_ENTRY_SIZE + 8);
+        const quint32 size = get<quint32>(table + i * SECTION_ENTRY_SIZE + 12);
+        if (quint64(offset) + size > quint64(m_size)) {
+            qDebug() << "快照段越界，已忽略：" << path;
+            m_file.unmap(const_cast<uchar *>(data));
+            close();
+            return false;
+        }
+    }
+
+    m_data = data;
+    m_strings = section(StringsSection, 1);
+    return true;
+}
+
+void PlannerSnapshot::close()
+{
+    if (m_data) m_file.unmap(const_cast<uchar *>(m_data));
+    m_data = nullptr;
+    m_size = 0;
+    m_strings = Section();
+    if (m_file.isOpen()) m_file.close();
+}
+
+PlannerSnapshot::Section PlannerSnapshot::section(quint32 type, quint32 recordSize) const
+{
+    if (!m_data) return Section();
+    const quint32 sectionCount = get<quint32>(m_data + 12);
+    const uchar *table = m_data + HEADER_SIZE;
+    for (quint32 i = 0; i < sectionCount; ++i) {
+        const uchar *entry = table + i * SECTION_ENTRY_SIZE;
+        if (get<quint32>(entry) != type) continue;
+        const quint32 count = get<quint32>(entry + 4);
+        const quint32 offset = get<quint32>(entry + 8);
+        const quint32 size = get<quint32>(entry + 12);
+        if (quint64(count) * recordSize != size) return Section();
+        return Section{m_data + offset, count};
+    }
+    return Section();
+}
+
+QString PlannerSnapshot::string(quint32 offset, quint32 length) const
+{
+    if (quint64(offset) + length > m_strings.count) return QString();
+    return QString::fromUtf8(reinterpret_cast<const char *>(m_strings.data + offset), length);
+}
+
+QDateTime PlannerSnapshot::createdAt() const
+{
+    return m_data ? QDateTime::fromMSecsSinceEpoch(get<qint64>(m_data + 32)) : QDateTime();
+}
+
+QDate PlannerSnapshot::weekStart() const
+{
+    return m_data ? QDate::fromJulianDay(get<qint32>(m_data + 40)) : QDate();
+}
+
+QList<QDate> PlannerSnapshot::taskDates() const
+{
+    const Section s = section(TaskDatesSection, DATE_RECORD);
+    QList<QDate> dates;
+    dates.reserve(s.count);
+    for (quint32 i = 0; i < s.count; ++i) {
+        dates.append(QDate::fromJulianDay(get<qint32>(s.data + i * DATE_RECORD)));
+    }
+    return dates;
+}
+
+QList<DatedTask> PlannerSnapshot::weekTasks() const
+{
+    const Section s = section(WeekTasksSection, TASK_RECORD);
+    QList<DatedTask> tasks;
+    tasks.reserve(s.count);
+    for (quint32 i = 0; i < s.count; ++i) {
+        const uchar *r = s.data + i * TASK_RECORD;
+        DatedTask item;
+        item.date = QDate::fromJulianDay(get<qint32>(r));
+        item.task = DailyTask(string(get<quint32>(r + 16), get<quint32>(r + 20)),
+                              timeOf(get<quint16>(r + 12)),
+                              timeOf(get<quint16>(r + 14)),
+                              string(get<quint32>(r + 24), get<quint32>(r + 28)),
+                              get<qint32>(r + 4));
+        item.task.setRuleId(get<qint32>(r + 8));
+        tasks.append(item);
+    }
+    return tasks;
+}
+
+QList<DailyTask> PlannerSnapshot::tasksForDate(const QDate &date) const
+{
+    QList<DailyTask> tasks;
+    for (const DatedTask &item : weekTasks()) {
+        if (item.date == date) tasks.append(item.task);
+    }
+    return tasks;
+}
+
+QList<CourseEntry> PlannerSnapshot::courses() const
+{
+    const Section s = section(CoursesSection, COURSE_RECORD);
+    QList<CourseEntry> courses;
+    courses.reserve(s.count);
+    for (quint32 i = 0; i < s.count; ++i) {
+        const uchar *r = s.data + i * COURSE_RECORD;
+        CourseEntry course;
+        course.day = r[0];
+        course.startPeriod = r[1];
+        course.periods = r[2];
+        course.color = string(get<quint32>(r + 4), get<quint32>(r + 8));
+        course.name = string(get<quint32>(r + 12), get<quint32>(r + 16));
+        course.classroom = string(get<quint32>(r + 20), get<quint32>(r + 24));
+        course.teacher = string(get<quint32>(r + 28), get<quint32>(r + 32));
+        courses.append(course);
+    }
+    return courses;
+}
+
+QMap<QDate, int> PlannerSnapshot::studyTotals() const
+{
+    const Section s = section(StudyTotalsSection, TOTAL_RECORD);
+    QMap<QDate, int> totals;
+    for (quint32 i = 0; i < s.count; ++i) {
+        const uchar *r = s.data + i * TOTAL_RECORD;
+        totals.insert(QDate::fromJulianDay(get<qint32>(r)), get<qint32>(r + 4));
+    }
+    return totals;
+}
+
+bool PlannerSnapshot::write(const Contents &contents, const QString &path)
+{
+    StringPool strings;
+
+    QByteArray dates;
+    QList<QDate> sortedDates = contents.taskDates;
+    std::sort(sortedDates.begin(), sortedDates.end());
+    sortedDates.erase(std::unique(sortedDates.begin(), sortedDates.end()), sortedDates.end());
+    for (const QDate &date : sortedDates) {
+        put<qint32>(dates, qint32(date.toJulianDay()));
+    }
+
+    QByteArray tasks;
+    for (const DatedTask &item : contents.weekTasks) {
+        put<qint32>(tasks, qint32(item.date.toJulianDay()));
+        put<qint32>(tasks, item.task.getId());
+        put<qint32>(tasks, item.task.getRuleId());
+        put<quint16>(tasks, minutesOf(item.task.getStartTime()));
+        put<quint16>(tasks, minutesOf(item.task.getEndTime()));
+        strings.add(tasks, item.task.getTitle());
+        strings.add(tasks, item.task.getNote());
+    }
+
+    QByteArray courses;
+    for (const CourseEntry &course : contents.courses) {
+        courses.append(char(qBound(0, course.day, 255)));
+        courses.append(char(qBound(0, course.startPeriod, 255)));
+        courses.append(char(qBound(0, course.periods, 255)));
+        courses.append('\0');
+        strings.add(courses, course.color);
+        strings.add(courses, course.name);
+        strings.add(courses, course.classroom);
+        strings.add(courses, course.teacher);
+    }
+
+    QByteArray totals;
+    for (auto it = contents.studyTotals.constBegin(); it != contents.studyTotals.constEnd(); ++it) {
+        put<qint32>(totals, qint32(it.key().toJulianDay()));
+        put<qint32>(totals, it.value());
+    }
+
+    struct Part { quint32 type; quint32 count; const QByteArray *bytes; };
+    const Part parts[] = {
+        {TaskDatesSection, quint32(sortedDates.size()), &dates},
+        {WeekTasksSection, quint32(contents.weekTasks.size()), &tasks},
+        {CoursesSection, quint32(contents.courses.size()), &courses},
+        {StudyTotalsSection, quint32(contents.studyTotals.size()), &totals},
+        {StringsSection, quint32(strings.data().size()), &strings.data()},
+    };
+    const quint32 sectionCount = sizeof(parts) / sizeof(parts[0]);
+
+    // 段表紧跟文件头，各段按 8 字节对齐依次排列
+    QByteArray payload;
+    quint32 offset = HEADER_SIZE + sectionCount * SECTION_ENTRY_SIZE;
+    QByteArray body;
+    for (const Part &part : parts) {
+        while (offset % 8) {
+            body.append('\0');
+            ++offset;
+        }
+        put<quint32>(payload, part.type);
+        put<quint32>(payload, part.count);
+        put<quint32>(payload, offset);
+        put<quint32>(payload, quint32(part.bytes->size()));
+        body += *part.bytes;
+        offset += quint32(part.bytes->size());
+    }
+    payload += body;
+
+    QByteArray header(HEADER_SIZE, '\0');
+    memcpy(header.data(), MAGIC, sizeof(MAGIC));
+    qToLittleEndian<quint32>(VERSION, header.data() + 8);
+    qToLittleEndian<quint32>(sectionCount, header.data() + 12);
+    qToLittleEndian<quint64>(quint64(payload.size()), header.data() + 16);
+    qToLittleEndian<quint32>(crc32(reinterpret_cast<const uchar *>(payload.constData()), payload.size()),
+                             header.data() + 24);
+    qToLittleEndian<qint64>(QDateTime::currentMSecsSinceEpoch(), header.data() + 32);
+    qToLittleEndian<qint32>(qint32(contents.weekStart.toJulianDay()), header.data() + 40);
+
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qDebug() << "无法写入快照：" << file.errorString();
+        return false;
+    }
+    file.write(header);
+    file.write(payload);
+    return file.commit();
+}
+
+bool PlannerSnapshot::writeFromDatabase(const QString &path)
+{
+    DatabaseManager &db = DatabaseManager::instance();
+    const QDate today = QDate::currentDate();
+
+    Contents contents;
+    contents.weekStart = today.addDays(1 - today.dayOfWeek());
+
+    // 日历高亮只看今天以后，覆盖本月前后的几页就够首帧使用
+    const QDate monthStart(today.year(), today.month(), 1);
+    const QDate from = qMax(today, monthStart.addDays(-7));
+    const QDate to = monthStart.addMonths(3);
+    contents.taskDates = db.getDatesWithTasksBetween(from, to);
+    for (const DatedTask &occurrence : db.getOccurrencesBetween(from, to)) {
+        contents.taskDates.append(occurrence.date);
+    }
+
+    const QDate weekEnd = contents.weekStart.addDays(6);
+    contents.weekTasks = db.getTasksBetween(contents.weekStart, weekEnd);
+    contents.weekTasks += db.getOccurrencesBetween(contents.weekStart, weekEnd);
+    std::stable_sort(contents.weekTasks.begin(), contents.weekTasks.end(),
+                     [](const DatedTask &a, const DatedTask &b) {
+                         return a.startDateTime() < b.startDateTime();
+                     });
+
+    contents.courses = ScheduleModel::loadSaved();
+
+    contents.studyTotals = db.getDailyStudyDurations();
+    return write(contents, path);
+}
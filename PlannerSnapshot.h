@@ -0,0 +1,69 @@
+#ifndef PLANNERSNAPSHOT_H
+#define PLANNERSNAPSHOT_H
+
+#include "DailyTask.h"
+#include "PersonSchedule.h"
+#include <QDate>
+#include <QFile>
+#include <QList>
+#include <QMap>
+
+// 规划器的只读快照，用于冷启动时在打开数据库之前画出第一帧。
+// 文件是定长记录 + 字符串池的二进制格式，整体 mmap 后按偏移读取：
+//   文件头（魔数、版本、CRC32、生成时间、本周起始日）
+//   段表：每段 {类型, 记录数, 偏移, 字节数}
+//   有任务的日期、本周任务、课表、每日自习总时长、UTF-8 字符串池
+// 版本不符、长度越界或校验失败时视为无效，调用方回退到数据库。
+class PlannerSnapshot
+{
+public:
+    static const quint32 VERSION = 1;
+
+    // 写入时使用的原始数据，便于不经数据库单独生成快照
+    struct Contents {
+        QDate weekStart;              // 本周周一
+        QList<QDate> taskDates;       // 有任务（含重复日程）的日期
+        QList<DatedTask> weekTasks;   // 本周的任务，按时间排序
+        QList<CourseEntry> courses;
+        QMap<QDate, int> studyTotals; // 每天的自习秒数
+    };
+
+    PlannerSnapshot() = default;
+    ~PlannerSnapshot();
+    PlannerSnapshot(const PlannerSnapshot &) = delete;
+    PlannerSnapshot &operator=(const PlannerSnapshot &) = delete;
+
+    static QString defaultPath();
+
+    bool open(const QString &path = defaultPath());
+    void close();
+    bool isValid() const { return m_data != nullptr; }
+
+    QDateTime createdAt() const;
+    QDate weekStart() const;
+    QList<QDate> taskDates() const;
+    QList<DatedTask> weekTasks() const;
+    QList<DailyTask> tasksForDate(const QDate &date) const;
+    QList<CourseEntry> courses() const;
+    QMap<QDate, int> studyTotals() const;
+
+    // 从数据库和已保存的课表收集数据并写出（先写临时文件再替换）
+    static bool writeFromDatabase(const QString &path = defaultPath());
+    static bool write(const Contents &contents, const QString &path = defaultPath());
+
+private:
+    struct Section {
+        const uchar *data = nullptr;
+        quint32 count = 0;
+    };
+
+    Section section(quint32 type, quint32 recordSize) const;
+    QString string(quint32 offset, quint32 length) const;
+
+    QFile m_file;
+    const uchar *m_data = nullptr;
+    qint64 m_size = 0;
+    Section m_strings;
+};
+
+#endif // PLANNERSNAPSHOT_H
@@ -0,0 +1,247 @@
+#include "PythonWorker.h"
+#include "MetricsRegistry.h"
+#include <QCoreApplication>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QSettings>
+#include <QTimer>
+#include <QDebug>
+
+// 这段时间内崩溃达到上限就不再自动重启，避免脚本一启动就崩时反复拉起
+static const qint64 CRASH_WINDOW_MS = 60 * 1000;
+static const int MAX_CRASHES_IN_WINDOW = 3;
+
+PythonWorker &PythonWorker::instance()
+{
+    static PythonWorker instance;
+    return instance;
+}
+
+PythonWorker::PythonWorker(QObject *parent)
+    : QObject(parent)
+    , m_timeoutTimer(new QTimer(this))
+{
+    m_clock.start();
+
+    QSettings settings("MyCourseApp", "Python");
+    m_program = settings.value("executable", "python").toString();
+
+    // 优先使用可执行文件旁边的脚本，找不到时按工作目录查找（和原来的行为一致）
+    QString script = QCoreApplication::applicationDirPath() + "/scraper.py";
+    if (!QFileInfo::exists(script)) script = "scraper.py";
+    m_arguments = {"-B", "-u", script, "--worker"};
+
+    m_timeoutTimer->setInterval(1000);
+    connect(m_timeoutTimer, &QTimer::timeout, this, &PythonWorker::onTimeoutCheck);
+
+    // 单例是静态对象，比 QApplication 活得久；子进程要在事件循环结束前停掉
+    if (QCoreApplication *app = QCoreApplication::instance()) {
+        connect(app, &QCoreApplication::aboutToQuit, this, &PythonWorker::shutdown);
+    }
+}
+
+PythonWorker::~PythonWorker()
+{
+    shutdown();
+}
+
+void PythonWorker::shutdown()
+{
+    m_shuttingDown = true;
+    m_pending.clear();
+    m_unsent.clear();
+    m_timeoutTimer->stop();
+    if (!m_process) return;
+    // 关闭标准输入，worker 读到 EOF 后自行退出
+    m_process->disconnect(this);
+    if (m_process->state() != QProcess::NotRunning) {
+        m_process->closeWriteChannel();
+        if (!m_process->waitForFinished(1000)) {
+            m_process->kill();
+            m_process->waitForFinished(1000);
+        }
+    }
+    delete m_process;
+    m_process = nullptr;
+}
+
+// 启动是异步的：解释器起来之前的请求先攒在 m_unsent，started 之后一起写入
+bool PythonWorker::ensureStarted()
+{
+    if (m_shuttingDown) return false;
+    if (isRunning()) return true;
+
+    const qint64 now = m_clock.elapsed();
+    while (!m_recentCrashesMs.isEmpty() && now - m_recentCrashesMs.first() > CRASH_WINDOW_MS) {
+        m_recentCrashesMs.removeFirst();
+    }
+    if (m_recentCrashesMs.size() >= MAX_CRASHES_IN_WINDOW) {
+        qDebug() << "Python worker 最近频繁崩溃，暂不重启";
+        return false;
+    }
+
+    if (!m_process) {
+        m_process = new QProcess(this);
+        m_process->setProcessChannelMode(QProcess::SeparateChannels);
+        connect(m_process, &QProcess::started, this, &PythonWorker::onStarted);
+        connect(m_process, &QProcess::readyReadStandardOutput, this, &PythonWorker::onReadyRead);
+        connect(m_process, &QProcess::readyReadStandardError, this, [this]() {
+            qDebug().noquote() << "Python worker:" << QString::fromUtf8(m_process->readAllStandardError()).trimmed();
+        });
+        connect(m_process, &QProcess::finished, this, &PythonWorker::onProcessFinished);
+        connect(m_process, &QProcess::errorOccurred, this, [this](QProcess::ProcessError error) {
+            // 启动失败不会再有 finished 信号
+            if (error == QProcess::FailedToStart) onFailedToStart();
+        });
+    }
+
+    m_stdoutBuffer.clear();
+    m_startedAtNs = m_clock.nsecsElapsed();
+    m_process->start(m_program, m_arguments);
+    return true;
+}
+
+void PythonWorker::onStarted()
+{
+    MetricsRegistry &metrics = MetricsRegistry::instance();
+    metrics.histogram("planner_python_start_seconds")->record((m_clock.nsecsElapsed() - m_startedAtNs) / 1000);
+    metrics.counter("planner_python_starts_total", {{"result", "ok"}})->increment();
+    qDebug() << "Python worker 已启动，pid" << m_process->processId();
+
+    for (const QByteArray &line : std::as_const(m_unsent)) {
+        m_process->write(line);
+    }
+    m_unsent.clear();
+}
+
+// 找不到解释器之类的启动失败不是崩溃：不计入重启限制，也不自动重试，下一个请求会再试一次
+void PythonWorker::onFailedToStart()
+{
+    qDebug() << "无法启动 Python worker：" << m_process->errorString();
+    MetricsRegistry::instance().counter("planner_python_starts_total", {{"result", "error"}})->increment();
+    m_unsent.clear();
+    // 有的平台在 start() 里同步报错，推迟回调以保持异步语义；只处理此刻在等的请求
+    const QList<int> ids = m_pending.keys();
+    QTimer::singleShot(0, this, [this, ids]() {
+        for (int id : ids) {
+            if (m_pending.contains(id)) finishRequest(id, QJsonValue(), "无法启动 Python 进程，请检查 Python 环境");
+        }
+    });
+}
+
+int PythonWorker::call(const QString &method, const QJsonObject &params, QObject *context, Callback callback)
+{
+    const int id = m_nextId++;
+    Pending pending;
+    pending.context = context;
+    pending.callback = std::move(callback);
+    pending.method = method;
+    pending.sentAtMs = m_clock.elapsed();
+    pending.sentAtNs = m_clock.nsecsElapsed();
+
+    // 先登记再启动，启动失败时这个请求也能收到报错
+    m_pending.insert(id, pending);
+    MetricsRegistry::instance().gauge("planner_python_pending")->set(m_pending.size());
+    if (!m_timeoutTimer->isActive()) m_timeoutTimer->start();
+
+    if (!ensureStarted()) {
+        // 保持异步语义，和正常应答走同一条路径
+        QTimer::singleShot(0, this, [this, id]() {
+            finishRequest(id, QJsonValue(), "无法启动 Python 进程，请检查 Python 环境");
+        });
+        return id;
+    }
+
+    const QJsonObject request{{"id", id}, {"method", method}, {"params", params}};
+    const QByteArray line = QJsonDocument(request).toJson(QJsonDocument::Compact) + '\n';
+    if (m_process->state() == QProcess::Running) {
+        m_process->write(line);
+    } else if (m_process->state() == QProcess::Starting) {
+        m_unsent.append(line);
+    }
+    return id;
+}
+
+void PythonWorker::onReadyRead()
+{
+    m_stdoutBuffer += m_process->readAllStandardOutput();
+    qsizetype newline;
+    while ((newline = m_stdoutBuffer.indexOf('\n')) >= 0) {
+        const QByteArray line = m_stdoutBuffer.left(newline).trimmed();
+        m_stdoutBuffer.remove(0, newline + 1);
+        if (!line.isEmpty()) handleLine(line);
+    }
+}
+
+void PythonWorker::handleLine(const QByteArray &line)
+{
+    QJsonParseError err;
+    const QJsonDocument doc = QJsonDocument::fromJson(line, &err);
+    if (err.error != QJsonParseError::NoError || !doc.isObject()) {
+        qDebug() << "Python worker 输出无法解析：" << line.left(200);
+        return;
+    }
+    const QJsonObject response = doc.object();
+    const QJsonValue idValue = response.value("id");
+    if (!idValue.isDouble()) {
+        qDebug() << "Python worker 报告错误：" << response.value("error").toString();
+        return;
+    }
+    finishRequest(idValue.toInt(), response.value("result"), response.value("error").toString());
+}
+
+void PythonWorker::finishRequest(int id, const QJsonValue &result, const QString &error)
+{
+    const Pending pending = m_pending.take(id);
+    if (m_pending.isEmpty()) m_timeoutTimer->stop();
+
+    MetricsRegistry &metrics = MetricsRegistry::instance();
+    metrics.gauge("planner_python_pending")->set(m_pending.size());
+    if (!pending.method.isEmpty()) {
+        metrics.histogram("planner_python_call_seconds", {{"method", pending.method}})
+            ->record((m_clock.nsecsElapsed() - pending.sentAtNs) / 1000);
+        metrics.counter("planner_python_calls_total", {{"method", pending.method}, {"result", error.isEmpty() ? "ok" : "error"}})
+            ->increment();
+    }
+    if (pending.context && pending.callback) {
+        pending.callback(result, error);
+    }
+}
+
+void PythonWorker::onTimeoutCheck()
+{
+    const qint64 now = m_clock.elapsed();
+    QList<int> expired;
+    for (auto it = m_pending.constBegin(); it != m_pending.constEnd(); ++it) {
+        if (now - it->sentAtMs > m_timeoutMs) expired.append(it.key());
+    }
+    // 晚到的应答找不到 id，会被直接丢弃
+    for (int id : expired) {
+        finishRequest(id, QJsonValue(), "Python 处理超时");
+    }
+}
+
+// 只有崩溃或非零退出码才算异常：计入重启限制，并且在有请求受影响时稍后重新拉起。
+// 正常退出（退出码 0）不重启，下一个请求到来时再启动
+void PythonWorker::onProcessFinished(int exitCode, QProcess::ExitStatus status)
+{
+    const bool crashed = status == QProcess::CrashExit || exitCode != 0;
+    qDebug() << "Python worker 已退出，退出码" << exitCode << (crashed ? "（异常退出）" : "");
+    MetricsRegistry::instance().counter("planner_python_exits_total", {{"result", crashed ? "crash" : "ok"}})->increment();
+    m_unsent.clear();
+    const bool hadPending = !m_pending.isEmpty();
+    failAll(crashed ? "Python 进程意外退出" : "Python 进程已退出");
+    if (!crashed) return;
+
+    m_recentCrashesMs.append(m_clock.elapsed());
+    // 有请求因此失败时调用方多半会重试，稍后先拉起来，重试时不用再等解释器和 bs4 的导入
+    if (hadPending) QTimer::singleShot(1000, this, [this]() { ensureStarted(); });
+}
+
+void PythonWorker::failAll(const QString &error)
+{
+    const QList<int> ids = m_pending.keys();
+    for (int id : ids) {
+        finishRequest(id, QJsonValue(), error);
+    }
+}
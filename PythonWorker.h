@@ -0,0 +1,79 @@
+#ifndef PYTHONWORKER_H
+#define PYTHONWORKER_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QJsonObject>
+#include <QJsonValue>
+#include <QPointer>
+#include <QProcess>
+#include <functional>
+
+class QTimer;
+
+// 常驻的 Python worker（scraper.py --worker）：只启动一次解释器，
+// 请求和应答都是一行一个 JSON，按 id 对应，可以同时有多个请求在途。
+// 进程异步启动，不阻塞界面；启动失败（找不到解释器等）时在等的请求报错，不当作崩溃。
+// 进程崩溃时在途请求全部报错，下一次调用时自动重启；短时间内反复崩溃则暂停重启。
+// 应用退出（aboutToQuit）时停掉进程，之后的请求直接报错。
+// 每个方法的往返耗时、进程启动和退出次数记在 MetricsRegistry 的 planner_python_* 下。
+class PythonWorker : public QObject
+{
+    Q_OBJECT
+
+public:
+    using Callback = std::function<void(const QJsonValue &result, const QString &error)>;
+
+    static PythonWorker &instance();
+
+    // 发送一个请求；context 销毁后不再回调。返回请求 id
+    int call(const QString &method, const QJsonObject &params, QObject *context, Callback callback);
+    bool isRunning() const { return m_process && m_process->state() != QProcess::NotRunning; }
+    int pendingCount() const { return m_pending.size(); }
+
+    void setRequestTimeout(int ms) { m_timeoutMs = ms; }
+
+    // 关闭 worker 进程并丢弃在途请求（不回调），aboutToQuit 时自动调用
+    void shutdown();
+
+private:
+    explicit PythonWorker(QObject *parent = nullptr);
+    ~PythonWorker() override;
+
+    struct Pending {
+        QPointer<QObject> context;
+        Callback callback;
+        QString method;
+        qint64 sentAtMs = 0;
+        qint64 sentAtNs = 0; // 记延迟用，超时判断仍按毫秒
+    };
+
+    bool ensureStarted();
+    void onStarted();
+    void onFailedToStart();
+    void onReadyRead();
+    void onProcessFinished(int exitCode, QProcess::ExitStatus status);
+    void onTimeoutCheck();
+    void handleLine(const QByteArray &line);
+    void finishRequest(int id, const QJsonValue &result, const QString &error);
+    void failAll(const QString &error);
+
+    QProcess *m_process = nullptr;
+    QString m_program;
+    QStringList m_arguments;
+    QByteArray m_stdoutBuffer;
+    QList<QByteArray> m_unsent; // 进程启动完成前的请求
+    qint64 m_startedAtNs = 0;
+    bool m_shuttingDown = false;
+    QHash<int, Pending> m_pending;
+    int m_nextId = 1;
+
+    QTimer *m_timeoutTimer;
+    int m_timeoutMs = 30000;
+    QElapsedTimer m_clock;
+
+    QList<qint64> m_recentCrashesMs; // 最近的崩溃时间，用于限制重启频率
+};
+
+#endif // PYTHONWORKER_H
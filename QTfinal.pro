@@ -1,4 +1,4 @@
-QT       += core gui widgets sql charts multimedia
+QT       += core gui widgets sql charts multimedia network concurrent
 
 # include(Qxlsx/Qxlsx.pri)
 
@@ -6,26 +6,39 @@ greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
 CONFIG += c++17
 
+# 不依赖界面的核心代码（任务、课表、自习记录、空闲教室等）在静态库 plannercore 里，整体构建见 planner.pro
+include(plannercore.pri)
+
 SOURCES += \
+    AnimationPlayer.cpp \
+    AssetService.cpp \
     CourseScheduleWindow.cpp \
-    DailyTask.cpp \
     DailyTaskDialog.cpp \
-    DatabaseManager.cpp \
+    DiagnosticsWindow.cpp \
+    ReminderItemDelegate.cpp \
+    StartupTrace.cpp \
     StatisticsWindow.cpp \
     StudySessionDialog.cpp \
     TaskReminderDialog.cpp \
+    TypewriterLabel.cpp \
+    WeatherService.cpp \
     main.cpp \
     mainwindow.cpp \
     smartroomwidget.cpp
 
 HEADERS += \
+    AnimationPlayer.h \
+    AssetService.h \
     CourseScheduleWindow.h \
-    DailyTask.h \
     DailyTaskDialog.h \
-    DatabaseManager.h \
+    DiagnosticsWindow.h \
+    ReminderItemDelegate.h \
+    StartupTrace.h \
     StatisticsWindow.h \
     StudySessionDialog.h \
     TaskReminderDialog.h \
+    TypewriterLabel.h \
+    WeatherService.h \
     mainwindow.h \
     smartroomwidget.h
 
@@ -36,15 +49,23 @@ FORMS += \
 RESOURCES += \
     resources.qrc
 
+# 卡顿记录里的调用栈要能显示函数名（见 StallWatchdog）：
+# Linux 和 MinGW 把符号导出到动态符号表/导出表；MSVC 的 Release 也生成 PDB，发布时放在 exe 旁边
+linux: QMAKE_LFLAGS += -rdynamic
+win32-g++: QMAKE_LFLAGS += -Wl,--export-all-symbols
+win32-msvc*: CONFIG += force_debug_info
+
 # 使用 QMAKE_POST_LINK 确保 Python 脚本被复制到执行目录
 win32 {
     # Windows系统下的文件复制命令
     QMAKE_POST_LINK += $$quote(copy /Y $$shell_path($$PWD/scraper.py) $$shell_path($$OUT_PWD)) &&
-    QMAKE_POST_LINK += $$quote(copy /Y $$shell_path($$PWD/query_free_room.py) $$shell_path($$OUT_PWD))
+    QMAKE_POST_LINK += $$quote(copy /Y $$shell_path($$PWD/query_free_room.py) $$shell_path($$OUT_PWD)) &&
+    QMAKE_POST_LINK += $$quote(copy /Y $$shell_path($$PWD/worker_loop.py) $$shell_path($$OUT_PWD))
 } else {
     # Linux/macOS系统下的文件复制命令
     QMAKE_POST_LINK += $$quote(cp $$shell_path($$PWD/scraper.py) $$shell_path($$OUT_PWD)) &&
-    QMAKE_POST_LINK += $$quote(cp $$shell_path($$PWD/query_free_room.py) $$shell_path($$OUT_PWD))
+    QMAKE_POST_LINK += $$quote(cp $$shell_path($$PWD/query_free_room.py) $$shell_path($$OUT_PWD)) &&
+    QMAKE_POST_LINK += $$quote(cp $$shell_path($$PWD/worker_loop.py) $$shell_path($$OUT_PWD))
 }
 
 DISTFILES += \
@@ -0,0 +1,165 @@
+#include "RecurrenceRule.h"
+#include <QDateTime>
+#include <QStringList>
+#include <algorithm>
+
+RecurrenceRule::RecurrenceRule(Frequency freq, int interval, const QDate &start)
+    : m_freq(freq), m_interval(qMax(1, interval)), m_start(start)
+{
+}
+
+QDate RecurrenceRule::nthOccurrence(qint64 index) const
+{
+    switch (m_freq) {
+    case Daily:
+        return m_start.addDays(index * m_interval);
+    case Weekly:
+        return m_start.addDays(index * m_interval * 7);
+    case Monthly: {
+        // 按 RFC 5545，31 号这类在某些月份不存在的实例直接跳过，而不是挪到月末
+        const QDate monthStart = nthMonthStart(index);
+        return QDate(monthStart.year(), monthStart.month(), m_start.day()); // 不存在时为无效日期
+    }
+    }
+    return QDate();
+}
+
+QDate RecurrenceRule::nthMonthStart(qint64 index) const
+{
+    const qint64 months = m_start.month() - 1 + index * m_interval;
+    return QDate(m_start.year() + static_cast<int>(months / 12), static_cast<int>(months % 12) + 1, 1);
+}
+
+qint64 RecurrenceRule::countLimitIndex() const
+{
+    if (m_count <= 0)
+        return -1;
+    // 29~31 号才会遇到没有这一天的月份，其余情况每个下标都是一个实例
+    if (m_freq != Monthly || m_start.day() <= 28)
+        return m_count;
+
+    // RFC 5545 的 COUNT 只数真正生成的实例，跳过的月份不占名额
+    qint64 generated = 0;
+    qint64 index = 0;
+    for (; generated < m_count; ++index) {
+        if (nthMonthStart(index).year() > 9999)
+            break;
+        if (nthOccurrence(index).isValid())
+            ++generated;
+    }
+    return index;
+}
+
+bool RecurrenceRule::occursOn(const QDate &date) const
+{
+    const QList<QDate> dates = occurrencesBetween(date, date);
+    return !dates.isEmpty();
+}
+
+QList<QDate> RecurrenceRule::occurrencesBetween(const QDate &from, const QDate &to) const
+{
+    QList<QDate> result;
+    if (!isValid() || !from.isValid() || !to.isValid() || to < from)
+        return result;
+
+    QDate lower = std::max(from, m_start);
+    QDate upper = to;
+    if (m_until.isValid() && m_until < upper)
+        upper = m_until;
+    if (upper < lower)
+        return result;
+
+    // 直接跳到区间内的第一个实例下标，代价与区间长度成正比，与规则跨度无关
+    qint64 index = 0;
+    switch (m_freq) {
+    case Daily:
+        index = (m_start.daysTo(lower) + m_interval - 1) / m_interval;
+        break;
+    case Weekly:
+        index = (m_start.daysTo(lower) + m_interval * 7 - 1) / (m_interval * 7);
+        break;
+    case Monthly: {
+        const qint64 monthDiff = (lower.year() - m_start.year()) * 12 + (lower.month() - m_start.month());
+        index = std::max<qint64>(0, monthDiff / m_interval);
+        break;
+    }
+    }
+
+    const qint64 limit = countLimitIndex();
+    for (;; ++index) {
+        if (limit >= 0 && index >= limit)
+            break;
+        const QDate date = nthOccurrence(index);
+        if (!date.isValid()) {
+            // 当月没有这一天：跳过，但整月已超出区间时结束
+            if (m_freq == Monthly && nthMonthStart(index) <= upper) continue;
+            break;
+        }
+        if (date > upper)
+            break;
+        if (date < lower || m_exceptions.contains(date))
+            continue;
+        result.append(date);
+    }
+    return result;
+}
+
+QString RecurrenceRule::toRRule() const
+{
+    static const char *names[] = {"DAILY", "WEEKLY", "MONTHLY"};
+    QStringList parts;
+    parts << QString("FREQ=%1").arg(names[m_freq]);
+    if (m_interval > 1)
+        parts << QString("INTERVAL=%1").arg(m_interval);
+    if (m_count > 0)
+        parts << QString("COUNT=%1").arg(m_count);
+    else if (m_until.isValid())
+        parts << QString("UNTIL=%1").arg(m_until.toString("yyyyMMdd"));
+    return parts.join(';');
+}
+
+RecurrenceRule RecurrenceRule::fromRRule(const QString &rrule, const QDate &start)
+{
+    RecurrenceRule rule(Weekly, 1, start);
+    for (const QString &part : rrule.split(';', Qt::SkipEmptyParts)) {
+        const QString key = part.section('=', 0, 0).trimmed().toUpper();
+        const QString value = part.section('=', 1).trimmed().toUpper();
+        if (key == "FREQ") {
+            if (value == "DAILY") rule.m_freq = Daily;
+            else if (value == "MONTHLY") rule.m_freq = Monthly;
+            else rule.m_freq = Weekly;
+        } else if (key == "INTERVAL") {
+            rule.setInterval(value.toInt());
+        } else if (key == "COUNT") {
+            rule.setCount(value.toInt());
+        } else if (key == "UNTIL") {
+            // 兼容 20250101、20250101T235959（本地）和 20250101T160000Z（UTC）三种写法。
+            // UTC 时刻要先换算成本地时间再取日期：20250101T160000Z 在东八区已经是 1 月 2 日
+            rule.m_until = QDate::fromString(value.left(8), "yyyyMMdd");
+            const QTime time = QTime::fromString(value.mid(9, 6), "HHmmss");
+            if (rule.m_until.isValid() && value.size() >= 16 && value.at(8) == 'T' && value.endsWith('Z') && time.isValid())
+                rule.m_until = QDateTime(rule.m_until, time, Qt::UTC).toLocalTime().date();
+        }
+    }
+    return rule;
+}
+
+QString RecurrenceRule::exceptionsToString() const
+{
+    QList<QDate> dates(m_exceptions.cbegin(), m_exceptions.cend());
+    std::sort(dates.begin(), dates.end());
+    QStringList parts;
+    for (const QDate &date : dates)
+        parts << date.toString(Qt::ISODate);
+    return parts.join(',');
+}
+
+QSet<QDate> RecurrenceRule::exceptionsFromString(const QString &text)
+{
+    QSet<QDate> dates;
+    for (const QString &part : text.split(',', Qt::SkipEmptyParts)) {
+        const QDate date = QDate::fromString(part.trimmed(), Qt::ISODate);
+        if (date.isValid()) dates.insert(date);
+    }
+    return dates;
+}
@@ -0,0 +1,60 @@
+#ifndef RECURRENCERULE_H
+#define RECURRENCERULE_H
+
+#include <QDate>
+#include <QList>
+#include <QSet>
+#include <QString>
+
+// 重复规则，取 iCalendar RRULE 的一个子集：
+// FREQ=DAILY/WEEKLY/MONTHLY，INTERVAL，UNTIL 或 COUNT，外加例外日期 (EXDATE)。
+// 规则只存一行，展开时只计算请求的日期区间，不物化所有实例。
+class RecurrenceRule
+{
+public:
+    enum Frequency { Daily, Weekly, Monthly };
+
+    RecurrenceRule(Frequency freq = Weekly, int interval = 1, const QDate &start = QDate());
+
+    Frequency frequency() const { return m_freq; }
+    int interval() const { return m_interval; }
+    QDate startDate() const { return m_start; }
+    QDate until() const { return m_until; }
+    int count() const { return m_count; }
+    const QSet<QDate> &exceptions() const { return m_exceptions; }
+
+    void setFrequency(Frequency freq) { m_freq = freq; }
+    void setInterval(int interval) { m_interval = qMax(1, interval); }
+    void setStartDate(const QDate &start) { m_start = start; }
+    void setUntil(const QDate &until) { m_until = until; }   // 无效日期表示不限
+    void setCount(int count) { m_count = qMax(0, count); }   // 0 表示不限次数
+    void addException(const QDate &date) { m_exceptions.insert(date); }
+    void setExceptions(const QSet<QDate> &dates) { m_exceptions = dates; }
+
+    bool isValid() const { return m_start.isValid(); }
+    bool occursOn(const QDate &date) const;
+    // 返回 [from, to] 内的全部实例日期（已剔除例外日期），按时间升序
+    QList<QDate> occurrencesBetween(const QDate &from, const QDate &to) const;
+
+    // 与 RRULE 文本互相转换，例如 "FREQ=WEEKLY;INTERVAL=2;COUNT=10"
+    QString toRRule() const;
+    static RecurrenceRule fromRRule(const QString &rrule, const QDate &start);
+    QString exceptionsToString() const;
+    static QSet<QDate> exceptionsFromString(const QString &text);
+
+private:
+    // 第 index 个实例的日期；按月重复时若当月没有这一天返回无效日期
+    QDate nthOccurrence(qint64 index) const;
+    QDate nthMonthStart(qint64 index) const;
+    // COUNT 换算成实例下标的上限（不含），不限次数时为 -1
+    qint64 countLimitIndex() const;
+
+    Frequency m_freq;
+    int m_interval;
+    QDate m_start;
+    QDate m_until;
+    int m_count = 0;
+    QSet<QDate> m_exceptions;
+};
+
+#endif // RECURRENCERULE_H
@@ -0,0 +1,78 @@
+#include "ReminderItemDelegate.h"
+#include "UpcomingTaskModel.h"
+#include <QPainter>
+#include <QTime>
+
+ReminderItemDelegate::ReminderItemDelegate(QObject *parent)
+    : QStyledItemDelegate(parent)
+{
+}
+
+static QColor urgencyColor(UpcomingTaskModel::Urgency urgency)
+{
+    switch (urgency) {
+    case UpcomingTaskModel::Today:
+    case UpcomingTaskModel::Urgent: return QColor("#D32F2F"); // 红色
+    case UpcomingTaskModel::Soon:   return QColor("#FBC02D"); // 黄色
+    case UpcomingTaskModel::Later:  return QColor("#388E3C"); // 绿色
+    }
+    return QColor("#388E3C");
+}
+
+void ReminderItemDelegate::paint(QPainter *painter, const QStyleOptionViewItem &option,
+                                 const QModelIndex &index) const
+{
+    painter->save();
+    const QRect rect = option.rect.adjusted(8, 0, -8, 0);
+
+    if (index.data(UpcomingTaskModel::IsHeaderRole).toBool()) {
+        const qint64 daysUntil = index.data(UpcomingTaskModel::DaysUntilRole).toLongLong();
+        const UpcomingTaskModel::Urgency urgency = UpcomingTaskModel::urgencyFor(daysUntil);
+        const QString distanceText = daysUntil == 0 ? QString(" (今天)")
+                                                    : QString(" (%1天后)").arg(daysUntil);
+
+        QFont font = option.font;
+        font.setPointSizeF(font.pointSizeF() + 1);
+        font.setBold(urgency == UpcomingTaskModel::Today);
+        painter->setFont(font);
+        painter->setPen(urgencyColor(urgency));
+        QRect textRect = rect.adjusted(0, 8, 0, 0);
+        painter->drawText(textRect, Qt::AlignLeft | Qt::AlignVCenter,
+                          index.data(Qt::DisplayRole).toString() + distanceText);
+        painter->setPen(QColor("#CED4DA"));
+        painter->drawLine(rect.bottomLeft(), rect.bottomRight());
+    } else {
+        if (option.state & QStyle::State_Selected) {
+            painter->fillRect(option.rect, QColor("#E9ECEF"));
+        }
+        const QTime start = index.data(UpcomingTaskModel::StartTimeRole).toTime();
+        const QTime end = index.data(UpcomingTaskModel::EndTimeRole).toTime();
+        const QString timeText = QString("%1 - %2").arg(start.toString("HH:mm"), end.toString("HH:mm"));
+
+        painter->setFont(option.font);
+        painter->setPen(QColor("#6C757D"));
+        QRect timeRect = rect.adjusted(16, 0, 0, 0);
+        timeRect.setWidth(110);
+        painter->drawText(timeRect, Qt::AlignLeft | Qt::AlignVCenter, timeText);
+
+        painter->setPen(QColor("#212529"));
+        QRect titleRect = rect.adjusted(16 + 110, 0, 0, 0);
+        QString title = index.data(Qt::DisplayRole).toString();
+        if (index.data(UpcomingTaskModel::IsRecurringRole).toBool()) {
+            title.prepend(QString::fromUtf8("↻ ")); // 重复日程的实例
+        }
+        painter->drawText(titleRect, Qt::AlignLeft | Qt::AlignVCenter,
+                          option.fontMetrics.elidedText(title, Qt::ElideRight, titleRect.width()));
+    }
+    painter->restore();
+}
+
+QSize ReminderItemDelegate::sizeHint(const QStyleOptionViewItem &option,
+                                     const QModelIndex &index) const
+{
+    const int lineHeight = option.fontMetrics.height();
+    if (index.data(UpcomingTaskModel::IsHeaderRole).toBool()) {
+        return QSize(option.rect.width(), lineHeight + 18);
+    }
+    return QSize(option.rect.width(), lineHeight + 12);
+}
@@ -0,0 +1,20 @@
+#ifndef REMINDERITEMDELEGATE_H
+#define REMINDERITEMDELEGATE_H
+
+#include <QStyledItemDelegate>
+
+// 日程提醒列表的绘制委托：日期标题行按紧急程度着色，任务行显示时间和标题
+class ReminderItemDelegate : public QStyledItemDelegate
+{
+    Q_OBJECT
+
+public:
+    explicit ReminderItemDelegate(QObject *parent = nullptr);
+
+    void paint(QPainter *painter, const QStyleOptionViewItem &option,
+               const QModelIndex &index) const override;
+    QSize sizeHint(const QStyleOptionViewItem &option,
+                   const QModelIndex &index) const override;
+};
+
+#endif // REMINDERITEMDELEGATE_H
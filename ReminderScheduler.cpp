@@ -0,0 +1,217 @@
+#include "ReminderScheduler.h"
+#include "DatabaseManager.h"
+#include <QSettings>
+#include <QDebug>
+#include <algorithm>
+
+// 只把这么多天内的任务放进堆里，窗口到期时再往后滚动加载
+static const int HORIZON_DAYS = 7;
+// 单次定时的上限：防止系统休眠/改时钟后长时间不触发
+static const int MAX_ARM_MS = 60 * 60 * 1000;
+
+ReminderScheduler::ReminderScheduler(QObject *parent)
+    : QObject(parent), m_timer(new QTimer(this))
+{
+    m_timer->setSingleShot(true);
+    m_timer->setTimerType(Qt::CoarseTimer);
+    connect(m_timer, &QTimer::timeout, this, &ReminderScheduler::onTimeout);
+
+    QSettings settings("MyCourseApp", "Reminder");
+    QList<int> leads;
+    for (const QVariant &value : settings.value("leadMinutes", QVariantList{15, 0}).toList()) {
+        leads << value.toInt();
+    }
+    m_leadMinutes = leads;
+
+    DatabaseManager &db = DatabaseManager::instance();
+    connect(&db, &DatabaseManager::taskAdded, this, &ReminderScheduler::onTaskAdded);
+    connect(&db, &DatabaseManager::taskUpdated, this, &ReminderScheduler::onTaskUpdated);
+    connect(&db, &DatabaseManager::taskRemoved, this, &ReminderScheduler::onTaskRemoved);
+    // 重复规则变化影响的实例较多，直接重新加载窗口
+    connect(&db, &DatabaseManager::taskRulesChanged, this, &ReminderScheduler::reload);
+}
+
+bool ReminderScheduler::parseLeadTimes(const QString &text, QList<int> &minutes)
+{
+    minutes.clear();
+    for (const QString &part : text.split(',', Qt::SkipEmptyParts)) {
+        bool isNumber;
+        const int value = part.trimmed().toInt(&isNumber);
+        if (!isNumber || value < 0) {
+            return false;
+        }
+        minutes << value;
+    }
+    return true;
+}
+
+void ReminderScheduler::setLeadTimes(const QList<int> &minutes)
+{
+    QList<int> leads;
+    for (int m : minutes) {
+        if (m >= 0 && !leads.contains(m)) leads << m;
+    }
+    m_leadMinutes = leads;
+
+    QVariantList stored;
+    for (int m : leads) stored << m;
+    QSettings settings("MyCourseApp", "Reminder");
+    settings.setValue("leadMinutes", stored);
+
+    reload();
+}
+
+void ReminderScheduler::reload()
+{
+    m_heap.clear();
+    m_tasks.clear();
+    // 版本号保留并整体递增即可让旧条目全部失效，这里直接清空更简单
+    m_generation.clear();
+
+    const QDateTime now = QDateTime::currentDateTime();
+    m_horizonEnd = now.addDays(HORIZON_DAYS);
+
+    // 提醒可能提前若干分钟，因此查询区间要向后多覆盖最大提前量
+    int maxLead = 0;
+    for (int m : m_leadMinutes) maxLead = std::max(maxLead, m);
+    const QDate lastDate = m_horizonEnd.addSecs(maxLead * 60).date();
+    DatabaseManager &db = DatabaseManager::instance();
+    for (const DatedTask &task : db.getTasksBetween(now.date(), lastDate)) {
+        scheduleTask(task);
+    }
+    for (const DatedTask &occurrence : db.getOccurrencesBetween(now.date(), lastDate)) {
+        scheduleTask(occurrence);
+    }
+    rearm();
+}
+
+int ReminderScheduler::pendingCount() const
+{
+    int count = 0;
+    for (const Entry &entry : m_heap) {
+        if (m_generation.value(entry.key) == entry.generation) ++count;
+    }
+    return count;
+}
+
+void ReminderScheduler::onTaskAdded(int id)
+{
+    DatedTask task;
+    if (DatabaseManager::instance().getTaskById(id, task)) {
+        scheduleTask(task);
+        rearm();
+    }
+}
+
+void ReminderScheduler::onTaskUpdated(int id)
+{
+    dropTask(id);
+    onTaskAdded(id);
+}
+
+void ReminderScheduler::onTaskRemoved(int id)
+{
+    dropTask(id);
+    rearm();
+}
+
+void ReminderScheduler::onTimeout()
+{
+    const QDateTime now = QDateTime::currentDateTime();
+
+    while (!m_heap.empty() && m_heap.front().fireAt <= now) {
+        std::pop_heap(m_heap.begin(), m_heap.end(), Later());
+        Entry entry = m_heap.back();
+        m_heap.pop_back();
+
+        if (m_generation.value(entry.key) != entry.generation)
+            continue; // 任务已被修改或删除
+        auto it = m_tasks.constFind(entry.key);
+        if (it != m_tasks.constEnd()) {
+            emit reminderDue(it.value(), entry.leadMinutes);
+        }
+    }
+
+    // 窗口到期，向后滚动重新加载
+    if (now >= m_horizonEnd) {
+        reload();
+        return;
+    }
+    compactHeap();
+    rearm();
+}
+
+qint64 ReminderScheduler::keyFor(const DatedTask &task)
+{
+    if (!task.task.isOccurrence()) {
+        return task.task.getId();
+    }
+    return -((static_cast<qint64>(task.task.getRuleId()) << 32) | static_cast<quint32>(task.date.toJulianDay()));
+}
+
+void ReminderScheduler::scheduleTask(const DatedTask &task)
+{
+    if (!task.task.getStartTime().isValid())
+        return;
+
+    const QDateTime now = QDateTime::currentDateTime();
+    const QDateTime start = task.startDateTime();
+    const qint64 key = keyFor(task);
+    const quint32 generation = m_generation.value(key) + 1;
+    bool scheduled = false;
+
+    for (int lead : m_leadMinutes) {
+        QDateTime fireAt = start.addSecs(-lead * 60);
+        // 已经错过的提醒不再补发；超出窗口的等滚动加载时再排
+        if (fireAt < now || fireAt > m_horizonEnd)
+            continue;
+        m_heap.push_back({fireAt, key, lead, generation});
+        std::push_heap(m_heap.begin(), m_heap.end(), Later());
+        scheduled = true;
+    }
+
+    if (scheduled) {
+        m_generation[key] = generation;
+        m_tasks[key] = task;
+    }
+}
+
+void ReminderScheduler::dropTask(qint64 key)
+{
+    // 只递增版本号，堆中旧条目在弹出或压缩时被丢弃
+    if (m_tasks.remove(key) > 0) {
+        m_generation[key] = m_generation.value(key) + 1;
+    }
+}
+
+void ReminderScheduler::rearm()
+{
+    // 先丢掉堆顶的失效条目，避免为它们白白唤醒
+    while (!m_heap.empty() && m_generation.value(m_heap.front().key) != m_heap.front().generation) {
+        std::pop_heap(m_heap.begin(), m_heap.end(), Later());
+        m_heap.pop_back();
+    }
+
+    const QDateTime now = QDateTime::currentDateTime();
+    QDateTime next = m_horizonEnd;
+    if (!m_heap.empty() && m_heap.front().fireAt < next) {
+        next = m_heap.front().fireAt;
+    }
+
+    qint64 ms = std::clamp<qint64>(now.msecsTo(next), 0, MAX_ARM_MS);
+    m_timer->start(static_cast<int>(ms));
+}
+
+void ReminderScheduler::compactHeap()
+{
+    // 失效条目超过一半时整体重建一次，保持堆的大小与有效提醒数同阶
+    const int live = pendingCount();
+    if (static_cast<size_t>(live) * 2 >= m_heap.size())
+        return;
+
+    m_heap.erase(std::remove_if(m_heap.begin(), m_heap.end(), [this](const Entry &entry) {
+                     return m_generation.value(entry.key) != entry.generation;
+                 }),
+                 m_heap.end());
+    std::make_heap(m_heap.begin(), m_heap.end(), Later());
+}
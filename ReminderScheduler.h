@@ -0,0 +1,68 @@
+#ifndef REMINDERSCHEDULER_H
+#define REMINDERSCHEDULER_H
+
+#include <QObject>
+#include <QTimer>
+#include <QHash>
+#include <QList>
+#include <QDateTime>
+#include <vector>
+#include "DailyTask.h"
+
+// 后台日程提醒调度器。
+// 把未来一段时间内的任务按“提醒时刻”放进一个最小堆，只用一个 QTimer 对准堆顶；
+// 任务增删改时通过 DatabaseManager 的信号做增量更新，过期的堆元素按版本号惰性丢弃。
+class ReminderScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ReminderScheduler(QObject *parent = nullptr);
+
+    // 提前多少分钟提醒，可设置多个，0 表示在开始时刻提醒
+    void setLeadTimes(const QList<int> &minutes);
+    QList<int> leadTimes() const { return m_leadMinutes; }
+    // 解析逗号分隔的分钟数（如 "30,10,0"），有非法项时返回 false
+    static bool parseLeadTimes(const QString &text, QList<int> &minutes);
+
+    // 重新从数据库加载提醒窗口内的全部任务
+    void reload();
+    int pendingCount() const;
+
+signals:
+    void reminderDue(const DatedTask &task, int leadMinutes);
+
+private slots:
+    void onTaskAdded(int id);
+    void onTaskUpdated(int id);
+    void onTaskRemoved(int id);
+    void onTimeout();
+
+private:
+    struct Entry {
+        QDateTime fireAt;
+        qint64 key;
+        int leadMinutes;
+        quint32 generation;
+    };
+    // std::push_heap 默认是最大堆，比较取反得到最小堆
+    struct Later {
+        bool operator()(const Entry &a, const Entry &b) const { return a.fireAt > b.fireAt; }
+    };
+
+    // 普通任务用 id 作键；重复日程的实例没有 id，用 (规则 id, 日期) 组合出负数键
+    static qint64 keyFor(const DatedTask &task);
+    void scheduleTask(const DatedTask &task);
+    void dropTask(qint64 key);
+    void rearm();
+    void compactHeap();
+
+    std::vector<Entry> m_heap;
+    QHash<qint64, quint32> m_generation; // 任务键 -> 当前有效版本
+    QHash<qint64, DatedTask> m_tasks;    // 窗口内仍有待触发提醒的任务
+    QList<int> m_leadMinutes;
+    QTimer *m_timer;
+    QDateTime m_horizonEnd;           // 已加载到的时间窗口终点
+};
+
+#endif // REMINDERSCHEDULER_H
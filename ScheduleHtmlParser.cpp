@@ -0,0 +1,230 @@
+#include "ScheduleHtmlParser.h"
+#include <QFile>
+#include <QRegularExpression>
+#include <QSet>
+
+namespace {
+
+// 取标签里的属性值，支持双引号、单引号和不带引号的写法
+QString attribute(const QString &tagAttributes, const QString &name)
+{
+    const QRegularExpression re(
+        QString(R"((?:^|\s)%1\s*=\s*(?:"([^"]*)"|'([^']*)'|([^\s>]+)))").arg(name),
+        QRegularExpression::CaseInsensitiveOption);
+    const QRegularExpressionMatch m = re.match(tagAttributes);
+    if (!m.hasMatch()) return QString();
+    for (int i = 1; i <= 3; ++i) {
+        if (m.capturedStart(i) >= 0) return m.captured(i);
+    }
+    return QString();
+}
+
+QString decodeEntities(QString text)
+{
+    if (!text.contains('&')) return text;
+    static const QRegularExpression numeric(R"(&#(x?)([0-9a-fA-F]+);)");
+    QString out;
+    out.reserve(text.size());
+    qsizetype last = 0;
+    auto it = numeric.globalMatch(text);
+    while (it.hasNext()) {
+        const QRegularExpressionMatch m = it.next();
+        out += QStringView(text).mid(last, m.capturedStart() - last);
+        bool ok = false;
+        const uint code = m.captured(2).toUInt(&ok, m.captured(1).isEmpty() ? 10 : 16);
+        const char32_t ch = code;
+        if (ok) out += QString::fromUcs4(&ch, 1);
+        last = m.capturedEnd();
+    }
+    out += QStringView(text).mid(last);
+    out.replace("&nbsp;", QString(QChar(0xA0)));
+    out.replace("&lt;", "<");
+    out.replace("&gt;", ">");
+    out.replace("&quot;", "\"");
+    out.replace("&#39;", "'");
+    out.replace("&amp;", "&");
+    return out;
+}
+
+QString textContent(const QString &innerHtml)
+{
+    static const QRegularExpression tags("<[^>]*>");
+    return decodeEntities(QString(innerHtml).remove(tags));
+}
+
+// 找到与 openEnd 处开始的 <div> 配对的 </div>，返回内部 HTML
+QString divInnerHtml(const QString &html, qsizetype openEnd)
+{
+    static const QRegularExpression divTag(R"(<(/?)div\b[^>]*>)", QRegularExpression::CaseInsensitiveOption);
+    int depth = 1;
+    auto it = divTag.globalMatch(html, openEnd);
+    while (it.hasNext()) {
+        const QRegularExpressionMatch m = it.next();
+        depth += m.captured(1).isEmpty() ? 1 : -1;
+        if (depth == 0) return html.mid(openEnd, m.capturedStart() - openEnd);
+    }
+    return html.mid(openEnd);
+}
+
+// 返回 [start, end) 之间按 openRe 切开的各段：(标签属性, 内容)
+QList<QPair<QString, QString>> elements(const QString &html, qsizetype start, qsizetype end,
+                                        const QRegularExpression &openRe, const QString &closeTag)
+{
+    QList<QPair<QString, QString>> result;
+    QList<QRegularExpressionMatch> opens;
+    auto it = openRe.globalMatch(html, start);
+    while (it.hasNext()) {
+        QRegularExpressionMatch m = it.next();
+        if (m.capturedStart() >= end) break;
+        opens.append(m);
+    }
+    for (int i = 0; i < opens.size(); ++i) {
+        const qsizetype contentStart = opens[i].capturedEnd();
+        qsizetype contentEnd = i + 1 < opens.size() ? opens[i + 1].capturedStart() : end;
+        const qsizetype close = html.indexOf(closeTag, contentStart, Qt::CaseInsensitive);
+        if (close >= 0 && close < contentEnd) contentEnd = close;
+        result.append({opens[i].captured(1), html.mid(contentStart, contentEnd - contentStart)});
+    }
+    return result;
+}
+
+// 对应 bs4 的 course_div.contents：div 的直接子节点。文本节点解码实体，
+// 子元素保留原始 HTML，<br> 按 bs4 的序列化写成 <br/>
+QStringList childNodes(const QString &innerHtml)
+{
+    static const QRegularExpression tagRe(R"(<(/?)([A-Za-z][A-Za-z0-9]*)\b[^>]*?(/?)>)");
+    static const QSet<QString> voidTags{"area", "base", "br", "col", "embed", "hr", "img", "input",
+                                        "link", "meta", "param", "source", "track", "wbr"};
+    QStringList nodes;
+    int depth = 0;
+    qsizetype textStart = 0;    // 外层当前文本节点的起点
+    qsizetype elementStart = 0; // 外层当前子元素的起点
+    auto it = tagRe.globalMatch(innerHtml);
+    while (it.hasNext()) {
+        const QRegularExpressionMatch m = it.next();
+        const bool closing = !m.captured(1).isEmpty();
+        const QString name = m.captured(2).toLower();
+        const bool empty = !m.captured(3).isEmpty() || voidTags.contains(name);
+        if (depth == 0) {
+            nodes << decodeEntities(innerHtml.mid(textStart, m.capturedStart() - textStart));
+            textStart = m.capturedEnd();
+            if (closing) continue; // 多余的结束标签，bs4 直接丢弃
+            if (empty) {
+                nodes << (name == "br" ? QString("<br/>") : m.captured(0));
+            } else {
+                elementStart = m.capturedStart();
+                depth = 1;
+            }
+        } else if (!empty) {
+            depth += closing ? -1 : 1;
+            if (depth == 0) {
+                nodes << innerHtml.mid(elementStart, m.capturedEnd() - elementStart);
+                textStart = m.capturedEnd();
+            }
+        }
+    }
+    nodes << (depth > 0 ? innerHtml.mid(elementStart) : decodeEntities(innerHtml.mid(textStart)));
+    return nodes;
+}
+
+bool isAllDigits(const QString &text)
+{
+    if (text.isEmpty()) return false;
+    for (QChar c : text) {
+        if (!c.isDigit()) return false;
+    }
+    return true;
+}
+
+} // namespace
+
+bool ScheduleHtmlParser::parseFile(const QString &filePath, QList<CourseEntry> &courses, QString *error)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        if (error) *error = QString("读取文件失败：%1").arg(file.errorString());
+        return false;
+    }
+    courses = parse(QString::fromUtf8(file.readAll()));
+    return true;
+}
+
+QList<CourseEntry> ScheduleHtmlParser::parse(const QString &html)
+{
+    static const QRegularExpression tableRe(R"(<table\b[^>]*\bid\s*=\s*["']?subtable["']?[^>]*>)",
+                                            QRegularExpression::CaseInsensitiveOption);
+    static const QRegularExpression trRe(R"(<tr\b([^>]*)>)", QRegularExpression::CaseInsensitiveOption);
+    static const QRegularExpression tdRe(R"(<td\b([^>]*)>)", QRegularExpression::CaseInsensitiveOption);
+    static const QRegularExpression divRe(R"(<div\b([^>]*)>)", QRegularExpression::CaseInsensitiveOption);
+    static const QRegularExpression nameRe(R"(^(.+?)\()", QRegularExpression::UseUnicodePropertiesOption);
+    static const QRegularExpression infoRe(R"(上课信息：.+?\s+(.+?)\s+教师：(.+?)\s+)",
+                                           QRegularExpression::UseUnicodePropertiesOption);
+    static const QRegularExpression colorRe(R"(background-color:\s*(.*?);)");
+
+    QList<CourseEntry> courses;
+    const QRegularExpressionMatch table = tableRe.match(html);
+    if (!table.hasMatch()) return courses;
+    qsizetype tableEnd = html.indexOf("</table", table.capturedEnd(), Qt::CaseInsensitive);
+    if (tableEnd < 0) tableEnd = html.size();
+
+    // 与 scraper.py 相同：15 行 × 10 列的占用表，处理跨行的课程
+    bool occupied[15][10] = {};
+    int rowIdx = 0;
+    for (const auto &tr : elements(html, table.capturedEnd(), tableEnd, trRe, "</tr")) {
+        if (!attribute(tr.first, "class").split(' ', Qt::SkipEmptyParts).contains("ptr_tr")) continue;
+        const int realRow = ++rowIdx;
+        if (realRow >= 15) break;
+        int dayPointer = 1;
+        const QString &rowHtml = tr.second;
+
+        for (const auto &td : elements(rowHtml, 0, rowHtml.size(), tdRe, "</td")) {
+            const QRegularExpressionMatch div = divRe.match(td.second);
+            QString divHtml;
+            if (div.hasMatch()) {
+                divHtml = divInnerHtml(td.second, div.capturedEnd());
+                if (isAllDigits(textContent(divHtml))) continue; // 节次列
+            }
+            while (dayPointer < 8 && occupied[realRow][dayPointer]) ++dayPointer;
+            if (dayPointer > 7) continue;
+
+            if (div.hasMatch() && !textContent(divHtml).trimmed().isEmpty()) {
+                bool ok = false;
+                int rowspan = attribute(td.first, "rowspan").toInt(&ok);
+                if (!ok || rowspan < 1) rowspan = 1;
+
+                QStringList lines;
+                for (const QString &node : childNodes(divHtml)) {
+                    const QString line = node.trimmed();
+                    if (!line.isEmpty()) lines << line;
+                }
+                // 与 scraper.py 完全一致：先用空格连接再把 <br/> 换成空格，换行处是三个空格，
+                // 末尾的 <br/> 留下两个空格（下面“教师：”后的 \s+ 靠它匹配）
+                const QString rawText = lines.join(' ').replace("<br/>", " ").replace("<br>", " ");
+
+                CourseEntry course;
+                const QRegularExpressionMatch name = nameRe.match(rawText);
+                course.name = name.hasMatch() ? name.captured(1) : lines.value(0);
+                course.classroom = "未知";
+                course.teacher = "未知";
+                const QRegularExpressionMatch info = infoRe.match(rawText);
+                if (info.hasMatch()) {
+                    course.classroom = info.captured(1).trimmed();
+                    course.teacher = info.captured(2).trimmed();
+                }
+                const QRegularExpressionMatch color = colorRe.match(attribute(div.captured(1), "style"));
+                course.color = color.hasMatch() ? color.captured(1) : QString("#FFFFFF");
+                course.day = dayPointer;
+                course.startPeriod = realRow;
+                course.periods = rowspan;
+                course.rawText = rawText;
+                courses.append(course);
+
+                for (int i = 0; i < rowspan && realRow + i < 15; ++i) {
+                    occupied[realRow + i][dayPointer] = true;
+                }
+            }
+            ++dayPointer;
+        }
+    }
+    return courses;
+}
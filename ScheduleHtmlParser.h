@@ -0,0 +1,18 @@
+#ifndef SCHEDULEHTMLPARSER_H
+#define SCHEDULEHTMLPARSER_H
+
+#include "PersonSchedule.h"
+#include <QList>
+#include <QString>
+
+// scraper.py 的 C++ 版本：从教务课表页面（id 为 subtable 的表格）里解析课程。
+// 不依赖 Python 和 bs4，纯函数、可在任意线程并行调用，供批量导入使用。
+namespace ScheduleHtmlParser {
+
+// 读取失败返回 false 并写入 error；找不到课表时返回 true 和空列表（与 scraper.py 一致）
+bool parseFile(const QString &filePath, QList<CourseEntry> &courses, QString *error = nullptr);
+QList<CourseEntry> parse(const QString &html);
+
+} // namespace ScheduleHtmlParser
+
+#endif // SCHEDULEHTMLPARSER_H
@@ -0,0 +1,84 @@
+#include "ScheduleModel.h"
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QSettings>
+
+ScheduleModel::ParseStatus ScheduleModel::parse(const QByteArray &json, QList<CourseEntry> &courses)
+{
+    courses.clear();
+    if (json.isEmpty()) {
+        return ParseStatus::EmptyInput;
+    }
+    const QJsonDocument doc = QJsonDocument::fromJson(json);
+    if (doc.isNull() || !doc.isArray()) {
+        return ParseStatus::Invalid;
+    }
+
+    const QJsonArray array = doc.array();
+    courses.reserve(array.size());
+    for (const QJsonValue &value : array) {
+        courses.append(CourseEntry::fromJson(value.toObject()));
+    }
+    return courses.isEmpty() ? ParseStatus::NoCourses : ParseStatus::Ok;
+}
+
+bool ScheduleModel::isPlaceable(const CourseEntry &course)
+{
+    return course.day >= 1 && course.day <= SCHEDULE_DAYS
+           && course.startPeriod >= 1 && course.startPeriod <= SCHEDULE_PERIODS;
+}
+
+QString ScheduleModel::displayText(const CourseEntry &course)
+{
+    return QString("%1\n\n@%2\n%3").arg(course.name, course.classroom, course.teacher);
+}
+
+QStringList ScheduleModel::courseNames(const QList<CourseEntry> &courses)
+{
+    QStringList names;
+    for (const CourseEntry &course : courses) {
+        const QString name = course.name.trimmed();
+        if (!name.isEmpty() && !names.contains(name)) {
+            names << name;
+        }
+    }
+    return names;
+}
+
+QByteArray ScheduleModel::savedJson()
+{
+    QSettings settings("MyCourseApp", "ScheduleData");
+    return settings.value("lastScheduleJson").toByteArray();
+}
+
+QList<CourseEntry> ScheduleModel::loadSaved()
+{
+    QList<CourseEntry> courses;
+    parse(savedJson(), courses);
+    return courses;
+}
+
+void ScheduleModel::save(const QByteArray &json)
+{
+    QSettings settings("MyCourseApp", "ScheduleData");
+    settings.setValue("lastScheduleJson", json);
+}
+
+QDate ScheduleModel::termStart()
+{
+    QSettings settings("MyCourseApp", "ScheduleData");
+    return QDate::fromString(settings.value("termStart").toString(), Qt::ISODate);
+}
+
+int ScheduleModel::termWeeks()
+{
+    QSettings settings("MyCourseApp", "ScheduleData");
+    return qMax(1, settings.value("termWeeks", 16).toInt());
+}
+
+void ScheduleModel::setTerm(const QDate &start, int weeks)
+{
+    QSettings settings("MyCourseApp", "ScheduleData");
+    settings.setValue("termStart", start.toString(Qt::ISODate));
+    settings.setValue("termWeeks", weeks);
+}
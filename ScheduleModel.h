@@ -0,0 +1,36 @@
+#ifndef SCHEDULEMODEL_H
+#define SCHEDULEMODEL_H
+
+#include "PersonSchedule.h"
+#include <QByteArray>
+#include <QDate>
+#include <QList>
+#include <QStringList>
+
+// 课表数据的解析与存取，不依赖任何界面类。
+// JSON 结构与 scraper.py 的输出相同：[{name, classroom, teacher, day, start_period, periods, color}, ...]
+class ScheduleModel
+{
+public:
+    enum class ParseStatus { Ok, EmptyInput, Invalid, NoCourses };
+
+    static ParseStatus parse(const QByteArray &json, QList<CourseEntry> &courses);
+    // 星期和起始节次都落在 7x12 的课表格子里
+    static bool isPlaceable(const CourseEntry &course);
+    // 课表格子里显示的文字：课名、教室、教师
+    static QString displayText(const CourseEntry &course);
+    static QStringList courseNames(const QList<CourseEntry> &courses); // 去重后的课程名
+
+    // 上一次导入的课表（QSettings "ScheduleData"/"lastScheduleJson"）
+    static QByteArray savedJson();
+    static QList<CourseEntry> loadSaved();
+    static void save(const QByteArray &json);
+
+    // 学期第一周的任意一天和总周数（"ScheduleData"/"termStart"、"termWeeks"，默认 16 周），
+    // 把每周课表展开成日历上的重复事件时使用；未设置时 termStart 为无效日期
+    static QDate termStart();
+    static int termWeeks();
+    static void setTerm(const QDate &start, int weeks);
+};
+
+#endif // SCHEDULEMODEL_H
@@ -0,0 +1,444 @@
+#include "StallWatchdog.h"
+#include "MetricsRegistry.h"
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSettings>
+#include <QStandardPaths>
+#include <QThread>
+#include <QDebug>
+
+#if defined(Q_OS_LINUX) && defined(__GLIBC__)
+#define PLANNER_STALL_BACKTRACE
+#include <cxxabi.h>
+#include <execinfo.h>
+#include <pthread.h>
+#include <cerrno>
+#include <csignal>
+#include <cstdlib>
+#elif defined(Q_OS_WIN) && (defined(Q_PROCESSOR_X86) || defined(Q_PROCESSOR_ARM_64))
+#define PLANNER_STALL_BACKTRACE_WIN
+#include <qt_windows.h>
+#include <dbghelp.h>
+#ifdef __GNUC__
+#include <cxxabi.h>
+#include <cstdlib>
+#endif
+#endif
+
+namespace {
+
+constexpr int DEFAULT_THRESHOLD_MS = 200;
+constexpr qint64 HANG_MS = 5000;                // 卡这么久还没恢复就先写一条 ongoing 记录，防止随后被强行结束
+constexpr int RING_CAPACITY = 50;
+constexpr qint64 MAX_LOG_BYTES = 256 * 1024;
+constexpr int BACKTRACE_TIMEOUT_MS = 100;
+
+// 当前主线程上的标签；只有主线程写，看门狗线程读，都是字符串字面量
+std::atomic<Qt::HANDLE> g_guiThread{nullptr};
+std::atomic<const char *> g_action{nullptr};
+std::atomic<const char *> g_operation{nullptr};
+
+QString tagText(const char *tag)
+{
+    return tag ? QString::fromUtf8(tag) : QString();
+}
+
+#ifdef PLANNER_STALL_BACKTRACE
+constexpr int BACKTRACE_SIGNAL = SIGUSR2;
+constexpr int MAX_FRAMES = 64;
+constexpr int SKIPPED_FRAMES = 2; // 信号处理函数本身和内核的信号跳板
+
+pthread_t g_guiPthread;
+bool g_backtraceReady = false;
+void *g_frames[MAX_FRAMES];
+std::atomic<int> g_frameCount{-1};
+
+void onBacktraceSignal(int)
+{
+    const int savedErrno = errno;
+    g_frameCount.store(backtrace(g_frames, MAX_FRAMES), std::memory_order_release);
+    errno = savedErrno;
+}
+
+// 别的库已经在用这个信号就不采集调用栈
+void installBacktraceHandler()
+{
+    if (g_backtraceReady) return;
+    struct sigaction previous {};
+    if (sigaction(BACKTRACE_SIGNAL, nullptr, &previous) != 0 || previous.sa_handler != SIG_DFL) {
+        qDebug() << "SIGUSR2 已被占用，卡顿记录不含调用栈";
+        return;
+    }
+    // 第一次调用 backtrace() 会加载 libgcc 并分配内存，不能发生在信号处理函数里
+    void *warmup[1];
+    backtrace(warmup, 1);
+    struct sigaction action {};
+    action.sa_handler = onBacktraceSignal;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESTART;
+    g_backtraceReady = sigaction(BACKTRACE_SIGNAL, &action, nullptr) == 0;
+}
+
+// "路径(符号+偏移) [地址]" 里的 C++ 符号还原成可读的函数名
+QString symbolize(const char *symbol, void *address)
+{
+    if (!symbol) return QString("0x%1").arg(quintptr(address), 0, 16);
+    QString text = QString::fromLocal8Bit(symbol);
+    const qsizetype open = text.indexOf('(');
+    const qsizetype plus = open < 0 ? -1 : text.indexOf('+', open);
+    if (plus <= open + 1) return text;
+    const QByteArray mangled = text.mid(open + 1, plus - open - 1).toLatin1();
+    int status = 0;
+    char *demangled = abi::__cxa_demangle(mangled.constData(), nullptr, nullptr, &status);
+    if (status == 0 && demangled) text.replace(open + 1, plus - open - 1, QString::fromUtf8(demangled));
+    free(demangled);
+    return text;
+}
+#endif
+
+#ifdef PLANNER_STALL_BACKTRACE_WIN
+constexpr int MAX_FRAMES = 64;
+
+HANDLE g_guiThreadHandle = nullptr;
+bool g_symbolsReady = false;
+
+// DbgHelp 不是线程安全的：初始化在 start() 里、看门狗线程启动之前做，之后只有看门狗线程调用
+void initSymbols()
+{
+    if (g_symbolsReady) return;
+    SymSetOptions(SymGetOptions() | SYMOPT_UNDNAME | SYMOPT_DEFERRED_LOADS | SYMOPT_LINES);
+    g_symbolsReady = SymInitialize(GetCurrentProcess(), nullptr, TRUE);
+    if (!g_symbolsReady) qDebug() << "SymInitialize 失败，卡顿记录不含调用栈：" << GetLastError();
+}
+
+// 挂起的线程上下文里取出栈遍历的起点
+DWORD prepareFrame(const CONTEXT &context, STACKFRAME64 &frame)
+{
+    frame.AddrPC.Mode = frame.AddrFrame.Mode = frame.AddrStack.Mode = AddrModeFlat;
+#if defined(Q_PROCESSOR_X86_64)
+    frame.AddrPC.Offset = context.Rip;
+    frame.AddrFrame.Offset = context.Rbp;
+    frame.AddrStack.Offset = context.Rsp;
+    return IMAGE_FILE_MACHINE_AMD64;
+#elif defined(Q_PROCESSOR_X86_32)
+    frame.AddrPC.Offset = context.Eip;
+    frame.AddrFrame.Offset = context.Ebp;
+    frame.AddrStack.Offset = context.Esp;
+    return IMAGE_FILE_MACHINE_I386;
+#else
+    frame.AddrPC.Offset = context.Pc;
+    frame.AddrFrame.Offset = context.Fp;
+    frame.AddrStack.Offset = context.Sp;
+    return IMAGE_FILE_MACHINE_ARM64;
+#endif
+}
+
+#ifdef Q_PROCESSOR_X86_64
+// 主线程挂起时可能正拿着堆锁或加载器锁，遍历期间不能分配内存、不能进加载器。
+// x64 的展开信息直接由 RtlLookupFunctionEntry 从已加载模块的 .pdata 里查，不经过 DbgHelp 的符号加载
+PVOID CALLBACK functionTableAccess(HANDLE, DWORD64 address)
+{
+    DWORD64 imageBase = 0;
+    return RtlLookupFunctionEntry(address, &imageBase, nullptr);
+}
+
+DWORD64 CALLBACK moduleBase(HANDLE, DWORD64 address)
+{
+    DWORD64 imageBase = 0;
+    RtlLookupFunctionEntry(address, &imageBase, nullptr);
+    return imageBase;
+}
+#else
+PFUNCTION_TABLE_ACCESS_ROUTINE64 functionTableAccess = SymFunctionTableAccess64;
+PGET_MODULE_BASE_ROUTINE64 moduleBase = SymGetModuleBase64;
+#endif
+
+// "函数+偏移 (文件:行) [地址]"；MSVC 的符号来自 PDB，MinGW 只有导出表里的名字（见 QTfinal.pro）
+QString symbolize(DWORD64 address)
+{
+    const HANDLE process = GetCurrentProcess();
+    alignas(SYMBOL_INFO) char buffer[sizeof(SYMBOL_INFO) + MAX_SYM_NAME];
+    auto *symbol = reinterpret_cast<SYMBOL_INFO *>(buffer);
+    symbol->SizeOfStruct = sizeof(SYMBOL_INFO);
+    symbol->MaxNameLen = MAX_SYM_NAME;
+    DWORD64 displacement = 0;
+    if (!SymFromAddr(process, address, &displacement, symbol)) return QString("0x%1").arg(address, 0, 16);
+
+    QString name = QString::fromLocal8Bit(symbol->Name);
+#ifdef __GNUC__
+    int status = 0;
+    char *demangled = abi::__cxa_demangle(symbol->Name, nullptr, nullptr, &status);
+    if (status == 0 && demangled) name = QString::fromUtf8(demangled);
+    free(demangled);
+#endif
+    QString text = QString("%1+0x%2").arg(name).arg(displacement, 0, 16);
+    IMAGEHLP_LINE64 line {};
+    line.SizeOfStruct = sizeof(line);
+    DWORD lineDisplacement = 0;
+    if (SymGetLineFromAddr64(process, address, &lineDisplacement, &line)) {
+        text += QString(" (%1:%2)").arg(QString::fromLocal8Bit(line.FileName)).arg(line.LineNumber);
+    }
+    return text + QString(" [0x%1]").arg(address, 0, 16);
+}
+#endif
+
+} // namespace
+
+StallWatchdog &StallWatchdog::instance()
+{
+    static StallWatchdog instance;
+    return instance;
+}
+
+StallWatchdog::~StallWatchdog()
+{
+    stop();
+}
+
+StallWatchdog::Operation::Operation(const char *tag)
+{
+    if (QThread::currentThreadId() != g_guiThread.load(std::memory_order_relaxed)) return;
+    m_active = true;
+    m_previous = g_operation.exchange(tag, std::memory_order_relaxed);
+    if (!m_previous) g_action.store(tag, std::memory_order_relaxed);
+}
+
+StallWatchdog::Operation::~Operation()
+{
+    if (!m_active) return;
+    g_operation.store(m_previous, std::memory_order_relaxed);
+    if (!m_previous) g_action.store(nullptr, std::memory_order_relaxed);
+}
+
+bool StallWatchdog::startFromSettings()
+{
+    QSettings settings("MyCourseApp", "Watchdog");
+    const int threshold = qEnvironmentVariableIsSet("PLANNER_STALL_MS")
+                              ? qEnvironmentVariableIntValue("PLANNER_STALL_MS")
+                              : settings.value("thresholdMs", DEFAULT_THRESHOLD_MS).toInt();
+    if (threshold <= 0) return false;
+    start(threshold);
+    return true;
+}
+
+void StallWatchdog::start(int thresholdMs)
+{
+    stop();
+    m_thresholdMs = qMax(1, thresholdMs);
+    const QString dataDir = QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation);
+    QDir().mkpath(dataDir);
+    m_logPath = dataDir + "/stalls.log";
+
+    g_guiThread.store(QThread::currentThreadId(), std::memory_order_relaxed);
+#ifdef PLANNER_STALL_BACKTRACE
+    g_guiPthread = pthread_self();
+    installBacktraceHandler();
+#elif defined(PLANNER_STALL_BACKTRACE_WIN)
+    // GetCurrentThread() 只是伪句柄，换成看门狗线程也能用的真句柄
+    g_guiThreadHandle = OpenThread(THREAD_SUSPEND_RESUME | THREAD_GET_CONTEXT | THREAD_QUERY_INFORMATION,
+                                   FALSE, GetCurrentThreadId());
+    initSymbols();
+#endif
+
+    m_receiver = new QObject();
+    m_clock.start();
+    m_pongNs.store(0);
+    m_stopRequested = false;
+    m_thread = QThread::create([this] { run(); });
+    m_thread->setObjectName("StallWatchdog");
+    m_thread->start(QThread::HighPriority);
+
+    // 退出阶段事件循环已经停了，ping 不会再被处理，不能当成卡顿
+    static bool quitHooked = false;
+    if (!quitHooked && QCoreApplication::instance()) {
+        quitHooked = true;
+        QObject::connect(QCoreApplication::instance(), &QCoreApplication::aboutToQuit, [] { instance().stop(); });
+    }
+}
+
+void StallWatchdog::stop()
+{
+    if (!m_thread) return;
+    {
+        QMutexLocker locker(&m_stopMutex);
+        m_stopRequested = true;
+        m_stopCondition.wakeAll();
+    }
+    m_thread->wait();
+    delete m_thread;
+    m_thread = nullptr;
+    // 还没处理的 ping 随接收者一起丢弃
+    delete m_receiver;
+    m_receiver = nullptr;
+    g_guiThread.store(nullptr, std::memory_order_relaxed);
+#ifdef PLANNER_STALL_BACKTRACE_WIN
+    if (g_guiThreadHandle) CloseHandle(g_guiThreadHandle);
+    g_guiThreadHandle = nullptr;
+#endif
+}
+
+void StallWatchdog::run()
+{
+    // 检查间隔决定了卡顿时长的精度
+    const int intervalMs = qBound(10, m_thresholdMs / 4, 250);
+    qint64 sentNs = -1; // 还没得到回应的 ping 的发出时刻
+    bool stalled = false;
+    bool persisted = false;
+    Stall current;
+
+    QMutexLocker locker(&m_stopMutex);
+    while (!m_stopRequested) {
+        m_stopCondition.wait(&m_stopMutex, intervalMs);
+        if (m_stopRequested) break;
+
+        if (sentNs < 0) {
+            sentNs = m_clock.nsecsElapsed();
+            QMetaObject::invokeMethod(m_receiver, [this] {
+                m_pongNs.store(m_clock.nsecsElapsed(), std::memory_order_release);
+            }, Qt::QueuedConnection);
+            continue;
+        }
+
+        const qint64 pongNs = m_pongNs.load(std::memory_order_acquire);
+        if (pongNs >= sentNs) {
+            if (stalled) {
+                current.durationMs = (pongNs - sentNs) / 1000000;
+                current.ongoing = false;
+                finishStall(current);
+            }
+            stalled = persisted = false;
+            sentNs = -1;
+            continue;
+        }
+
+        const qint64 waitedMs = (m_clock.nsecsElapsed() - sentNs) / 1000000;
+        if (!stalled && waitedMs >= m_thresholdMs) {
+            // 在卡住的当下取标签和调用栈，这时主线程停在的位置就是罪魁
+            current = beginStall(waitedMs);
+            stalled = true;
+        } else if (stalled && !persisted && waitedMs >= HANG_MS) {
+            current.durationMs = waitedMs;
+            current.ongoing = true;
+            appendToLog(current);
+            persisted = true;
+        }
+    }
+}
+
+StallWatchdog::Stall StallWatchdog::beginStall(qint64 waitedMs) const
+{
+    Stall stall;
+    stall.startedAt = QDateTime::currentDateTime().addMSecs(-waitedMs);
+    stall.action = tagText(g_action.load(std::memory_order_relaxed));
+    stall.operation = tagText(g_operation.load(std::memory_order_relaxed));
+    stall.backtrace = captureGuiBacktrace();
+    return stall;
+}
+
+void StallWatchdog::finishStall(Stall stall)
+{
+    const QString action = stall.action.isEmpty() ? QString("untagged") : stall.action;
+    MetricsRegistry &metrics = MetricsRegistry::instance();
+    metrics.counter("planner_gui_stalls_total", {{"action", action}})->increment();
+    metrics.histogram("planner_gui_stall_seconds", {{"action", action}})->record(stall.durationMs * 1000);
+
+    qWarning() << "界面卡顿" << stall.durationMs << "ms，操作：" << action
+               << (stall.operation != stall.action ? stall.operation : QString());
+    appendToLog(stall);
+
+    QMutexLocker locker(&m_ringMutex);
+    if (m_ring.size() < RING_CAPACITY) {
+        m_ring.append(std::move(stall));
+    } else {
+        m_ring[m_ringNext] = std::move(stall);
+    }
+    m_ringNext = (m_ringNext + 1) % RING_CAPACITY;
+}
+
+QList<StallWatchdog::Stall> StallWatchdog::recentStalls() const
+{
+    QMutexLocker locker(&m_ringMutex);
+    if (m_ring.size() < RING_CAPACITY) return m_ring;
+    return m_ring.mid(m_ringNext) + m_ring.mid(0, m_ringNext);
+}
+
+void StallWatchdog::appendToLog(const Stall &stall) const
+{
+    // 日志只保留两代：当前文件写满后改名为 .1，覆盖更早的那一份
+    QFile file(m_logPath);
+    if (file.size() > MAX_LOG_BYTES) {
+        QFile::remove(m_logPath + ".1");
+        QFile::rename(m_logPath, m_logPath + ".1");
+    }
+    if (!file.open(QIODevice::Append)) {
+        qDebug() << "无法写入卡顿记录：" << file.errorString();
+        return;
+    }
+    QJsonObject obj{{"started", stall.startedAt.toString(Qt::ISODateWithMs)},
+                    {"ms", stall.durationMs},
+                    {"threshold", m_thresholdMs},
+                    {"action", stall.action},
+                    {"operation", stall.operation},
+                    {"backtrace", QJsonArray::fromStringList(stall.backtrace)}};
+    // 同一次卡顿可能先写一条 ongoing，恢复后再写最终的一条，按 started 去重
+    if (stall.ongoing) obj.insert("ongoing", true);
+    file.write(QJsonDocument(obj).toJson(QJsonDocument::Compact) + '\n');
+}
+
+QStringList StallWatchdog::captureGuiBacktrace() const
+{
+#ifdef PLANNER_STALL_BACKTRACE
+    if (!g_backtraceReady) return {};
+    g_frameCount.store(-1, std::memory_order_relaxed);
+    if (pthread_kill(g_guiPthread, BACKTRACE_SIGNAL) != 0) return {};
+
+    QElapsedTimer waited;
+    waited.start();
+    int count;
+    while ((count = g_frameCount.load(std::memory_order_acquire)) < 0) {
+        // 主线程屏蔽了信号（例如卡在内核里）时拿不到
+        if (waited.elapsed() > BACKTRACE_TIMEOUT_MS) return {};
+        QThread::usleep(200);
+    }
+
+    QStringList frames;
+    char **symbols = backtrace_symbols(g_frames, count);
+    for (int i = SKIPPED_FRAMES; i < count; ++i) {
+        frames << symbolize(symbols ? symbols[i] : nullptr, g_frames[i]);
+    }
+    free(symbols);
+    return frames;
+#elif defined(PLANNER_STALL_BACKTRACE_WIN)
+    if (!g_symbolsReady || !g_guiThreadHandle) return {};
+    if (SuspendThread(g_guiThreadHandle) == DWORD(-1)) return {};
+
+    // 挂起期间只收集返回地址，尽量少做事；查符号要读 PDB、分配内存，放到恢复主线程之后
+    DWORD64 addresses[MAX_FRAMES];
+    int count = 0;
+    CONTEXT context {};
+    context.ContextFlags = CONTEXT_FULL;
+    if (GetThreadContext(g_guiThreadHandle, &context)) {
+        STACKFRAME64 frame {};
+        const DWORD machine = prepareFrame(context, frame);
+        while (count < MAX_FRAMES
+               && StackWalk64(machine, GetCurrentProcess(), g_guiThreadHandle, &frame, &context, nullptr,
+                              functionTableAccess, moduleBase, nullptr)
+               && frame.AddrPC.Offset != 0) {
+            addresses[count++] = frame.AddrPC.Offset;
+        }
+    }
+    ResumeThread(g_guiThreadHandle);
+
+    QStringList frames;
+    for (int i = 0; i < count; ++i) {
+        frames << symbolize(addresses[i]);
+    }
+    return frames;
+#else
+    return {};
+#endif
+}
@@ -0,0 +1,90 @@
+#ifndef STALLWATCHDOG_H
+#define STALLWATCHDOG_H
+
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QList>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+#include <QWaitCondition>
+#include <atomic>
+
+class QObject;
+class QThread;
+
+// 界面卡顿看门狗：后台线程定时往主线程的事件队列里投一个 ping，超过阈值还没被处理就算一次卡顿，
+// 记下卡了多久、当时在做什么（Operation 标签）和主线程的调用栈。
+// 最近的记录留在内存里的环形缓冲（诊断面板显示），同时追加到应用数据目录下的 stalls.log
+// （JSON Lines，超过 256 KB 轮换成 stalls.log.1），并计入指标 planner_gui_stalls_total、planner_gui_stall_seconds。
+// 阈值取环境变量 PLANNER_STALL_MS，否则取 QSettings "Watchdog" 的 thresholdMs（默认 200），为 0 时不启动。
+// 调用栈在 Linux（glibc）上给主线程发 SIGUSR2，由信号处理函数调用 backtrace()；
+// 在 Windows 上挂起主线程，取线程上下文后用 DbgHelp 的 StackWalk64 遍历，恢复后再用 SymFromAddr 查符号。
+// 其他平台只有标签。
+class StallWatchdog
+{
+public:
+    struct Stall {
+        QDateTime startedAt;
+        qint64 durationMs = 0;
+        QString action;       // 最外层的标签，通常对应一次用户操作
+        QString operation;    // 最内层的标签，例如某个数据库操作
+        QStringList backtrace;
+        bool ongoing = false; // 写记录时主线程还没恢复
+    };
+
+    static StallWatchdog &instance();
+
+    // 按环境变量和设置启动，阈值为 0 时返回 false；必须在主线程调用
+    bool startFromSettings();
+    void start(int thresholdMs);
+    void stop();
+    bool isRunning() const { return m_thread != nullptr; }
+    int thresholdMs() const { return m_thresholdMs; }
+    QString logPath() const { return m_logPath; }
+
+    // 最近的卡顿记录，旧的在前
+    QList<Stall> recentStalls() const;
+
+    // 给主线程上的一段代码打标签，可以嵌套；只接受字符串字面量，不复制。
+    // 看门狗没启动或不在主线程时什么也不做
+    class Operation
+    {
+    public:
+        explicit Operation(const char *tag);
+        ~Operation();
+        Operation(const Operation &) = delete;
+        Operation &operator=(const Operation &) = delete;
+
+    private:
+        const char *m_previous = nullptr;
+        bool m_active = false;
+    };
+
+private:
+    StallWatchdog() = default;
+    ~StallWatchdog();
+
+    void run();
+    Stall beginStall(qint64 waitedMs) const;
+    void finishStall(Stall stall);
+    void appendToLog(const Stall &stall) const;
+    QStringList captureGuiBacktrace() const;
+
+    QThread *m_thread = nullptr;
+    QObject *m_receiver = nullptr; // 住在主线程，ping 投递给它
+    QElapsedTimer m_clock;
+    std::atomic<qint64> m_pongNs{0};
+    int m_thresholdMs = 0;
+    QString m_logPath;
+
+    QMutex m_stopMutex;
+    QWaitCondition m_stopCondition;
+    bool m_stopRequested = false;
+
+    mutable QMutex m_ringMutex;
+    QList<Stall> m_ring;
+    int m_ringNext = 0;
+};
+
+#endif // STALLWATCHDOG_H
@@ -0,0 +1,147 @@
+#include "StartupTrace.h"
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QEvent>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QStandardPaths>
+#include <QTextStream>
+#include <QTimer>
+#include <QWidget>
+
+StartupTrace &StartupTrace::instance()
+{
+    static StartupTrace instance;
+    return instance;
+}
+
+void StartupTrace::start()
+{
+    m_clock.start();
+    m_events.reserve(32);
+    record("process-start", 'i', 0, 0);
+}
+
+void StartupTrace::mark(const char *name)
+{
+    record(name, 'i', nowUs(), 0);
+}
+
+void StartupTrace::record(const char *name, char phase, qint64 startUs, qint64 durationUs)
+{
+    if (m_finished) return;
+    m_events.append({name, phase, startUs, durationUs});
+}
+
+StartupTrace::Scope::Scope(const char *name)
+    : m_name(name)
+    , m_startUs(StartupTrace::instance().nowUs())
+{
+}
+
+StartupTrace::Scope::~Scope()
+{
+    StartupTrace &trace = StartupTrace::instance();
+    trace.record(m_name, 'X', m_startUs, trace.nowUs() - m_startUs);
+}
+
+void StartupTrace::watchFirstFrame(QWidget *window)
+{
+    if (m_firstFrameUs >= 0 || !window) return;
+    m_watchedWindow = window;
+    window->installEventFilter(this);
+}
+
+bool StartupTrace::eventFilter(QObject *watched, QEvent *event)
+{
+    if (watched == m_watchedWindow && event->type() == QEvent::Paint) {
+        m_watchedWindow->removeEventFilter(this);
+        m_watchedWindow = nullptr;
+        mark("first-paint");
+        // 绘制事件处理完后 backing store 才会刷到屏幕，排到事件队列末尾再记首帧
+        QTimer::singleShot(0, this, [this]() {
+            m_firstFrameUs = nowUs();
+            record("first-frame", 'i', m_firstFrameUs, 0);
+            emit firstFramePainted(m_firstFrameUs / 1000);
+        });
+    }
+    return QObject::eventFilter(watched, event);
+}
+
+void StartupTrace::finish()
+{
+    if (m_finished) return;
+    mark("startup-finished");
+    m_finished = true;
+
+    const qint64 readyMs = elapsedMs();
+    qDebug().noquote() << QString("启动耗时：首帧 %1 ms，全部就绪 %2 ms").arg(firstFrameMs()).arg(readyMs);
+    for (const Event &e : std::as_const(m_events)) {
+        if (e.phase == 'X') {
+            qDebug().noquote() << QString("  %1 %2 ms (+%3 ms)")
+                                      .arg(QString::fromLatin1(e.name), -24)
+                                      .arg(e.durationUs / 1000.0, 0, 'f', 1)
+                                      .arg(e.startUs / 1000.0, 0, 'f', 1);
+        }
+    }
+
+    const QString dataDir = QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation);
+    QDir().mkpath(dataDir);
+    appendHistory(dataDir);
+
+    const QByteArray traceEnv = qgetenv("PLANNER_STARTUP_TRACE");
+    if (!traceEnv.isEmpty()) {
+        const QString path = traceEnv == "1" ? dataDir + "/startup_trace.json"
+                                             : QString::fromLocal8Bit(traceEnv);
+        writeChromeTrace(path);
+    }
+}
+
+// 每次启动追加一行：时间、版本、首帧毫秒、就绪毫秒
+void StartupTrace::appendHistory(const QString &dir) const
+{
+    QFile file(dir + "/startup_times.log");
+    if (!file.open(QIODevice::Append | QIODevice::Text)) {
+        qDebug() << "无法写入启动耗时记录：" << file.errorString();
+        return;
+    }
+    QTextStream out(&file);
+    out << QDateTime::currentDateTime().toString(Qt::ISODate) << '\t'
+        << QCoreApplication::applicationVersion() << '\t'
+        << firstFrameMs() << '\t'
+        << elapsedMs() << '\n';
+}
+
+void StartupTrace::writeChromeTrace(const QString &path) const
+{
+    const qint64 pid = QCoreApplication::applicationPid();
+    QJsonArray traceEvents;
+    for (const Event &e : std::as_const(m_events)) {
+        QJsonObject obj;
+        obj["name"] = QString::fromLatin1(e.name);
+        obj["cat"] = "startup";
+        obj["ph"] = QString(QChar::fromLatin1(e.phase));
+        obj["ts"] = e.startUs;
+        obj["pid"] = pid;
+        obj["tid"] = 1;
+        if (e.phase == 'X') {
+            obj["dur"] = e.durationUs;
+        } else {
+            obj["s"] = "g";
+        }
+        traceEvents.append(obj);
+    }
+
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qDebug() << "无法写入启动 trace 文件：" << path << file.errorString();
+        return;
+    }
+    file.write(QJsonDocument(QJsonObject{{"traceEvents", traceEvents},
+                                         {"displayTimeUnit", "ms"}}).toJson(QJsonDocument::Compact));
+    qDebug() << "启动 trace 已写入：" << path;
+}
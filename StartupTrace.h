@@ -0,0 +1,75 @@
+#ifndef STARTUPTRACE_H
+#define STARTUPTRACE_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QList>
+
+class QWidget;
+
+// 启动过程计时：记录各阶段的起止时间和首帧时间。
+// 结束后打印摘要，并在 startup_times.log 里追加一行，便于逐版本对比；
+// 设置环境变量 PLANNER_STARTUP_TRACE 时额外写出 Chrome trace JSON
+// （值为文件路径，或为 1 时写到应用数据目录下的 startup_trace.json），可用 chrome://tracing 打开。
+class StartupTrace : public QObject
+{
+    Q_OBJECT
+
+public:
+    static StartupTrace &instance();
+
+    // main() 最开始调用，之后的时间都相对这一刻
+    void start();
+    // 瞬时事件
+    void mark(const char *name);
+    // 监视窗口的第一次绘制，完成后发出 firstFramePainted
+    void watchFirstFrame(QWidget *window);
+    // 启动阶段全部结束：打印摘要并写出记录，只生效一次
+    void finish();
+
+    qint64 elapsedMs() const { return m_clock.isValid() ? m_clock.elapsed() : 0; }
+    qint64 firstFrameMs() const { return m_firstFrameUs < 0 ? -1 : m_firstFrameUs / 1000; }
+
+    // 作用域内的代码记为一个阶段
+    class Scope
+    {
+    public:
+        explicit Scope(const char *name);
+        ~Scope();
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+
+    private:
+        const char *m_name;
+        qint64 m_startUs;
+    };
+
+signals:
+    void firstFramePainted(qint64 elapsedMs);
+
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) override;
+
+private:
+    StartupTrace() = default;
+
+    struct Event {
+        const char *name; // 只接受字符串字面量，不复制
+        char phase;       // 'X' 阶段，'i' 瞬时事件
+        qint64 startUs;
+        qint64 durationUs;
+    };
+
+    qint64 nowUs() const { return m_clock.isValid() ? m_clock.nsecsElapsed() / 1000 : 0; }
+    void record(const char *name, char phase, qint64 startUs, qint64 durationUs);
+    void writeChromeTrace(const QString &path) const;
+    void appendHistory(const QString &dir) const;
+
+    QElapsedTimer m_clock;
+    QList<Event> m_events;
+    QWidget *m_watchedWindow = nullptr;
+    qint64 m_firstFrameUs = -1;
+    bool m_finished = false;
+};
+
+#endif // STARTUPTRACE_H
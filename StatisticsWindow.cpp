@@ -1,5 +1,8 @@
 #include "StatisticsWindow.h"
 #include "DatabaseManager.h"
+#include "MetricsRegistry.h"
+#include "StallWatchdog.h"
+#include "StudyStatistics.h"
 #include <QtCharts> // 包含所有Qt Charts组件
 #include <QVBoxLayout>
 #include <QHBoxLayout>
@@ -23,6 +26,8 @@ StatisticsWindow::StatisticsWindow(QWidget *parent)
             this, &StatisticsWindow::onChartTypeChanged);
     connect(lineChartButton, &QPushButton::clicked,
             this, &StatisticsWindow::onChartTypeChanged);
+    connect(tagChartButton, &QPushButton::clicked,
+            this, &StatisticsWindow::onChartTypeChanged);
     connect(unitComboBox, QOverload<int>::of(&QComboBox::currentIndexChanged),
             this, &StatisticsWindow::onUnitChanged);
     connect(deleteButton, &QPushButton::clicked,
@@ -40,6 +45,7 @@ void StatisticsWindow::setupUi()
     // --- 创建顶部工具栏控件 ---
     barChartButton = new QPushButton("条形图");
     lineChartButton = new QPushButton("折线图");
+    tagChartButton = new QPushButton("课程分布");
     unitComboBox = new QComboBox();
     deleteButton = new QPushButton("删除所有记录");
 
@@ -55,6 +61,7 @@ void StatisticsWindow::setupUi()
     topLayout->addWidget(new QLabel("图表类型:"));
     topLayout->addWidget(barChartButton);
     topLayout->addWidget(lineChartButton);
+    topLayout->addWidget(tagChartButton);
     topLayout->addSpacing(30);
     topLayout->addWidget(new QLabel("时间单位:"));
     topLayout->addWidget(unitComboBox);
@@ -90,6 +97,11 @@ void StatisticsWindow::setupUi()
 
 void StatisticsWindow::drawChart()
 {
+    static const char *const chartNames[] = {"bar", "line", "tag"};
+    StallWatchdog::Operation tag("chart-rebuild");
+    const MetricsRegistry::ScopedTimer timer(MetricsRegistry::instance().histogram(
+        "planner_chart_rebuild_seconds", {{"chart", chartNames[currentChartType]}}));
+
     // 从数据库获取每日学习时长数据
     QMap<QDate, int> dailyDurations = DatabaseManager::instance().getDailyStudyDurations();
 
@@ -100,46 +112,27 @@ void StatisticsWindow::drawChart()
     }
     stackedWidget->setCurrentIndex(0); // 显示图表页面
 
-    // 设置单位转换因子
-    double conversionFactor = 1.0;
-    QString unitName;
-    switch (currentTimeUnit) {
-    case Seconds:
-        conversionFactor = 1.0;
-        unitName = "秒";
-        break;
-    case Minutes:
-        conversionFactor = 60.0;
-        unitName = "分钟";
-        break;
-    case Hours:
-        conversionFactor = 3600.0;
-        unitName = "小时";
-        break;
-    }
+    // 单位换算和按日期排序都在 StudyStatistics 里完成
+    const QString unitName = StudyStatistics::unitName(currentTimeUnit);
     QString yAxisTitle = QString("时长 (%1)").arg(unitName);
 
-    // 准备数据：按日期排序
-    QList<QDate> sortedDates = dailyDurations.keys();
-    std::sort(sortedDates.begin(), sortedDates.end());
+    if (currentChartType == TagPie) {
+        drawTagChart(unitName);
+        return;
+    }
 
-    // 准备类别标签和最大值
-    QStringList categories;
-    double maxValue = 0;
+    const StudyStatistics::Series daily = StudyStatistics::daily(dailyDurations, currentTimeUnit);
+    const QStringList &categories = daily.labels;
+    const double maxValue = daily.maxValue;
     QAbstractSeries *series = nullptr;
 
     // 创建条形图系列
     if (currentChartType == Bar) {
         QBarSeries *barSeries = new QBarSeries();
         QBarSet *set = new QBarSet(yAxisTitle);
-
-        for (const QDate& date : sortedDates) {
-            double value = static_cast<double>(dailyDurations[date]) / conversionFactor;
+        for (double value : daily.values) {
             *set << value;
-            maxValue = std::max(maxValue, value);
-            categories << date.toString("MM-dd");
         }
-
         barSeries->append(set);
         series = barSeries;
     }
@@ -147,15 +140,9 @@ void StatisticsWindow::drawChart()
     else {
         QLineSeries *lineSeries = new QLineSeries();
         lineSeries->setName(yAxisTitle);
-        int index = 0;
-
-        for (const QDate& date : sortedDates) {
-            double value = static_cast<double>(dailyDurations[date]) / conversionFactor;
-            lineSeries->append(index++, value);
-            maxValue = std::max(maxValue, value);
-            categories << date.toString("MM-dd");
+        for (int index = 0; index < daily.values.size(); ++index) {
+            lineSeries->append(index, daily.values.at(index));
         }
-
         series = lineSeries;
     }
 
@@ -188,6 +175,30 @@ void StatisticsWindow::drawChart()
     chartView->setChart(chart);
 }
 
+void StatisticsWindow::drawTagChart(const QString &unitName)
+{
+    // 一次聚合查询拿到各课程/标签的总时长，不需要逐段查询
+    const QList<StudyStatistics::Slice> slices =
+        StudyStatistics::byTag(DatabaseManager::instance().getStudyDurationsByTag(), currentTimeUnit);
+
+    QPieSeries *pieSeries = new QPieSeries();
+    for (const StudyStatistics::Slice &slice : slices) {
+        QPieSlice *pieSlice = pieSeries->append(
+            QString("%1 %2%3").arg(slice.label).arg(slice.value, 0, 'f', 1).arg(unitName),
+            slice.value);
+        pieSlice->setLabelVisible(true);
+    }
+
+    QChart *chart = new QChart();
+    chart->addSeries(pieSeries);
+    chart->setTitle("按课程/标签的自习时长分布");
+    chart->setAnimationOptions(QChart::SeriesAnimations);
+    chart->legend()->setVisible(true);
+    chart->legend()->setAlignment(Qt::AlignRight);
+
+    chartView->setChart(chart);
+}
+
 void StatisticsWindow::onChartTypeChanged()
 {
     // 确定当前选择的图表类型
@@ -196,6 +207,8 @@ void StatisticsWindow::onChartTypeChanged()
         currentChartType = Bar;
     } else if (button == lineChartButton) {
         currentChartType = Line;
+    } else if (button == tagChartButton) {
+        currentChartType = TagPie;
     }
 
     // 重绘图表
@@ -206,9 +219,9 @@ void StatisticsWindow::onUnitChanged()
 {
     // 更新时间单位
     switch(unitComboBox->currentIndex()) {
-    case 0: currentTimeUnit = Minutes; break;
-    case 1: currentTimeUnit = Seconds; break;
-    case 2: currentTimeUnit = Hours;   break;
+    case 0: currentTimeUnit = StudyStatistics::Minutes; break;
+    case 1: currentTimeUnit = StudyStatistics::Seconds; break;
+    case 2: currentTimeUnit = StudyStatistics::Hours;   break;
     }
 
     // 重绘图表
@@ -233,7 +246,12 @@ void StatisticsWindow::onDeleteRecordsClicked()
 
     if (input == "yes") {
         // 执行删除操作
-        if (DatabaseManager::instance().deleteAllStudySessions()) {
+        bool deleted;
+        {
+            StallWatchdog::Operation tag("delete-study-records");
+            deleted = DatabaseManager::instance().deleteAllStudySessions();
+        }
+        if (deleted) {
             QMessageBox::information(
                 this,
                 "成功",
@@ -2,6 +2,7 @@
 #define STATISTICSWINDOW_H
 
 #include <QWidget>
+#include "StudyStatistics.h"
 
 // 前向声明
 QT_BEGIN_NAMESPACE
@@ -22,11 +23,11 @@ private slots:
     void onDeleteRecordsClicked();
 
 private:
-    enum ChartType { Bar, Line };
-    enum TimeUnit { Seconds, Minutes, Hours };
+    enum ChartType { Bar, Line, TagPie };
 
     void setupUi(); // 【新增】将UI创建和逻辑分离
     void drawChart();
+    void drawTagChart(const QString &unitName); // 按课程/标签的分布图
 
     // UI 控件
     QStackedWidget *stackedWidget; // 【核心修正】使用堆叠窗口
@@ -34,12 +35,13 @@ private:
     QWidget *noDataWidget;         // 【新增】用于显示“无数据”的独立窗口
     QPushButton *barChartButton;
     QPushButton *lineChartButton;
+    QPushButton *tagChartButton;   // 按课程/标签查看
     QComboBox *unitComboBox;
     QPushButton *deleteButton;
 
     // 状态变量
     ChartType currentChartType = Bar;
-    TimeUnit currentTimeUnit = Minutes;
+    StudyStatistics::TimeUnit currentTimeUnit = StudyStatistics::Minutes;
 };
 
 #endif // STATISTICSWINDOW_H
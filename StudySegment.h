@@ -0,0 +1,16 @@
+#ifndef STUDYSEGMENT_H
+#define STUDYSEGMENT_H
+
+#include <QDateTime>
+#include <QString>
+
+// 一段连续的自习时间（暂停/切换课程/番茄钟休息都会切出新的一段）
+struct StudySegment {
+    QDateTime start;
+    QDateTime end;
+    QString tag; // 课程名或自定义标签，空字符串表示未分类
+
+    int durationSeconds() const { return static_cast<int>(start.secsTo(end)); }
+};
+
+#endif // STUDYSEGMENT_H
@@ -1,64 +1,97 @@
 #include "StudySessionDialog.h"
-#include "DatabaseManager.h"
 #include <QVBoxLayout>
 #include <QHBoxLayout>
+#include <QComboBox>
+#include <QCheckBox>
 #include <QDateTime>
-#include <QDebug>
 #include <QEvent>
-#include <QMovie> // 引入 QMovie
+#include <QLineEdit>
+#include "AnimationPlayer.h"
+#include "ScheduleModel.h"
+
+static const char *UNTAGGED_TEXT = "未分类";
 
 StudySessionDialog::StudySessionDialog(QWidget *parent)
-    : QDialog(parent), timer(new QTimer(this)), animation(nullptr) // 初始化 animation 为 nullptr
+    : QDialog(parent), animation(nullptr), timer(new QTimer(this)), // 初始化 animation 为 nullptr
+    engine(new StudySessionEngine(this))
 {
     setWindowTitle("自习中...");
-    resize(300, 400);
+    resize(320, 480);
 
     timerLabel = new QLabel("00:00:00", this);
     timerLabel->setAlignment(Qt::AlignCenter);
     timerLabel->setStyleSheet("font-size: 24px;");
 
-    gifLabel = new QLabel(this);
-    // 在这里加载您的 GIF。请确保 ":/images/Ralsei_emote.gif" 存在于您的 .qrc 文件中
-    // 假设您已经将 Ralsei_emote.gif 添加到了资源的 /images 路径下
-    animation = new QMovie(":/images/Ralsei_study_dialog.gif", QByteArray(), this);
-    if (!animation->isValid()) {
-        qDebug() << "错误：无法加载 GIF 文件: :/images/lancer.gif";
-        // 如果 GIF 加载失败，可以添加备用方案或错误处理
-    } else {
-        gifLabel->setMovie(animation);
-        animation->start(); // 开始播放 GIF 动画
-    }
+    phaseLabel = new QLabel("自习中", this);
+    phaseLabel->setAlignment(Qt::AlignCenter);
+    phaseLabel->setStyleSheet("font-size: 14px; color: #555;");
 
+    gifLabel = new QLabel(this);
     gifLabel->setAlignment(Qt::AlignCenter);
     gifLabel->setFixedSize(200, 200);
+
+    // 缩放好的帧由 AssetService 缓存，每次开始自习都直接复用，不再重新解码 GIF
+    animation = new AnimationPlayer(gifLabel, this);
+    animation->setSource(":/images/Ralsei_study_dialog.gif", gifLabel->size());
+    animation->start();
     // 之前用于 QPixmap 鼠标悬停效果的事件过滤器已不再需要用于 GIF 播放
     // gifLabel->installEventFilter(this); // 如果没有其他过滤需求，可以移除此行
 
+    // 课程/标签选择：默认列出课表中的课程，也可以手动输入自定义标签
+    tagComboBox = new QComboBox(this);
+    tagComboBox->setEditable(true);
+    tagComboBox->addItem(UNTAGGED_TEXT);
+    tagComboBox->addItems(loadCourseTags());
+    // 可编辑的下拉框每敲一个字都会改 currentText，只在选中一项或输完回车/离开输入框时切换标签，
+    // 否则输入 "math" 会先后记下 "m"、"ma"、"mat" 三段
+    connect(tagComboBox, &QComboBox::activated,
+            this, &StudySessionDialog::onTagChanged);
+    connect(tagComboBox->lineEdit(), &QLineEdit::editingFinished,
+            this, &StudySessionDialog::onTagChanged);
+
+    pomodoroCheckBox = new QCheckBox("番茄钟模式 (25+5)", this);
+    connect(pomodoroCheckBox, &QCheckBox::toggled,
+            this, &StudySessionDialog::onPomodoroToggled);
+
+    pauseButton = new QPushButton("暂停", this);
+    connect(pauseButton, &QPushButton::clicked,
+            this, &StudySessionDialog::onPauseResumeClicked);
+
     endButton = new QPushButton("结束自习", this);
     connect(endButton, &QPushButton::clicked,
             this, &StudySessionDialog::onEndSessionClicked);
 
+    connect(engine, &StudySessionEngine::phaseChanged,
+            this, &StudySessionDialog::onPhaseChanged);
+
+    QHBoxLayout *tagLayout = new QHBoxLayout;
+    tagLayout->addWidget(new QLabel("课程/标签:", this));
+    tagLayout->addWidget(tagComboBox, 1);
+
+    QHBoxLayout *buttonLayout = new QHBoxLayout;
+    buttonLayout->addWidget(pauseButton);
+    buttonLayout->addWidget(endButton);
+
     QVBoxLayout *mainLayout = new QVBoxLayout(this);
     mainLayout->setContentsMargins(20, 20, 20, 20);
-    mainLayout->setSpacing(20);
+    mainLayout->setSpacing(12);
 
     mainLayout->addWidget(timerLabel, 0, Qt::AlignHCenter);
+    mainLayout->addWidget(phaseLabel, 0, Qt::AlignHCenter);
     mainLayout->addWidget(gifLabel, 0, Qt::AlignHCenter);
-    mainLayout->addWidget(endButton, 0, Qt::AlignHCenter);
+    mainLayout->addLayout(tagLayout);
+    mainLayout->addWidget(pomodoroCheckBox);
+    mainLayout->addLayout(buttonLayout);
 
     setLayout(mainLayout);
 
-    startTime = QTime::currentTime(); // 初始化为当前时间
-    timerLabel->setText("00:00:00");
-
     connect(timer, &QTimer::timeout,
             this, &StudySessionDialog::updateTimer);
-    timer->start(1000);
 }
 
 void StudySessionDialog::updateTimer()
 {
-    int elapsed = startTime.secsTo(QTime::currentTime());
+    int elapsed = engine->elapsedSeconds();
     int hours = elapsed / 3600;
     int minutes = (elapsed % 3600) / 60;
     int seconds = elapsed % 60;
@@ -68,32 +101,100 @@ void StudySessionDialog::updateTimer()
             .arg(minutes, 2, 10, QChar('0'))
             .arg(seconds, 2, 10, QChar('0'))
         );
+
+    // 番茄钟模式下额外显示当前阶段的剩余时间
+    int remaining = engine->phaseRemainingSeconds();
+    if (remaining >= 0) {
+        onPhaseChanged(engine->phase());
+    }
 }
 
 void StudySessionDialog::onEndSessionClicked()
 {
     timer->stop();
-    // 使用 state() 函数检查 QMovie 的状态
-    if (animation && animation->state() == QMovie::Running) {
+    if (animation && animation->isRunning()) {
         animation->stop(); // 在会话结束时停止 GIF 动画
     }
-    QDateTime endDateTime = QDateTime::currentDateTime();
-    QDateTime startDateTime(QDate::currentDate(), startTime);
 
-    saveStudySession(startDateTime, endDateTime);
+    // 结束时把缓存的全部分段一次性写入数据库
+    engine->finish();
 
     accept();
 }
 
-void StudySessionDialog::saveStudySession(const QDateTime &start, const QDateTime &end)
+void StudySessionDialog::onPauseResumeClicked()
+{
+    if (engine->phase() == StudySessionEngine::Phase::Paused) {
+        engine->resume();
+    } else {
+        engine->pause();
+    }
+}
+
+void StudySessionDialog::onTagChanged()
+{
+    engine->setTag(currentTag());
+}
+
+void StudySessionDialog::onPomodoroToggled(bool enabled)
 {
-    int durationSeconds = start.secsTo(end);
-    qDebug() << "自习开始:" << start.toString(Qt::ISODate)
-             << " 结束:" << end.toString(Qt::ISODate)
-             << " 时长(秒):" << durationSeconds;
+    engine->setPomodoroEnabled(enabled);
+    updateTimer();
+}
+
+void StudySessionDialog::onPhaseChanged(StudySessionEngine::Phase phase)
+{
+    QString text;
+    switch (phase) {
+    case StudySessionEngine::Phase::Working:    text = "自习中"; break;
+    case StudySessionEngine::Phase::Paused:     text = "已暂停"; break;
+    case StudySessionEngine::Phase::ShortBreak: text = "短休息"; break;
+    case StudySessionEngine::Phase::LongBreak:  text = "长休息"; break;
+    case StudySessionEngine::Phase::Idle:       text = "已结束"; break;
+    }
+
+    int remaining = engine->phaseRemainingSeconds();
+    if (remaining >= 0) {
+        text += QString("  剩余 %1:%2")
+                    .arg(remaining / 60, 2, 10, QChar('0'))
+                    .arg(remaining % 60, 2, 10, QChar('0'));
+    }
+    if (engine->completedPomodoros() > 0) {
+        text += QString("  🍅×%1").arg(engine->completedPomodoros());
+    }
+    phaseLabel->setText(text);
+    pauseButton->setText(phase == StudySessionEngine::Phase::Paused ? "继续" : "暂停");
+
+    // 暂停和休息时停下动画
+    if (animation) {
+        animation->setPaused(phase != StudySessionEngine::Phase::Working);
+    }
+}
+
+// 对话框被直接销毁（例如随父窗口一起）时，趁子控件还在先结束自习，phaseChanged 的槽可以安全更新界面
+StudySessionDialog::~StudySessionDialog()
+{
+    timer->stop();
+    engine->finish();
+}
 
-    // 假设 DatabaseManager::instance().addStudySession 方法存在
-    DatabaseManager::instance().addStudySession(start, end, durationSeconds);
+// 直接关闭窗口（Esc/右上角）同样视为结束自习，避免丢失记录
+void StudySessionDialog::reject()
+{
+    timer->stop();
+    engine->finish();
+    QDialog::reject();
+}
+
+QString StudySessionDialog::currentTag() const
+{
+    QString tag = tagComboBox->currentText().trimmed();
+    return tag == UNTAGGED_TEXT ? QString() : tag;
+}
+
+QStringList StudySessionDialog::loadCourseTags()
+{
+    return ScheduleModel::courseNames(ScheduleModel::loadSaved());
 }
 
 // eventFilter 已修改，移除了 QPixmap 悬停逻辑
@@ -106,16 +207,16 @@ bool StudySessionDialog::eventFilter(QObject *obj, QEvent *event)
 
 void StudySessionDialog::startSession()
 {
-    // 每次开始自习时，将计时器重置为当前时间，并更新显示
-    startTime = QTime::currentTime();
+    // 每次开始自习时，重新开始一次会话，并更新显示
+    engine->setPomodoroEnabled(pomodoroCheckBox->isChecked());
+    engine->start(currentTag());
     timerLabel->setText("00:00:00");
 
     if (!timer->isActive())
         timer->start(1000);
 
     // 确保在会话开始时 GIF 动画开始或恢复
-    // 使用 state() 函数检查 QMovie 的状态
-    if (animation && animation->state() != QMovie::Running) {
+    if (animation && !animation->isRunning()) {
         animation->start();
     }
 }
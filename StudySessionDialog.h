@@ -4,11 +4,13 @@
 #include <QDialog>
 #include <QLabel>
 #include <QPushButton>
-#include <QMovie> // 引入 QMovie 以支持 GIF
 #include <QTimer>
 #include <QTime>
-// 不再需要 QPixmap，因为图片现在由 QMovie 处理
-// #include <QPixmap>
+#include "StudySessionEngine.h"
+
+class QComboBox;
+class AnimationPlayer;
+class QCheckBox;
 
 class StudySessionDialog : public QDialog
 {
@@ -16,25 +18,36 @@ class StudySessionDialog : public QDialog
 
 public:
     explicit StudySessionDialog(QWidget *parent = nullptr);
+    ~StudySessionDialog() override;
     void startSession();  // 每次开始自习调用
 
 private slots:
     void updateTimer();
     void onEndSessionClicked();
+    void onPauseResumeClicked();
+    void onTagChanged();
+    void onPomodoroToggled(bool enabled);
+    void onPhaseChanged(StudySessionEngine::Phase phase);
 
 private:
     QLabel *timerLabel;
+    QLabel *phaseLabel;      // 显示当前阶段（自习/暂停/休息）和番茄钟剩余时间
     QLabel *gifLabel;
+    QComboBox *tagComboBox;  // 课程/标签选择，可手动输入
+    QCheckBox *pomodoroCheckBox;
+    QPushButton *pauseButton;
     QPushButton *endButton;
-    QMovie *animation; // 现在直接用于 GIF
+    AnimationPlayer *animation; // 播放共享缓存里的 GIF 帧
     QTimer *timer;
-    QTime startTime;
+    StudySessionEngine *engine;
 
-    void saveStudySession(const QDateTime &start, const QDateTime &end);
+    static QStringList loadCourseTags(); // 从已保存的课表中读取课程名
+    QString currentTag() const;
 protected:
     // eventFilter 对于简单的 GIF 显示不再是严格必需的，
     // 但如果还有其他事件过滤需求可以保留。
     bool eventFilter(QObject *obj, QEvent *event) override;
+    void reject() override;
 };
 
 #endif // STUDYSESSIONDIALOG_H
@@ -0,0 +1,209 @@
+#include "StudySessionEngine.h"
+#include "DatabaseManager.h"
+#include <QDebug>
+#include <QSignalBlocker>
+
+StudySessionEngine::StudySessionEngine(QObject *parent)
+    : QObject(parent), m_phaseTimer(new QTimer(this))
+{
+    m_phaseTimer->setSingleShot(true);
+    connect(m_phaseTimer, &QTimer::timeout,
+            this, &StudySessionEngine::onPhaseTimeout);
+}
+
+StudySessionEngine::~StudySessionEngine()
+{
+    // 窗口被意外关闭时也不丢失已经计时的分段。
+    // 父对象可能正在析构，连接的槽会碰到已销毁的子控件，所以这里只落库，不发信号
+    if (m_phase != Phase::Idle) {
+        m_phaseTimer->stop();
+        closeSegment();
+        const QSignalBlocker blocker(this);
+        flush();
+    }
+}
+
+void StudySessionEngine::setPomodoroEnabled(bool enabled)
+{
+    m_pomodoroEnabled = enabled;
+    if (!enabled) {
+        m_phaseTimer->stop();
+        m_phaseDeadline = QDateTime();
+        m_pausedRemainingMs = -1;
+        // 关闭番茄钟时若正处于休息阶段，直接回到自习；
+        // 休息中暂停的，继续时也要回到自习，而不是没有计时器、也不记时长的休息
+        if (m_phase == Phase::ShortBreak || m_phase == Phase::LongBreak) {
+            enterPhase(Phase::Working, 0);
+        } else if (m_phase == Phase::Paused) {
+            m_phaseBeforePause = Phase::Working;
+        }
+    } else if (m_phase == Phase::Working) {
+        enterPhase(Phase::Working, m_config.workMinutes);
+    }
+}
+
+void StudySessionEngine::start(const QString &tag)
+{
+    if (m_phase != Phase::Idle) {
+        finish();
+    }
+    m_tag = tag;
+    m_closedSeconds = 0;
+    m_completedPomodoros = 0;
+    enterPhase(Phase::Working, m_pomodoroEnabled ? m_config.workMinutes : 0);
+}
+
+void StudySessionEngine::pause()
+{
+    if (m_phase == Phase::Idle || m_phase == Phase::Paused)
+        return;
+
+    if (m_phaseTimer->isActive()) {
+        m_pausedRemainingMs = m_phaseTimer->remainingTime();
+        m_phaseTimer->stop();
+    }
+    closeSegment();
+    flush();
+    m_phaseBeforePause = m_phase;
+    m_phase = Phase::Paused;
+    emit phaseChanged(m_phase);
+}
+
+void StudySessionEngine::resume()
+{
+    if (m_phase != Phase::Paused)
+        return;
+
+    m_phase = m_phaseBeforePause;
+    if (m_phase == Phase::Working) {
+        openSegment();
+    }
+    if (m_pausedRemainingMs >= 0) {
+        m_phaseDeadline = QDateTime::currentDateTime().addMSecs(m_pausedRemainingMs);
+        m_phaseTimer->start(m_pausedRemainingMs);
+        m_pausedRemainingMs = -1;
+    }
+    emit phaseChanged(m_phase);
+}
+
+void StudySessionEngine::finish()
+{
+    if (m_phase == Phase::Idle)
+        return;
+
+    m_phaseTimer->stop();
+    m_phaseDeadline = QDateTime();
+    m_pausedRemainingMs = -1;
+    closeSegment();
+    flush();
+    m_phase = Phase::Idle;
+    emit phaseChanged(m_phase);
+}
+
+void StudySessionEngine::setTag(const QString &tag)
+{
+    if (tag == m_tag)
+        return;
+
+    // 只在自习进行中才需要切段，暂停/休息时下一段自然会用新标签
+    if (m_phase == Phase::Working) {
+        closeSegment();
+        m_tag = tag;
+        openSegment();
+    } else {
+        m_tag = tag;
+    }
+}
+
+int StudySessionEngine::elapsedSeconds() const
+{
+    int total = m_closedSeconds;
+    if (m_segmentStart.isValid()) {
+        total += static_cast<int>(m_segmentStart.secsTo(QDateTime::currentDateTime()));
+    }
+    return total;
+}
+
+int StudySessionEngine::phaseRemainingSeconds() const
+{
+    if (!m_pomodoroEnabled)
+        return -1;
+    if (m_phase == Phase::Paused)
+        return m_pausedRemainingMs >= 0 ? m_pausedRemainingMs / 1000 : -1;
+    if (!m_phaseDeadline.isValid())
+        return -1;
+    return qMax<qint64>(0, QDateTime::currentDateTime().secsTo(m_phaseDeadline));
+}
+
+bool StudySessionEngine::flush()
+{
+    if (m_pending.isEmpty())
+        return true;
+
+    if (!DatabaseManager::instance().addStudySegments(m_pending)) {
+        // 保留缓存，下次暂停/结束时再尝试写入
+        qDebug() << "自习分段写入失败，保留" << m_pending.size() << "段待下次写入";
+        return false;
+    }
+    const int count = m_pending.size();
+    m_pending.clear();
+    emit flushed(count);
+    return true;
+}
+
+void StudySessionEngine::onPhaseTimeout()
+{
+    m_phaseDeadline = QDateTime();
+    if (m_phase == Phase::Working) {
+        ++m_completedPomodoros;
+        closeSegment();
+        flush();
+        emit pomodoroCompleted(m_completedPomodoros);
+
+        const bool longBreak = m_config.cyclesBeforeLongBreak > 0
+                               && m_completedPomodoros % m_config.cyclesBeforeLongBreak == 0;
+        if (longBreak) {
+            enterPhase(Phase::LongBreak, m_config.longBreakMinutes);
+        } else {
+            enterPhase(Phase::ShortBreak, m_config.shortBreakMinutes);
+        }
+    } else if (m_phase == Phase::ShortBreak || m_phase == Phase::LongBreak) {
+        enterPhase(Phase::Working, m_config.workMinutes);
+    }
+}
+
+void StudySessionEngine::openSegment()
+{
+    if (!m_segmentStart.isValid()) {
+        m_segmentStart = QDateTime::currentDateTime();
+    }
+}
+
+void StudySessionEngine::closeSegment()
+{
+    if (!m_segmentStart.isValid())
+        return;
+
+    StudySegment segment{m_segmentStart, QDateTime::currentDateTime(), m_tag};
+    m_segmentStart = QDateTime();
+    // 不足一秒的碎片（如连续快速切换标签）不记录
+    if (segment.durationSeconds() <= 0)
+        return;
+
+    m_closedSeconds += segment.durationSeconds();
+    m_pending.append(segment);
+}
+
+void StudySessionEngine::enterPhase(Phase phase, int minutes)
+{
+    m_phase = phase;
+    if (phase == Phase::Working) {
+        openSegment();
+    }
+    if (m_pomodoroEnabled && minutes > 0) {
+        const int ms = minutes * 60 * 1000;
+        m_phaseDeadline = QDateTime::currentDateTime().addMSecs(ms);
+        m_phaseTimer->start(ms);
+    }
+    emit phaseChanged(m_phase);
+}
@@ -0,0 +1,79 @@
+#ifndef STUDYSESSIONENGINE_H
+#define STUDYSESSIONENGINE_H
+
+#include <QObject>
+#include <QList>
+#include <QDateTime>
+#include <QTimer>
+#include "StudySegment.h"
+
+// 自习会话引擎：负责暂停/继续、番茄钟循环和按标签切分的多段计时。
+// 各段先缓存在内存中，只在暂停、进入休息或结束时一次性写入数据库。
+class StudySessionEngine : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum class Phase { Idle, Working, Paused, ShortBreak, LongBreak };
+
+    struct PomodoroConfig {
+        int workMinutes = 25;
+        int shortBreakMinutes = 5;
+        int longBreakMinutes = 15;
+        int cyclesBeforeLongBreak = 4;
+    };
+
+    explicit StudySessionEngine(QObject *parent = nullptr);
+    ~StudySessionEngine();
+
+    void setPomodoroEnabled(bool enabled);
+    bool isPomodoroEnabled() const { return m_pomodoroEnabled; }
+    void setPomodoroConfig(const PomodoroConfig &config) { m_config = config; }
+    PomodoroConfig pomodoroConfig() const { return m_config; }
+
+    void start(const QString &tag = QString());
+    void pause();
+    void resume();
+    void finish();
+    // 切换标签：结束当前段并以新标签开始下一段
+    void setTag(const QString &tag);
+    QString tag() const { return m_tag; }
+
+    Phase phase() const { return m_phase; }
+    int elapsedSeconds() const;          // 本次会话累计的有效自习时长
+    int phaseRemainingSeconds() const;   // 番茄钟当前阶段的剩余时间，未启用时为 -1
+    int completedPomodoros() const { return m_completedPomodoros; }
+    int pendingSegmentCount() const { return m_pending.size(); }
+
+    // 将缓存的分段在一个事务内写入数据库
+    bool flush();
+
+signals:
+    void phaseChanged(StudySessionEngine::Phase phase);
+    void pomodoroCompleted(int count);
+    void flushed(int segmentCount);
+
+private slots:
+    void onPhaseTimeout();
+
+private:
+    void openSegment();
+    void closeSegment();
+    void enterPhase(Phase phase, int minutes);
+
+    QList<StudySegment> m_pending; // 尚未落库的分段
+    QDateTime m_segmentStart;      // 当前打开的分段起点，无效表示没有进行中的分段
+    QString m_tag;
+    Phase m_phase = Phase::Idle;
+    Phase m_phaseBeforePause = Phase::Idle;
+    int m_closedSeconds = 0;       // 已关闭分段的累计时长（含已落库的）
+    int m_completedPomodoros = 0;
+
+    bool m_pomodoroEnabled = false;
+    PomodoroConfig m_config;
+    QTimer *m_phaseTimer;
+    QDateTime m_phaseDeadline;
+    int m_pausedRemainingMs = -1;  // 暂停时番茄钟阶段剩余的毫秒数
+};
+
+#endif // STUDYSESSIONENGINE_H
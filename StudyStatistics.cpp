@@ -0,0 +1,49 @@
+#include "StudyStatistics.h"
+#include <algorithm>
+
+double StudyStatistics::unitSeconds(TimeUnit unit)
+{
+    switch (unit) {
+    case Seconds: return 1.0;
+    case Minutes: return 60.0;
+    case Hours:   return 3600.0;
+    }
+    return 1.0;
+}
+
+QString StudyStatistics::unitName(TimeUnit unit)
+{
+    switch (unit) {
+    case Seconds: return "秒";
+    case Minutes: return "分钟";
+    case Hours:   return "小时";
+    }
+    return QString();
+}
+
+StudyStatistics::Series StudyStatistics::daily(const QMap<QDate, int> &secondsByDate, TimeUnit unit)
+{
+    // QMap 本身按日期有序
+    Series series;
+    const double factor = unitSeconds(unit);
+    for (auto it = secondsByDate.cbegin(); it != secondsByDate.cend(); ++it) {
+        const double value = static_cast<double>(it.value()) / factor;
+        series.dates << it.key();
+        series.labels << it.key().toString("MM-dd");
+        series.values << value;
+        series.maxValue = std::max(series.maxValue, value);
+    }
+    return series;
+}
+
+QList<StudyStatistics::Slice> StudyStatistics::byTag(const QMap<QString, int> &secondsByTag, TimeUnit unit)
+{
+    QList<Slice> slices;
+    const double factor = unitSeconds(unit);
+    for (auto it = secondsByTag.cbegin(); it != secondsByTag.cend(); ++it) {
+        if (it.value() <= 0) continue;
+        slices.append(Slice{it.key().isEmpty() ? QString("未分类") : it.key(),
+                            static_cast<double>(it.value()) / factor});
+    }
+    return slices;
+}
@@ -0,0 +1,35 @@
+#ifndef STUDYSTATISTICS_H
+#define STUDYSTATISTICS_H
+
+#include <QDate>
+#include <QList>
+#include <QMap>
+#include <QStringList>
+
+// 自习时长的统计与单位换算，图表窗口只负责把结果画出来
+class StudyStatistics
+{
+public:
+    enum TimeUnit { Seconds, Minutes, Hours };
+
+    static double unitSeconds(TimeUnit unit);
+    static QString unitName(TimeUnit unit);
+
+    // 按日期排好序的每日时长
+    struct Series {
+        QList<QDate> dates;
+        QStringList labels; // MM-dd
+        QList<double> values;
+        double maxValue = 0;
+    };
+    static Series daily(const QMap<QDate, int> &secondsByDate, TimeUnit unit);
+
+    // 按课程/标签的时长分布，跳过时长为 0 的标签，空标签记为“未分类”
+    struct Slice {
+        QString label;
+        double value = 0;
+    };
+    static QList<Slice> byTag(const QMap<QString, int> &secondsByTag, TimeUnit unit);
+};
+
+#endif // STUDYSTATISTICS_H
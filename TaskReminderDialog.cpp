@@ -1,96 +1,84 @@
 #include "TaskReminderDialog.h"
+#include "ReminderScheduler.h"
+#include "UpcomingTaskModel.h"
+#include "ReminderItemDelegate.h"
 #include <QVBoxLayout>
-#include <QTextEdit>
+#include <QHBoxLayout>
+#include <QInputDialog>
+#include <QMessageBox>
+#include <QListView>
+#include <QLabel>
 #include <QPushButton>
 #include <QDate>
-#include <algorithm> // 用于排序
 
-TaskReminderDialog::TaskReminderDialog(const QList<QDate> &taskDates, QWidget *parent)
-    : QDialog(parent)
+TaskReminderDialog::TaskReminderDialog(ReminderScheduler *scheduler, QWidget *parent)
+    : QDialog(parent), m_scheduler(scheduler)
 {
-    setupUiAndLogic(taskDates);
+    setupUiAndLogic();
 }
 
-void TaskReminderDialog::setupUiAndLogic(const QList<QDate> &taskDates)
+void TaskReminderDialog::setupUiAndLogic()
 {
     setWindowTitle("日程提醒");
     setMinimumSize(400, 500);
 
     // --- 创建控件 ---
-    reminderTextEdit = new QTextEdit(this);
-    reminderTextEdit->setReadOnly(true);
+    QLabel *titleLabel = new QLabel("未来日程一览", this);
+    titleLabel->setObjectName("reminderTitleLabel");
+
+    // 模型只在滚动到底部时按页取数据，委托负责按紧急程度着色
+    taskModel = new UpcomingTaskModel(QDate::currentDate(), 50, this);
+    reminderListView = new QListView(this);
+    reminderListView->setModel(taskModel);
+    reminderListView->setItemDelegate(new ReminderItemDelegate(reminderListView));
+    reminderListView->setSelectionMode(QAbstractItemView::SingleSelection);
+    reminderListView->setVerticalScrollMode(QAbstractItemView::ScrollPerPixel);
+    reminderListView->setMouseTracking(true);
+
+    emptyLabel = new QLabel("<h2>太棒了！</h2><p>未来没有任何已安排的日程。</p>", this);
+    emptyLabel->setAlignment(Qt::AlignCenter);
 
     closeButton = new QPushButton("关闭", this);
     connect(closeButton, &QPushButton::clicked,
             this, &TaskReminderDialog::accept);
 
+    settingsButton = new QPushButton("提醒设置", this);
+    settingsButton->setEnabled(m_scheduler != nullptr);
+    connect(settingsButton, &QPushButton::clicked,
+            this, &TaskReminderDialog::onReminderSettingsClicked);
+
     // --- 布局 ---
+    QHBoxLayout *buttonLayout = new QHBoxLayout;
+    buttonLayout->addWidget(settingsButton);
+    buttonLayout->addStretch();
+    buttonLayout->addWidget(closeButton);
+
     QVBoxLayout *mainLayout = new QVBoxLayout(this);
-    mainLayout->addWidget(reminderTextEdit);
-    mainLayout->addWidget(closeButton, 0, Qt::AlignRight);
+    mainLayout->addWidget(titleLabel);
+    mainLayout->addWidget(reminderListView);
+    mainLayout->addWidget(emptyLabel);
+    mainLayout->addLayout(buttonLayout);
     setLayout(mainLayout);
 
-    // --- 逻辑处理与内容生成 ---
-    if (taskDates.isEmpty()) {
-        reminderTextEdit->setHtml("<h2>太棒了！</h2><p>未来没有任何已安排的日程。</p>");
-        return;
-    }
-
-    // 1. 过滤并排序日期
-    QList<QDate> futureDates;
-    const QDate today = QDate::currentDate();
-    for (const QDate &date : taskDates) {
-        if (date >= today) {
-            futureDates.append(date);
-        }
+    // --- 逻辑处理 ---
+    // 先取第一页，判断是否有任何日程
+    if (taskModel->canFetchMore(QModelIndex())) {
+        taskModel->fetchMore(QModelIndex());
     }
-    std::sort(futureDates.begin(), futureDates.end());
-
-    // 2. 生成HTML内容
-    QString htmlContent = "<h1>未来日程一览</h1><hr>";
-
-    if (futureDates.isEmpty()) {
-        htmlContent += "<p>未来没有任何已安排的日程。</p>";
-    } else {
-        htmlContent += "<p>您在以下日期安排了任务：</p><ul>";
-        for (const QDate& date : futureDates) {
-            qint64 daysUntil = today.daysTo(date);
-            QString style;
-            QString distanceText;
-
-            if (daysUntil == 0) {
-                style = "color:#D32F2F; font-weight:bold;"; // 红色加粗
-                distanceText = " (今天)";
-            } else if (daysUntil <= 6) {
-                style = "color:#D32F2F;"; // 红色
-                distanceText = QString(" (%1天后)").arg(daysUntil);
-            } else if (daysUntil <= 14) {
-                style = "color:#FBC02D;"; // 黄色
-                distanceText = QString(" (%1天后)").arg(daysUntil);
-            } else {
-                style = "color:#388E3C;"; // 绿色
-                distanceText = QString(" (%1天后)").arg(daysUntil);
-            }
-
-            htmlContent += QString("<li><span style='%1'>%2</span>%3</li>")
-                               .arg(style)
-                               .arg(date.toString("yyyy年MM月dd日 (dddd)"))
-                               .arg(distanceText);
-        }
-        htmlContent += "</ul>";
-    }
-
-    reminderTextEdit->setHtml(htmlContent);
+    const bool empty = taskModel->isExhaustedAndEmpty();
+    reminderListView->setVisible(!empty);
+    emptyLabel->setVisible(empty);
 
     // --- 设置样式 ---
     QString styleSheet = R"(
         QDialog { background-color: #F8F9FA; }
-        QTextEdit {
+        #reminderTitleLabel { font-size: 22px; font-weight: bold; padding: 4px 0; }
+        QListView {
             background-color: white;
             border: 1px solid #CED4DA;
             border-radius: 8px;
             font-size: 16px;
-            padding: 15px;
+            padding: 8px;
         }
         QPushButton {
             background-color: #6C757D;
@@ -103,3 +91,29 @@ void TaskReminderDialog::setupUiAndLogic(const QList<QDate> &taskDates)
     )";
     this->setStyleSheet(styleSheet);
 }
+
+void TaskReminderDialog::onReminderSettingsClicked()
+{
+    QStringList current;
+    for (int minutes : m_scheduler->leadTimes()) {
+        current << QString::number(minutes);
+    }
+
+    bool ok;
+    QString input = QInputDialog::getText(
+        this,
+        "提醒设置",
+        "在日程开始前多少分钟提醒？多个时间用逗号分隔，0 表示准点提醒：",
+        QLineEdit::Normal,
+        current.join(","),
+        &ok
+        );
+    if (!ok) return;
+
+    QList<int> leads;
+    if (!ReminderScheduler::parseLeadTimes(input, leads)) {
+        QMessageBox::warning(this, "输入错误", "请输入非负整数，例如：30,10,0");
+        return;
+    }
+    m_scheduler->setLeadTimes(leads);
+}
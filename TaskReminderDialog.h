@@ -6,22 +6,33 @@
 #include <QDate>
 
 // 前向声明，避免包含完整头文件
-class QTextEdit;
+class QListView;
+class QLabel;
 class QPushButton;
+class ReminderScheduler;
+class UpcomingTaskModel;
 
 class TaskReminderDialog : public QDialog
 {
     Q_OBJECT
 
 public:
-    // 构造函数，接收一个包含任务的日期列表
-    explicit TaskReminderDialog(const QList<QDate> &taskDates, QWidget *parent = nullptr);
+    // 构造函数：日程按日期分组显示，数据在滚动时按页从数据库加载
+    explicit TaskReminderDialog(ReminderScheduler *scheduler = nullptr,
+                                QWidget *parent = nullptr);
+
+private slots:
+    void onReminderSettingsClicked(); // 设置提前提醒的分钟数
 
 private:
-    void setupUiAndLogic(const QList<QDate> &taskDates); // 设置UI和处理逻辑的函数
+    void setupUiAndLogic(); // 设置UI和处理逻辑的函数
 
-    QTextEdit *reminderTextEdit; // 用于显示提醒内容的文本框
+    QListView *reminderListView;  // 分组显示未来日程的列表
+    QLabel *emptyLabel;           // 没有日程时的提示
+    UpcomingTaskModel *taskModel;
     QPushButton *closeButton;    // 关闭按钮
+    QPushButton *settingsButton; // 提醒设置按钮
+    ReminderScheduler *m_scheduler;
 };
 
 #endif // TASKREMINDERDIALOG_H
@@ -0,0 +1,506 @@
+#include "TaskTransfer.h"
+#include "DatabaseManager.h"
+#include "ICalendar.h"
+#include "ScheduleModel.h"
+#include <QFileInfo>
+#include <QHash>
+#include <QIODevice>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QScopedPointer>
+#include <QStringList>
+
+namespace {
+
+constexpr qsizetype FLUSH_BYTES = 64 * 1024;
+
+QTime parseTime(const QString &text)
+{
+    const QString t = text.trimmed();
+    if (t.isEmpty()) return QTime();
+    QTime time = QTime::fromString(t, "HH:mm");
+    if (!time.isValid()) time = QTime::fromString(t, "HH:mm:ss");
+    if (!time.isValid()) time = QTime::fromString(t, "H:mm");
+    return time;
+}
+
+QString timeText(const QTime &time)
+{
+    return time.isValid() ? time.toString("HH:mm") : QString();
+}
+
+// 读一行原始字节并去掉行尾换行；返回 false 表示已到输入末尾。
+// 不用 atEnd()：标准输入是管道时它可能在数据到达前就返回 true
+bool readRawLine(QIODevice *in, QByteArray &line)
+{
+    line = in->readLine();
+    if (line.isEmpty()) return false;
+    while (line.endsWith('\n') || line.endsWith('\r')) line.chop(1);
+    return true;
+}
+
+// ---------------------------------------------------------------- 写出
+
+class RecordWriter
+{
+public:
+    explicit RecordWriter(QIODevice *out) : m_out(out) {}
+    virtual ~RecordWriter() = default;
+
+    virtual void begin() {}
+    virtual void write(const DatedTask &item) = 0;
+    // 不支持重复规则的格式返回 false，由调用方跳过
+    virtual bool writeRule(const RecurringTask &recurring) { Q_UNUSED(recurring); return false; }
+    virtual void end() {}
+
+    // 攒够一块再写，避免每条记录一次系统调用
+    virtual bool flush()
+    {
+        if (!m_buffer.isEmpty()) {
+            if (m_out->write(m_buffer) != m_buffer.size()) m_failed = true;
+            m_buffer.clear();
+        }
+        return !m_failed;
+    }
+    virtual bool failed() const { return m_failed; }
+
+protected:
+    void append(const QByteArray &bytes)
+    {
+        m_buffer += bytes;
+        if (m_buffer.size() >= FLUSH_BYTES) flush();
+    }
+
+private:
+    QIODevice *m_out;
+    QByteArray m_buffer;
+    bool m_failed = false;
+};
+
+QByteArray csvField(const QString &text)
+{
+    if (!text.contains(',') && !text.contains('"') && !text.contains('\n') && !text.contains('\r')) {
+        return text.toUtf8();
+    }
+    QString quoted = text;
+    quoted.replace('"', "\"\"");
+    return '"' + quoted.toUtf8() + '"';
+}
+
+class CsvWriter : public RecordWriter
+{
+public:
+    using RecordWriter::RecordWriter;
+
+    void begin() override { append("id,date,start_time,end_time,title,note\r\n"); }
+    void write(const DatedTask &item) override
+    {
+        append(QByteArray::number(item.task.getId()) + ',' +
+               item.date.toString(Qt::ISODate).toUtf8() + ',' +
+               timeText(item.task.getStartTime()).toUtf8() + ',' +
+               timeText(item.task.getEndTime()).toUtf8() + ',' +
+               csvField(item.task.getTitle()) + ',' +
+               csvField(item.task.getNote()) + "\r\n");
+    }
+};
+
+class JsonLinesWriter : public RecordWriter
+{
+public:
+    using RecordWriter::RecordWriter;
+
+    void write(const DatedTask &item) override
+    {
+        append(QJsonDocument(TaskTransfer::toJson(item)).toJson(QJsonDocument::Compact) + '\n');
+    }
+};
+
+// 适配到 ICalendarWriter，重复规则写成带 RRULE 的 VEVENT
+class IcsRecordWriter : public RecordWriter
+{
+public:
+    explicit IcsRecordWriter(QIODevice *out) : RecordWriter(out), m_ics(out) {}
+
+    void begin() override { m_ics.begin(); }
+    void write(const DatedTask &item) override { m_ics.writeTask(item); }
+    bool writeRule(const RecurringTask &recurring) override
+    {
+        m_ics.writeRule(recurring);
+        return true;
+    }
+    void end() override { m_ics.end(); }
+    bool flush() override { return m_ics.flush(); }
+    bool failed() const override { return m_ics.failed(); }
+
+private:
+    ICalendarWriter m_ics;
+};
+
+// ---------------------------------------------------------------- 读入
+
+class RecordReader
+{
+public:
+    enum Result { Record, Skip, End };
+
+    virtual ~RecordReader() = default;
+    // 表头等开头部分无法识别时返回 false
+    virtual bool begin(QString &error) { Q_UNUSED(error); return true; }
+    virtual Result next(DatedTask &item, QString &error) = 0;
+    // 刚读到的记录是否是重复日程；无效规则表示单次任务
+    const RecurrenceRule &rule() const { return m_rule; }
+
+protected:
+    RecurrenceRule m_rule;
+};
+
+// 校验一条解析出的记录，出错时写入 error 并返回 Skip
+RecordReader::Result checkRecord(const DatedTask &item, qint64 line, QString &error)
+{
+    if (!item.date.isValid()) {
+        error = QString("第 %1 行：日期无效").arg(line);
+        return RecordReader::Skip;
+    }
+    if (item.task.getTitle().trimmed().isEmpty()) {
+        error = QString("第 %1 行：标题为空").arg(line);
+        return RecordReader::Skip;
+    }
+    return RecordReader::Record;
+}
+
+class CsvReader : public RecordReader
+{
+public:
+    explicit CsvReader(QIODevice *in) : m_in(in) {}
+
+    bool begin(QString &error) override
+    {
+        QStringList header;
+        if (!readRecord(header)) {
+            error = "CSV 为空";
+            return false;
+        }
+        if (!header.isEmpty() && header.first().startsWith(QChar(0xFEFF))) header.first().remove(0, 1);
+        for (int i = 0; i < header.size(); ++i) {
+            m_columns.insert(header.at(i).trimmed().toLower(), i);
+        }
+        if (!m_columns.contains("date") || !m_columns.contains("title")) {
+            error = "CSV 表头缺少 date 或 title 列";
+            return false;
+        }
+        return true;
+    }
+
+    Result next(DatedTask &item, QString &error) override
+    {
+        QStringList fields;
+        do {
+            if (!readRecord(fields)) return End;
+        } while (fields.size() == 1 && fields.first().trimmed().isEmpty()); // 跳过空行
+
+        item.date = QDate::fromString(column(fields, "date").trimmed(), Qt::ISODate);
+        item.task = DailyTask(column(fields, "title"),
+                              parseTime(column(fields, "start_time")),
+                              parseTime(column(fields, "end_time")),
+                              column(fields, "note"));
+        return checkRecord(item, m_recordLine, error);
+    }
+
+private:
+    QString column(const QStringList &fields, const QString &name) const
+    {
+        const int index = m_columns.value(name, -1);
+        return index >= 0 && index < fields.size() ? fields.at(index) : QString();
+    }
+
+    // 读一条记录；引号内的换行属于字段内容，会接着读下一行
+    bool readRecord(QStringList &fields)
+    {
+        fields.clear();
+        QByteArray raw;
+        if (!readRawLine(m_in, raw)) return false;
+        m_recordLine = ++m_line;
+
+        QString field;
+        bool quoted = false;
+        while (true) {
+            const QString text = QString::fromUtf8(raw);
+            for (qsizetype i = 0; i < text.size(); ++i) {
+                const QChar c = text.at(i);
+                if (quoted) {
+                    if (c != '"') {
+                        field += c;
+                    } else if (i + 1 < text.size() && text.at(i + 1) == '"') {
+                        field += '"';
+                        ++i;
+                    } else {
+                        quoted = false;
+                    }
+                } else if (c == '"') {
+                    quoted = true;
+                } else if (c == ',') {
+                    fields << field;
+                    field.clear();
+                } else {
+                    field += c;
+                }
+            }
+            if (!quoted || !readRawLine(m_in, raw)) break;
+            ++m_line;
+            field += '\n';
+        }
+        fields << field;
+        return true;
+    }
+
+    QIODevice *m_in;
+    QHash<QString, int> m_columns;
+    qint64 m_line = 0;
+    qint64 m_recordLine = 0;
+};
+
+class JsonLinesReader : public RecordReader
+{
+public:
+    explicit JsonLinesReader(QIODevice *in) : m_in(in) {}
+
+    Result next(DatedTask &item, QString &error) override
+    {
+        QByteArray raw;
+        do {
+            if (!readRawLine(m_in, raw)) return End;
+            ++m_line;
+        } while (raw.trimmed().isEmpty());
+
+        QJsonParseError parseError;
+        const QJsonDocument doc = QJsonDocument::fromJson(raw, &parseError);
+        if (!doc.isObject()) {
+            error = QString("第 %1 行：%2").arg(m_line).arg(parseError.error == QJsonParseError::NoError
+                                                                ? QString("不是 JSON 对象") : parseError.errorString());
+            return Skip;
+        }
+        item = TaskTransfer::fromJson(doc.object());
+        return checkRecord(item, m_line, error);
+    }
+
+private:
+    QIODevice *m_in;
+    qint64 m_line = 0;
+};
+
+// 适配到 ICalendarReader。RRULE 能转成 RecurrenceRule 的事件作为重复日程导入（只占一行），
+// 其余的 RRULE 无法表示，只导入第一次
+class IcsRecordReader : public RecordReader
+{
+public:
+    explicit IcsRecordReader(QIODevice *in) : m_ics(in) {}
+
+    Result next(DatedTask &item, QString &error) override
+    {
+        ICalendarEvent event;
+        if (!m_ics.next(event)) return End;
+        if (!event.date.isValid()) {
+            error = QString("第 %1 行：DTSTART 无效").arg(event.line);
+            return Skip;
+        }
+        // 展开不了的规则（如多个 BYDAY）跳过并报出来，当成一次性任务导入会悄悄丢掉其余实例
+        if (!event.rrule.isEmpty() && !ICalendarReader::isSupportedRRule(event.rrule, event.date)) {
+            error = QString("第 %1 行：不支持的重复规则 %2").arg(event.line).arg(event.rrule);
+            return Skip;
+        }
+        item.date = event.date;
+        item.task = DailyTask(event.summary, event.start, event.end, event.description);
+        m_rule = RecurrenceRule();
+        if (!event.rrule.isEmpty()) {
+            m_rule = RecurrenceRule::fromRRule(event.rrule, event.date);
+            m_rule.setExceptions(event.exdates);
+        }
+        return checkRecord(item, event.line, error);
+    }
+
+private:
+    ICalendarReader m_ics;
+};
+
+RecordWriter *createWriter(TaskTransfer::Format format, QIODevice *out)
+{
+    switch (format) {
+    case TaskTransfer::Csv:       return new CsvWriter(out);
+    case TaskTransfer::JsonLines: return new JsonLinesWriter(out);
+    case TaskTransfer::ICalendar: return new IcsRecordWriter(out);
+    }
+    return nullptr;
+}
+
+RecordReader *createReader(TaskTransfer::Format format, QIODevice *in)
+{
+    switch (format) {
+    case TaskTransfer::Csv:       return new CsvReader(in);
+    case TaskTransfer::JsonLines: return new JsonLinesReader(in);
+    case TaskTransfer::ICalendar: return new IcsRecordReader(in);
+    }
+    return nullptr;
+}
+
+// 规则在 [from, to] 内是否有实例；只给了起始日期时看之后五年
+bool overlaps(const RecurrenceRule &rule, const QDate &from, const QDate &to)
+{
+    if (!from.isValid()) return !to.isValid() || rule.startDate() <= to;
+    return !rule.occurrencesBetween(from, to.isValid() ? to : from.addYears(5)).isEmpty();
+}
+
+} // namespace
+
+QJsonObject TaskTransfer::toJson(const DatedTask &item)
+{
+    return QJsonObject{{"id", item.task.getId()},
+                       {"date", item.date.toString(Qt::ISODate)},
+                       {"start_time", timeText(item.task.getStartTime())},
+                       {"end_time", timeText(item.task.getEndTime())},
+                       {"title", item.task.getTitle()},
+                       {"note", item.task.getNote()}};
+}
+
+DatedTask TaskTransfer::fromJson(const QJsonObject &obj)
+{
+    DatedTask item;
+    item.date = QDate::fromString(obj.value("date").toString(), Qt::ISODate);
+    item.task = DailyTask(obj.value("title").toString(),
+                          parseTime(obj.value("start_time").toString()),
+                          parseTime(obj.value("end_time").toString()),
+                          obj.value("note").toString(),
+                          obj.value("id").toInt(-1));
+    return item;
+}
+
+bool TaskTransfer::formatFromName(const QString &name, Format &format)
+{
+    const QString n = name.trimmed().toLower();
+    if (n == "csv") format = Csv;
+    else if (n == "json" || n == "jsonl" || n == "ndjson") format = JsonLines;
+    else if (n == "ics" || n == "ical" || n == "icalendar") format = ICalendar;
+    else return false;
+    return true;
+}
+
+bool TaskTransfer::formatFromFileName(const QString &path, Format &format)
+{
+    return formatFromName(QFileInfo(path).suffix(), format);
+}
+
+bool TaskTransfer::exportTasks(QIODevice *out, Format format, const QDate &from, const QDate &to,
+                               Stats *stats, QString *error)
+{
+    QScopedPointer<RecordWriter> writer(createWriter(format, out));
+    qint64 count = 0;
+    writer->begin();
+    const bool ok = DatabaseManager::instance().forEachTask(from, to, [&](const DatedTask &item) {
+        writer->write(item);
+        ++count;
+        return !writer->failed();
+    });
+
+    // 重复日程每条规则只写一个事件，不展开实例
+    qint64 rules = 0;
+    if (ok && !writer->failed()) {
+        const QList<RecurringTask> recurring = DatabaseManager::instance().getTaskRules();
+        for (const RecurringTask &item : recurring) {
+            if (overlaps(item.rule, from, to) && writer->writeRule(item)) ++rules;
+        }
+    }
+    writer->end();
+    const bool written = writer->flush();
+
+    if (stats) {
+        stats->records = count + rules;
+        stats->rules = rules;
+    }
+    if (!ok) {
+        if (error) *error = "读取任务失败";
+        return false;
+    }
+    if (!written) {
+        if (error) *error = "写出失败：" + out->errorString();
+        return false;
+    }
+    return true;
+}
+
+bool TaskTransfer::importTasks(QIODevice *in, Format format, int batchSize, Stats *stats, QString *error)
+{
+    Stats local;
+    Stats &s = stats ? *stats : local;
+    s = Stats();
+
+    QScopedPointer<RecordReader> reader(createReader(format, in));
+    QString message;
+    if (!reader->begin(message)) {
+        if (error) *error = message;
+        return false;
+    }
+
+    batchSize = qMax(1, batchSize);
+    QList<DatedTask> batch;
+    QList<TaskChange> ruleBatch;
+    batch.reserve(batchSize);
+    auto flush = [&]() {
+        // 普通任务和重复规则同在一个事务里，失败时整批回滚，s.records 只统计真正写入的
+        if (!DatabaseManager::instance().applyTaskChanges(ruleBatch, batch)) return false;
+        s.records += batch.size() + ruleBatch.size();
+        s.rules += ruleBatch.size();
+        batch.clear();
+        ruleBatch.clear();
+        return true;
+    };
+
+    DatedTask item;
+    RecordReader::Result result;
+    while ((result = reader->next(item, message)) != RecordReader::End) {
+        if (result == RecordReader::Skip) {
+            if (s.skipped++ == 0) s.firstError = message;
+            continue;
+        }
+        if (reader->rule().isValid()) {
+            ruleBatch.append(TaskChange::addRule(item.task, reader->rule()));
+        } else {
+            batch.append(item);
+        }
+        if (batch.size() + ruleBatch.size() >= batchSize && !flush()) {
+            if (error) *error = "写入数据库失败";
+            return false;
+        }
+    }
+    if (!flush()) {
+        if (error) *error = "写入数据库失败";
+        return false;
+    }
+    return true;
+}
+
+bool TaskTransfer::exportCourses(QIODevice *out, const QList<CourseEntry> &courses, const QDate &termStart, int weeks,
+                                 Stats *stats, QString *error)
+{
+    if (!termStart.isValid()) {
+        if (error) *error = "未设置学期开始日期";
+        return false;
+    }
+    ICalendarWriter writer(out);
+    qint64 count = 0;
+    writer.begin();
+    for (const CourseEntry &course : courses) {
+        if (!ScheduleModel::isPlaceable(course)) continue;
+        writer.writeCourse(course, termStart, weeks);
+        ++count;
+    }
+    writer.end();
+
+    if (stats) {
+        stats->records = count;
+        stats->rules = count;
+    }
+    if (!writer.flush()) {
+        if (error) *error = "写出失败：" + out->errorString();
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,55 @@
+#ifndef TASKTRANSFER_H
+#define TASKTRANSFER_H
+
+#include "DailyTask.h"
+#include "PersonSchedule.h"
+#include <QDate>
+#include <QJsonObject>
+#include <QList>
+#include <QString>
+
+class QIODevice;
+
+// 任务的批量导入导出。逐条读写 QIODevice，不在内存里拼整份文档，
+// 几 GB 的导出/导入内存占用也只与单条记录和一个批次有关。
+// 支持的格式：
+//   CSV       首行为表头 id,date,start_time,end_time,title,note（RFC 4180 引号规则）
+//   JSON      JSON Lines，每行一个 {"id","date","start_time","end_time","title","note"} 对象
+//   iCalendar 每个任务一个 VEVENT，重复日程写成一个带 RRULE 的 VEVENT（见 ICalendar.h）
+class TaskTransfer
+{
+public:
+    enum Format { Csv, JsonLines, ICalendar };
+
+    // csv / json / jsonl / ics，不区分大小写
+    static bool formatFromName(const QString &name, Format &format);
+    // 按扩展名推断：.csv / .json / .jsonl / .ndjson / .ics
+    static bool formatFromFileName(const QString &path, Format &format);
+
+    // 单条任务与 JSON 对象互转（JSON Lines 导入导出和本地 RPC 共用）。
+    // 时间为 HH:mm，没有时间时为空串；fromJson 不校验日期和标题
+    static QJsonObject toJson(const DatedTask &item);
+    static DatedTask fromJson(const QJsonObject &obj);
+
+    struct Stats {
+        qint64 records = 0;  // 成功导出/导入的条数
+        qint64 rules = 0;    // 其中作为重复日程（task_rules）导出/导入的条数
+        qint64 skipped = 0;  // 导入时无法解析或重复规则不支持而跳过的条数
+        QString firstError;  // 第一条被跳过的原因（带行号）
+    };
+
+    // 导出 [from, to] 内的任务，日期无效表示该端不设限。
+    // iCalendar 还会导出在区间内有实例的重复日程；CSV/JSON 只含 tasks 表
+    static bool exportTasks(QIODevice *out, Format format, const QDate &from = QDate(), const QDate &to = QDate(),
+                            Stats *stats = nullptr, QString *error = nullptr);
+    // 每攒够 batchSize 条在一个事务里写入；中途写库失败时返回 false，之前已提交的批次保留。
+    // iCalendar 中 RRULE 可以表示的事件导入为重复日程
+    static bool importTasks(QIODevice *in, Format format, int batchSize = 1000,
+                            Stats *stats = nullptr, QString *error = nullptr);
+
+    // 把每周课表导出为 iCalendar：每门课一个从 termStart 所在周起、重复 weeks 周的 VEVENT
+    static bool exportCourses(QIODevice *out, const QList<CourseEntry> &courses, const QDate &termStart, int weeks,
+                              Stats *stats = nullptr, QString *error = nullptr);
+};
+
+#endif // TASKTRANSFER_H
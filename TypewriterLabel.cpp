@@ -0,0 +1,261 @@
+#include "TypewriterLabel.h"
+#include <QEvent>
+#include <QPainter>
+#include <QPaintEvent>
+#include <QRandomGenerator>
+#include <QStyleOption>
+#include <QTextLine>
+#include <QTimer>
+#include <QWindow>
+
+namespace {
+const int kFirstTypingMs = 120; // 第一句打得慢一点
+const int kTypingMs = 90;
+const int kDeletingMs = 30;
+const int kHoldFullMs = 1000;   // 打完后停顿
+const int kHoldEmptyMs = 500;   // 删完后停顿
+}
+
+TypewriterLabel::TypewriterLabel(QWidget *parent)
+    : QWidget(parent)
+    , m_timer(new QTimer(this))
+{
+    setAttribute(Qt::WA_StyledBackground);
+    m_timer->setTimerType(Qt::CoarseTimer);
+    connect(m_timer, &QTimer::timeout, this, &TypewriterLabel::onTick);
+}
+
+void TypewriterLabel::setPhrases(const QStringList &phrases)
+{
+    m_phrases = phrases;
+}
+
+void TypewriterLabel::start()
+{
+    if (m_running || m_phrases.isEmpty()) return;
+    m_running = true;
+    m_paused = false;
+    m_firstPhrase = true;
+    selectNextPhrase();
+    enterStage(Stage::Typing);
+    if (!canAnimate()) pause();
+}
+
+void TypewriterLabel::stop()
+{
+    m_running = false;
+    m_paused = false;
+    m_timer->stop();
+}
+
+int TypewriterLabel::visibleLength() const
+{
+    return m_cursorStops.isEmpty() ? 0 : m_cursorStops.at(m_visibleStops);
+}
+
+void TypewriterLabel::selectNextPhrase()
+{
+    m_phrase = m_phrases.at(QRandomGenerator::global()->bounded(m_phrases.size()));
+    layoutPhrase();
+    m_visibleStops = 0;
+    update();
+}
+
+// 整句排版一次，记下每个字形簇边界的位置，之后的节拍不再碰排版
+void TypewriterLabel::layoutPhrase()
+{
+    m_layout.clearLayout();
+    m_layout.setText(m_phrase);
+    m_layout.setFont(font());
+    QTextOption option;
+    option.setWrapMode(QTextOption::NoWrap);
+    m_layout.setTextOption(option);
+    m_layout.setCacheEnabled(true);
+
+    m_layout.beginLayout();
+    QTextLine line = m_layout.createLine();
+    if (line.isValid()) line.setLineWidth(1e6);
+    m_layout.endLayout();
+
+    m_cursorStops.clear();
+    m_stopX.clear();
+    m_phraseWidth = 0;
+    if (!line.isValid()) return;
+
+    int pos = 0;
+    m_cursorStops.append(0);
+    m_stopX.append(line.cursorToX(0));
+    while (pos < m_phrase.size()) {
+        pos = m_layout.nextCursorPosition(pos);
+        m_cursorStops.append(pos);
+        m_stopX.append(line.cursorToX(pos));
+    }
+    m_phraseWidth = line.naturalTextWidth();
+    m_visibleStops = qMin(m_visibleStops, int(m_cursorStops.size()) - 1);
+}
+
+void TypewriterLabel::enterStage(Stage stage)
+{
+    m_stage = stage;
+    m_timer->start(intervalFor(stage));
+}
+
+int TypewriterLabel::intervalFor(Stage stage) const
+{
+    switch (stage) {
+    case Stage::Typing:    return m_firstPhrase ? kFirstTypingMs : kTypingMs;
+    case Stage::HoldFull:  return kHoldFullMs;
+    case Stage::Deleting:  return kDeletingMs;
+    case Stage::HoldEmpty: return kHoldEmptyMs;
+    }
+    return kTypingMs;
+}
+
+void TypewriterLabel::onTick()
+{
+    if (!canAnimate()) {
+        pause();
+        return;
+    }
+
+    const int lastStop = int(m_cursorStops.size()) - 1;
+    switch (m_stage) {
+    case Stage::Typing:
+        if (m_visibleStops < lastStop) {
+            updateColumns(m_visibleStops, m_visibleStops + 1);
+            ++m_visibleStops;
+        } else {
+            enterStage(Stage::HoldFull);
+        }
+        break;
+    case Stage::HoldFull:
+        enterStage(Stage::Deleting);
+        break;
+    case Stage::Deleting:
+        if (m_visibleStops > 0) {
+            updateColumns(m_visibleStops - 1, m_visibleStops);
+            --m_visibleStops;
+        } else {
+            enterStage(Stage::HoldEmpty);
+        }
+        break;
+    case Stage::HoldEmpty:
+        m_firstPhrase = false;
+        selectNextPhrase();
+        enterStage(Stage::Typing);
+        break;
+    }
+}
+
+// 只重绘 [fromStop, toStop] 两个边界之间的那一列，左右各留一点给字形外伸
+void TypewriterLabel::updateColumns(int fromStop, int toStop)
+{
+    const QPointF origin = textOrigin();
+    const qreal left = origin.x() + m_stopX.at(fromStop);
+    const qreal right = origin.x() + m_stopX.at(toStop);
+    update(QRectF(qMin(left, right) - 2, 0, qAbs(right - left) + 4, height()).toAlignedRect());
+}
+
+// 整句居中：打字过程中已显示的部分不再移动，才能只重绘新增的那一列
+QPointF TypewriterLabel::textOrigin() const
+{
+    const QRectF bounds = m_layout.boundingRect();
+    return QPointF((width() - m_phraseWidth) / 2.0, (height() - bounds.height()) / 2.0);
+}
+
+void TypewriterLabel::paintEvent(QPaintEvent *event)
+{
+    QPainter painter(this);
+    QStyleOption option;
+    option.initFrom(this);
+    style()->drawPrimitive(QStyle::PE_Widget, &option, &painter, this);
+
+    if (m_visibleStops <= 0 || m_cursorStops.isEmpty()) return;
+
+    const QPointF origin = textOrigin();
+    const QRectF visible(0, 0, origin.x() + m_stopX.at(m_visibleStops), height());
+    painter.setClipRect(visible.intersected(QRectF(event->rect())));
+    painter.setPen(palette().color(foregroundRole()));
+    m_layout.draw(&painter, origin);
+}
+
+void TypewriterLabel::changeEvent(QEvent *event)
+{
+    // 样式表改字号时重新排版当前句子
+    if (event->type() == QEvent::FontChange || event->type() == QEvent::StyleChange) {
+        if (!m_phrase.isEmpty()) {
+            layoutPhrase();
+            update();
+        }
+    }
+    QWidget::changeEvent(event);
+}
+
+void TypewriterLabel::showEvent(QShowEvent *event)
+{
+    QWidget::showEvent(event);
+    watchWindow();
+    resumeIfPossible();
+}
+
+void TypewriterLabel::hideEvent(QHideEvent *event)
+{
+    QWidget::hideEvent(event);
+    if (m_running) pause();
+}
+
+// 顶层窗口的最小化和 QWindow 的暴露状态变化都会影响能否继续动画
+void TypewriterLabel::watchWindow()
+{
+    QWidget *top = window();
+    if (m_watchedWindow != top) {
+        if (m_watchedWindow) m_watchedWindow->removeEventFilter(this);
+        m_watchedWindow = top;
+        top->installEventFilter(this);
+    }
+    QWindow *handle = top->windowHandle();
+    if (handle && m_watchedHandle != handle) {
+        if (m_watchedHandle) m_watchedHandle->removeEventFilter(this);
+        m_watchedHandle = handle;
+        handle->installEventFilter(this);
+        connect(handle, &QObject::destroyed, this, [this]() { m_watchedHandle = nullptr; });
+    }
+}
+
+bool TypewriterLabel::eventFilter(QObject *watched, QEvent *event)
+{
+    if (watched == m_watchedWindow && event->type() == QEvent::WindowStateChange) {
+        if (window()->isMinimized()) {
+            if (m_running) pause();
+        } else {
+            resumeIfPossible();
+        }
+    } else if (watched == m_watchedHandle && event->type() == QEvent::Expose) {
+        // 被遮挡或移出屏幕时平台会发出未暴露的 Expose 事件
+        if (canAnimate()) resumeIfPossible();
+        else if (m_running) pause();
+    }
+    return QWidget::eventFilter(watched, event);
+}
+
+bool TypewriterLabel::canAnimate() const
+{
+    if (!isVisible()) return false;
+    const QWidget *top = window();
+    if (top->isMinimized()) return false;
+    const QWindow *handle = top->windowHandle();
+    return handle && handle->isExposed();
+}
+
+void TypewriterLabel::pause()
+{
+    m_timer->stop();
+    m_paused = true;
+}
+
+void TypewriterLabel::resumeIfPossible()
+{
+    if (!m_running || !m_paused || !canAnimate()) return;
+    m_paused = false;
+    m_timer->start(intervalFor(m_stage));
+}
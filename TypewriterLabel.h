@@ -0,0 +1,71 @@
+#ifndef TYPEWRITERLABEL_H
+#define TYPEWRITERLABEL_H
+
+#include <QWidget>
+#include <QStringList>
+#include <QTextLayout>
+#include <QVector>
+
+class QTimer;
+
+// 打字机效果的标题栏：每句话只排版一次（QTextLayout），
+// 之后每个节拍只是改变可见的字符数，并且只重绘新出现/消失的那一小块。
+// 窗口隐藏、最小化或不可见（平台报告未暴露）时计时器完全停下，恢复后接着打。
+class TypewriterLabel : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit TypewriterLabel(QWidget *parent = nullptr);
+
+    void setPhrases(const QStringList &phrases);
+    void start();
+    void stop();
+
+    bool isRunning() const { return m_running; }
+    bool isPaused() const { return m_running && m_paused; }
+    QString currentPhrase() const { return m_phrase; }
+    int visibleLength() const; // 当前可见的字符数（QChar 计）
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void changeEvent(QEvent *event) override;
+    void showEvent(QShowEvent *event) override;
+    void hideEvent(QHideEvent *event) override;
+    bool eventFilter(QObject *watched, QEvent *event) override;
+
+private slots:
+    void onTick();
+
+private:
+    enum class Stage { Typing, HoldFull, Deleting, HoldEmpty };
+
+    void selectNextPhrase();
+    void layoutPhrase();
+    void enterStage(Stage stage);
+    int intervalFor(Stage stage) const;
+    bool canAnimate() const;
+    void pause();
+    void resumeIfPossible();
+    void watchWindow();
+    QPointF textOrigin() const;
+    void updateColumns(int fromStop, int toStop);
+
+    QStringList m_phrases;
+    QString m_phrase;
+    QTextLayout m_layout;
+    QVector<int> m_cursorStops;  // 每个字形簇的边界（字符下标），首项为 0
+    QVector<qreal> m_stopX;      // 对应边界的 x 坐标
+    qreal m_phraseWidth = 0;
+    int m_visibleStops = 0;      // 当前显示到第几个边界
+
+    QTimer *m_timer;
+    Stage m_stage = Stage::Typing;
+    bool m_running = false;
+    bool m_paused = false;
+    bool m_firstPhrase = true;
+    QObject *m_watchedWindow = nullptr;
+    QObject *m_watchedHandle = nullptr;
+};
+
+#endif // TYPEWRITERLABEL_H
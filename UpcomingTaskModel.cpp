@@ -0,0 +1,134 @@
+#include "UpcomingTaskModel.h"
+#include "DatabaseManager.h"
+#include <algorithm>
+
+// 重复日程向后展开的最大天数
+static const int OCCURRENCE_HORIZON_DAYS = 365;
+
+UpcomingTaskModel::UpcomingTaskModel(const QDate &fromDate, int pageSize, QObject *parent)
+    : QAbstractListModel(parent), m_fromDate(fromDate), m_pageSize(pageSize)
+{
+    reset();
+}
+
+UpcomingTaskModel::Urgency UpcomingTaskModel::urgencyFor(qint64 daysUntil)
+{
+    if (daysUntil <= 0) return Today;
+    if (daysUntil <= 6) return Urgent;
+    if (daysUntil <= 14) return Soon;
+    return Later;
+}
+
+void UpcomingTaskModel::reset()
+{
+    beginResetModel();
+    m_rows.clear();
+    // 游标放在 fromDate 的最前面，第一页即从 fromDate 当天开始
+    m_cursor = DatedTask{m_fromDate, DailyTask()};
+    m_cursor.task.setId(-1);
+    m_occurrencesFrom = m_fromDate;
+    m_horizon = m_fromDate.addDays(OCCURRENCE_HORIZON_DAYS);
+    m_exhausted = false;
+    endResetModel();
+}
+
+int UpcomingTaskModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_rows.size();
+}
+
+QVariant UpcomingTaskModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_rows.size())
+        return QVariant();
+
+    const Row &row = m_rows.at(index.row());
+    switch (role) {
+    case Qt::DisplayRole:
+        return row.isHeader ? row.item.date.toString("yyyy年MM月dd日 (dddd)")
+                            : row.item.task.getTitle();
+    case Qt::ToolTipRole:
+        return row.isHeader ? QVariant() : QVariant(row.item.task.getNote());
+    case IsHeaderRole:
+        return row.isHeader;
+    case DateRole:
+        return row.item.date;
+    case DaysUntilRole:
+        return QDate::currentDate().daysTo(row.item.date);
+    case StartTimeRole:
+        return row.item.task.getStartTime();
+    case EndTimeRole:
+        return row.item.task.getEndTime();
+    case NoteRole:
+        return row.item.task.getNote();
+    case TaskIdRole:
+        return row.item.task.getId();
+    case IsRecurringRole:
+        return row.item.task.isOccurrence();
+    default:
+        return QVariant();
+    }
+}
+
+bool UpcomingTaskModel::canFetchMore(const QModelIndex &parent) const
+{
+    return !parent.isValid() && !m_exhausted;
+}
+
+void UpcomingTaskModel::fetchMore(const QModelIndex &parent)
+{
+    if (parent.isValid() || m_exhausted)
+        return;
+
+    DatabaseManager &db = DatabaseManager::instance();
+    QList<DatedTask> page = db.getTasksPageAfter(m_cursor, m_pageSize);
+
+    // 确定本页覆盖到哪一天：整页时最后一天可能还有下一页的任务，
+    // 先把这一天留给下一页，保证同一天内普通任务与重复实例的顺序正确
+    QDate through;
+    if (page.size() < m_pageSize) {
+        m_exhausted = true;
+        through = m_horizon;
+    } else {
+        const QDate lastDate = page.constLast().date;
+        if (page.constFirst().date < lastDate) {
+            while (page.constLast().date == lastDate) {
+                page.removeLast();
+            }
+            through = lastDate.addDays(-1);
+        } else {
+            through = lastDate; // 整页都在同一天，只能接受跨页
+        }
+    }
+    if (!page.isEmpty()) {
+        m_cursor = page.constLast();
+    }
+
+    QList<DatedTask> merged = page;
+    const QDate occurrencesTo = std::min(through, m_horizon);
+    if (m_occurrencesFrom <= occurrencesTo) {
+        merged += db.getOccurrencesBetween(m_occurrencesFrom, occurrencesTo);
+        m_occurrencesFrom = occurrencesTo.addDays(1);
+        std::stable_sort(merged.begin(), merged.end(), [](const DatedTask &a, const DatedTask &b) {
+            return a.startDateTime() < b.startDateTime();
+        });
+    }
+    if (merged.isEmpty())
+        return;
+
+    // 先算出新增行（含日期标题行），再一次性插入
+    QVector<Row> newRows;
+    newRows.reserve(page.size() * 2);
+    QDate lastDate = m_rows.isEmpty() ? QDate() : m_rows.constLast().item.date;
+    for (const DatedTask &task : merged) {
+        if (task.date != lastDate) {
+            newRows.append({true, DatedTask{task.date, DailyTask()}});
+            lastDate = task.date;
+        }
+        newRows.append({false, task});
+    }
+
+    beginInsertRows(QModelIndex(), m_rows.size(), m_rows.size() + newRows.size() - 1);
+    m_rows += newRows;
+    endInsertRows();
+}
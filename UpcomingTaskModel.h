@@ -0,0 +1,59 @@
+#ifndef UPCOMINGTASKMODEL_H
+#define UPCOMINGTASKMODEL_H
+
+#include <QAbstractListModel>
+#include <QVector>
+#include <QDate>
+#include "DailyTask.h"
+
+// 未来日程列表模型：按日期分组（每个日期前插入一个标题行），
+// 滚动到底部时才从数据库分页取下一批，不会一次性加载全部任务。
+// 重复日程的实例只在每页覆盖的日期区间内展开，再与普通任务按时间合并。
+class UpcomingTaskModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+public:
+    enum Roles {
+        IsHeaderRole = Qt::UserRole + 1,
+        DateRole,
+        DaysUntilRole,
+        StartTimeRole,
+        EndTimeRole,
+        NoteRole,
+        TaskIdRole,
+        IsRecurringRole
+    };
+
+    // 紧急程度分档：≤6 天红色，≤14 天黄色，≥15 天绿色
+    enum Urgency { Today, Urgent, Soon, Later };
+    static Urgency urgencyFor(qint64 daysUntil);
+
+    explicit UpcomingTaskModel(const QDate &fromDate = QDate::currentDate(),
+                               int pageSize = 50,
+                               QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    bool canFetchMore(const QModelIndex &parent) const override;
+    void fetchMore(const QModelIndex &parent) override;
+
+    bool isExhaustedAndEmpty() const { return m_exhausted && m_rows.isEmpty(); }
+    void reset(); // 重新从第一页开始加载
+
+private:
+    struct Row {
+        bool isHeader;
+        DatedTask item;
+    };
+
+    QVector<Row> m_rows;
+    QDate m_fromDate;
+    DatedTask m_cursor;   // 最后一条已加载任务，作为下一页的键集游标
+    QDate m_occurrencesFrom; // 重复日程实例尚未展开的起始日期
+    QDate m_horizon;         // 重复日程最多展开到这一天（无限重复的规则需要一个终点）
+    int m_pageSize;
+    bool m_exhausted = false;
+};
+
+#endif // UPCOMINGTASKMODEL_H
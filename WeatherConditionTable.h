@@ -0,0 +1,250 @@
+#ifndef WEATHERCONDITIONTABLE_H
+#define WEATHERCONDITIONTABLE_H
+
+#include <QString>
+#include <QStringView>
+#include <cstddef>
+
+// OpenWeatherMap 天气状况的中文翻译表。
+// 表在编译期确定，启动时不做任何插入和分配；优先按 weather[0].id 查找，
+// 找不到时按英文描述查找，最后按 id 所属大类给出笼统的描述。
+namespace WeatherConditionTable {
+
+struct IdEntry {
+    int id;
+    const char *chinese;
+};
+
+struct DescriptionEntry {
+    const char *english; // 小写
+    const char *chinese;
+};
+
+// 按 id 升序排列，二分查找
+inline constexpr IdEntry kById[] = {
+    {200, "雷阵雨"}, // thunderstorm with light rain
+    {201, "雷雨"}, // thunderstorm with rain
+    {202, "雷暴大雨"}, // thunderstorm with heavy rain
+    {210, "弱雷暴"}, // light thunderstorm
+    {211, "雷暴"}, // thunderstorm
+    {212, "强雷暴"}, // heavy thunderstorm
+    {221, "零星雷暴"}, // ragged thunderstorm
+    {230, "雷暴伴小毛毛雨"}, // thunderstorm with light drizzle
+    {231, "雷暴伴毛毛雨"}, // thunderstorm with drizzle
+    {232, "雷暴伴大毛毛雨"}, // thunderstorm with heavy drizzle
+    {300, "毛毛雨"}, // light intensity drizzle
+    {301, "毛毛雨"}, // drizzle
+    {302, "大毛毛雨"}, // heavy intensity drizzle
+    {310, "小毛毛雨"}, // light intensity drizzle rain
+    {311, "毛毛雨"}, // drizzle rain
+    {312, "大毛毛雨"}, // heavy intensity drizzle rain
+    {313, "阵雨夹毛毛雨"}, // shower rain and drizzle
+    {314, "大阵雨夹毛毛雨"}, // heavy shower rain and drizzle
+    {321, "阵性毛毛雨"}, // shower drizzle
+    {500, "小雨"}, // light rain
+    {501, "中雨"}, // moderate rain
+    {502, "大雨"}, // heavy intensity rain
+    {503, "暴雨"}, // very heavy rain
+    {504, "大暴雨"}, // extreme rain
+    {511, "冻雨"}, // freezing rain
+    {520, "小阵雨"}, // light intensity shower rain
+    {521, "阵雨"}, // shower rain
+    {522, "大阵雨"}, // heavy intensity shower rain
+    {531, "零星阵雨"}, // ragged shower rain
+    {600, "小雪"}, // light snow
+    {601, "雪"}, // snow
+    {602, "大雪"}, // heavy snow
+    {611, "雨夹雪"}, // sleet
+    {612, "小阵雨夹雪"}, // light shower sleet
+    {613, "阵雨夹雪"}, // shower sleet
+    {615, "小雨夹雪"}, // light rain and snow
+    {616, "雨夹雪"}, // rain and snow
+    {620, "小阵雪"}, // light shower snow
+    {621, "阵雪"}, // shower snow
+    {622, "大阵雪"}, // heavy shower snow
+    {701, "薄雾"}, // mist
+    {711, "烟"}, // smoke
+    {721, "霾"}, // haze
+    {731, "沙尘暴"}, // sand/dust whirls
+    {741, "雾"}, // fog
+    {751, "扬沙"}, // sand
+    {761, "浮尘"}, // dust
+    {762, "火山灰"}, // volcanic ash
+    {771, "飑"}, // squalls
+    {781, "龙卷风"}, // tornado
+    {800, "晴空"}, // clear sky
+    {801, "少云"}, // few clouds
+    {802, "多云"}, // scattered clouds
+    {803, "碎云"}, // broken clouds
+    {804, "阴天"}, // overcast clouds
+};
+
+// 按英文描述（字节序）升序排列，二分查找
+inline constexpr DescriptionEntry kByDescription[] = {
+    {"broken clouds", "碎云"},
+    {"clear sky", "晴空"},
+    {"drizzle", "毛毛雨"},
+    {"drizzle rain", "毛毛雨"},
+    {"dust", "浮尘"},
+    {"dust whirls", "尘卷风"},
+    {"extreme rain", "大暴雨"},
+    {"few clouds", "少云"},
+    {"fog", "雾"},
+    {"freezing rain", "冻雨"},
+    {"hail", "冰雹"},
+    {"haze", "霾"},
+    {"heavy intensity drizzle", "大毛毛雨"},
+    {"heavy intensity drizzle rain", "大毛毛雨"},
+    {"heavy intensity rain", "大雨"},
+    {"heavy intensity shower rain", "大阵雨"},
+    {"heavy shower rain and drizzle", "大阵雨夹毛毛雨"},
+    {"heavy shower snow", "大阵雪"},
+    {"heavy snow", "大雪"},
+    {"heavy thunderstorm", "强雷暴"},
+    {"light intensity drizzle", "毛毛雨"},
+    {"light intensity drizzle rain", "小毛毛雨"},
+    {"light intensity shower rain", "小阵雨"},
+    {"light rain", "小雨"},
+    {"light rain and snow", "小雨夹雪"},
+    {"light shower sleet", "小阵雨夹雪"},
+    {"light shower snow", "小阵雪"},
+    {"light snow", "小雪"},
+    {"light thunderstorm", "弱雷暴"},
+    {"mist", "薄雾"},
+    {"moderate rain", "中雨"},
+    {"overcast clouds", "阴天"},
+    {"ragged shower rain", "零星阵雨"},
+    {"ragged thunderstorm", "零星雷暴"},
+    {"rain", "雨"},
+    {"rain and snow", "雨夹雪"},
+    {"sand", "扬沙"},
+    {"sand/dust whirls", "沙尘暴"},
+    {"scattered clouds", "多云"},
+    {"shower drizzle", "阵性毛毛雨"},
+    {"shower rain", "阵雨"},
+    {"shower rain and drizzle", "阵雨夹毛毛雨"},
+    {"shower sleet", "阵雨夹雪"},
+    {"shower snow", "阵雪"},
+    {"sleet", "雨夹雪"},
+    {"smoke", "烟"},
+    {"snow", "雪"},
+    {"squalls", "飑"},
+    {"thunderstorm", "雷暴"},
+    {"thunderstorm with drizzle", "雷暴伴毛毛雨"},
+    {"thunderstorm with heavy drizzle", "雷暴伴大毛毛雨"},
+    {"thunderstorm with heavy rain", "雷暴大雨"},
+    {"thunderstorm with light drizzle", "雷暴伴小毛毛雨"},
+    {"thunderstorm with light rain", "雷阵雨"},
+    {"thunderstorm with rain", "雷雨"},
+    {"tornado", "龙卷风"},
+    {"very heavy rain", "暴雨"},
+    {"volcanic ash", "火山灰"},
+};
+
+inline constexpr std::size_t kIdCount = sizeof(kById) / sizeof(kById[0]);
+inline constexpr std::size_t kDescriptionCount = sizeof(kByDescription) / sizeof(kByDescription[0]);
+
+constexpr int compareAscii(const char *a, const char *b)
+{
+    while (*a && *a == *b) {
+        ++a;
+        ++b;
+    }
+    return static_cast<unsigned char>(*a) - static_cast<unsigned char>(*b);
+}
+
+constexpr const char *chineseById(int id)
+{
+    std::size_t lo = 0;
+    std::size_t hi = kIdCount;
+    while (lo < hi) {
+        const std::size_t mid = lo + (hi - lo) / 2;
+        if (kById[mid].id < id) {
+            lo = mid + 1;
+        } else if (kById[mid].id > id) {
+            hi = mid;
+        } else {
+            return kById[mid].chinese;
+        }
+    }
+    return nullptr;
+}
+
+// id 不在表中时按大类兜底（OpenWeatherMap 偶尔会新增细分代码）
+constexpr const char *chineseByGroup(int id)
+{
+    if (id >= 200 && id < 300) return "雷暴";
+    if (id >= 300 && id < 400) return "毛毛雨";
+    if (id >= 500 && id < 600) return "雨";
+    if (id >= 600 && id < 700) return "雪";
+    if (id >= 700 && id < 800) return "雾霾";
+    if (id == 800) return "晴";
+    if (id > 800 && id < 900) return "多云";
+    return nullptr;
+}
+
+// 忽略大小写比较 QStringView 和 ASCII 字面量，不产生临时字符串
+inline int compareDescription(QStringView text, const char *english)
+{
+    qsizetype i = 0;
+    for (; i < text.size() && english[i]; ++i) {
+        const char16_t c = text.at(i).toLower().unicode();
+        const char16_t e = static_cast<unsigned char>(english[i]);
+        if (c != e) return c < e ? -1 : 1;
+    }
+    if (i < text.size()) return 1;
+    return english[i] ? -1 : 0;
+}
+
+inline const char *chineseByDescription(QStringView description)
+{
+    description = description.trimmed();
+    std::size_t lo = 0;
+    std::size_t hi = kDescriptionCount;
+    while (lo < hi) {
+        const std::size_t mid = lo + (hi - lo) / 2;
+        const int cmp = compareDescription(description, kByDescription[mid].english);
+        if (cmp > 0) {
+            lo = mid + 1;
+        } else if (cmp < 0) {
+            hi = mid;
+        } else {
+            return kByDescription[mid].chinese;
+        }
+    }
+    return nullptr;
+}
+
+// 依次按 id、英文描述、id 大类查找；都找不到时返回原始英文描述
+inline QString toChinese(int id, QStringView description)
+{
+    if (const char *text = chineseById(id)) return QString::fromUtf8(text);
+    if (const char *text = chineseByDescription(description)) return QString::fromUtf8(text);
+    if (const char *text = chineseByGroup(id)) return QString::fromUtf8(text);
+    return description.toString();
+}
+
+// ---- 编译期自检：二分查找依赖表有序、无重复；译文本身由 tests/tst_weather_table.cpp 逐条核对 ----
+constexpr bool idsSortedAndUnique()
+{
+    for (std::size_t i = 1; i < kIdCount; ++i) {
+        if (kById[i - 1].id >= kById[i].id) return false;
+    }
+    return true;
+}
+
+constexpr bool descriptionsSortedAndUnique()
+{
+    for (std::size_t i = 1; i < kDescriptionCount; ++i) {
+        if (compareAscii(kByDescription[i - 1].english, kByDescription[i].english) >= 0) return false;
+    }
+    return true;
+}
+
+static_assert(idsSortedAndUnique(), "kById 必须按 id 严格升序");
+static_assert(descriptionsSortedAndUnique(), "kByDescription 必须按英文描述严格升序");
+static_assert(chineseById(799) == nullptr && chineseByGroup(799) != nullptr, "未知代码应落到大类兜底");
+
+} // namespace WeatherConditionTable
+
+#endif // WEATHERCONDITIONTABLE_H
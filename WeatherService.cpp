@@ -0,0 +1,343 @@
+#include "WeatherService.h"
+#include "NetworkService.h"
+#include "MetricsRegistry.h"
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QUrlQuery>
+#include <QPixmapCache>
+#include <QStandardPaths>
+#include <QSettings>
+#include <QElapsedTimer>
+#include <QTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QRandomGenerator>
+#include <QDebug>
+#include <algorithm>
+
+static const char *DEFAULT_BASE_URL = "http://api.openweathermap.org/data/2.5/weather";
+static const char *DEFAULT_ICON_BASE_URL = "https://openweathermap.org/img/wn";
+// 失败后第一次重试的等待时间，之后每次翻倍，直到正常刷新间隔
+static const int INITIAL_BACKOFF_SECONDS = 30;
+// 刷新间隔上下浮动的比例，避免多台机器同时请求
+static const double REFRESH_JITTER = 0.1;
+
+WeatherService::WeatherService(const QString &apiKey, QObject *parent)
+    : QObject(parent)
+    , m_apiKey(apiKey)
+    , m_refreshTimer(new QTimer(this))
+{
+    m_refreshTimer->setSingleShot(true);
+    connect(m_refreshTimer, &QTimer::timeout, this, &WeatherService::onRefreshTimeout);
+
+    // 环境变量优先于配置文件，方便测试时指向本地 mock
+    QSettings settings("MyCourseApp", "Weather");
+    QString base = qEnvironmentVariable("PLANNER_WEATHER_BASE_URL",
+                                        settings.value("baseUrl", DEFAULT_BASE_URL).toString());
+    QString iconBase = qEnvironmentVariable("PLANNER_WEATHER_ICON_URL",
+                                            settings.value("iconBaseUrl", DEFAULT_ICON_BASE_URL).toString());
+    m_baseUrl = QUrl(base);
+    m_iconBaseUrl = QUrl(iconBase);
+    m_ttlSeconds = settings.value("cacheTtlSeconds", m_ttlSeconds).toInt();
+
+    // 把上次的结果放进缓存（视为已过期），后续请求会带上条件头
+    WeatherReading last = lastPersistedReading();
+    if (last.isValid()) {
+        CacheEntry &entry = m_cache[last.city.toLower()];
+        entry.reading = last;
+        entry.expiresAt = QDateTime::currentDateTimeUtc();
+    }
+}
+
+void WeatherService::fetchWeather(const QString &city, bool forceRefresh)
+{
+    const QString key = city.trimmed().toLower();
+    if (key.isEmpty()) return;
+
+    auto cached = m_cache.constFind(key);
+    if (!forceRefresh && cached != m_cache.constEnd()
+        && QDateTime::currentDateTimeUtc() < cached->expiresAt) {
+        // 命中缓存：保持异步语义，和网络返回走同一条路径
+        const WeatherReading reading = cached->reading;
+        MetricsRegistry::instance().counter("planner_weather_replies_total", {{"result", "cache"}})->increment();
+        QTimer::singleShot(0, this, [this, reading]() { emit weatherReady(reading); });
+        return;
+    }
+
+    // 同一城市已有请求在途，等它返回即可
+    if (m_inFlight.contains(key)) return;
+
+    QUrl url(m_baseUrl);
+    QUrlQuery query(url);
+    query.addQueryItem("q", city.trimmed());
+    query.addQueryItem("units", "metric");
+    query.addQueryItem("appid", m_apiKey);
+    query.addQueryItem("lang", "en");
+    url.setQuery(query);
+
+    QNetworkRequest request(url);
+    // 天气 JSON 由本类自己缓存并做条件请求，不再存进共享的 HTTP 磁盘缓存，
+    // 否则 304 会被网络层替换成缓存里的 200
+    request.setAttribute(QNetworkRequest::CacheSaveControlAttribute, false);
+    request.setAttribute(QNetworkRequest::CacheLoadControlAttribute, QNetworkRequest::AlwaysNetwork);
+    if (cached != m_cache.constEnd()) {
+        // 条件请求：数据没变时服务器只回 304
+        if (!cached->etag.isEmpty())
+            request.setRawHeader("If-None-Match", cached->etag);
+        if (!cached->lastModified.isEmpty())
+            request.setRawHeader("If-Modified-Since", cached->lastModified);
+    }
+
+    m_inFlight.insert(key);
+    QElapsedTimer timer;
+    timer.start();
+    NetworkService::instance().get(request, this, [this, key, timer](QNetworkReply *reply) {
+        // 从发起到收到应答的整段时间，含网络层排队
+        MetricsRegistry::instance().histogram("planner_weather_fetch_seconds")->record(timer.nsecsElapsed() / 1000);
+        onWeatherReply(reply, key);
+    });
+}
+
+bool WeatherService::cachedReading(const QString &city, WeatherReading &out) const
+{
+    auto it = m_cache.constFind(city.trimmed().toLower());
+    if (it == m_cache.constEnd()) return false;
+    out = it->reading;
+    return true;
+}
+
+void WeatherService::onWeatherReply(QNetworkReply *reply, const QString &cityKey)
+{
+    m_inFlight.remove(cityKey);
+    const bool isBackgroundCity = cityKey == m_refreshCity.trimmed().toLower();
+
+    const int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    CacheEntry &entry = m_cache[cityKey];
+
+    auto countReply = [](const char *result) {
+        MetricsRegistry::instance().counter("planner_weather_replies_total", {{"result", result}})->increment();
+    };
+
+    if (status == 304 && entry.reading.isValid()) {
+        countReply("not_modified");
+        entry.expiresAt = QDateTime::currentDateTimeUtc().addSecs(m_ttlSeconds);
+        entry.reading.fetchedAt = QDateTime::currentDateTime();
+        persistReading(entry.reading);
+        if (isBackgroundCity) scheduleNextRefresh(false);
+        emit weatherReady(entry.reading);
+        return;
+    }
+
+    if (reply->error() != QNetworkReply::NoError) {
+        countReply("error");
+        if (!entry.reading.isValid()) m_cache.remove(cityKey);
+        if (isBackgroundCity) scheduleNextRefresh(true);
+        emit weatherFailed(cityKey, reply->errorString());
+        return;
+    }
+
+    WeatherReading reading;
+    const QByteArray data = reply->readAll();
+    if (!parseReading(data, reading)) {
+        qDebug() << "无效的 JSON 响应：" << data;
+        countReply("invalid");
+        if (!entry.reading.isValid()) m_cache.remove(cityKey);
+        if (isBackgroundCity) scheduleNextRefresh(true);
+        emit weatherFailed(cityKey, "无法解析天气数据。");
+        return;
+    }
+
+    countReply("updated");
+    persistReading(reading);
+    if (isBackgroundCity) scheduleNextRefresh(false);
+    entry.reading = reading;
+    entry.expiresAt = QDateTime::currentDateTimeUtc().addSecs(m_ttlSeconds);
+    entry.etag = reply->rawHeader("ETag");
+    entry.lastModified = reply->rawHeader("Last-Modified");
+    emit weatherReady(reading);
+}
+
+bool WeatherService::parseReading(const QByteArray &data, WeatherReading &out) const
+{
+    const QJsonObject jsonObj = QJsonDocument::fromJson(data).object();
+    if (!jsonObj.contains("main") || !jsonObj.contains("weather") || !jsonObj.contains("name"))
+        return false;
+
+    const QJsonArray weatherArray = jsonObj["weather"].toArray();
+    if (weatherArray.isEmpty())
+        return false;
+    const QJsonObject weather = weatherArray.at(0).toObject();
+
+    out.city = jsonObj["name"].toString();
+    out.temperature = jsonObj["main"].toObject()["temp"].toDouble();
+    out.description = weather["description"].toString();
+    out.iconCode = weather["icon"].toString();
+    out.conditionId = weather["id"].toInt();
+    out.fetchedAt = QDateTime::currentDateTime();
+    return true;
+}
+
+QString WeatherService::iconDiskPath(const QString &iconCode) const
+{
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation)
+           + "/weather_icons/" + iconCode + "@2x.png";
+}
+
+QString WeatherService::pixmapKey(const QString &iconCode, const QSize &size)
+{
+    return QString("weather_icon_%1_%2x%3").arg(iconCode).arg(size.width()).arg(size.height());
+}
+
+void WeatherService::fetchIcon(const QString &iconCode, const QSize &size)
+{
+    if (iconCode.isEmpty()) return;
+
+    // 1. 已缩放好的图在内存缓存里
+    QPixmap scaled;
+    if (QPixmapCache::find(pixmapKey(iconCode, size), &scaled)) {
+        QTimer::singleShot(0, this, [this, iconCode, scaled]() { emit iconReady(iconCode, scaled); });
+        return;
+    }
+
+    // 2. 原图在磁盘缓存里
+    QPixmap source;
+    if (source.load(iconDiskPath(iconCode))) {
+        emitScaledIcon(iconCode, source, size);
+        return;
+    }
+
+    // 3. 下载；同一图标的多个请求只发一次
+    auto waiters = m_iconWaiters.find(iconCode);
+    if (waiters != m_iconWaiters.end()) {
+        if (!waiters->contains(size)) waiters->append(size);
+        return;
+    }
+    m_iconWaiters.insert(iconCode, {size});
+
+    QUrl url(m_iconBaseUrl.toString() + "/" + iconCode + "@2x.png");
+    QNetworkRequest request(url);
+    request.setAttribute(QNetworkRequest::CacheLoadControlAttribute, QNetworkRequest::PreferCache);
+    NetworkService::instance().get(request, this, [this, iconCode](QNetworkReply *reply) {
+        onIconReply(reply, iconCode);
+    });
+}
+
+void WeatherService::onIconReply(QNetworkReply *reply, const QString &iconCode)
+{
+    const QList<QSize> sizes = m_iconWaiters.take(iconCode);
+
+    if (reply->error() != QNetworkReply::NoError) {
+        qDebug() << "图标下载错误：" << reply->errorString();
+        return;
+    }
+
+    const QByteArray data = reply->readAll();
+    QPixmap source;
+    if (!source.loadFromData(data)) {
+        qDebug() << "无法从数据加载图标。";
+        return;
+    }
+
+    // 原始字节落盘，下次启动直接读取
+    const QString path = iconDiskPath(iconCode);
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    QFile file(path);
+    if (file.open(QIODevice::WriteOnly)) {
+        file.write(data);
+    }
+
+    for (const QSize &size : sizes) {
+        emitScaledIcon(iconCode, source, size);
+    }
+}
+
+void WeatherService::emitScaledIcon(const QString &iconCode, const QPixmap &source, const QSize &size)
+{
+    // 平滑缩放只做一次，结果放进 QPixmapCache
+    QPixmap scaled = source.scaled(size, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+    QPixmapCache::insert(pixmapKey(iconCode, size), scaled);
+    QTimer::singleShot(0, this, [this, iconCode, scaled]() { emit iconReady(iconCode, scaled); });
+}
+
+WeatherReading WeatherService::lastPersistedReading() const
+{
+    QSettings settings("MyCourseApp", "Weather");
+    WeatherReading reading;
+    reading.city = settings.value("last/city").toString();
+    reading.temperature = settings.value("last/temperature").toDouble();
+    reading.description = settings.value("last/description").toString();
+    reading.iconCode = settings.value("last/iconCode").toString();
+    reading.conditionId = settings.value("last/conditionId").toInt();
+    reading.fetchedAt = settings.value("last/fetchedAt").toDateTime();
+    if (reading.city.isEmpty()) return WeatherReading();
+    return reading;
+}
+
+void WeatherService::persistReading(const WeatherReading &reading)
+{
+    QSettings settings("MyCourseApp", "Weather");
+    settings.setValue("last/city", reading.city);
+    settings.setValue("last/temperature", reading.temperature);
+    settings.setValue("last/description", reading.description);
+    settings.setValue("last/iconCode", reading.iconCode);
+    settings.setValue("last/conditionId", reading.conditionId);
+    settings.setValue("last/fetchedAt", reading.fetchedAt);
+}
+
+void WeatherService::startBackgroundRefresh(const QString &city, int intervalSeconds)
+{
+    m_refreshCity = city.trimmed();
+    m_refreshIntervalSeconds = std::max(60, intervalSeconds);
+    m_failureCount = 0;
+    // 立即重新验证一次，之后按间隔刷新
+    onRefreshTimeout();
+}
+
+void WeatherService::stopBackgroundRefresh()
+{
+    m_refreshTimer->stop();
+    m_refreshCity.clear();
+}
+
+void WeatherService::setBackgroundCity(const QString &city)
+{
+    if (m_refreshCity.isEmpty() || city.trimmed().compare(m_refreshCity, Qt::CaseInsensitive) == 0)
+        return;
+    m_refreshCity = city.trimmed();
+    m_failureCount = 0;
+    scheduleNextRefresh(false);
+}
+
+bool WeatherService::isBackgroundRefreshActive() const
+{
+    return !m_refreshCity.isEmpty();
+}
+
+void WeatherService::onRefreshTimeout()
+{
+    if (m_refreshCity.isEmpty()) return;
+    emit revalidating(m_refreshCity);
+    // 无视 TTL，但条件请求让没变化的数据只花一个 304
+    fetchWeather(m_refreshCity, true);
+}
+
+void WeatherService::scheduleNextRefresh(bool lastFailed)
+{
+    if (m_refreshCity.isEmpty()) return;
+
+    int seconds = m_refreshIntervalSeconds;
+    if (lastFailed) {
+        ++m_failureCount;
+        const int exponent = std::min(m_failureCount - 1, 16);
+        seconds = std::min(m_refreshIntervalSeconds, INITIAL_BACKOFF_SECONDS << exponent);
+    } else {
+        m_failureCount = 0;
+    }
+
+    const double jitter = 1.0 + REFRESH_JITTER * (2.0 * QRandomGenerator::global()->generateDouble() - 1.0);
+    m_refreshTimer->start(static_cast<int>(seconds * jitter * 1000));
+}
@@ -0,0 +1,99 @@
+#ifndef WEATHERSERVICE_H
+#define WEATHERSERVICE_H
+
+#include <QObject>
+#include <QHash>
+#include <QSet>
+#include <QList>
+#include <QSize>
+#include <QUrl>
+#include <QDateTime>
+#include <QPixmap>
+
+class QNetworkReply;
+class QTimer;
+
+// 一次天气查询的结果
+struct WeatherReading {
+    QString city;
+    double temperature = 0.0;
+    QString description;  // OpenWeatherMap 的英文描述
+    QString iconCode;
+    int conditionId = 0;  // weather[0].id
+    QDateTime fetchedAt;
+
+    bool isValid() const { return fetchedAt.isValid(); }
+};
+
+// 天气服务层：按城市缓存结果（TTL 内不再请求）、合并同一城市的并发请求、
+// 过期后带 ETag/Last-Modified 做条件请求；图标落盘缓存，缩放后的图放进 QPixmapCache。
+// 请求都走共享的 NetworkService。基础 URL 可配置，便于对本地 mock 服务测试。
+class WeatherService : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit WeatherService(const QString &apiKey, QObject *parent = nullptr);
+
+    void setBaseUrl(const QUrl &url) { m_baseUrl = url; }
+    QUrl baseUrl() const { return m_baseUrl; }
+    void setIconBaseUrl(const QUrl &url) { m_iconBaseUrl = url; }
+    void setCacheTtl(int seconds) { m_ttlSeconds = seconds; }
+
+    // forceRefresh 为 true 时忽略 TTL，但仍会发条件请求
+    void fetchWeather(const QString &city, bool forceRefresh = false);
+    bool cachedReading(const QString &city, WeatherReading &out) const;
+    // 结果通过 iconReady 返回，已缩放到 size
+    void fetchIcon(const QString &iconCode, const QSize &size);
+
+    // 上次成功获取并持久化的天气，启动时先用它填充界面
+    WeatherReading lastPersistedReading() const;
+
+    // 后台定时刷新：间隔带随机抖动，失败时指数退避
+    void startBackgroundRefresh(const QString &city, int intervalSeconds);
+    void stopBackgroundRefresh();
+    // 切换后台刷新的城市，从现在起重新计时，不立即请求
+    void setBackgroundCity(const QString &city);
+    bool isBackgroundRefreshActive() const;
+    QString backgroundCity() const { return m_refreshCity; }
+
+signals:
+    void weatherReady(const WeatherReading &reading);
+    void weatherFailed(const QString &city, const QString &error);
+    void iconReady(const QString &iconCode, const QPixmap &pixmap);
+    void revalidating(const QString &city); // 后台开始重新验证，界面保持旧数据
+
+private:
+    struct CacheEntry {
+        WeatherReading reading;
+        QDateTime expiresAt;
+        QByteArray etag;
+        QByteArray lastModified;
+    };
+
+    void onWeatherReply(QNetworkReply *reply, const QString &cityKey);
+    void onIconReply(QNetworkReply *reply, const QString &iconCode);
+    bool parseReading(const QByteArray &data, WeatherReading &out) const;
+    QString iconDiskPath(const QString &iconCode) const;
+    static QString pixmapKey(const QString &iconCode, const QSize &size);
+    void emitScaledIcon(const QString &iconCode, const QPixmap &source, const QSize &size);
+    void persistReading(const WeatherReading &reading);
+    void scheduleNextRefresh(bool lastFailed);
+    void onRefreshTimeout();
+
+    QString m_apiKey;
+    QUrl m_baseUrl;
+    QUrl m_iconBaseUrl;
+    int m_ttlSeconds = 10 * 60;
+
+    QHash<QString, CacheEntry> m_cache;               // 小写城市名 -> 缓存
+    QSet<QString> m_inFlight;                         // 正在请求的城市，重复请求直接合并
+    QHash<QString, QList<QSize>> m_iconWaiters;       // 正在下载的图标及等待的尺寸
+
+    QTimer *m_refreshTimer;
+    QString m_refreshCity;
+    int m_refreshIntervalSeconds = 30 * 60;
+    int m_failureCount = 0;                           // 连续失败次数，用于退避
+};
+
+#endif // WEATHERSERVICE_H
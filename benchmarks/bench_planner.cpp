@@ -0,0 +1,539 @@
+// 规划器核心的基准测试。数据集按固定种子合成，同一版本多次运行结果可比；
+// 每个用例都有 1k / 100k / 1M 三档数据（PLANNER_BENCH_MAX_ROWS 可限制上限）。
+// 默认只依赖 plannercore，定义 PLANNER_WIDGET_BENCH 时再加上界面相关的用例。
+#include "DatabaseManager.h"
+#include "FreeRoomModel.h"
+#include "ScheduleModel.h"
+#include "TaskTransfer.h"
+#include <QCoreApplication>
+#include <QFile>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRandomGenerator>
+#include <QSqlQuery>
+#include <QStandardPaths>
+#include <QTemporaryDir>
+#include <QtTest>
+#ifdef PLANNER_WIDGET_BENCH
+#include "CourseScheduleWindow.h"
+#include "TypewriterLabel.h"
+#include <QApplication>
+#include <QElapsedTimer>
+#ifdef Q_OS_WIN
+#include <windows.h>
+#else
+#include <ctime>
+#endif
+#endif
+
+namespace {
+
+constexpr quint32 SEED = 20240601;
+const QDate BASE_DATE(2024, 9, 1);
+
+const QStringList BUILDINGS = {"一教", "二教", "三教", "四教", "理教", "文史", "地学"};
+const QStringList WORDS = {"高等数学", "线性代数", "作业", "复习", "组会", "实验报告",
+                           "期中考试", "阅读", "讨论班", "体育", "英语听力", "程序设计"};
+
+qint64 maxRows()
+{
+    bool ok = false;
+    const qint64 value = qEnvironmentVariableIntValue("PLANNER_BENCH_MAX_ROWS", &ok);
+    return ok && value > 0 ? value : 1000000;
+}
+
+QString sizeLabel(int rows)
+{
+    return rows >= 1000000 ? QString("%1M").arg(rows / 1000000) : QString("%1k").arg(rows / 1000);
+}
+
+void addSizeRows()
+{
+    QTest::addColumn<int>("rows");
+    for (int rows : {1000, 100000, 1000000}) {
+        if (rows > maxRows()) continue;
+        QTest::newRow(qPrintable(sizeLabel(rows))) << rows;
+    }
+}
+
+QString randomTitle(QRandomGenerator &rng)
+{
+    return WORDS.at(rng.bounded(WORDS.size())) + " " + WORDS.at(rng.bounded(WORDS.size()));
+}
+
+// 课表 JSON：与 scraper.py 输出的结构相同
+QByteArray scheduleJson(int courses)
+{
+    QRandomGenerator rng(SEED);
+    QJsonArray array;
+    for (int i = 0; i < courses; ++i) {
+        array.append(QJsonObject{
+            {"name", randomTitle(rng)},
+            {"classroom", BUILDINGS.at(rng.bounded(BUILDINGS.size())) + QString::number(100 + rng.bounded(400))},
+            {"teacher", QString("教师%1").arg(rng.bounded(500))},
+            {"day", 1 + rng.bounded(7)},
+            {"start_period", 1 + rng.bounded(12)},
+            {"periods", 1 + rng.bounded(3)},
+            {"color", QString("#%1").arg(rng.bounded(0x1000000), 6, 16, QChar('0'))},
+        });
+    }
+    return QJsonDocument(array).toJson(QJsonDocument::Compact);
+}
+
+// 门户接口返回的 rows：每行一间教室，c1..c12 为空字符串表示该节空闲
+QJsonArray freeRoomRows(int rooms)
+{
+    QRandomGenerator rng(SEED);
+    const QStringList dates = {"2024-09-01", "2024-09-02", "2024-09-03"};
+    QJsonArray rows;
+    for (int i = 0; i < rooms; ++i) {
+        QJsonObject row{{"room", QString("%1%2").arg(BUILDINGS.at(i % BUILDINGS.size())).arg(i)},
+                        {"cap", 60 + rng.bounded(200)},
+                        {"date", dates.at(rng.bounded(dates.size()))}};
+        for (int period = 1; period <= 12; ++period) {
+            row.insert(QString("c%1").arg(period), rng.bounded(2) ? QString() : QString("占用"));
+        }
+        rows.append(row);
+    }
+    return rows;
+}
+
+} // namespace
+
+class PlannerBenchmark : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void addDailyTask_data() { addSizeRows(); }
+    void addDailyTask();
+    void getTasksForDate_data() { addSizeRows(); }
+    void getTasksForDate();
+    void getDatesWithTasksBetween_data() { addSizeRows(); }
+    void getDatesWithTasksBetween();
+    void updateTaskById_data() { addSizeRows(); }
+    void updateTaskById();
+    void deleteTaskById_data() { addSizeRows(); }
+    void deleteTaskById();
+    void searchTasks_data() { addSizeRows(); }
+    void searchTasks();
+    void searchTasksShort_data();
+    void searchTasksShort();
+    void getDailyStudyDurations_data() { addSizeRows(); }
+    void getDailyStudyDurations();
+
+    // 重复规则按月展开 vs. 同样数量的实例直接存成行
+    void occurrencesFromRules_data() { addSizeRows(); }
+    void occurrencesFromRules();
+    void occurrencesMaterialized_data() { addSizeRows(); }
+    void occurrencesMaterialized();
+
+    // iCalendar 流式导出，以及把导出结果批量导入一个空库
+    void exportICalendar_data() { addSizeRows(); }
+    void exportICalendar();
+    void importICalendar_data() { addSizeRows(); }
+    void importICalendar();
+
+    void parseSchedule_data() { addSizeRows(); }
+    void parseSchedule();
+    void freeRoomGroupRows_data() { addSizeRows(); }
+    void freeRoomGroupRows();
+    void freeRoomEntries_data() { addSizeRows(); }
+    void freeRoomEntries();
+
+#ifdef PLANNER_WIDGET_BENCH
+    void populateTable_data() { addSizeRows(); }
+    void populateTable();
+    void typewriterTick();
+    void typewriterIdleCpu_data();
+    void typewriterIdleCpu();
+#endif
+
+private:
+    void useDataset(int rows);
+    void useScratchCopy(int rows);
+    void seed(const QString &path, int rows);
+
+    QTemporaryDir m_dir;
+    QHash<int, QString> m_datasets;
+};
+
+void PlannerBenchmark::initTestCase()
+{
+    QVERIFY(m_dir.isValid());
+    QStandardPaths::setTestModeEnabled(true);
+}
+
+// 每档数据只生成一次，之后的用例直接打开同一个文件
+void PlannerBenchmark::useDataset(int rows)
+{
+    QString path = m_datasets.value(rows);
+    if (path.isEmpty()) {
+        path = m_dir.filePath(QString("bench_%1.db").arg(rows));
+        seed(path, rows);
+        m_datasets.insert(rows, path);
+    }
+    QVERIFY(DatabaseManager::instance().init(path));
+}
+
+// 会改动数据的用例在一份副本上跑，共用的数据集保持原样，后面的查询用例结果才可比
+void PlannerBenchmark::useScratchCopy(int rows)
+{
+    useDataset(rows);
+    const QString path = m_dir.filePath("scratch.db");
+    QFile::remove(path);
+    QSqlQuery query(QSqlDatabase::database());
+    QVERIFY2(query.exec(QString("VACUUM INTO '%1'").arg(QString(path).replace("'", "''"))),
+             qPrintable(query.lastError().text()));
+    query.finish();
+    QVERIFY(DatabaseManager::instance().init(path));
+}
+
+void PlannerBenchmark::seed(const QString &path, int rows)
+{
+    QVERIFY(DatabaseManager::instance().init(path));
+    QSqlDatabase db = QSqlDatabase::database();
+    QRandomGenerator rng(SEED);
+
+    QVERIFY(db.transaction());
+    QSqlQuery query(db);
+    query.prepare("INSERT INTO tasks (date, title, start_time, end_time, note) VALUES (?, ?, ?, ?, ?)");
+    for (int i = 0; i < rows; ++i) {
+        const QTime start(8 + rng.bounded(12), rng.bounded(4) * 15);
+        query.addBindValue(BASE_DATE.addDays(rng.bounded(730)).toString(Qt::ISODate));
+        query.addBindValue(randomTitle(rng));
+        query.addBindValue(start.toString("HH:mm"));
+        query.addBindValue(start.addSecs(3600).toString("HH:mm"));
+        query.addBindValue(rng.bounded(4) ? QString() : randomTitle(rng));
+        QVERIFY2(query.exec(), qPrintable(query.lastError().text()));
+    }
+
+    query.prepare("INSERT INTO study_sessions (start_time, end_time, duration_seconds, tag) VALUES (?, ?, ?, ?)");
+    for (int i = 0; i < rows; ++i) {
+        const QDateTime start(BASE_DATE.addDays(rng.bounded(730)), QTime(8 + rng.bounded(12), 0));
+        const int seconds = 600 + rng.bounded(7200);
+        query.addBindValue(start.toString(Qt::ISODate));
+        query.addBindValue(start.addSecs(seconds).toString(Qt::ISODate));
+        query.addBindValue(seconds);
+        query.addBindValue(WORDS.at(rng.bounded(WORDS.size())));
+        QVERIFY2(query.exec(), qPrintable(query.lastError().text()));
+    }
+    QVERIFY(db.commit());
+    query.exec("ANALYZE"); // 数据写完后更新查询规划用的统计信息
+}
+
+void PlannerBenchmark::addDailyTask()
+{
+    QFETCH(int, rows);
+    useScratchCopy(rows);
+    DatabaseManager &db = DatabaseManager::instance();
+    QBENCHMARK {
+        DailyTask task("基准测试", QTime(9, 0), QTime(10, 0), "bench");
+        db.addDailyTask(BASE_DATE, task);
+    }
+}
+
+void PlannerBenchmark::getTasksForDate()
+{
+    QFETCH(int, rows);
+    useDataset(rows);
+    DatabaseManager &db = DatabaseManager::instance();
+    QRandomGenerator rng(SEED);
+    QBENCHMARK {
+        const QList<DailyTask> tasks = db.getTasksForDate(BASE_DATE.addDays(rng.bounded(730)));
+        Q_UNUSED(tasks);
+    }
+}
+
+void PlannerBenchmark::getDatesWithTasksBetween()
+{
+    QFETCH(int, rows);
+    useDataset(rows);
+    DatabaseManager &db = DatabaseManager::instance();
+    QBENCHMARK {
+        // 一页日历：本月前后各多一周
+        const QList<QDate> dates = db.getDatesWithTasksBetween(BASE_DATE.addDays(-7), BASE_DATE.addDays(44));
+        Q_UNUSED(dates);
+    }
+}
+
+void PlannerBenchmark::updateTaskById()
+{
+    QFETCH(int, rows);
+    useScratchCopy(rows);
+    DatabaseManager &db = DatabaseManager::instance();
+    QRandomGenerator rng(SEED);
+    QBENCHMARK {
+        const int id = 1 + rng.bounded(rows);
+        db.updateTaskById(id, DailyTask("已修改", QTime(14, 0), QTime(15, 0), QString(), id));
+    }
+}
+
+void PlannerBenchmark::deleteTaskById()
+{
+    QFETCH(int, rows);
+    useScratchCopy(rows);
+    DatabaseManager &db = DatabaseManager::instance();
+    // 从末尾往前删，迭代次数超过行数后删除的是不存在的 id，只剩查找开销
+    int id = rows;
+    QBENCHMARK {
+        db.deleteTaskById(id > 0 ? id-- : 0);
+    }
+}
+
+void PlannerBenchmark::searchTasks()
+{
+    QFETCH(int, rows);
+    useDataset(rows);
+    DatabaseManager &db = DatabaseManager::instance();
+    QBENCHMARK {
+        const QList<DatedTask> results = db.searchTasks("实验报告", 50);
+        Q_UNUSED(results);
+    }
+}
+
+// 一两个字的词 trigram 匹配不到，按日期索引做 LIKE 扫描
+void PlannerBenchmark::searchTasksShort_data()
+{
+    QTest::addColumn<int>("rows");
+    QTest::addColumn<QString>("text");
+    for (int rows : {1000, 100000, 1000000}) {
+        if (rows > maxRows()) continue;
+        for (const QString &text : {QString("实验"), QString("数"), QString("作业 复")}) {
+            QTest::newRow(qPrintable(sizeLabel(rows) + "/" + text)) << rows << text;
+        }
+    }
+}
+
+void PlannerBenchmark::searchTasksShort()
+{
+    QFETCH(int, rows);
+    QFETCH(QString, text);
+    useDataset(rows);
+    DatabaseManager &db = DatabaseManager::instance();
+    QBENCHMARK {
+        const QList<DatedTask> results = db.searchTasks(text, 50);
+        Q_UNUSED(results);
+    }
+}
+
+void PlannerBenchmark::getDailyStudyDurations()
+{
+    QFETCH(int, rows);
+    useDataset(rows);
+    DatabaseManager &db = DatabaseManager::instance();
+    QBENCHMARK {
+        const QMap<QDate, int> totals = db.getDailyStudyDurations();
+        Q_UNUSED(totals);
+    }
+}
+
+void PlannerBenchmark::occurrencesFromRules()
+{
+    QFETCH(int, rows);
+    // 每条规则每天重复，rows / 730 条规则在两年里展开出约 rows 个实例
+    const QString path = m_dir.filePath(QString("rules_%1.db").arg(rows));
+    DatabaseManager &db = DatabaseManager::instance();
+    QVERIFY(db.init(path));
+    QSqlDatabase::database().transaction();
+    for (int i = 0; i < qMax(1, rows / 730); ++i) {
+        DailyTask task(QString("重复 %1").arg(i), QTime(8 + i % 12, 0), QTime(9 + i % 12, 0));
+        QVERIFY(db.addTaskRule(task, RecurrenceRule(RecurrenceRule::Daily, 1, BASE_DATE)));
+    }
+    QSqlDatabase::database().commit();
+    QVERIFY(db.init(path)); // 清掉按月缓存，第一次迭代包含展开开销
+
+    QBENCHMARK {
+        const QList<DatedTask> occurrences = db.getOccurrencesBetween(BASE_DATE, BASE_DATE.addDays(729));
+        Q_UNUSED(occurrences);
+    }
+}
+
+void PlannerBenchmark::occurrencesMaterialized()
+{
+    QFETCH(int, rows);
+    useDataset(rows);
+    DatabaseManager &db = DatabaseManager::instance();
+    QBENCHMARK {
+        const QList<DatedTask> tasks = db.getTasksBetween(BASE_DATE, BASE_DATE.addDays(729));
+        Q_UNUSED(tasks);
+    }
+}
+
+void PlannerBenchmark::exportICalendar()
+{
+    QFETCH(int, rows);
+    useDataset(rows);
+    QBENCHMARK {
+        QFile out(m_dir.filePath("export.ics"));
+        QVERIFY(out.open(QIODevice::WriteOnly | QIODevice::Truncate));
+        QVERIFY(TaskTransfer::exportTasks(&out, TaskTransfer::ICalendar));
+    }
+}
+
+void PlannerBenchmark::importICalendar()
+{
+    QFETCH(int, rows);
+    useDataset(rows);
+    const QString ics = m_dir.filePath(QString("import_%1.ics").arg(rows));
+    {
+        QFile out(ics);
+        QVERIFY(out.open(QIODevice::WriteOnly | QIODevice::Truncate));
+        QVERIFY(TaskTransfer::exportTasks(&out, TaskTransfer::ICalendar));
+    }
+    int run = 0;
+    QBENCHMARK {
+        QVERIFY(DatabaseManager::instance().init(m_dir.filePath(QString("import_%1_%2.db").arg(rows).arg(run++))));
+        QFile in(ics);
+        QVERIFY(in.open(QIODevice::ReadOnly));
+        TaskTransfer::Stats stats;
+        QVERIFY(TaskTransfer::importTasks(&in, TaskTransfer::ICalendar, 1000, &stats));
+        QCOMPARE(stats.records, qint64(rows));
+    }
+}
+
+void PlannerBenchmark::parseSchedule()
+{
+    QFETCH(int, rows);
+    const QByteArray json = scheduleJson(rows);
+    QBENCHMARK {
+        QList<CourseEntry> courses;
+        ScheduleModel::parse(json, courses);
+    }
+}
+
+void PlannerBenchmark::freeRoomGroupRows()
+{
+    QFETCH(int, rows);
+    const QJsonArray data = freeRoomRows(rows);
+    QBENCHMARK {
+        const QJsonObject grouped = FreeRoomModel::groupRows("理教", data);
+        Q_UNUSED(grouped);
+    }
+}
+
+void PlannerBenchmark::freeRoomEntries()
+{
+    QFETCH(int, rows);
+    const QJsonObject grouped = FreeRoomModel::groupRows("理教", freeRoomRows(rows));
+    QBENCHMARK {
+        const QList<FreeRoomModel::Entry> entries = FreeRoomModel::entries(grouped, "理教", {3, 4});
+        Q_UNUSED(entries);
+    }
+}
+
+#ifdef PLANNER_WIDGET_BENCH
+void PlannerBenchmark::populateTable()
+{
+    QFETCH(int, rows);
+    const QByteArray json = scheduleJson(rows);
+    CourseScheduleWindow window;
+    QBENCHMARK {
+        window.populateTable(json);
+    }
+}
+
+// 打字机每个节拍的开销：推进一个字符并完成对应的局部重绘
+void PlannerBenchmark::typewriterTick()
+{
+    TypewriterLabel label;
+    label.resize(600, 48);
+    label.setPhrases({"You are filled with the power of determination."});
+    label.show();
+    QVERIFY(QTest::qWaitForWindowExposed(&label));
+    label.start();
+
+    QBENCHMARK {
+        QMetaObject::invokeMethod(&label, "onTick");
+        QCoreApplication::sendPostedEvents(&label, QEvent::UpdateRequest);
+        QCoreApplication::sendPostedEvents(label.window(), QEvent::UpdateRequest);
+    }
+}
+
+namespace {
+
+// 本进程（所有线程）累计消耗的 CPU 时间，纳秒
+qint64 processCpuNs()
+{
+#ifdef Q_OS_WIN
+    FILETIME creation, exited, kernel, user;
+    if (!GetProcessTimes(GetCurrentProcess(), &creation, &exited, &kernel, &user)) return 0;
+    auto ticks = [](const FILETIME &time) {
+        return (qint64(time.dwHighDateTime) << 32) | time.dwLowDateTime;
+    };
+    return (ticks(kernel) + ticks(user)) * 100; // FILETIME 的单位是 100 ns
+#else
+    timespec now {};
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &now);
+    return qint64(now.tv_sec) * 1000000000 + now.tv_nsec;
+#endif
+}
+
+} // namespace
+
+void PlannerBenchmark::typewriterIdleCpu_data()
+{
+    QTest::addColumn<QString>("state");
+    QTest::newRow("visible") << "visible";
+    QTest::newRow("hidden") << "hidden";
+    QTest::newRow("minimized") << "minimized";
+}
+
+// 打字机在空闲的事件循环里每秒消耗的进程 CPU 时间（纳秒）。窗口隐藏或最小化时计时器应停下，
+// 数值应接近零；可见时是打字本身的开销。时长取 PLANNER_BENCH_IDLE_SECONDS（默认 5 秒）
+void PlannerBenchmark::typewriterIdleCpu()
+{
+    QFETCH(QString, state);
+    const int seconds = qEnvironmentVariableIsSet("PLANNER_BENCH_IDLE_SECONDS")
+                            ? qMax(1, qEnvironmentVariableIntValue("PLANNER_BENCH_IDLE_SECONDS"))
+                            : 5;
+
+    TypewriterLabel label;
+    label.resize(600, 48);
+    label.setPhrases({"You are filled with the power of determination."});
+    label.show();
+    QVERIFY(QTest::qWaitForWindowExposed(&label));
+    label.start();
+    if (state == "hidden") {
+        label.hide();
+    } else if (state == "minimized") {
+        label.showMinimized();
+    }
+    if (state == "visible") {
+        QVERIFY(!label.isPaused());
+    } else {
+        QTRY_VERIFY(label.isPaused());
+    }
+    // 状态切换引起的重绘先处理掉
+    QTest::qWait(200);
+
+    QElapsedTimer wall;
+    wall.start();
+    const qint64 before = processCpuNs();
+    QTest::qWait(seconds * 1000);
+    const qint64 cpu = processCpuNs() - before;
+    // QTest 没有 CPU 时间的单位，和 perf 后端的 task-clock 一样记作纳秒
+    QTest::setBenchmarkResult(cpu * 1000.0 / qMax<qint64>(1, wall.elapsed()), QTest::WalltimeNanoseconds);
+}
+#endif
+
+int main(int argc, char *argv[])
+{
+#ifdef PLANNER_WIDGET_BENCH
+    // 没有显示器时也能跑界面相关的用例
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    QApplication app(argc, argv);
+#else
+    QCoreApplication app(argc, argv);
+#endif
+    PlannerBenchmark benchmark;
+    return QTest::qExec(&benchmark, argc, argv);
+}
+
+#include "bench_planner.moc"
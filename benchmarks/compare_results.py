@@ -0,0 +1,53 @@
+# -*- coding: utf-8 -*-
+"""比较两次 planner_bench 的 XML 结果（./planner_bench -o results.xml,xml）。
+
+用法: python compare_results.py baseline.xml current.xml [--threshold 10]
+任何用例比基线慢超过阈值（百分比）时以非零状态退出，便于在脚本里发现性能回退。
+"""
+import argparse
+import sys
+import xml.etree.ElementTree as ET
+
+
+def load(path):
+    results = {}
+    for function in ET.parse(path).getroot().iter("TestFunction"):
+        for bench in function.iter("BenchmarkResult"):
+            key = (function.get("name"), bench.get("tag") or "", bench.get("metric"))
+            # QTest 输出的 value 已经是每次迭代的平均值，iterations 只是参考
+            results[key] = float(bench.get("value"))
+    return results
+
+
+def main():
+    parser = argparse.ArgumentParser(description="比较两次基准测试结果")
+    parser.add_argument("baseline")
+    parser.add_argument("current")
+    parser.add_argument("--threshold", type=float, default=10.0, help="允许变慢的百分比")
+    args = parser.parse_args()
+
+    baseline = load(args.baseline)
+    current = load(args.current)
+    regressions = 0
+    print("%-32s %-6s %14s %14s %8s" % ("用例", "数据", "基线", "当前", "变化"))
+    for key in sorted(current):
+        name, tag, metric = key
+        now = current[key]
+        before = baseline.get(key)
+        if before is None:
+            print("%-32s %-6s %14s %14.4f %8s" % (name, tag, "-", now, "新增"))
+            continue
+        change = (now - before) / before * 100 if before else 0.0
+        flag = ""
+        if change > args.threshold:
+            regressions += 1
+            flag = "  <-- 变慢"
+        print("%-32s %-6s %14.4f %14.4f %+7.1f%%%s" % (name, tag, before, now, change, flag))
+
+    if regressions:
+        print("\n%d 个用例超过 %.0f%% 阈值" % (regressions, args.threshold))
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
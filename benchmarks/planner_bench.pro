@@ -0,0 +1,37 @@
+# 规划器核心的基准测试（QTest QBENCHMARK），随顶层 planner.pro 一起构建，或者在构建好 plannercore 之后单独构建：
+#   qmake planner_bench.pro && make
+#   ./planner_bench -o results.xml,xml          # 机器可读结果，供 compare_results.py 比较
+#   ./planner_bench -o results.csv,csv
+#   PLANNER_BENCH_MAX_ROWS=100000 ./planner_bench   # 跳过 1M 行的数据集
+# 默认只链接规划器核心（plannercore.pri），在纯 QtCore 进程里运行；
+# qmake "CONFIG+=widget_bench" 额外编译课表表格填充、打字机重绘和打字机空闲 CPU 三个界面用例；
+#   PLANNER_BENCH_IDLE_SECONDS=10 ./planner_bench typewriterIdleCpu   # 空闲测量的时长，默认 5 秒
+QT = core testlib
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+TARGET = planner_bench
+
+include(../plannercore.pri)
+
+SOURCES += \
+    bench_planner.cpp
+
+widget_bench {
+    QT += gui widgets
+    DEFINES += PLANNER_WIDGET_BENCH
+
+    SOURCES += \
+        ../CourseScheduleWindow.cpp \
+        ../TypewriterLabel.cpp \
+        ../smartroomwidget.cpp
+
+    HEADERS += \
+        ../CourseScheduleWindow.h \
+        ../TypewriterLabel.h \
+        ../smartroomwidget.h
+}
+
+DISTFILES += \
+    compare_results.py
@@ -0,0 +1,264 @@
+// 本地 JSON-RPC 服务的压测客户端。每个连接保持 depth 个在途请求（流水线），
+// 每行可以打包 batch 个请求；按方法统计客户端看到的往返延迟，最后附上服务端的 server.stats。
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLocalSocket>
+#include <QRandomGenerator>
+#include <QTextStream>
+#include <algorithm>
+#include <functional>
+
+namespace {
+
+struct MethodWeight {
+    QString method;
+    int weight = 1;
+};
+
+struct Latencies {
+    QList<qint64> micros;
+    qint64 errors = 0;
+};
+
+QTextStream &out()
+{
+    static QTextStream stream(stdout);
+    return stream;
+}
+
+// "ping=1,tasks.add=2" 这样的权重表
+QList<MethodWeight> parseMix(const QString &text)
+{
+    QList<MethodWeight> mix;
+    for (const QString &part : text.split(',', Qt::SkipEmptyParts)) {
+        MethodWeight item;
+        item.method = part.section('=', 0, 0).trimmed();
+        item.weight = qMax(0, part.section('=', 1).toInt());
+        if (!item.method.isEmpty() && item.weight > 0) mix.append(item);
+    }
+    return mix;
+}
+
+QJsonObject paramsFor(const QString &method, QRandomGenerator &rng)
+{
+    const QDate base(2030, 1, 1); // 远离真实数据的日期
+    if (method == "tasks.add") {
+        const QTime start(8 + rng.bounded(12), rng.bounded(4) * 15);
+        return QJsonObject{{"date", base.addDays(rng.bounded(365)).toString(Qt::ISODate)},
+                           {"title", QString("loadtest %1").arg(rng.bounded(100000))},
+                           {"start_time", start.toString("HH:mm")},
+                           {"end_time", start.addSecs(3600).toString("HH:mm")}};
+    }
+    if (method == "tasks.list") {
+        const QDate from = base.addDays(rng.bounded(358));
+        return QJsonObject{{"from", from.toString(Qt::ISODate)}, {"to", from.addDays(6).toString(Qt::ISODate)}};
+    }
+    if (method == "tasks.search") {
+        return QJsonObject{{"text", "loadtest"}, {"limit", 20}};
+    }
+    if (method == "study.totals") {
+        return QJsonObject{{"by", rng.bounded(2) ? "day" : "tag"}};
+    }
+    return QJsonObject();
+}
+
+class Worker : public QObject
+{
+public:
+    Worker(int index, const QString &server, const QList<MethodWeight> &mix,
+           int requests, int depth, int batch, QHash<QString, Latencies> &results)
+        : m_server(server), m_mix(mix), m_remaining(requests), m_depth(depth), m_batch(batch),
+          m_results(results), m_rng(20240601u + index)
+    {
+        for (const MethodWeight &item : m_mix) m_totalWeight += item.weight;
+        m_clock.start();
+        connect(&m_socket, &QLocalSocket::connected, this, [this] { fill(); });
+        connect(&m_socket, &QLocalSocket::readyRead, this, [this] { onReadyRead(); });
+        connect(&m_socket, &QLocalSocket::errorOccurred, this, [this] {
+            out() << "连接错误：" << m_socket.errorString() << Qt::endl;
+            finish();
+        });
+    }
+
+    void start(std::function<void()> done)
+    {
+        m_done = std::move(done);
+        m_socket.connectToServer(m_server);
+    }
+
+private:
+    QString pickMethod()
+    {
+        int roll = m_rng.bounded(m_totalWeight);
+        for (const MethodWeight &item : m_mix) {
+            if ((roll -= item.weight) < 0) return item.method;
+        }
+        return m_mix.constLast().method;
+    }
+
+    // 在途请求不足 depth 时继续发，一行打包最多 batch 个
+    void fill()
+    {
+        QByteArray chunk;
+        while (m_remaining > 0 && m_inFlight.size() + m_batch <= qMax(m_depth, m_batch)) {
+            QJsonArray batch;
+            const int count = qMin(m_batch, m_remaining);
+            for (int i = 0; i < count; ++i) {
+                const QString method = pickMethod();
+                const qint64 id = ++m_nextId;
+                m_inFlight.insert(id, {method, m_clock.nsecsElapsed()});
+                batch.append(QJsonObject{{"jsonrpc", "2.0"}, {"id", id}, {"method", method},
+                                         {"params", paramsFor(method, m_rng)}});
+            }
+            m_remaining -= count;
+            chunk += (m_batch == 1 ? QJsonDocument(batch.first().toObject()).toJson(QJsonDocument::Compact)
+                                   : QJsonDocument(batch).toJson(QJsonDocument::Compact)) + '\n';
+        }
+        if (!chunk.isEmpty()) m_socket.write(chunk);
+    }
+
+    void onReadyRead()
+    {
+        const qint64 now = m_clock.nsecsElapsed();
+        while (m_socket.canReadLine()) {
+            const QJsonDocument doc = QJsonDocument::fromJson(m_socket.readLine());
+            const QJsonArray responses = doc.isArray() ? doc.array() : QJsonArray{doc.object()};
+            for (const QJsonValue &value : responses) {
+                const QJsonObject response = value.toObject();
+                const auto pending = m_inFlight.take(response.value("id").toInteger());
+                if (pending.first.isEmpty()) continue;
+                Latencies &latencies = m_results[pending.first];
+                latencies.micros.append((now - pending.second) / 1000);
+                if (response.contains("error")) ++latencies.errors;
+            }
+        }
+        if (m_remaining == 0 && m_inFlight.isEmpty()) {
+            finish();
+        } else {
+            fill();
+        }
+    }
+
+    void finish()
+    {
+        if (!m_done) return;
+        m_socket.disconnectFromServer();
+        auto done = std::move(m_done);
+        m_done = nullptr;
+        done();
+    }
+
+    QLocalSocket m_socket;
+    QString m_server;
+    QList<MethodWeight> m_mix;
+    int m_totalWeight = 0;
+    int m_remaining;
+    int m_depth;
+    int m_batch;
+    qint64 m_nextId = 0;
+    QHash<qint64, QPair<QString, qint64>> m_inFlight; // id -> (方法, 发送时刻 ns)
+    QHash<QString, Latencies> &m_results;
+    QRandomGenerator m_rng;
+    QElapsedTimer m_clock;
+    std::function<void()> m_done;
+};
+
+qint64 percentile(const QList<qint64> &sorted, double fraction)
+{
+    if (sorted.isEmpty()) return 0;
+    const qsizetype index = qMin(sorted.size() - 1, qsizetype(fraction * sorted.size()));
+    return sorted.at(index);
+}
+
+// 压测结束后单独连一次，取服务端统计
+void printServerStats(const QString &server)
+{
+    QLocalSocket socket;
+    socket.connectToServer(server);
+    if (!socket.waitForConnected(2000)) return;
+    socket.write(R"({"jsonrpc":"2.0","id":1,"method":"server.stats"})" "\n");
+    while (!socket.canReadLine() && socket.waitForReadyRead(2000)) {}
+    const QJsonObject stats = QJsonDocument::fromJson(socket.readLine()).object().value("result").toObject();
+    out() << "\n服务端统计（微秒）：\n" << QJsonDocument(stats).toJson(QJsonDocument::Indented);
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("本地 JSON-RPC 服务压测");
+    parser.addHelpOption();
+    parser.addOptions({
+        {"name", "服务端套接字名", "name", "planner-rpc"},
+        {"connections", "并发连接数", "n", "4"},
+        {"requests", "每个连接发送的请求数", "n", "10000"},
+        {"depth", "每个连接的在途请求上限（流水线深度）", "n", "32"},
+        {"batch", "每行打包的请求数，1 表示不用批量", "n", "1"},
+        {"mix", "方法及权重", "list", "ping=1,tasks.add=2,tasks.list=4,tasks.search=1,study.totals=1"},
+    });
+    parser.process(app);
+
+    const QString server = parser.value("name");
+    const int connections = qMax(1, parser.value("connections").toInt());
+    const int requests = qMax(1, parser.value("requests").toInt());
+    const int depth = qMax(1, parser.value("depth").toInt());
+    const int batch = qMax(1, parser.value("batch").toInt());
+    const QList<MethodWeight> mix = parseMix(parser.value("mix"));
+    if (mix.isEmpty()) {
+        out() << "--mix 为空" << Qt::endl;
+        return 2;
+    }
+
+    QList<QHash<QString, Latencies>> results(connections);
+    QList<Worker *> workers;
+    int running = connections;
+    QElapsedTimer wall;
+    wall.start();
+    for (int i = 0; i < connections; ++i) {
+        workers.append(new Worker(i, server, mix, requests, depth, batch, results[i]));
+        workers.last()->start([&] {
+            if (--running == 0) app.quit();
+        });
+    }
+    app.exec();
+    const double seconds = wall.nsecsElapsed() / 1e9;
+    qDeleteAll(workers);
+
+    // 合并各连接的结果
+    QHash<QString, Latencies> merged;
+    qint64 total = 0;
+    for (const QHash<QString, Latencies> &perConnection : std::as_const(results)) {
+        for (auto it = perConnection.cbegin(); it != perConnection.cend(); ++it) {
+            merged[it.key()].micros += it.value().micros;
+            merged[it.key()].errors += it.value().errors;
+            total += it.value().micros.size();
+        }
+    }
+
+    out() << QString("%1 个连接，流水线深度 %2，批量 %3：%4 个请求用时 %5 秒，%6 请求/秒\n")
+                 .arg(connections).arg(depth).arg(batch).arg(total)
+                 .arg(seconds, 0, 'f', 2).arg(seconds > 0 ? total / seconds : 0, 0, 'f', 0);
+    out() << QString("%1 %2 %3 %4 %5 %6 %7\n").arg("方法", -16).arg("次数", 8).arg("错误", 6)
+                 .arg("p50(us)", 9).arg("p90(us)", 9).arg("p99(us)", 9).arg("max(us)", 9);
+    QStringList methods = merged.keys();
+    methods.sort();
+    for (const QString &method : std::as_const(methods)) {
+        QList<qint64> sorted = merged.value(method).micros;
+        std::sort(sorted.begin(), sorted.end());
+        out() << QString("%1 %2 %3 %4 %5 %6 %7\n").arg(method, -16).arg(sorted.size(), 8)
+                     .arg(merged.value(method).errors, 6)
+                     .arg(percentile(sorted, 0.50), 9).arg(percentile(sorted, 0.90), 9)
+                     .arg(percentile(sorted, 0.99), 9).arg(sorted.isEmpty() ? 0 : sorted.last(), 9);
+    }
+    printServerStats(server);
+    out().flush();
+    return 0;
+}
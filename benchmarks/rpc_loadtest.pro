@@ -0,0 +1,14 @@
+# 本地 JSON-RPC 服务的压测客户端：多个连接、流水线发送、可选批量，统计各方法的延迟分位数。
+# 会写入测试任务，请对一份单独的数据库运行服务端：
+#   ../cli/planner-cli --db /tmp/loadtest.db serve --name planner-loadtest &
+#   qmake rpc_loadtest.pro && make
+#   ./rpc_loadtest --name planner-loadtest --connections 8 --requests 20000 --depth 64 --batch 16
+QT = core network
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+TARGET = rpc_loadtest
+
+SOURCES += \
+    rpc_loadtest.cpp
@@ -0,0 +1,412 @@
+// planner-cli：不启动界面，直接在 tasks.db 和课表数据上做批量操作，供夜间脚本调用。
+// 导入导出逐条流式处理，输入输出多大都只占常数内存。退出码：0 成功，1 执行失败，2 用法错误。
+#include "BatchScheduleImporter.h"
+#include "DatabaseManager.h"
+#include "DeltaSync.h"
+#include "GroupScheduleStore.h"
+#include "MetricsExporter.h"
+#include "PlannerRpcServer.h"
+#include "ScheduleModel.h"
+#include "StudyStatistics.h"
+#include "TaskTransfer.h"
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTextStream>
+
+namespace {
+
+enum ExitCode { ExitOk = 0, ExitFailure = 1, ExitUsage = 2 };
+
+QTextStream &err()
+{
+    static QTextStream stream(stderr);
+    return stream;
+}
+
+int fail(const QString &message, int code = ExitFailure)
+{
+    err() << message << Qt::endl;
+    return code;
+}
+
+// 路径为空或 "-" 时使用标准输入/输出
+bool openStream(QFile &file, const QString &path, QIODevice::OpenMode mode)
+{
+    if (path.isEmpty() || path == "-") {
+        return file.open(mode.testFlag(QIODevice::WriteOnly) ? stdout : stdin, mode);
+    }
+    file.setFileName(path);
+    return file.open(mode);
+}
+
+bool parseDateOption(const QCommandLineParser &parser, const QString &name, QDate &date)
+{
+    if (!parser.isSet(name)) return true;
+    date = QDate::fromString(parser.value(name), Qt::ISODate);
+    return date.isValid();
+}
+
+bool openDatabase(const QCommandLineParser &parser)
+{
+    return DatabaseManager::instance().init(parser.value("db"));
+}
+
+// 未指定 --format 时按文件扩展名推断，都没有时用 fallback
+bool resolveFormat(const QCommandLineParser &parser, const QString &path,
+                   TaskTransfer::Format fallback, TaskTransfer::Format &format)
+{
+    if (parser.isSet("format")) return TaskTransfer::formatFromName(parser.value("format"), format);
+    if (!TaskTransfer::formatFromFileName(path, format)) format = fallback;
+    return true;
+}
+
+int exportTasks(const QCommandLineParser &parser)
+{
+    const QString path = parser.value("output");
+    TaskTransfer::Format format;
+    if (!resolveFormat(parser, path, TaskTransfer::Csv, format)) {
+        return fail("未知格式：" + parser.value("format"), ExitUsage);
+    }
+    QDate from, to;
+    if (!parseDateOption(parser, "from", from) || !parseDateOption(parser, "to", to)) {
+        return fail("日期格式应为 yyyy-MM-dd", ExitUsage);
+    }
+    if (!openDatabase(parser)) return fail("无法打开数据库：" + parser.value("db"));
+
+    QFile out;
+    if (!openStream(out, path, QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return fail("无法写入 " + path + "：" + out.errorString());
+    }
+    TaskTransfer::Stats stats;
+    QString error;
+    if (!TaskTransfer::exportTasks(&out, format, from, to, &stats, &error)) return fail(error);
+    err() << "已导出 " << stats.records << " 条任务";
+    if (stats.rules > 0) err() << "（其中重复日程 " << stats.rules << " 条）";
+    err() << Qt::endl;
+    return ExitOk;
+}
+
+// 保存的课表导出为 iCalendar，每门课一个按周重复的事件
+int exportSchedule(const QCommandLineParser &parser)
+{
+    QDate termStart = ScheduleModel::termStart();
+    if (!parseDateOption(parser, "term-start", termStart)) return fail("日期格式应为 yyyy-MM-dd", ExitUsage);
+    if (!termStart.isValid()) return fail("请用 --term-start 指定学期第一周的日期", ExitUsage);
+    bool ok = true;
+    const int weeks = parser.isSet("weeks") ? parser.value("weeks").toInt(&ok) : ScheduleModel::termWeeks();
+    if (!ok || weeks <= 0) return fail("--weeks 应为正整数", ExitUsage);
+
+    const QList<CourseEntry> courses = ScheduleModel::loadSaved();
+    if (courses.isEmpty()) return fail("还没有导入课表");
+
+    QFile out;
+    if (!openStream(out, parser.value("output"), QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return fail("无法写入 " + parser.value("output") + "：" + out.errorString());
+    }
+    TaskTransfer::Stats stats;
+    QString error;
+    if (!TaskTransfer::exportCourses(&out, courses, termStart, weeks, &stats, &error)) return fail(error);
+    if (parser.isSet("term-start") || parser.isSet("weeks")) ScheduleModel::setTerm(termStart, weeks);
+    err() << "已导出 " << stats.records << " 门课程，共 " << weeks << " 周" << Qt::endl;
+    return ExitOk;
+}
+
+int importTasks(const QCommandLineParser &parser, const QStringList &args)
+{
+    const QString path = args.value(0);
+    TaskTransfer::Format format;
+    if (!resolveFormat(parser, path, TaskTransfer::Csv, format)) {
+        return fail("未知格式：" + parser.value("format"), ExitUsage);
+    }
+    bool ok = true;
+    const int batchSize = parser.isSet("batch") ? parser.value("batch").toInt(&ok) : 1000;
+    if (!ok || batchSize <= 0) return fail("--batch 应为正整数", ExitUsage);
+    if (!openDatabase(parser)) return fail("无法打开数据库：" + parser.value("db"));
+
+    QFile in;
+    if (!openStream(in, path, QIODevice::ReadOnly)) {
+        return fail("无法读取 " + path + "：" + in.errorString());
+    }
+    TaskTransfer::Stats stats;
+    QString error;
+    const bool imported = TaskTransfer::importTasks(&in, format, batchSize, &stats, &error);
+    err() << "已导入 " << stats.records << " 条任务";
+    if (stats.rules > 0) err() << "（其中重复日程 " << stats.rules << " 条）";
+    if (stats.skipped > 0) err() << "，跳过 " << stats.skipped << " 条（" << stats.firstError << "）";
+    err() << Qt::endl;
+    return imported ? ExitOk : fail(error);
+}
+
+// 把每日时长归到所在的周（周一）或月（1 号）
+QMap<QDate, int> bucketByPeriod(const QMap<QDate, int> &daily, const QString &period)
+{
+    if (period == "day") return daily;
+    QMap<QDate, int> buckets;
+    for (auto it = daily.cbegin(); it != daily.cend(); ++it) {
+        const QDate key = period == "week" ? it.key().addDays(1 - it.key().dayOfWeek())
+                                           : QDate(it.key().year(), it.key().month(), 1);
+        buckets[key] += it.value();
+    }
+    return buckets;
+}
+
+int report(const QCommandLineParser &parser)
+{
+    const QString by = parser.value("by");
+    if (by != "day" && by != "week" && by != "month" && by != "tag") {
+        return fail("--by 只能是 day、week、month 或 tag", ExitUsage);
+    }
+    const QString unitName = parser.value("unit");
+    StudyStatistics::TimeUnit unit;
+    if (unitName == "s") unit = StudyStatistics::Seconds;
+    else if (unitName == "min") unit = StudyStatistics::Minutes;
+    else if (unitName == "h") unit = StudyStatistics::Hours;
+    else return fail("--unit 只能是 s、min 或 h", ExitUsage);
+
+    const QString format = parser.isSet("format") ? parser.value("format").toLower() : QString("csv");
+    if (format != "csv" && format != "json" && format != "jsonl") {
+        return fail("报表只支持 csv 或 json 格式", ExitUsage);
+    }
+    QDate from, to;
+    if (!parseDateOption(parser, "from", from) || !parseDateOption(parser, "to", to)) {
+        return fail("日期格式应为 yyyy-MM-dd", ExitUsage);
+    }
+    if (by == "tag" && (from.isValid() || to.isValid())) {
+        return fail("按标签汇总时不支持 --from/--to", ExitUsage);
+    }
+    if (!openDatabase(parser)) return fail("无法打开数据库：" + parser.value("db"));
+
+    QFile out;
+    if (!openStream(out, parser.value("output"), QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return fail("无法写入 " + parser.value("output") + "：" + out.errorString());
+    }
+    const double factor = StudyStatistics::unitSeconds(unit);
+    const bool csv = format == "csv";
+    const QString &keyName = by;
+    if (csv) out.write(keyName.toUtf8() + ",duration_" + unitName.toUtf8() + "\r\n");
+
+    auto writeRow = [&](const QString &key, int seconds) {
+        const double value = seconds / factor;
+        if (csv) {
+            QString field = key;
+            if (field.contains(',') || field.contains('"') || field.contains('\n')) {
+                field = '"' + field.replace('"', "\"\"") + '"';
+            }
+            out.write(field.toUtf8() + ',' + QByteArray::number(value, 'f', 2) + "\r\n");
+        } else {
+            const QJsonObject row{{keyName, key}, {"duration_" + unitName, value}};
+            out.write(QJsonDocument(row).toJson(QJsonDocument::Compact) + '\n');
+        }
+    };
+
+    if (by == "tag") {
+        const QMap<QString, int> byTag = DatabaseManager::instance().getStudyDurationsByTag();
+        for (auto it = byTag.cbegin(); it != byTag.cend(); ++it) writeRow(it.key(), it.value());
+    } else {
+        QMap<QDate, int> daily = DatabaseManager::instance().getDailyStudyDurations();
+        if (from.isValid()) daily.erase(daily.begin(), daily.lowerBound(from));
+        if (to.isValid()) daily.erase(daily.upperBound(to), daily.end());
+        const QMap<QDate, int> buckets = bucketByPeriod(daily, by);
+        const QString keyFormat = by == "month" ? "yyyy-MM" : "yyyy-MM-dd";
+        for (auto it = buckets.cbegin(); it != buckets.cend(); ++it) writeRow(it.key().toString(keyFormat), it.value());
+    }
+    return out.error() == QFileDevice::NoError ? ExitOk : fail("写出失败：" + out.errorString());
+}
+
+// 单个文件：输出课程 JSON，--save 时作为自己的课表保存；
+// 多个文件或 --group：每人输出一行 JSON，--group 时写入小组课表
+int importSchedule(const QCommandLineParser &parser, const QStringList &args)
+{
+    if (args.isEmpty()) return fail("请指定课表 HTML 文件或目录", ExitUsage);
+    QStringList renamed;
+    const QList<BatchScheduleImporter::Source> sources = BatchScheduleImporter::collectSources(args, &renamed);
+    if (sources.isEmpty()) return fail("没有找到 .html/.htm/.txt 课表文件");
+
+    const bool group = parser.isSet("group");
+    if (parser.isSet("save") && (group || sources.size() > 1)) {
+        return fail("--save 只能用于单个课表文件", ExitUsage);
+    }
+    QFile out;
+    if (!openStream(out, parser.value("output"), QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return fail("无法写入 " + parser.value("output") + "：" + out.errorString());
+    }
+
+    if (!group && sources.size() == 1) {
+        const BatchScheduleImporter::Result result = BatchScheduleImporter::importFile(sources.first().path);
+        if (!result.error.isEmpty()) return fail(sources.first().path + "：" + result.error);
+        QJsonArray array;
+        for (const CourseEntry &course : result.person.courses) array.append(course.toJson());
+        const QByteArray json = QJsonDocument(array).toJson(QJsonDocument::Indented);
+        out.write(json);
+        if (parser.isSet("save")) {
+            ScheduleModel::save(json);
+            err() << "已保存 " << result.person.courses.size() << " 门课程" << Qt::endl;
+        }
+        return ExitOk;
+    }
+
+    // 逐个文件解析、输出，只有 --group 时才需要留下结果
+    for (const QString &line : std::as_const(renamed)) err() << "重名，已改名：" << line << Qt::endl;
+    QList<PersonSchedule> imported;
+    int failures = 0;
+    for (const BatchScheduleImporter::Source &source : sources) {
+        const BatchScheduleImporter::Result result = BatchScheduleImporter::importFile(source.path, source.name);
+        if (!result.error.isEmpty()) {
+            err() << source.path << "：" << result.error << Qt::endl;
+            ++failures;
+            continue;
+        }
+        QJsonArray courses;
+        for (const CourseEntry &course : result.person.courses) courses.append(course.toJson());
+        const QJsonObject line{{"name", result.person.name}, {"source", source.path}, {"courses", courses}};
+        out.write(QJsonDocument(line).toJson(QJsonDocument::Compact) + '\n');
+        if (group) imported.append(result.person);
+    }
+    if (group && !imported.isEmpty()) {
+        GroupScheduleStore::instance().upsert(imported);
+        err() << "已写入小组课表 " << imported.size() << " 人" << Qt::endl;
+    }
+    err() << "解析 " << sources.size() - failures << "/" << sources.size() << " 个文件" << Qt::endl;
+    return failures == sources.size() ? ExitFailure : ExitOk;
+}
+
+void printSyncStats(const DeltaSync::Stats &stats)
+{
+    err() << "发出 " << stats.sent << " 条变更，收到 " << stats.received << " 条：合并 " << stats.applied
+          << "，冲突丢弃 " << stats.conflicts << "，重复 " << stats.duplicates << Qt::endl;
+}
+
+// 与共享目录或另一台机器上的同步服务（planner-cli serve）交换增量变更
+int sync(const QCommandLineParser &parser)
+{
+    if (parser.isSet("dir") == parser.isSet("server")) {
+        return fail("请用 --dir 或 --server 指定同步目标（二选一）", ExitUsage);
+    }
+    if (!openDatabase(parser)) return fail("无法打开数据库：" + parser.value("db"));
+
+    DeltaSync::Stats stats;
+    QString error;
+    const bool ok = parser.isSet("dir") ? DeltaSync::syncDirectory(parser.value("dir"), &stats, &error)
+                                        : DeltaSync::syncWithServer(parser.value("server"), &stats, &error);
+    printSyncStats(stats);
+    return ok ? ExitOk : fail(error);
+}
+
+int exportChanges(const QCommandLineParser &parser)
+{
+    bool ok = true;
+    const qint64 since = parser.isSet("since") ? parser.value("since").toLongLong(&ok) : 0;
+    if (!ok || since < 0) return fail("--since 应为非负整数", ExitUsage);
+    if (!openDatabase(parser)) return fail("无法打开数据库：" + parser.value("db"));
+
+    QFile out;
+    if (!openStream(out, parser.value("output"), QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return fail("无法写入 " + parser.value("output") + "：" + out.errorString());
+    }
+    DeltaSync::Stats stats;
+    qint64 last = since;
+    QString error;
+    if (!DeltaSync::exportChanges(&out, since, &last, &stats, &error)) return fail(error);
+    out.flush();
+    err() << "已导出 " << stats.sent << " 条变更，下次可用 --since " << last << Qt::endl;
+    return out.error() == QFileDevice::NoError ? ExitOk : fail("写出失败：" + out.errorString());
+}
+
+int importChanges(const QCommandLineParser &parser, const QStringList &args)
+{
+    const QString path = args.value(0);
+    bool ok = true;
+    const int batchSize = parser.isSet("batch") ? parser.value("batch").toInt(&ok) : 1000;
+    if (!ok || batchSize <= 0) return fail("--batch 应为正整数", ExitUsage);
+    if (!openDatabase(parser)) return fail("无法打开数据库：" + parser.value("db"));
+
+    QFile in;
+    if (!openStream(in, path, QIODevice::ReadOnly)) {
+        return fail("无法读取 " + path + "：" + in.errorString());
+    }
+    DeltaSync::Stats stats;
+    QString error;
+    const bool imported = DeltaSync::importChanges(&in, batchSize, &stats, &error);
+    printSyncStats(stats);
+    return imported ? ExitOk : fail(error);
+}
+
+// 不开界面，单独运行本地 RPC 服务（供压测或无界面的机器使用），Ctrl+C 结束
+int serve(QCoreApplication &app, const QCommandLineParser &parser)
+{
+    if (!openDatabase(parser)) return fail("无法打开数据库：" + parser.value("db"));
+    PlannerRpcServer server;
+    if (!server.start(parser.isSet("name") ? parser.value("name") : PlannerRpcServer::defaultName())) {
+        return fail("RPC 服务启动失败");
+    }
+    err() << "RPC 服务：" << server.serverName() << Qt::endl;
+    // 配置了 PLANNER_METRICS_PORT / PLANNER_METRICS_FILE 时同时导出指标
+    MetricsExporter exporter;
+    exporter.startFromSettings();
+    return app.exec();
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    // 与界面程序共用应用数据目录（小组课表等）
+    QCoreApplication::setApplicationName("QTfinal");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(
+        "规划器批处理工具\n\n"
+        "命令：\n"
+        "  export-tasks      导出任务（csv / json / ics）\n"
+        "  import-tasks      导入任务，文件省略或为 - 时读标准输入\n"
+        "  export-schedule   把保存的课表导出为按周重复的日历事件（ics）\n"
+        "  report            自习时长报表\n"
+        "  import-schedule   从教务课表 HTML 导入课程\n"
+        "  serve             不开界面运行本地 JSON-RPC 服务（也可作为 sync --server 的同步服务）\n"
+        "  sync              与 --dir 共享目录或 --server 同步服务交换增量变更\n"
+        "  export-changes    导出序号大于 --since 的变更（planner-delta JSON Lines）\n"
+        "  import-changes    合并另一台机器导出的变更，文件省略或为 - 时读标准输入");
+    parser.addHelpOption();
+    parser.addPositionalArgument("command", "export-tasks | import-tasks | export-schedule | report | import-schedule | serve"
+                                                " | sync | export-changes | import-changes");
+    parser.addOptions({
+        {"db", "数据库文件，默认当前目录下的 tasks.db", "path", "tasks.db"},
+        {{"f", "format"}, "csv、json（JSON Lines）或 ics；默认按文件扩展名推断", "format"},
+        {{"o", "output"}, "输出文件，默认标准输出", "path"},
+        {"from", "起始日期（含）", "yyyy-MM-dd"},
+        {"to", "结束日期（含）", "yyyy-MM-dd"},
+        {"batch", "import-tasks / import-changes 每个事务写入的条数，默认 1000", "n"},
+        {"term-start", "export-schedule：学期第一周的任意一天，指定后会记住", "yyyy-MM-dd"},
+        {"weeks", "export-schedule：学期周数，默认 16，指定后会记住", "n"},
+        {"by", "report 的汇总方式：day、week、month 或 tag", "period", "day"},
+        {"unit", "report 的时长单位：s、min 或 h", "unit", "min"},
+        {"save", "import-schedule：保存为自己的课表"},
+        {"group", "import-schedule：写入小组课表"},
+        {"name", "serve：本地套接字名，默认 planner-rpc", "name"},
+        {"dir", "sync：共享同步目录", "path"},
+        {"server", "sync：同步服务的本地套接字名", "name"},
+        {"since", "export-changes：只导出序号大于它的变更，默认 0（全部）", "seq"},
+    });
+    parser.process(app);
+
+    QStringList args = parser.positionalArguments();
+    if (args.isEmpty()) {
+        parser.showHelp(ExitUsage);
+    }
+    const QString command = args.takeFirst();
+    if (command == "export-tasks") return exportTasks(parser);
+    if (command == "import-tasks") return importTasks(parser, args);
+    if (command == "export-schedule") return exportSchedule(parser);
+    if (command == "report") return report(parser);
+    if (command == "import-schedule") return importSchedule(parser, args);
+    if (command == "serve") return serve(app, parser);
+    if (command == "sync") return sync(parser);
+    if (command == "export-changes") return exportChanges(parser);
+    if (command == "import-changes") return importChanges(parser, args);
+    return fail("未知命令：" + command, ExitUsage);
+}
@@ -0,0 +1,19 @@
+# 命令行批处理工具，只链接规划器核心，不需要显示器。随顶层 planner.pro 一起构建，或者在构建好 plannercore 之后：
+#   qmake planner_cli.pro && make
+#   ./planner-cli --db ~/tasks.db export-tasks --format csv -o tasks.csv
+#   ./planner-cli import-tasks tasks.ics
+#   ./planner-cli export-schedule --term-start 2025-02-17 --weeks 16 -o courses.ics
+#   ./planner-cli report --by week --unit h
+#   ./planner-cli import-schedule --save schedule.html
+# 用法见 ./planner-cli --help。
+QT = core
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+TARGET = planner-cli
+
+include(../plannercore.pri)
+
+SOURCES += \
+    planner_cli.cpp
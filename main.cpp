@@ -1,11 +1,19 @@
 #include "mainwindow.h"
+#include "StartupTrace.h"
 
 #include <QApplication>
 
 int main(int argc, char *argv[])
 {
+    StartupTrace::instance().start();
+
     QApplication a(argc, argv);
+    StartupTrace::instance().mark("qapplication-ready");
+
     MainWindow w;
-    w.show();
+    {
+        StartupTrace::Scope scope("show");
+        w.show();
+    }
     return a.exec();
 }
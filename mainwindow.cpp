@@ -8,12 +8,24 @@
 #include "StudySessionDialog.h"
 #include "StatisticsWindow.h"
 #include "DatabaseManager.h"
+#include "WeatherConditionTable.h"
+#include "StartupTrace.h"
+#include "TypewriterLabel.h"
+#include "AnimationPlayer.h"
+#include "PlannerSnapshot.h"
+#include "PlannerRpcServer.h"
+#include "MetricsRegistry.h"
+#include "MetricsExporter.h"
+#include "DiagnosticsWindow.h"
+#include "StallWatchdog.h"
 #include <QLabel>
 #include <QMessageBox>
-#include <QMovie>
 #include <QNetworkRequest>
 #include <QIcon>
 #include <QPair>
+#include <QSystemTrayIcon>
+#include <QSettings>
+#include <QShortcut>
 
 MainWindow::MainWindow(QWidget *parent)
     : QWidget(parent)
@@ -21,110 +33,158 @@ MainWindow::MainWindow(QWidget *parent)
     , courseWindow(nullptr)
     , studyDialog(nullptr)
     , statsWindow(nullptr)
+    , reminderScheduler(nullptr)
+    , trayIcon(nullptr)
     , headerLabel(nullptr)
-    , typewriterTimer(nullptr)
-    , typewriterPos(0)
-    , deletingPhase(false)
-    , netManager(new QNetworkAccessManager(this))
-    , iconNetManager(new QNetworkAccessManager(this)) // 初始化图标下载管理器
+    , weatherService(nullptr)
     , m_apiKey("4259998722ba752c0ce245ab9f00d75e") // OpenWeatherMap API Key
 {
-    ui->setupUi(this);
-    setWindowTitle("个人学习助手");
-
-    // 初始化UI外观
-    setupUiLooks();
-    setupWeatherUI(); // 初始化天气UI
+    StartupTrace::Scope ctorScope("mainwindow-ctor");
+    {
+        StartupTrace::Scope scope("setup-ui");
+        ui->setupUi(this);
+        setWindowTitle("个人学习助手");
+
+        // 初始化UI外观（GIF 和天气数据在首帧之后再加载）
+        setupUiLooks();
+        setupWeatherUI(); // 初始化天气UI
+    }
 
-    // 初始化打字机效果的语句库
-    phraseList = {
+    // 初始化打字机效果的语句库（首帧之后再开始打字）
+    headerLabel->setPhrases({
         "Keep your determination!",
         "You are filled with the power of determination.",
         "It's a beautiful day outside...",
         "Geeetttt dunked on~",
         "Beware of the man who speaks in hands.",
         "Debugging is fun!"
-    };
+    });
+
+    // 有本周的快照时，首帧直接用快照画，数据库放到首帧之后再打开
+    PlannerSnapshot snapshot;
+    {
+        StartupTrace::Scope scope("snapshot-open");
+        const QDate today = QDate::currentDate();
+        if (!snapshot.open() || snapshot.weekStart() != today.addDays(1 - today.dayOfWeek())) {
+            snapshot.close();
+        }
+    }
+    if (!snapshot.isValid()) {
+        ensureDatabase();
+    }
+
+    // 日程提醒的调度器先建好，加载任务放到首帧之后
+    reminderScheduler = new ReminderScheduler(this);
+    connect(reminderScheduler, &ReminderScheduler::reminderDue,
+            this, &MainWindow::onReminderDue);
+
+    // 设置当前日期并更新UI
+    {
+        StartupTrace::Scope scope("calendar-and-tasks");
+        currentSelectedDate = QDate::currentDate();
+        calendarWidget->setSelectedDate(currentSelectedDate);
+        if (snapshot.isValid()) {
+            applyCalendarHighlights(snapshot.taskDates());
+            showTasksForDate(currentSelectedDate, snapshot.tasksForDate(currentSelectedDate));
+        } else {
+            updateCalendarHighlights();
+            onDateSelected(currentSelectedDate);
+        }
+    }
 
-    // 创建并启动打字机效果定时器
-    typewriterTimer = new QTimer(this);
-    connect(typewriterTimer, &QTimer::timeout,
-            this,           &MainWindow::onTypewriterTimeout);
+    // 任务有变动时稍等片刻再重写快照，连续修改只写一次
+    snapshotTimer = new QTimer(this);
+    snapshotTimer->setSingleShot(true);
+    snapshotTimer->setInterval(2000);
+    connect(snapshotTimer, &QTimer::timeout, this, [] { PlannerSnapshot::writeFromDatabase(); });
+    DatabaseManager &db = DatabaseManager::instance();
+    connect(&db, &DatabaseManager::taskAdded, snapshotTimer, qOverload<>(&QTimer::start));
+    connect(&db, &DatabaseManager::taskUpdated, snapshotTimer, qOverload<>(&QTimer::start));
+    connect(&db, &DatabaseManager::taskRemoved, snapshotTimer, qOverload<>(&QTimer::start));
+    connect(&db, &DatabaseManager::taskRulesChanged, snapshotTimer, qOverload<>(&QTimer::start));
+
+    // 首帧画出来之后再做不影响第一眼的初始化
+    connect(&StartupTrace::instance(), &StartupTrace::firstFramePainted,
+            this, &MainWindow::startDeferredInit, Qt::SingleShotConnection);
+    StartupTrace::instance().watchFirstFrame(this);
+}
 
-    // 初始化数据库
+// 首帧之后的初始化：提醒、托盘、GIF、打字机、天气，以及设置里启用的本地 RPC 服务。
+// 每一步单独计时，全部完成后输出启动记录。
+void MainWindow::startDeferredInit()
+{
+    if (!m_databaseReady) {
+        // 首帧来自快照：现在打开数据库，并用最新数据替换快照里的内容
+        ensureDatabase();
+        StartupTrace::Scope scope("deferred-calendar");
+        updateCalendarHighlights();
+        onDateSelected(currentSelectedDate);
+        snapshotTimer->start();
+    }
+    {
+        StartupTrace::Scope scope("deferred-reminders");
+        reminderScheduler->reload();
+        if (QSystemTrayIcon::isSystemTrayAvailable()) {
+            trayIcon = new QSystemTrayIcon(QIcon(":/images/lancer.jpg"), this);
+            trayIcon->setToolTip("个人学习助手");
+            trayIcon->show();
+        }
+    }
+    {
+        StartupTrace::Scope scope("deferred-gif");
+        startGifAnimation();
+    }
+    {
+        StartupTrace::Scope scope("deferred-typewriter");
+        headerLabel->start();
+    }
+    {
+        // 天气：先显示缓存，再在后台重新验证
+        StartupTrace::Scope scope("deferred-weather");
+        startWeatherService();
+    }
+    if (PlannerRpcServer::enabledInSettings()) {
+        StartupTrace::Scope scope("deferred-rpc");
+        rpcServer = new PlannerRpcServer(this);
+        // 脚本改了任务后刷新日历和当天列表
+        connect(rpcServer, &PlannerRpcServer::tasksChanged, this, [this] {
+            updateCalendarHighlights();
+            onDateSelected(currentSelectedDate);
+        });
+        rpcServer->start();
+    }
+    {
+        // 指标导出：设置或环境变量里配置了文件/端口才启动
+        StartupTrace::Scope scope("deferred-metrics");
+        metricsExporter = new MetricsExporter(this);
+        if (!metricsExporter->startFromSettings()) {
+            delete metricsExporter;
+            metricsExporter = nullptr;
+        }
+    }
+    {
+        // 卡顿看门狗最后启动：启动阶段的耗时归 StartupTrace 记录，不算卡顿
+        StartupTrace::Scope scope("deferred-watchdog");
+        StallWatchdog::instance().startFromSettings();
+    }
+    StartupTrace::instance().finish();
+}
+
+void MainWindow::ensureDatabase()
+{
+    if (m_databaseReady) return;
+    m_databaseReady = true;
+    StartupTrace::Scope scope("database-init");
     if (!DatabaseManager::instance().init()) {
         qDebug() << "数据库初始化失败";
     }
-
-    // 设置当前日期并更新UI
-    currentSelectedDate = QDate::currentDate();
-    updateCalendarHighlights();
-    onDateSelected(currentSelectedDate);
-    calendarWidget->setSelectedDate(currentSelectedDate);
-
-    // 启动打字机效果
-    selectNextPhrase();
-    startTypewriter(120);
-
-    // 连接天气API的finished信号
-    connect(netManager, &QNetworkAccessManager::finished,
-            this, &MainWindow::onWeatherApiReply);
-    // 连接图标下载的finished信号
-    connect(iconNetManager, &QNetworkAccessManager::finished,
-            this, &MainWindow::onWeatherIconReply);
-
-    // 启动时获取默认城市的天气（例如：东京）
-    fetchWeather("Tokyo"); // 您可以改为任何默认城市
-
-    // 初始化天气描述到中文翻译的映射
-    weatherTranslationMap["clear sky"] = "晴空";
-    weatherTranslationMap["few clouds"] = "少云";
-    weatherTranslationMap["scattered clouds"] = "多云";
-    weatherTranslationMap["broken clouds"] = "碎云";
-    weatherTranslationMap["overcast clouds"] = "阴天";
-    weatherTranslationMap["shower rain"] = "阵雨";
-    weatherTranslationMap["rain"] = "雨";
-    weatherTranslationMap["light rain"] = "小雨";
-    weatherTranslationMap["moderate rain"] = "中雨";
-    weatherTranslationMap["heavy intensity rain"] = "大雨";
-    weatherTranslationMap["thunderstorm"] = "雷暴";
-    weatherTranslationMap["snow"] = "雪";
-    weatherTranslationMap["light snow"] = "小雪";
-    weatherTranslationMap["mist"] = "薄雾";
-    weatherTranslationMap["fog"] = "雾";
-    weatherTranslationMap["haze"] = "霾";
-    weatherTranslationMap["sleet"] = "雨夹雪";
-    weatherTranslationMap["light intensity drizzle"] = "毛毛雨";
-    weatherTranslationMap["drizzle"] = "毛毛雨";
-    weatherTranslationMap["heavy intensity drizzle"] = "大毛毛雨";
-    weatherTranslationMap["drizzle rain"] = "毛毛雨";
-    weatherTranslationMap["heavy intensity drizzle rain"] = "大毛毛雨";
-    weatherTranslationMap["light intensity shower rain"] = "小阵雨";
-    weatherTranslationMap["heavy intensity shower rain"] = "大阵雨";
-    weatherTranslationMap["ragged shower rain"] = "零星阵雨";
-    weatherTranslationMap["light snow"] = "小雪";
-    weatherTranslationMap["snow"] = "雪";
-    weatherTranslationMap["heavy snow"] = "大雪";
-    weatherTranslationMap["sleet"] = "雨夹雪";
-    weatherTranslationMap["light shower sleet"] = "小阵雨夹雪";
-    weatherTranslationMap["shower sleet"] = "阵雨夹雪";
-    weatherTranslationMap["light rain and snow"] = "小雨夹雪";
-    weatherTranslationMap["rain and snow"] = "雨夹雪";
-    weatherTranslationMap["light shower snow"] = "小阵雪";
-    weatherTranslationMap["shower snow"] = "阵雪";
-    weatherTranslationMap["heavy shower snow"] = "大阵雪";
-    weatherTranslationMap["squalls"] = "飑";
-    weatherTranslationMap["tornado"] = "龙卷风";
-    weatherTranslationMap["dust whirls"] = "尘卷风";
-    weatherTranslationMap["sand/dust whirls"] = "沙尘暴";
-    weatherTranslationMap["volcanic ash"] = "火山灰";
-    weatherTranslationMap["smoke"] = "烟";
-    weatherTranslationMap["hail"] = "冰雹";
-    weatherTranslationMap["freezing rain"] = "冻雨";
 }
 
 MainWindow::~MainWindow()
 {
+    if (m_databaseReady) {
+        PlannerSnapshot::writeFromDatabase();
+    }
     delete ui;
 }
 
@@ -140,6 +200,18 @@ void MainWindow::setupUiLooks()
     detailTextEdit = new QTextEdit();
     detailTextEdit->setReadOnly(true);
 
+    // 日程搜索：边输入边出结果，停顿片刻再查询，避免每个按键都查库
+    searchLineEdit = new QLineEdit();
+    searchLineEdit->setPlaceholderText("搜索日程标题或备注...");
+    searchLineEdit->setClearButtonEnabled(true);
+    searchLineEdit->setObjectName("searchLineEdit");
+    searchResultList = new QListWidget();
+    searchResultList->setMaximumHeight(160);
+    searchResultList->setVisible(false);
+    searchDebounceTimer = new QTimer(this);
+    searchDebounceTimer->setSingleShot(true);
+    searchDebounceTimer->setInterval(120);
+
     // 创建学习激励标签
     QLabel *studyMotivationLabel = new QLabel();
     studyMotivationLabel->setAlignment(Qt::AlignCenter);
@@ -180,15 +252,7 @@ void MainWindow::setupUiLooks()
     // 创建并配置GIF标签
     gifLabel = new QLabel;
     gifLabel->setAlignment(Qt::AlignCenter);
-    gifLabel->setFixedSize(160, 160);
-    gifMovie = new QMovie(":/images/lancer_main_window_160.gif"); // 确保您的资源文件路径正确
-    if (gifMovie->isValid()) {
-        gifLabel->setMovie(gifMovie);
-        gifMovie->setCacheMode(QMovie::CacheAll);
-        gifMovie->start();
-    } else {
-        qDebug() << "错误：无法加载 GIF 文件";
-    }
+    gifLabel->setFixedSize(160, 160); // 先占好位置，动画在首帧后加载，布局不会跳动
     leftLayout->addWidget(gifLabel);
 
     // 创建右侧面板布局
@@ -202,6 +266,8 @@ void MainWindow::setupUiLooks()
     QVBoxLayout *rightLayout = new QVBoxLayout(rightPane);
     rightLayout->addLayout(rightTopLayout, 5);
     rightLayout->addWidget(addDailyTaskButton);
+    rightLayout->addWidget(searchLineEdit);
+    rightLayout->addWidget(searchResultList);
     rightLayout->addWidget(detailTextEdit, 4);
     rightLayout->setSpacing(10);
     rightLayout->setContentsMargins(10, 10, 10, 10);
@@ -215,8 +281,7 @@ void MainWindow::setupUiLooks()
     splitter->setHandleWidth(2);
 
     // 创建顶部标题标签
-    headerLabel = new QLabel(this);
-    headerLabel->setAlignment(Qt::AlignCenter);
+    headerLabel = new TypewriterLabel(this);
     headerLabel->setFixedHeight(50);
     headerLabel->setStyleSheet("font-size:20px;");
 
@@ -237,10 +302,22 @@ void MainWindow::setupUiLooks()
             this, &MainWindow::onStatisticsButtonClicked);
     connect(reminderButton, &QPushButton::clicked,
             this, &MainWindow::onReminderButtonClicked);
+    // 诊断面板没有按钮，只用快捷键打开
+    connect(new QShortcut(QKeySequence("Ctrl+Shift+D"), this), &QShortcut::activated,
+            this, &MainWindow::onDiagnosticsShortcut);
     connect(calendarWidget, &QCalendarWidget::clicked,
             this, &MainWindow::onDateSelected);
+    // 翻页时重新展开可见范围内的重复日程
+    connect(calendarWidget, &QCalendarWidget::currentPageChanged,
+            this, [this](int, int) { updateCalendarHighlights(); });
     connect(addDailyTaskButton, &QPushButton::clicked,
             this, &MainWindow::onAddDailyTaskClicked);
+    connect(searchLineEdit, &QLineEdit::textChanged,
+            searchDebounceTimer, qOverload<>(&QTimer::start));
+    connect(searchDebounceTimer, &QTimer::timeout,
+            this, &MainWindow::onSearchTextChanged);
+    connect(searchResultList, &QListWidget::itemClicked,
+            this, &MainWindow::onSearchResultActivated);
 
     // 应用样式表
     QString styleSheet = R"(
@@ -337,9 +414,19 @@ void MainWindow::setupUiLooks()
             font-size: 16px;
             color: #4CAF50;
         }
+        #weatherStatusLabel {
+            font-size: 12px;
+            color: #78909C;
+        }
         #weatherIconLabel {
             background-color: transparent;
         }
+        #searchLineEdit {
+            padding: 6px;
+            border: 1px solid #CED4DA;
+            border-radius: 5px;
+            background-color: #FFFFFF;
+        }
         #cityLineEdit {
             padding: 8px;
             border: 1px solid #B0BEC5;
@@ -384,6 +471,10 @@ void MainWindow::setupWeatherUI()
     weatherIconLabel->setFixedSize(64, 64); // 设置图标大小，OpenWeatherMap的@2x图标通常是50x50或更大
     weatherIconLabel->setObjectName("weatherIconLabel");
 
+    weatherStatusLabel = new QLabel("", this);
+    weatherStatusLabel->setAlignment(Qt::AlignCenter);
+    weatherStatusLabel->setObjectName("weatherStatusLabel");
+
     cityLineEdit = new QLineEdit(this);
     cityLineEdit->setPlaceholderText("输入城市名称 (例如: Beijing)");
     cityLineEdit->setClearButtonEnabled(true);
@@ -406,6 +497,7 @@ void MainWindow::setupWeatherUI()
     weatherTextLayout->addWidget(weatherLocationLabel);
     weatherTextLayout->addWidget(weatherTemperatureLabel);
     weatherTextLayout->addWidget(weatherConditionLabel);
+    weatherTextLayout->addWidget(weatherStatusLabel);
     weatherDisplayLayout->addLayout(weatherTextLayout);
 
     // 创建城市输入和按钮的水平布局
@@ -434,14 +526,84 @@ void MainWindow::setupWeatherUI()
     }
 }
 
+void MainWindow::startGifAnimation()
+{
+    if (gifPlayer) return;
+    // 帧在后台解码并由 AssetService 缓存，其他窗口再用时不重复解码
+    gifPlayer = new AnimationPlayer(gifLabel, this);
+    gifPlayer->setSource(":/images/lancer_main_window_160.gif", gifLabel->size());
+    gifPlayer->start();
+}
+
+// 天气服务在第一次用到时才创建
+void MainWindow::ensureWeatherService()
+{
+    if (weatherService) return;
+    // 天气服务：结果和图标都通过信号返回
+    weatherService = new WeatherService(m_apiKey, this);
+    connect(weatherService, &WeatherService::weatherReady,
+            this, &MainWindow::onWeatherReady);
+    connect(weatherService, &WeatherService::weatherFailed,
+            this, &MainWindow::onWeatherFailed);
+    connect(weatherService, &WeatherService::iconReady,
+            this, &MainWindow::onWeatherIconReady);
+    connect(weatherService, &WeatherService::revalidating,
+            this, &MainWindow::onWeatherRevalidating);
+}
+
+void MainWindow::startWeatherService()
+{
+    ensureWeatherService();
+
+    // 立即用上次保存的天气填充面板，不等网络
+    QString city = "Tokyo"; // 首次启动的默认城市
+    WeatherReading last = weatherService->lastPersistedReading();
+    if (last.isValid()) {
+        city = last.city;
+        onWeatherReady(last);
+    }
+
+    QSettings settings("MyCourseApp", "Weather");
+    if (settings.value("backgroundRefresh", true).toBool()) {
+        weatherService->startBackgroundRefresh(city, settings.value("refreshIntervalSeconds", 30 * 60).toInt());
+    } else {
+        fetchWeather(city);
+    }
+}
+
 void MainWindow::onReminderButtonClicked()
 {
-    QList<QDate> datesWithTasks = DatabaseManager::instance().getAllDatesWithTasks();
-    TaskReminderDialog dialog(datesWithTasks, this);
+    TaskReminderDialog dialog(reminderScheduler, this);
     dialog.exec();
 }
 
 void MainWindow::updateCalendarHighlights()
+{
+    StallWatchdog::Operation tag("calendar-highlights");
+    ensureDatabase();
+    const MetricsRegistry::ScopedTimer timer(
+        MetricsRegistry::instance().histogram("planner_ui_refresh_seconds", {{"view", "calendar"}}));
+
+    // 只查日历当前可见的范围（前后各多算一周，覆盖相邻月份的格子），翻页时再查新的一页
+    const QDate today = QDate::currentDate();
+    const QDate pageStart(calendarWidget->yearShown(), calendarWidget->monthShown(), 1);
+    const QDate visibleFrom = qMax(today, pageStart.addDays(-7));
+    const QDate visibleTo = pageStart.addMonths(1).addDays(13);
+    if (visibleFrom > visibleTo) {
+        applyCalendarHighlights({});
+        return;
+    }
+
+    // 获取有任务的日期
+    QList<QDate> datesWithTasks = DatabaseManager::instance().getDatesWithTasksBetween(visibleFrom, visibleTo);
+    const QList<DatedTask> occurrences = DatabaseManager::instance().getOccurrencesBetween(visibleFrom, visibleTo);
+    for (const DatedTask &occurrence : occurrences) {
+        datesWithTasks.append(occurrence.date);
+    }
+    applyCalendarHighlights(datesWithTasks);
+}
+
+void MainWindow::applyCalendarHighlights(const QList<QDate> &datesWithTasks)
 {
     // 清除旧的高亮
     for (const QDate &date : m_highlightedDates) {
@@ -449,12 +611,10 @@ void MainWindow::updateCalendarHighlights()
     }
     m_highlightedDates.clear();
 
-    // 获取有任务的日期并设置新样式
-    QList<QDate> datesWithTasks = DatabaseManager::instance().getAllDatesWithTasks();
+    // 按剩余天数设置新样式
     const QDate today = QDate::currentDate();
-
     for (const QDate &taskDate : datesWithTasks) {
-        if (taskDate < today) continue;
+        if (taskDate < today || m_highlightedDates.contains(taskDate)) continue;
 
         qint64 daysUntil = today.daysTo(taskDate);
         QTextCharFormat format;
@@ -475,6 +635,31 @@ void MainWindow::updateCalendarHighlights()
     }
 }
 
+void MainWindow::onReminderDue(const DatedTask &task, int leadMinutes)
+{
+    QString title = leadMinutes > 0
+                        ? QString("%1 分钟后开始：%2").arg(leadMinutes).arg(task.task.getTitle())
+                        : QString("日程开始：%1").arg(task.task.getTitle());
+    QString body = QString("%1 %2 - %3")
+                       .arg(task.date.toString("MM月dd日"))
+                       .arg(task.task.getStartTime().toString("HH:mm"))
+                       .arg(task.task.getEndTime().toString("HH:mm"));
+    if (!task.task.getNote().isEmpty()) {
+        body += "\n" + task.task.getNote();
+    }
+
+    if (trayIcon) {
+        trayIcon->showMessage(title, body, QSystemTrayIcon::Information, 10000);
+    } else {
+        // 没有系统托盘时用非模态消息框，避免阻塞主界面
+        QMessageBox *box = new QMessageBox(QMessageBox::Information, "日程提醒",
+                                           title + "\n" + body, QMessageBox::Ok, this);
+        box->setAttribute(Qt::WA_DeleteOnClose);
+        box->setModal(false);
+        box->show();
+    }
+}
+
 void MainWindow::onCourseScheduleButtonClicked()
 {
     if (!courseWindow) {
@@ -491,6 +676,16 @@ void MainWindow::onStudySessionButtonClicked()
     dialog.exec();
 }
 
+void MainWindow::onDiagnosticsShortcut()
+{
+    if (!diagnosticsWindow) {
+        diagnosticsWindow = new DiagnosticsWindow(metricsExporter, this);
+        diagnosticsWindow->setWindowFlag(Qt::Window);
+    }
+    diagnosticsWindow->show();
+    diagnosticsWindow->raise();
+}
+
 void MainWindow::onStatisticsButtonClicked()
 {
     if(statsWindow) {
@@ -502,13 +697,17 @@ void MainWindow::onStatisticsButtonClicked()
 }
 
 void MainWindow::onDateSelected(const QDate &date)
+{
+    StallWatchdog::Operation tag("date-selected");
+    ensureDatabase();
+    showTasksForDate(date, DatabaseManager::instance().getTasksForDate(date));
+}
+
+void MainWindow::showTasksForDate(const QDate &date, const QList<DailyTask> &tasks)
 {
     currentSelectedDate = date;
     detailTextEdit->clear();
 
-    // 获取选定日期的任务
-    QList<DailyTask> tasks = DatabaseManager::instance().getTasksForDate(date);
-
     if (tasks.isEmpty()) {
         detailTextEdit->setHtml(
             QString("<h3>%1</h3><p>这一天还没有任务。</p>")
@@ -522,82 +721,66 @@ void MainWindow::onDateSelected(const QDate &date)
         for (const DailyTask &task : tasks) {
             html += QString(
                         "<hr>"
-                        "<p><b>标题:</b> %1<br>"
+                        "<p><b>标题:</b> %1%5<br>"
                         "<b>时间:</b> %2 - %3<br>"
                         "<b>备注:</b> %4</p>"
                         )
                         .arg(task.getTitle())
                         .arg(task.getStartTime().toString("HH:mm"))
                         .arg(task.getEndTime().toString("HH:mm"))
-                        .arg(task.getNote().isEmpty() ? "无" : task.getNote());
+                        .arg(task.getNote().isEmpty() ? "无" : task.getNote())
+                        .arg(task.isOccurrence() ? " (重复)" : "");
         }
 
         detailTextEdit->setHtml(html);
     }
 }
 
-void MainWindow::onAddDailyTaskClicked()
+void MainWindow::onSearchTextChanged()
 {
-    QList<DailyTask> tasks = DatabaseManager::instance().getTasksForDate(currentSelectedDate);
-    DailyTaskDialog dialog(currentSelectedDate, this, tasks);
-    dialog.exec();
+    const QString text = searchLineEdit->text().trimmed();
+    searchResultList->clear();
+    if (text.isEmpty()) {
+        searchResultList->setVisible(false);
+        return;
+    }
 
-    // 更新UI显示
-    onDateSelected(currentSelectedDate);
-    updateCalendarHighlights();
+    const QList<DatedTask> results = DatabaseManager::instance().searchTasks(text, 50);
+
+    for (const DatedTask &result : results) {
+        auto *item = new QListWidgetItem(
+            QString("%1  %2  %3")
+                .arg(result.date.toString("yyyy-MM-dd"))
+                .arg(result.task.getStartTime().toString("HH:mm"))
+                .arg(result.task.getTitle()),
+            searchResultList);
+        item->setData(Qt::UserRole, result.date);
+        item->setToolTip(result.task.getNote());
+    }
+    if (results.isEmpty()) {
+        auto *item = new QListWidgetItem("没有找到匹配的日程", searchResultList);
+        item->setFlags(Qt::NoItemFlags);
+    }
+    searchResultList->setVisible(true);
 }
 
-void MainWindow::selectNextPhrase()
+void MainWindow::onSearchResultActivated(QListWidgetItem *item)
 {
-    // 随机选择一条语句
-    int idx = QRandomGenerator::global()->bounded(phraseList.size());
-    currentPhrase  = phraseList.at(idx);
-    typewriterPos  = 0;
-    deletingPhase  = false;
-    headerLabel->clear();
+    const QDate date = item->data(Qt::UserRole).toDate();
+    if (!date.isValid()) return;
+    calendarWidget->setSelectedDate(date);
+    onDateSelected(date);
 }
 
-void MainWindow::startTypewriter(int intervalMs)
+void MainWindow::onAddDailyTaskClicked()
 {
-    if (typewriterTimer->isActive()) {
-        typewriterTimer->stop();
-    }
-    typewriterTimer->start(intervalMs);
-}
+    QList<DailyTask> tasks = DatabaseManager::instance().getTasksForDate(currentSelectedDate);
+    DailyTaskDialog dialog(currentSelectedDate, this, tasks);
+    dialog.exec();
 
-void MainWindow::onTypewriterTimeout()
-{
-    // 打字阶段
-    if (!deletingPhase) {
-        if (typewriterPos < currentPhrase.length()) {
-            headerLabel->setText(
-                headerLabel->text() + currentPhrase.at(typewriterPos)
-                );
-            ++typewriterPos;
-        } else {
-            // 完成打字后暂停1秒进入删除阶段
-            typewriterTimer->stop();
-            QTimer::singleShot(1000, this, [this]() {
-                deletingPhase = true;
-                startTypewriter(30);
-            });
-        }
-    }
-    // 删除阶段
-    else {
-        QString txt = headerLabel->text();
-        if (!txt.isEmpty()) {
-            txt.chop(1);
-            headerLabel->setText(txt);
-        } else {
-            // 完成删除后暂停0.5秒选择新语句
-            typewriterTimer->stop();
-            QTimer::singleShot(500, this, [this]() {
-                selectNextPhrase();
-                startTypewriter(90);
-            });
-        }
-    }
+    // 更新UI显示
+    onDateSelected(currentSelectedDate);
+    updateCalendarHighlights();
 }
 
 // 天气模块相关实现
@@ -623,101 +806,73 @@ void MainWindow::fetchWeather(const QString &city)
         return;
     }
 
-    // 构建 OpenWeatherMap API 请求URL
-    // q=城市名, units=metric表示摄氏度, appid=您的API Key, lang=en 获取英文描述
-    QString url = QString("%1q=%2&units=metric&appid=%3&lang=en")
-                      .arg(OPENWEATHER_API_BASE_URL)
-                      .arg(city)
-                      .arg(m_apiKey);
+    // 由天气服务负责缓存和合并重复请求；之后后台刷新也跟随这个城市
+    ensureWeatherService();
+    weatherService->fetchWeather(city);
+    weatherService->setBackgroundCity(city);
+
+    // 只更新状态行，已有的天气数据保留到新数据到达再替换
+    weatherStatusLabel->setText(QString("正在获取 %1 的天气...").arg(city));
+}
 
-    QNetworkRequest request;
-    request.setUrl(QUrl(url));
-    netManager->get(request); // 发送 GET 请求
+void MainWindow::onWeatherRevalidating(const QString &city)
+{
+    Q_UNUSED(city);
+    weatherStatusLabel->setText(weatherStatusLabel->text().section(" · ", 0, 0) + " · 正在更新...");
+}
 
-    // 更新UI显示为正在获取状态
-    weatherLocationLabel->setText(QString("正在获取 %1 的天气...").arg(city));
-    weatherTemperatureLabel->clear();
-    weatherConditionLabel->clear();
-    weatherIconLabel->clear(); // 清除图标
+void MainWindow::onWeatherReady(const WeatherReading &reading)
+{
+    updateWeatherUI(reading.city, reading.temperature, reading.conditionId, reading.description, reading.iconCode);
+    weatherStatusLabel->setText(QString("更新于 %1").arg(reading.fetchedAt.toString("MM-dd HH:mm")));
 }
 
-void MainWindow::onWeatherApiReply(QNetworkReply *reply)
+void MainWindow::onWeatherFailed(const QString &city, const QString &error)
 {
-    // 检查网络请求是否成功
-    if (reply->error() == QNetworkReply::NoError) {
-        QByteArray responseData = reply->readAll(); // 读取所有响应数据
-        QJsonDocument jsonDoc = QJsonDocument::fromJson(responseData); // 将数据解析为JSON文档
-        QJsonObject jsonObj = jsonDoc.object(); // 获取JSON根对象
-
-        // 检查JSON响应中是否包含必要的字段
-        if (jsonObj.contains("main") && jsonObj.contains("weather") && jsonObj.contains("name")) {
-            QJsonObject mainObject = jsonObj["main"].toObject(); // 获取“main”对象，包含温度等信息
-            QJsonArray weatherArray = jsonObj["weather"].toArray(); // 获取“weather”数组，包含天气状况
-
-            QString cityName = jsonObj["name"].toString(); // 城市名
-            double temperature = mainObject["temp"].toDouble(); // 温度
-            QString englishCondition = weatherArray[0].toObject()["description"].toString(); // 天气描述（英文）
-            QString iconCode = weatherArray[0].toObject()["icon"].toString(); // 天气图标代码
-
-            // 更新UI显示
-            updateWeatherUI(cityName, temperature, englishCondition, iconCode);
-        } else {
-            qDebug() << "无效的 JSON 响应：" << responseData;
-            updateWeatherUI("错误", 0.0, "无法解析天气数据。", ""); // 传递空图标代码
-        }
-    } else {
-        qDebug() << "网络错误：" << reply->errorString();
-        updateWeatherUI("错误", 0.0, QString("无法获取天气：%1").arg(reply->errorString()), ""); // 传递空图标代码
+    qDebug() << "获取天气失败：" << city << error;
+    WeatherReading cached;
+    if (weatherService->cachedReading(city, cached)) {
+        // 有旧数据时继续显示，只在状态行提示
+        weatherStatusLabel->setText(QString("更新失败，显示 %1 的数据")
+                                        .arg(cached.fetchedAt.toString("MM-dd HH:mm")));
+        return;
     }
-    reply->deleteLater(); // 释放QNetworkReply对象，避免内存泄漏
+    if (!weatherLocationLabel->text().isEmpty() && !weatherTemperatureLabel->text().isEmpty()) {
+        weatherStatusLabel->setText(QString("无法获取 %1 的天气：%2").arg(city, error));
+        return;
+    }
+    updateWeatherUI("错误", 0.0, 0, QString("无法获取天气：%1").arg(error), ""); // 传递空图标代码
+    weatherStatusLabel->clear();
 }
 
-// 辅助函数：根据英文天气描述获取中文描述
-QString MainWindow::getChineseWeatherCondition(const QString &englishCondition)
+// 辅助函数：根据天气代码（优先）或英文描述获取中文描述，查的是编译期常量表
+QString MainWindow::getChineseWeatherCondition(int conditionId, const QString &englishCondition)
 {
-    QString lowerCaseCondition = englishCondition.toLower();
-    if (weatherTranslationMap.contains(lowerCaseCondition)) {
-        return weatherTranslationMap.value(lowerCaseCondition);
-    } else {
-        qDebug() << "未找到天气描述的中文翻译：" << englishCondition;
-        return englishCondition; // 如果没有找到翻译，返回原始英文描述
-    }
+    return WeatherConditionTable::toChinese(conditionId, englishCondition);
 }
 
-void MainWindow::updateWeatherUI(const QString &city, double temperature, const QString &englishCondition, const QString &iconCode)
+void MainWindow::updateWeatherUI(const QString &city, double temperature, int conditionId, const QString &englishCondition, const QString &iconCode)
 {
     weatherLocationLabel->setText(city);
     // 格式化温度，保留一位小数，并加上摄氏度符号
     weatherTemperatureLabel->setText(QString("%1°C").arg(temperature, 0, 'f', 1));
 
     // 获取中文天气描述
-    QString chineseCondition = getChineseWeatherCondition(englishCondition);
+    QString chineseCondition = getChineseWeatherCondition(conditionId, englishCondition);
     weatherConditionLabel->setText(chineseCondition);
 
-    // 从OpenWeatherMap下载图标
+    // 图标先查内存/磁盘缓存，都没有时才下载
+    m_currentIconCode = iconCode;
     if (!iconCode.isEmpty()) {
-        QString iconUrl = QString("https://openweathermap.org/img/wn/%1@2x.png").arg(iconCode); // 获取@2x大小的图标
-        iconNetManager->get(QNetworkRequest(QUrl(iconUrl)));
+        weatherService->fetchIcon(iconCode, weatherIconLabel->size());
     } else {
         weatherIconLabel->clear(); // 没有图标代码，清除图标
     }
 }
 
-// 处理图标下载完成的槽函数
-void MainWindow::onWeatherIconReply(QNetworkReply *reply)
+// 图标就绪（已按 QLabel 大小缩放并缓存）
+void MainWindow::onWeatherIconReady(const QString &iconCode, const QPixmap &pixmap)
 {
-    if (reply->error() == QNetworkReply::NoError) {
-        QPixmap pixmap;
-        if (pixmap.loadFromData(reply->readAll())) {
-            // 根据 QLabel 的大小等比例缩放图标
-            weatherIconLabel->setPixmap(pixmap.scaled(weatherIconLabel->size(), Qt::KeepAspectRatio, Qt::SmoothTransformation));
-        } else {
-            qDebug() << "无法从数据加载图标。";
-            weatherIconLabel->clear();
-        }
-    } else {
-        qDebug() << "图标下载错误：" << reply->errorString();
-        weatherIconLabel->clear();
-    }
-    reply->deleteLater();
+    if (iconCode != m_currentIconCode) return; // 已经切换到别的城市
+    weatherIconLabel->setPixmap(pixmap);
 }
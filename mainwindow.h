@@ -12,7 +12,6 @@
 #include <QTextCharFormat>
 #include <QSet>
 #include <QLabel>
-#include <QMovie>
 #include <QWidget>
 #include <QLabel>
 #include <QTimer>
@@ -33,6 +32,15 @@
 #include "DailyTask.h"
 #include "DailyTaskDialog.h"
 #include "TaskReminderDialog.h"
+#include "ReminderScheduler.h"
+#include "WeatherService.h"
+
+class QSystemTrayIcon;
+class TypewriterLabel;
+class AnimationPlayer;
+class PlannerRpcServer;
+class MetricsExporter;
+class DiagnosticsWindow;
 
 QT_BEGIN_NAMESPACE
 namespace Ui {
@@ -57,33 +65,42 @@ private slots:
     void onCourseScheduleButtonClicked();
     void onStudySessionButtonClicked();
     void onStatisticsButtonClicked();
+    void onDiagnosticsShortcut(); // Ctrl+Shift+D 打开诊断面板
     void onDateSelected(const QDate &date);
     void onAddDailyTaskClicked();
     void onReminderButtonClicked();
 
-    void onTypewriterTimeout();
+    void onReminderDue(const DatedTask &task, int leadMinutes); // 日程提醒到点
+    void onSearchTextChanged();                                // 搜索框输入（防抖后执行）
+    void onSearchResultActivated(QListWidgetItem *item);       // 点击搜索结果跳到对应日期
 
     // 天气模块的槽函数
     void onFetchWeatherButtonClicked(); // 搜索天气按钮点击槽函数
-    void onWeatherApiReply(QNetworkReply *reply); // 天气API响应槽函数
-    void onWeatherIconReply(QNetworkReply *reply); // 新增槽函数处理图标下载
+    void onWeatherReady(const WeatherReading &reading); // 天气数据返回（可能来自缓存）
+    void onWeatherFailed(const QString &city, const QString &error); // 天气获取失败
+    void onWeatherIconReady(const QString &iconCode, const QPixmap &pixmap); // 图标就绪（已缩放）
+    void onWeatherRevalidating(const QString &city); // 后台刷新开始
+
+    void startDeferredInit(); // 首帧之后再做的初始化
 
 private:
     void setupUiLooks();
     void updateCalendarHighlights();
+    void applyCalendarHighlights(const QList<QDate> &datesWithTasks); // 按剩余天数给日期上色
+    void showTasksForDate(const QDate &date, const QList<DailyTask> &tasks);
+    void ensureDatabase(); // 第一次用到时打开数据库
     void setupWeatherUI(); // 设置天气UI的函数
-
-    // 打字机相关函数
-    void startTypewriter(int intervalMs = 120);
-    void selectNextPhrase();
+    void ensureWeatherService(); // 第一次用到时创建天气服务
+    void startWeatherService(); // 先显示上次的天气，再后台刷新
+    void startGifAnimation();
 
     // 天气模块相关函数
     void fetchWeather(const QString &city); // 获取天气数据
     // 修改：增加一个参数用于传递原始的英文天气描述和图标代码，以便进行翻译和图标加载
-    void updateWeatherUI(const QString &city, double temperature, const QString &englishCondition, const QString &iconCode); // 更新天气UI显示
+    void updateWeatherUI(const QString &city, double temperature, int conditionId, const QString &englishCondition, const QString &iconCode); // 更新天气UI显示
 
-    // 辅助函数：根据英文天气描述获取中文描述
-    QString getChineseWeatherCondition(const QString &englishCondition);
+    // 辅助函数：根据天气代码或英文描述获取中文描述
+    QString getChineseWeatherCondition(int conditionId, const QString &englishCondition);
 
 
     Ui::MainWindow *ui;
@@ -97,41 +114,51 @@ private:
     QMap<QDate, QList<DailyTask>> dateInfoMap;
     QCalendarWidget *calendarWidget;
     QTextEdit *detailTextEdit;
+
+    // 日程搜索
+    QLineEdit *searchLineEdit;
+    QListWidget *searchResultList;
+    QTimer *searchDebounceTimer;
     QDate currentSelectedDate;
 
     QSet<QDate> m_highlightedDates;
 
+    // 冷启动快照：首帧之后才打开数据库，任务变动后防抖重写快照
+    bool m_databaseReady = false;
+    QTimer *snapshotTimer = nullptr;
+
     CourseScheduleWindow *courseWindow;
     StudySessionDialog *studyDialog;
     StatisticsWindow *statsWindow;
 
+    // 日程提醒
+    ReminderScheduler *reminderScheduler;
+    // 本地 RPC 服务，设置里启用时才创建
+    PlannerRpcServer *rpcServer = nullptr;
+    // 指标导出（Prometheus 文本文件/本机端口）和诊断面板
+    MetricsExporter *metricsExporter = nullptr;
+    DiagnosticsWindow *diagnosticsWindow = nullptr;
+    QSystemTrayIcon *trayIcon;
+
     // 新增 GIF 播放控件
     QLabel *gifLabel;
-    QMovie *gifMovie;
+    AnimationPlayer *gifPlayer = nullptr; // 首帧之后才创建
 
     // 顶部打字机
-    QLabel      *headerLabel;
-    QTimer      *typewriterTimer;
-    QStringList  phraseList;      // 语句库
-    QString      currentPhrase;   // 当前正在打/删的句子
-    int          typewriterPos;   // 在 currentPhrase 中的位置
-    bool         deletingPhase;   // false=打字，true=删除
+    TypewriterLabel *headerLabel;
 
     // 天气模块成员变量
-    QNetworkAccessManager *netManager; // 网络请求管理器 (用于天气数据)
-    QNetworkAccessManager *iconNetManager; // 新增：用于下载图标的网络管理器
+    WeatherService *weatherService;    // 天气服务：缓存、请求合并、图标缓存
+    QString m_currentIconCode;         // 当前显示的天气图标，丢弃过期的图标回调
     QLabel *weatherLocationLabel;      // 显示城市名
     QLabel *weatherTemperatureLabel;   // 显示温度
     QLabel *weatherConditionLabel;     // 显示天气状况（中文）
     QLabel *weatherIconLabel;          // 天气图标标签
+    QLabel *weatherStatusLabel;        // 更新时间/刷新状态，刷新时不清空已显示的数据
     QLineEdit *cityLineEdit;           // 城市输入框
     QPushButton *fetchWeatherButton;   // 获取天气按钮
 
     QString m_apiKey; // OpenWeatherMap API Key
-    const QString OPENWEATHER_API_BASE_URL = "http://api.openweathermap.org/data/2.5/weather?"; // OpenWeatherMap API基础URL
-
-    // 天气描述到中文翻译的映射
-    QMap<QString, QString> weatherTranslationMap;
 };
 
 #endif // MAINWINDOW_H
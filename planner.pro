@@ -0,0 +1,35 @@
+# 整个项目的顶层：先构建不依赖界面的核心静态库 plannercore，其余目标都链接它。
+#   qmake planner.pro && make && make check
+# 单独打开 QTfinal.pro 等子项目前需要先构建 plannercore。
+TEMPLATE = subdirs
+
+SUBDIRS += \
+    plannercore \
+    app \
+    cli \
+    bench \
+    rpc_loadtest \
+    schedule_import_test \
+    delta_sync_test \
+    weather_table_test
+
+plannercore.file = plannercore.pro
+
+app.file = QTfinal.pro
+app.depends = plannercore
+
+cli.file = cli/planner_cli.pro
+cli.depends = plannercore
+
+bench.file = benchmarks/planner_bench.pro
+bench.depends = plannercore
+
+rpc_loadtest.file = benchmarks/rpc_loadtest.pro
+
+schedule_import_test.file = tests/schedule_import_test.pro
+schedule_import_test.depends = plannercore
+
+delta_sync_test.file = tests/delta_sync_test.pro
+delta_sync_test.depends = plannercore
+
+weather_table_test.file = tests/weather_table_test.pro
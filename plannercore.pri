@@ -0,0 +1,16 @@
+# 链接规划器核心静态库 plannercore（见 plannercore.pro）。应用、命令行工具、基准测试和单元测试 include 这个文件，
+# 核心的源码只在 plannercore.pro 里编译一次；需要先构建 plannercore，整体构建用顶层的 planner.pro。
+QT += sql network concurrent
+
+INCLUDEPATH += $$PWD
+DEPENDPATH += $$PWD
+
+PLANNERCORE_LIB = $$qtLibraryTarget(plannercore)
+PLANNERCORE_LIB_DIR = $$shadowed($$PWD)
+LIBS += -L$$PLANNERCORE_LIB_DIR -l$$PLANNERCORE_LIB
+# 库更新后重新链接
+win32-msvc*: PRE_TARGETDEPS += $$PLANNERCORE_LIB_DIR/$${PLANNERCORE_LIB}.lib
+else: PRE_TARGETDEPS += $$PLANNERCORE_LIB_DIR/lib$${PLANNERCORE_LIB}.a
+
+# StallWatchdog 在 Windows 上用 DbgHelp 采集和解析主线程的调用栈
+win32: LIBS += -ldbghelp
@@ -0,0 +1,74 @@
+# 不依赖界面的规划器核心：任务与重复规则、自习记录、课表、空闲教室、提醒与统计，构建成静态库 plannercore。
+# QT 里没有 gui/widgets，核心代码一旦引用了界面类就无法通过编译。
+# 应用、命令行工具、基准测试和单元测试通过 plannercore.pri 链接它，整体构建见 planner.pro。
+TEMPLATE = lib
+CONFIG += staticlib c++17
+QT = core sql network concurrent
+
+# Windows 上调试版叫 plannercored，避免和发布版的程序混着链接
+TARGET = $$qtLibraryTarget(plannercore)
+DESTDIR = $$shadowed($$PWD)
+
+# 和 QTfinal.pro 共用一个构建目录，中间文件单独放
+CONFIG(debug, debug|release) {
+    OBJECTS_DIR = plannercore_build/debug
+    MOC_DIR = plannercore_build/debug
+} else {
+    OBJECTS_DIR = plannercore_build/release
+    MOC_DIR = plannercore_build/release
+}
+
+SOURCES += \
+    BatchScheduleImporter.cpp \
+    DailyTask.cpp \
+    DatabaseManager.cpp \
+    DeltaSync.cpp \
+    FreeRoomClient.cpp \
+    FreeRoomModel.cpp \
+    GroupAvailability.cpp \
+    GroupScheduleStore.cpp \
+    ICalendar.cpp \
+    MetricsExporter.cpp \
+    MetricsRegistry.cpp \
+    NetworkService.cpp \
+    PlannerRpcServer.cpp \
+    PlannerSnapshot.cpp \
+    PythonWorker.cpp \
+    RecurrenceRule.cpp \
+    ReminderScheduler.cpp \
+    ScheduleHtmlParser.cpp \
+    ScheduleModel.cpp \
+    StallWatchdog.cpp \
+    StudySessionEngine.cpp \
+    StudyStatistics.cpp \
+    TaskTransfer.cpp \
+    UpcomingTaskModel.cpp
+
+HEADERS += \
+    BatchScheduleImporter.h \
+    DailyTask.h \
+    DatabaseManager.h \
+    DeltaSync.h \
+    FreeRoomClient.h \
+    FreeRoomModel.h \
+    GroupAvailability.h \
+    GroupScheduleStore.h \
+    ICalendar.h \
+    MetricsExporter.h \
+    MetricsRegistry.h \
+    NetworkService.h \
+    PersonSchedule.h \
+    PlannerRpcServer.h \
+    PlannerSnapshot.h \
+    PythonWorker.h \
+    RecurrenceRule.h \
+    ReminderScheduler.h \
+    ScheduleHtmlParser.h \
+    ScheduleModel.h \
+    StallWatchdog.h \
+    StudySegment.h \
+    StudySessionEngine.h \
+    StudyStatistics.h \
+    TaskTransfer.h \
+    UpcomingTaskModel.h \
+    WeatherConditionTable.h
@@ -42,10 +42,45 @@ def write_debug_json(payload: str):
         # 如果写入失败，在标准错误流中打印调试信息
         print(f"调试: 写入调试文件失败: {e}", file=sys.stderr)
 
+def build_result(building: str, rows):
+    """
+    构造C++程序所期望的JSON结构: {楼宇: {日期: {节次: [教室...]}}}
+    """
+    result = {building: {}}
+    for row in rows:
+        room = row.get("room", "").strip()
+        date = row.get("date", "default")
+        if not room:
+            continue
+        
+        # setdefault会返回指定键的值，如果键不存在，则插入带有默认值的键
+        sects = result[building].setdefault(date, {})
+        for k, v in row.items():
+            # 过滤掉非节次信息（如教室名、容量、日期）
+            if k in ("room", "cap", "date"):
+                continue
+            # 如果值为""，表示该节次是空闲的
+            if v == "":
+                sects.setdefault(k, []).append(room)
+    return result
+
+def query(building: str, time: str):
+    """
+    常驻 worker 使用：网络错误直接抛出，由 worker 转成 error 应答。
+    """
+    return build_result(building, get_free_classroom(building, time))
+
 def main():
+    # 常驻模式：按行读取 JSON 请求，不写调试文件
+    if len(sys.argv) == 2 and sys.argv[1] == "--worker":
+        import worker_loop
+        worker_loop.serve({"free_rooms": lambda params: query(params.get("building", ""),
+                                                              params.get("time", "今天"))})
+        return
+
     # 检查命令行参数是否正确
     if len(sys.argv) != 3:
-        payload = json.dumps({"error": "用法: query_free_rooms.py <教学楼> <时间>"}, ensure_ascii=False)
+        payload = json.dumps({"error": "用法: query_free_room.py <教学楼> <时间> 或 query_free_room.py --worker"}, ensure_ascii=False)
         write_debug_json(payload)
         send_output(payload) # 使用辅助函数输出
         sys.exit(0)
@@ -61,30 +96,12 @@ def main():
         send_output(payload) # 使用辅助函数输出
         sys.exit(0)
 
-    # 构造C++程序所期望的JSON结构
-    result = {building: {}}
-    for row in rows:
-        room = row.get("room", "").strip()
-        date = row.get("date", "default")
-        if not room:
-            continue
-        
-        # setdefault会返回指定键的值，如果键不存在，则插入带有默认值的键
-        sects = result[building].setdefault(date, {})
-        for k, v in row.items():
-            # 过滤掉非节次信息（如教室名、容量、日期）
-            if k in ("room", "cap", "date"):
-                continue
-            # 如果值为""，表示该节次是空闲的
-            if v == "":
-                sects.setdefault(k, []).append(room)
-
     # 将最终结果转换为JSON格式的字符串
-    payload = json.dumps(result, ensure_ascii=False)
+    payload = json.dumps(build_result(building, rows), ensure_ascii=False)
     write_debug_json(payload)
 
     # 使用辅助函数进行最终的输出
     send_output(payload)
 
 if __name__ == "__main__":
-    main()
\ No newline at end of file
+    main()
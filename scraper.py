@@ -1,4 +1,6 @@
 # scraper.py (最终版 - 接收文件路径参数)
+# 用法: python scraper.py <文件路径>   解析一次并把 JSON 写到标准输出
+#       python scraper.py --worker     常驻模式，见 worker_loop.py；同时提供空闲教室查询
 import json
 import sys
 from bs4 import BeautifulSoup
@@ -62,9 +64,28 @@ def parse_schedule_from_file(file_path):
     return courses
 
 
+def handle_parse_schedule(params):
+    data = parse_schedule_from_file(params.get("path", ""))
+    if data is None:
+        raise RuntimeError("无法读取课表文件")
+    return data
+
+
+def handle_free_rooms(params):
+    # 只有用到时才导入 requests
+    import query_free_room
+    return query_free_room.query(params.get("building", ""), params.get("time", "今天"))
+
+
 if __name__ == '__main__':
+    if len(sys.argv) > 1 and sys.argv[1] == '--worker':
+        import worker_loop
+        worker_loop.serve({
+            "parse_schedule": handle_parse_schedule,
+            "free_rooms": handle_free_rooms,
+        })
     # 检查是否从命令行接收到了文件路径参数
-    if len(sys.argv) > 1:
+    elif len(sys.argv) > 1:
         file_path_from_cpp = sys.argv[1]
         print(f"Python: 已接收到文件路径: {file_path_from_cpp}", file=sys.stderr)
 
@@ -1,4 +1,7 @@
 #include "smartroomwidget.h"
+#include "FreeRoomClient.h"
+#include "FreeRoomModel.h"
+#include "StallWatchdog.h"
 #include <QComboBox>
 #include <QListWidget>
 #include <QTableWidget>
@@ -7,17 +10,15 @@
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QHeaderView>
-#include <QProcess>
-#include <QCoreApplication>
-#include <QJsonDocument>
-#include <QJsonParseError>
 #include <QJsonObject>
 #include <QJsonArray>
 #include <QDebug>
 #include <QRegularExpression>
+#include <QSet>
 
 SmartRoomWidget::SmartRoomWidget(QWidget *parent)
     : QWidget(parent)
+    , freeRoomClient(new FreeRoomClient(this))
 {
     setWindowTitle("空闲教室查询和推荐");
     resize(800, 600);
@@ -75,125 +76,64 @@ SmartRoomWidget::SmartRoomWidget(QWidget *parent)
     mainLayout->addWidget(resultTable);
     mainLayout->addWidget(statusLabel);
     setLayout(mainLayout);
+
+    connect(freeRoomClient, &FreeRoomClient::finished,
+            this, &SmartRoomWidget::displayFreeRooms);
+    connect(freeRoomClient, &FreeRoomClient::failed,
+            this, &SmartRoomWidget::onQueryFailed);
 }
 
 void SmartRoomWidget::onSearchClicked()
 {
+    StallWatchdog::Operation tag("free-room-search");
     QString building = buildingBox->currentText();
     QString time = timeBox->currentText();
 
-    // 准备Python脚本路径
-    QString script = QCoreApplication::applicationDirPath() + "/query_free_rooms.py";
-    QStringList arguments = { script, building, time };
-
-    // 启动Python进程
-    QProcess process;
-    qDebug() << "执行命令: python" << script << building << time;
-    process.start("python", arguments);
-
-    // 等待进程完成（最多10秒）
-    if (!process.waitForFinished(10000)) {
-        statusLabel->setText("状态：脚本执行超时");
-        qDebug() << "stdout:" << process.readAllStandardOutput();
-        qDebug() << "stderr:" << process.readAllStandardError();
-        qDebug() << "exitCode" << process.exitCode();
-        return;
-    }
-
-    // 获取并处理脚本输出
-    QString output = process.readAllStandardOutput().trimmed();
-    qDebug() << "【Python输出】" << output;
-    parseJsonAndDisplay(output);
+    // 异步查询，不再阻塞界面；结果回来之前禁用查询按钮
+    searchButton->setEnabled(false);
+    statusLabel->setText(QString("状态：正在查询 %1 %2 的空闲教室...").arg(building, time));
+    freeRoomClient->query(building, time);
 }
 
-void SmartRoomWidget::parseJsonAndDisplay(const QString &jsonText)
+void SmartRoomWidget::onQueryFailed(const QString &building, const QString &error)
 {
-    // 清除旧数据
+    searchButton->setEnabled(true);
     resultTable->clearContents();
     resultTable->setRowCount(0);
+    statusLabel->setText(QString("状态：%1 查询失败（%2）").arg(building, error));
+}
 
-    // 处理空响应
-    QString payload = jsonText.trimmed();
-    if (payload.isEmpty()) {
-        qDebug() << "收到空JSON响应，使用默认空对象";
-        payload = "{}";
-    }
+void SmartRoomWidget::displayFreeRooms(const QString &queriedBuilding, const QJsonObject &root)
+{
+    StallWatchdog::Operation tag("free-room-results");
+    searchButton->setEnabled(true);
 
-    // 解析JSON
-    QJsonParseError err;
-    QJsonDocument doc = QJsonDocument::fromJson(payload.toUtf8(), &err);
+    // 清除旧数据
+    resultTable->clearContents();
+    resultTable->setRowCount(0);
 
-    // 检查JSON解析错误
-    if (err.error != QJsonParseError::NoError || !doc.isObject()) {
-        statusLabel->setText("状态：JSON解析错误");
-        qDebug() << "解析错误:" << err.errorString() << "\n原始数据:" << payload;
+    if (root.isEmpty()) {
+        statusLabel->setText("状态：无可用数据");
         return;
     }
 
-    QJsonObject root = doc.object();
-
-    // 获取当前选择的楼宇
-    QString building = buildingBox->currentText();
-    QString actualBuilding = building;
-
-    // 如果JSON中没有对应的楼宇键，使用第一个可用的键
-    if (!root.contains(building)) {
-        QStringList keys = root.keys();
-        if (keys.isEmpty()) {
-            statusLabel->setText("状态：无可用数据");
-            return;
-        }
-        actualBuilding = keys.first();
-        qDebug() << "未找到楼宇键" << building
-                 << "，使用" << actualBuilding << "代替";
-    }
-
-    QJsonObject buildingObj = root.value(actualBuilding).toObject();
-
-    // 获取用户选择的节次
-    QStringList selectedSections;
+    // 获取用户选择的节次（如"第3节课" -> 3），都不选表示全部节次
+    static const QRegularExpression nonDigits("[^0-9]");
+    QSet<int> selectedSections;
     for (int i = 0; i < sectionList->count(); ++i) {
         QListWidgetItem *item = sectionList->item(i);
         if (item->checkState() == Qt::Checked) {
-            QString section = item->text();
-            // 提取节次数字（如"第3节课" -> "3"）
-            section.remove(QRegularExpression("[^0-9]"));
-            selectedSections << section;
+            selectedSections.insert(QString(item->text()).remove(nonDigits).toInt());
         }
     }
 
-    // 填充结果表格
-    int recordCount = 0;
-    for (const QString &dateKey : buildingObj.keys()) {
-        QJsonObject sections = buildingObj.value(dateKey).toObject();
-
-        // 跳过"default"日期键
-        QString displayDate = (dateKey == "default" ? QString() : dateKey);
-
-        for (const QString &sectionKey : sections.keys()) {
-            // 提取节次数字（如"c3" -> "3"）
-            QString sectionNum = sectionKey;
-            sectionNum.remove(QRegularExpression("[^0-9]"));
-
-            // 如果用户选择了特定节次，跳过未选中的
-            if (!selectedSections.isEmpty() && !selectedSections.contains(sectionNum)) {
-                continue;
-            }
-
-            // 获取该节次的空闲教室列表
-            QJsonArray rooms = sections.value(sectionKey).toArray();
-            for (const QJsonValue &roomValue : rooms) {
-                QString room = roomValue.toString();
-                if (room.isEmpty()) continue;
-
-                // 添加行到结果表格
-                int row = resultTable->rowCount();
-                resultTable->insertRow(row);
-                resultTable->setItem(row, 0, new QTableWidgetItem(sectionNum));
-                resultTable->setItem(row, 1, new QTableWidgetItem(room));
-                recordCount++;
-            }
-        }
+    // 填充结果表格；使用发起查询时的楼宇（查询期间下拉框可能已经换了）
+    const QList<FreeRoomModel::Entry> entries = FreeRoomModel::entries(root, queriedBuilding, selectedSections);
+    const int recordCount = entries.size();
+    resultTable->setRowCount(recordCount);
+    for (int row = 0; row < recordCount; ++row) {
+        resultTable->setItem(row, 0, new QTableWidgetItem(QString::number(entries[row].period)));
+        resultTable->setItem(row, 1, new QTableWidgetItem(entries[row].room));
     }
 
     // 更新状态标签
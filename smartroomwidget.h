@@ -2,7 +2,9 @@
 #define SMARTROOMWIDGET_H
 
 #include <QWidget>
+#include <QJsonObject>
 
+class FreeRoomClient;
 class QComboBox;
 class QListWidget;
 class QTableWidget;
@@ -18,7 +20,8 @@ public:
 
 private slots:
     void onSearchClicked();
-    void parseJsonAndDisplay(const QString &jsonText);
+    void displayFreeRooms(const QString &building, const QJsonObject &root);
+    void onQueryFailed(const QString &building, const QString &error);
 
 private:
     QComboBox    *buildingBox;
@@ -27,6 +30,7 @@ private:
     QPushButton  *searchButton;
     QTableWidget *resultTable;
     QLabel       *statusLabel;
+    FreeRoomClient *freeRoomClient;
 };
 
 #endif // SMARTROOMWIDGET_H
@@ -0,0 +1,14 @@
+# 增量同步的单元测试：两个数据库经同一个临时共享目录互相同步（DeltaSync::syncDirectory），
+# 检查新增、修改、删除在两边收敛，重复同步不再合并变更。SQLite 缺少 JSON 函数时整组跳过。
+#   qmake delta_sync_test.pro && make && ./delta_sync_test
+QT = core testlib
+
+CONFIG += c++17 console testcase
+CONFIG -= app_bundle
+
+TARGET = delta_sync_test
+
+include(../plannercore.pri)
+
+SOURCES += \
+    tst_delta_sync.cpp
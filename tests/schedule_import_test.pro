@@ -0,0 +1,18 @@
+# 课表导入的单元测试：ScheduleHtmlParser 与 scraper.py 的输出逐字段对照，以及批量导入的命名规则。
+#   qmake schedule_import_test.pro && make && ./schedule_import_test
+# fixtures/schedule.json 是 python scraper.py fixtures/schedule.html 的输出，页面改动后需要重新生成。
+QT = core testlib
+
+CONFIG += c++17 console testcase
+CONFIG -= app_bundle
+
+TARGET = schedule_import_test
+
+include(../plannercore.pri)
+
+SOURCES += \
+    tst_schedule_import.cpp
+
+DISTFILES += \
+    fixtures/schedule.html \
+    fixtures/schedule.json
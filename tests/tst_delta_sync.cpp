@@ -0,0 +1,174 @@
+// 增量同步：两台“设备”各用一个数据库，通过同一个共享目录交换变更文件，
+// 新增、修改、删除都要在两边收敛，重复同步不再合并任何变更。
+// 同一进程里靠改 PLANNER_SYNC_DEVICE_ID 再重新 init 来切换设备，不碰本机的 QSettings
+#include "DatabaseManager.h"
+#include "DeltaSync.h"
+#include <QStandardPaths>
+#include <QTemporaryDir>
+#include <QThread>
+#include <QtTest>
+
+namespace {
+
+const QDate DAY(2025, 3, 10);
+
+QStringList titlesOn(const QDate &date)
+{
+    QStringList titles;
+    for (const DailyTask &task : DatabaseManager::instance().getTasksForDate(date)) {
+        titles << task.getTitle();
+    }
+    titles.sort();
+    return titles;
+}
+
+} // namespace
+
+class DeltaSyncTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void addsPropagate();
+    void updatesAndDeletesPropagate();
+    void resyncAppliesNothing();
+
+private:
+    // 切换到 device 的数据库（<case>_<device>.db）
+    bool openDevice(const QString &testCase, const QString &device);
+    // 以 device 的身份和 syncDir 同步一次
+    bool syncAs(const QString &testCase, const QString &device, const QString &syncDir,
+                DeltaSync::Stats *stats = nullptr);
+
+    QTemporaryDir m_dir;
+};
+
+void DeltaSyncTest::initTestCase()
+{
+    QVERIFY(m_dir.isValid());
+    QStandardPaths::setTestModeEnabled(true);
+    qputenv("PLANNER_SYNC_DEVICE_ID", "probe");
+    QVERIFY(DatabaseManager::instance().init(m_dir.filePath("probe.db")));
+    if (!DatabaseManager::instance().isChangeLogAvailable()) QSKIP("SQLite 缺少 JSON 函数，不记录变更日志");
+}
+
+void DeltaSyncTest::cleanupTestCase()
+{
+    qunsetenv("PLANNER_SYNC_DEVICE_ID");
+}
+
+bool DeltaSyncTest::openDevice(const QString &testCase, const QString &device)
+{
+    qputenv("PLANNER_SYNC_DEVICE_ID", device.toUtf8());
+    DatabaseManager &db = DatabaseManager::instance();
+    return db.init(m_dir.filePath(testCase + "_" + device + ".db")) && db.isChangeLogAvailable()
+           && db.deviceId() == device;
+}
+
+bool DeltaSyncTest::syncAs(const QString &testCase, const QString &device, const QString &syncDir,
+                           DeltaSync::Stats *stats)
+{
+    if (!openDevice(testCase, device)) return false;
+    QString error;
+    if (!DeltaSync::syncDirectory(syncDir, stats, &error)) {
+        qWarning() << device << "同步失败：" << error;
+        return false;
+    }
+    return true;
+}
+
+void DeltaSyncTest::addsPropagate()
+{
+    const QString syncDir = m_dir.filePath("adds");
+    DatabaseManager &db = DatabaseManager::instance();
+
+    QVERIFY(openDevice("adds", "device-a"));
+    DailyTask report("写报告", QTime(9, 0), QTime(10, 0));
+    QVERIFY(db.addDailyTask(DAY, report));
+    QVERIFY(db.addStudySession(QDateTime(DAY, QTime(14, 0)), QDateTime(DAY, QTime(15, 0)), 3600, "数学"));
+    DeltaSync::Stats a;
+    QVERIFY(syncAs("adds", "device-a", syncDir, &a));
+    QCOMPARE(a.sent, qint64(2));
+    QCOMPARE(a.received, qint64(0));
+
+    QVERIFY(openDevice("adds", "device-b"));
+    DailyTask review("复习", QTime(19, 0), QTime(21, 0));
+    QVERIFY(db.addDailyTask(DAY, review));
+    DeltaSync::Stats b;
+    QVERIFY(syncAs("adds", "device-b", syncDir, &b));
+    QCOMPARE(b.sent, qint64(1));
+    QCOMPARE(b.applied, qint64(2));
+    QCOMPARE(titlesOn(DAY), QStringList({"写报告", "复习"}));
+    QCOMPARE(db.getStudyDurationsByTag().value("数学"), 3600);
+
+    a = {};
+    QVERIFY(syncAs("adds", "device-a", syncDir, &a));
+    QCOMPARE(a.applied, qint64(1));
+    QCOMPARE(titlesOn(DAY), QStringList({"写报告", "复习"}));
+}
+
+void DeltaSyncTest::updatesAndDeletesPropagate()
+{
+    const QString syncDir = m_dir.filePath("edits");
+    DatabaseManager &db = DatabaseManager::instance();
+
+    QVERIFY(openDevice("edits", "device-a"));
+    DailyTask keep("预习", QTime(8, 0), QTime(9, 0));
+    DailyTask drop("取快递", QTime(12, 0), QTime(12, 30));
+    QVERIFY(db.addDailyTask(DAY, keep));
+    QVERIFY(db.addDailyTask(DAY, drop));
+    QVERIFY(syncAs("edits", "device-a", syncDir));
+    QVERIFY(syncAs("edits", "device-b", syncDir));
+    QCOMPARE(titlesOn(DAY), QStringList({"取快递", "预习"}));
+
+    // 后写者胜按毫秒比较，隔开一点，免得本地修改和刚合并进来的那条落在同一毫秒
+    QThread::msleep(5);
+    int keepId = -1;
+    int dropId = -1;
+    for (const DailyTask &task : db.getTasksForDate(DAY)) {
+        if (task.getTitle() == "预习") keepId = task.getId();
+        if (task.getTitle() == "取快递") dropId = task.getId();
+    }
+    QVERIFY(keepId > 0 && dropId > 0);
+    DailyTask renamed = keep;
+    renamed.setTitle("预习第三章");
+    QVERIFY(db.updateTaskById(keepId, renamed));
+    QVERIFY(db.deleteTaskById(dropId));
+    QVERIFY(syncAs("edits", "device-b", syncDir));
+    QCOMPARE(titlesOn(DAY), QStringList({"预习第三章"}));
+
+    DeltaSync::Stats a;
+    QVERIFY(syncAs("edits", "device-a", syncDir, &a));
+    QCOMPARE(a.applied, qint64(2));
+    QCOMPARE(a.conflicts, qint64(0));
+    QCOMPARE(titlesOn(DAY), QStringList({"预习第三章"}));
+}
+
+void DeltaSyncTest::resyncAppliesNothing()
+{
+    const QString syncDir = m_dir.filePath("resync");
+    DatabaseManager &db = DatabaseManager::instance();
+
+    QVERIFY(openDevice("resync", "device-a"));
+    DailyTask task("背单词", QTime(7, 0), QTime(7, 30));
+    QVERIFY(db.addDailyTask(DAY, task));
+    QVERIFY(syncAs("resync", "device-a", syncDir));
+    QVERIFY(syncAs("resync", "device-b", syncDir));
+    QVERIFY(syncAs("resync", "device-a", syncDir));
+
+    // 对端转回来的本机变更只算重复，两边都不再有需要合并的
+    const QStringList devices = {"device-b", "device-a"};
+    for (const QString &device : devices) {
+        DeltaSync::Stats stats;
+        QVERIFY(syncAs("resync", device, syncDir, &stats));
+        QCOMPARE(stats.applied, qint64(0));
+        QCOMPARE(stats.conflicts, qint64(0));
+        QCOMPARE(titlesOn(DAY), QStringList({"背单词"}));
+    }
+}
+
+QTEST_GUILESS_MAIN(DeltaSyncTest)
+
+#include "tst_delta_sync.moc"
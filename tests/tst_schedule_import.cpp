@@ -0,0 +1,105 @@
+// 课表导入：C++ 解析器对同一份页面的输出必须和 scraper.py 完全一致（包括 raw_text 里的空白），
+// 批量导入时人名取相对拖入目录的路径，同一批里仍重名的加编号并报告
+#include "BatchScheduleImporter.h"
+#include "ScheduleHtmlParser.h"
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QTemporaryDir>
+#include <QtTest>
+
+class ScheduleImportTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void parserMatchesScraper();
+    void parserWithoutTable();
+    void namesRelativeToRoot();
+    void duplicateNamesNumbered();
+};
+
+void ScheduleImportTest::parserMatchesScraper()
+{
+    const QString htmlPath = QFINDTESTDATA("fixtures/schedule.html");
+    const QString jsonPath = QFINDTESTDATA("fixtures/schedule.json");
+    QVERIFY(!htmlPath.isEmpty() && !jsonPath.isEmpty());
+
+    QFile jsonFile(jsonPath);
+    QVERIFY(jsonFile.open(QIODevice::ReadOnly));
+    const QJsonArray expected = QJsonDocument::fromJson(jsonFile.readAll()).array();
+    QVERIFY(!expected.isEmpty());
+
+    QList<CourseEntry> courses;
+    QString error;
+    QVERIFY2(ScheduleHtmlParser::parseFile(htmlPath, courses, &error), qPrintable(error));
+    QCOMPARE(courses.size(), expected.size());
+    for (int i = 0; i < courses.size(); ++i) {
+        const QJsonObject actual = courses.at(i).toJson();
+        const QJsonObject want = expected.at(i).toObject();
+        for (auto it = want.constBegin(); it != want.constEnd(); ++it) {
+            QVERIFY2(actual.value(it.key()) == it.value(),
+                     qPrintable(QString("第 %1 门课的 %2：实际 %3，期望 %4")
+                                    .arg(i)
+                                    .arg(it.key(), actual.value(it.key()).toVariant().toString(),
+                                         it.value().toVariant().toString())));
+        }
+    }
+}
+
+// 与 scraper.py 一样，找不到课表时返回空列表而不是报错
+void ScheduleImportTest::parserWithoutTable()
+{
+    QCOMPARE(ScheduleHtmlParser::parse("<html><body><table id=\"other\"></table></body></html>").size(), 0);
+}
+
+void ScheduleImportTest::namesRelativeToRoot()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString root = dir.filePath("小组");
+    for (const QString &file : {"一组/张三.html", "二组/张三.html", "李四.htm", "说明.md"}) {
+        QVERIFY(QDir().mkpath(QFileInfo(root + "/" + file).absolutePath()));
+        QFile f(root + "/" + file);
+        QVERIFY(f.open(QIODevice::WriteOnly));
+    }
+
+    QStringList renamed;
+    const QList<BatchScheduleImporter::Source> sources = BatchScheduleImporter::collectSources({root}, &renamed);
+    QStringList names;
+    for (const BatchScheduleImporter::Source &source : sources) names << source.name;
+    QCOMPARE(names, QStringList({"一组/张三", "二组/张三", "李四"}));
+    QVERIFY(renamed.isEmpty());
+
+    // 单独拖入的文件只取文件名
+    const QList<BatchScheduleImporter::Source> single =
+        BatchScheduleImporter::collectSources({root + "/一组/张三.html"});
+    QCOMPARE(single.size(), 1);
+    QCOMPARE(single.first().name, QString("张三"));
+}
+
+void ScheduleImportTest::duplicateNamesNumbered()
+{
+    QTemporaryDir first;
+    QTemporaryDir second;
+    QVERIFY(first.isValid() && second.isValid());
+    for (const QString &path : {first.filePath("张三.html"), first.filePath("张三.txt"), second.filePath("张三.html")}) {
+        QFile f(path);
+        QVERIFY(f.open(QIODevice::WriteOnly));
+    }
+
+    QStringList renamed;
+    const QList<BatchScheduleImporter::Source> sources =
+        BatchScheduleImporter::collectSources({first.path(), second.path(), first.filePath("张三.html")}, &renamed);
+    QStringList names;
+    for (const BatchScheduleImporter::Source &source : sources) names << source.name;
+    // 同一路径只导入一次；重名的依次编号，并逐个列出
+    QCOMPARE(names, QStringList({"张三", "张三 (2)", "张三 (3)"}));
+    QCOMPARE(renamed.size(), 2);
+    QVERIFY(renamed.at(0).endsWith("张三 (2)"));
+    QVERIFY(renamed.at(1).endsWith("张三 (3)"));
+}
+
+QTEST_GUILESS_MAIN(ScheduleImportTest)
+
+#include "tst_schedule_import.moc"
@@ -0,0 +1,112 @@
+// WeatherConditionTable 的查表结果：每个已知 id 的译文逐条对照 OpenWeatherMap 的代码表，
+// 另外覆盖按英文描述查找和未知 id 的大类兜底。期望值单独写在这里，不从被测的表里取
+#include "WeatherConditionTable.h"
+#include <QtTest>
+
+class WeatherTableTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void byId_data();
+    void byId();
+    void idTableFullyCovered();
+    void byDescription_data();
+    void byDescription();
+    void groupFallback_data();
+    void groupFallback();
+};
+
+void WeatherTableTest::byId_data()
+{
+    QTest::addColumn<int>("id");
+    QTest::addColumn<QString>("chinese");
+
+    const QList<QPair<int, QString>> expected = {
+        {200, "雷阵雨"}, {201, "雷雨"}, {202, "雷暴大雨"}, {210, "弱雷暴"}, {211, "雷暴"},
+        {212, "强雷暴"}, {221, "零星雷暴"}, {230, "雷暴伴小毛毛雨"}, {231, "雷暴伴毛毛雨"}, {232, "雷暴伴大毛毛雨"},
+        {300, "毛毛雨"}, {301, "毛毛雨"}, {302, "大毛毛雨"}, {310, "小毛毛雨"}, {311, "毛毛雨"},
+        {312, "大毛毛雨"}, {313, "阵雨夹毛毛雨"}, {314, "大阵雨夹毛毛雨"}, {321, "阵性毛毛雨"},
+        {500, "小雨"}, {501, "中雨"}, {502, "大雨"}, {503, "暴雨"}, {504, "大暴雨"},
+        {511, "冻雨"}, {520, "小阵雨"}, {521, "阵雨"}, {522, "大阵雨"}, {531, "零星阵雨"},
+        {600, "小雪"}, {601, "雪"}, {602, "大雪"}, {611, "雨夹雪"}, {612, "小阵雨夹雪"},
+        {613, "阵雨夹雪"}, {615, "小雨夹雪"}, {616, "雨夹雪"}, {620, "小阵雪"}, {621, "阵雪"}, {622, "大阵雪"},
+        {701, "薄雾"}, {711, "烟"}, {721, "霾"}, {731, "沙尘暴"}, {741, "雾"},
+        {751, "扬沙"}, {761, "浮尘"}, {762, "火山灰"}, {771, "飑"}, {781, "龙卷风"},
+        {800, "晴空"}, {801, "少云"}, {802, "多云"}, {803, "碎云"}, {804, "阴天"},
+    };
+    for (const auto &[id, chinese] : expected) {
+        QTest::newRow(qPrintable(QString::number(id))) << id << chinese;
+    }
+}
+
+void WeatherTableTest::byId()
+{
+    QFETCH(int, id);
+    QFETCH(QString, chinese);
+    QCOMPARE(QString::fromUtf8(WeatherConditionTable::chineseById(id)), chinese);
+    // 描述对不上时仍以 id 为准
+    QCOMPARE(WeatherConditionTable::toChinese(id, u"something else"), chinese);
+}
+
+// 表里多出来的代码也要在上面的期望值里出现
+void WeatherTableTest::idTableFullyCovered()
+{
+    QCOMPARE(int(WeatherConditionTable::kIdCount), 55);
+}
+
+void WeatherTableTest::byDescription_data()
+{
+    QTest::addColumn<QString>("description");
+    QTest::addColumn<QString>("chinese");
+
+    QTest::newRow("exact") << "light rain" << "小雨";
+    QTest::newRow("case") << "Overcast Clouds" << "阴天";
+    QTest::newRow("trimmed") << "  fog " << "雾";
+    QTest::newRow("slash") << "sand/dust whirls" << "沙尘暴";
+    QTest::newRow("prefix of longer") << "rain" << "雨";
+    QTest::newRow("longer than entry") << "rain and snow" << "雨夹雪";
+    QTest::newRow("only in description table") << "hail" << "冰雹";
+    QTest::newRow("first") << "broken clouds" << "碎云";
+    QTest::newRow("last") << "volcanic ash" << "火山灰";
+}
+
+void WeatherTableTest::byDescription()
+{
+    QFETCH(QString, description);
+    QFETCH(QString, chinese);
+    // id 不认识（0 或新代码）时按描述查
+    QCOMPARE(WeatherConditionTable::toChinese(0, description), chinese);
+    QCOMPARE(WeatherConditionTable::toChinese(799, description), chinese);
+}
+
+void WeatherTableTest::groupFallback_data()
+{
+    QTest::addColumn<int>("id");
+    QTest::addColumn<QString>("description");
+    QTest::addColumn<QString>("chinese");
+
+    QTest::newRow("thunderstorm") << 299 << "new thunder" << "雷暴";
+    QTest::newRow("drizzle") << 399 << "new drizzle" << "毛毛雨";
+    QTest::newRow("rain") << 599 << "new rain" << "雨";
+    QTest::newRow("snow") << 699 << "new snow" << "雪";
+    QTest::newRow("atmosphere") << 799 << "new haze" << "雾霾";
+    QTest::newRow("cloud") << 899 << "new clouds" << "多云";
+    // 大类也没有时原样返回英文描述
+    QTest::newRow("unknown group") << 900 << "Tropical Storm" << "Tropical Storm";
+    QTest::newRow("no id") << 0 << "something odd" << "something odd";
+    QTest::newRow("empty") << 0 << "" << "";
+}
+
+void WeatherTableTest::groupFallback()
+{
+    QFETCH(int, id);
+    QFETCH(QString, description);
+    QFETCH(QString, chinese);
+    QVERIFY(!WeatherConditionTable::chineseById(id));
+    QCOMPARE(WeatherConditionTable::toChinese(id, description), chinese);
+}
+
+QTEST_APPLESS_MAIN(WeatherTableTest)
+
+#include "tst_weather_table.moc"
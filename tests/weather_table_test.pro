@@ -0,0 +1,16 @@
+# 天气状况中文翻译表（WeatherConditionTable.h）的单元测试：
+#   qmake weather_table_test.pro && make && ./weather_table_test
+QT = core testlib
+
+CONFIG += c++17 console testcase
+CONFIG -= app_bundle
+
+TARGET = weather_table_test
+
+INCLUDEPATH += $$PWD/..
+
+SOURCES += \
+    tst_weather_table.cpp
+
+HEADERS += \
+    ../WeatherConditionTable.h
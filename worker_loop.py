@@ -0,0 +1,53 @@
+# worker_loop.py - 常驻 worker 的通用循环
+# 协议：标准输入每行一个 JSON 请求 {"id": 1, "method": "...", "params": {...}}，
+# 标准输出每行一个 JSON 应答 {"id": 1, "result": ...} 或 {"id": 1, "error": "..."}。
+# 请求在线程池里处理，应答可能乱序，调用方按 id 对应。日志只写标准错误。
+import json
+import sys
+import threading
+from concurrent.futures import ThreadPoolExecutor
+
+_write_lock = threading.Lock()
+
+
+def _send(message):
+    line = json.dumps(message, ensure_ascii=False) + "\n"
+    with _write_lock:
+        sys.stdout.buffer.write(line.encode("utf-8"))
+        sys.stdout.buffer.flush()
+
+
+def _handle(handlers, request):
+    request_id = request.get("id")
+    method = request.get("method")
+    handler = handlers.get(method)
+    if handler is None:
+        _send({"id": request_id, "error": f"未知方法: {method}"})
+        return
+    try:
+        result = handler(request.get("params") or {})
+        _send({"id": request_id, "result": result})
+    except Exception as e:
+        _send({"id": request_id, "error": str(e)})
+
+
+def serve(handlers, max_workers=4):
+    """
+    读取标准输入直到 EOF（主程序关闭管道即退出）。
+    handlers: 方法名 -> 函数(params: dict)，返回值需可 JSON 序列化，出错时抛异常。
+    """
+    handlers = dict(handlers)
+    handlers.setdefault("ping", lambda params: "pong")
+    print(f"Python worker: 已启动，方法: {', '.join(sorted(handlers))}", file=sys.stderr)
+
+    with ThreadPoolExecutor(max_workers=max_workers) as pool:
+        for raw in sys.stdin.buffer:
+            raw = raw.strip()
+            if not raw:
+                continue
+            try:
+                request = json.loads(raw.decode("utf-8"))
+            except ValueError as e:
+                _send({"id": None, "error": f"请求不是合法的 JSON: {e}"})
+                continue
+            pool.submit(_handle, handlers, request)